@@ -0,0 +1,84 @@
+// src/InspectorGUI/Core/BinaryLogFormat.h
+
+#ifndef BINARYLOGFORMAT_H
+#define BINARYLOGFORMAT_H
+
+// 解释: 这个头文件只描述二进制日志文件的“字节布局”，不依赖Qt。
+//       写入端 (BinaryLogSink) 和离线解码工具 (LogDecoder) 共同包含它，
+//       保证两边对文件格式的理解永远一致。
+
+#include <cstdint>
+
+namespace BinaryLog
+{
+    // --- 文件头 ---
+    // 每个日志文件都以一个固定长度的文件头开始，解码器用它来识别文件和版本。
+    constexpr char     kFileMagic[8] = { 'P', 'I', 'L', 'O', 'G', '\0', '\0', '\1' };
+    constexpr uint32_t kFileVersion  = 1;
+
+    #pragma pack(push, 1)
+    struct FileHeader
+    {
+        char     magic[8];    // 固定为 kFileMagic
+        uint32_t version;     // 文件格式版本
+        uint32_t reserved;    // 保留字段，当前为0
+        int64_t  createdNs;   // 文件创建时刻 (自1970年起的纳秒数, UTC)
+    };
+
+    /**
+     * @brief 每条记录的公共头部。
+     * @details payloadSize 不包含头部本身，解码器可以借此跳过不认识的记录类型。
+     */
+    struct RecordHeader
+    {
+        uint8_t  type;        // RecordType
+        uint8_t  level;       // 日志级别 (与 QtMsgType 的取值一致)
+        uint16_t argCount;    // 参数个数 (仅 Event 记录有效)
+        uint32_t payloadSize; // 紧随其后的负载字节数
+    };
+
+    /**
+     * @brief Event 记录的固定负载部分，其后紧跟 argCount 个参数。
+     */
+    struct EventHeader
+    {
+        int64_t  timestampNs; // 记录产生时刻 (自1970年起的纳秒数, UTC)
+        uint32_t threadId;    // 产生记录的线程ID
+        uint32_t formatId;    // 格式字符串ID，对应同一文件中先前出现的 Format 记录
+    };
+    #pragma pack(pop)
+
+    // --- 记录类型 ---
+    enum RecordType : uint8_t
+    {
+        Record_Format = 1, // 负载: uint32 formatId + 格式字符串(UTF-8, 不含结尾'\0')
+        Record_Event  = 2, // 负载: EventHeader + 参数列表
+        Record_Lost   = 3  // 负载: uint32 threadId + uint64 丢弃的记录数 (线程缓冲区溢出时产生)
+    };
+
+    // --- 参数类型标签 ---
+    // 每个参数以1字节标签开头，后面是对应类型的原始字节。
+    enum ArgTag : uint8_t
+    {
+        Arg_Int64  = 1, // int64_t
+        Arg_UInt64 = 2, // uint64_t
+        Arg_Double = 3, // double
+        Arg_String = 4  // uint16_t 长度 + UTF-8 字节
+    };
+
+    // 日志级别 (与 QtMsgType 的取值保持一致，解码器不依赖Qt，所以在这里单独列出)
+    enum Level : uint8_t
+    {
+        Level_Debug    = 0,
+        Level_Warning  = 1,
+        Level_Critical = 2,
+        Level_Fatal    = 3,
+        Level_Info     = 4
+    };
+
+    // 格式ID 0 被保留给经由 qDebug/qInfo 等接口进入的普通文本日志，其格式固定为 "%s"。
+    constexpr uint32_t kTextFormatId = 0;
+
+} // namespace BinaryLog
+
+#endif // BINARYLOGFORMAT_H
@@ -0,0 +1,284 @@
+// src/InspectorGUI/Core/BinaryLogSink.cpp
+
+#include "BinaryLogSink.h"
+#include <QDateTime>
+#include <QDir>
+#include <QMutexLocker>
+#include <cstddef>
+
+// --- 1. 全局格式字符串注册表 ---
+// 解释: 注册表与 sink 实例无关（LOG_FAST 宏会把ID缓存在函数内的静态变量里，
+//       所以ID必须在整个进程生命周期内保持不变）。它只增不减，下标就是格式ID。
+//       使用函数内静态变量，避免不同编译单元之间静态对象初始化顺序的问题。
+namespace
+{
+    struct FormatRegistry
+    {
+        QMutex mutex;
+        std::vector<QByteArray> formats;
+
+        FormatRegistry()
+        {
+            formats.push_back(QByteArray("%s")); // ID 0: 普通文本日志 (BinaryLog::kTextFormatId)
+        }
+    };
+
+    FormatRegistry& formatRegistry()
+    {
+        static FormatRegistry registry;
+        return registry;
+    }
+
+    // 用于区分不同 sink 实例的递增编号
+    std::atomic<quint64> g_nextGeneration { 1 };
+
+    // 每个线程缓存“自己在哪个 sink 上的缓冲区”
+    struct LocalBufferCache
+    {
+        quint64 generation = 0;
+        std::shared_ptr<void> buffer; // 以 void 形式持有，真实类型是 BinaryLogSink::ThreadBuffer
+    };
+    thread_local LocalBufferCache t_localBuffer;
+
+    qint64 nowNs()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                   std::chrono::system_clock::now().time_since_epoch()).count();
+    }
+}
+
+quint32 BinaryLogSink::registerFormat(const char* format)
+{
+    FormatRegistry& registry = formatRegistry();
+    QMutexLocker locker(&registry.mutex);
+    registry.formats.push_back(QByteArray(format));
+    return static_cast<quint32>(registry.formats.size() - 1);
+}
+
+
+// --- 2. 构造与析构 ---
+BinaryLogSink::BinaryLogSink(const Options& options, QObject *parent)
+    : QThread(parent)
+    , m_options(options)
+    , m_generation(g_nextGeneration.fetch_add(1))
+{
+}
+
+BinaryLogSink::~BinaryLogSink()
+{
+    // 确保后台线程把剩余的记录写完再销毁
+    stop();
+    wait();
+}
+
+void BinaryLogSink::stop()
+{
+    QMutexLocker locker(&m_wakeMutex);
+    m_stopRequested = true;
+    m_wakeCondition.wakeOne();
+}
+
+
+// --- 3. 热路径辅助函数 ---
+BinaryLogSink::ThreadBuffer* BinaryLogSink::localBuffer()
+{
+    // 绝大多数调用直接命中 thread_local 缓存，无需任何加锁
+    if (t_localBuffer.generation == m_generation) {
+        return static_cast<ThreadBuffer*>(t_localBuffer.buffer.get());
+    }
+
+    // 本线程第一次向这个 sink 写日志：创建缓冲区并登记到列表中
+    auto buffer = std::make_shared<ThreadBuffer>();
+    buffer->threadId = static_cast<quint32>(reinterpret_cast<quintptr>(QThread::currentThreadId()));
+    buffer->data.reserve(static_cast<size_t>(m_options.threadBufferBytes) / 4);
+    {
+        QMutexLocker locker(&m_buffersMutex);
+        m_buffers.push_back(buffer);
+    }
+
+    t_localBuffer.generation = m_generation;
+    t_localBuffer.buffer = buffer;
+    return buffer.get();
+}
+
+void BinaryLogSink::beginRecord(ThreadBuffer* buffer, quint8 level, quint32 formatId, quint16 argCount, size_t& headerPos)
+{
+    // a. 先写入记录头，payloadSize 暂时为0，等参数写完后在 endRecord 中回填
+    headerPos = buffer->data.size();
+    BinaryLog::RecordHeader header;
+    header.type = BinaryLog::Record_Event;
+    header.level = level;
+    header.argCount = argCount;
+    header.payloadSize = 0;
+    put(buffer->data, &header, sizeof(header));
+
+    // b. 写入事件的固定部分：时间戳、线程ID、格式ID
+    BinaryLog::EventHeader event;
+    event.timestampNs = nowNs();
+    event.threadId = buffer->threadId;
+    event.formatId = formatId;
+    put(buffer->data, &event, sizeof(event));
+}
+
+void BinaryLogSink::endRecord(ThreadBuffer* buffer, size_t headerPos)
+{
+    const quint32 payloadSize = static_cast<quint32>(buffer->data.size() - headerPos - sizeof(BinaryLog::RecordHeader));
+    std::memcpy(buffer->data.data() + headerPos + offsetof(BinaryLog::RecordHeader, payloadSize),
+                &payloadSize, sizeof(payloadSize));
+}
+
+void BinaryLogSink::logText(quint8 level, const QByteArray& utf8)
+{
+    log(level, BinaryLog::kTextFormatId, utf8);
+}
+
+
+// --- 4. 后台线程 ---
+void BinaryLogSink::run()
+{
+    if (!openNewFile()) {
+        return;
+    }
+
+    while (true)
+    {
+        bool stopping = false;
+        {
+            QMutexLocker locker(&m_wakeMutex);
+            if (!m_stopRequested) {
+                m_wakeCondition.wait(&m_wakeMutex, static_cast<unsigned long>(m_options.flushIntervalMs));
+            }
+            stopping = m_stopRequested;
+        }
+
+        flushBuffers();
+        if (stopping) break;
+        rotateIfNeeded();
+    }
+
+    closeFile();
+}
+
+void BinaryLogSink::flushBuffers()
+{
+    // a. 在锁内复制一份缓冲区列表，避免在写文件期间阻塞新线程的登记
+    std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+    {
+        QMutexLocker locker(&m_buffersMutex);
+        buffers = m_buffers;
+    }
+
+    // b. 逐个交换出各线程缓冲区中的数据。交换 (swap) 只是交换指针，持锁时间极短。
+    m_scratch.clear();
+    std::vector<std::pair<quint32, quint64>> lost;
+    std::vector<char> swapped;
+    for (const auto& buffer : buffers)
+    {
+        quint64 dropped = 0;
+        {
+            QMutexLocker locker(&buffer->mutex);
+            swapped.swap(buffer->data);
+            dropped = buffer->dropped;
+            buffer->dropped = 0;
+        }
+        m_scratch.insert(m_scratch.end(), swapped.begin(), swapped.end());
+        swapped.clear(); // 保留容量，下次交换时还给线程使用
+        if (dropped > 0) {
+            lost.emplace_back(buffer->threadId, dropped);
+        }
+    }
+
+    if (!m_file.isOpen()) {
+        return; // 日志文件打开失败时只丢弃数据，保证线程缓冲区不会无限增长
+    }
+
+    // c. 先写出新注册的格式字典，保证文件中每个格式ID的定义都出现在使用它的记录之前
+    //    (记录中的格式ID一定是在记录产生之前注册的，而字典是在交换缓冲区之后才读取的)
+    writeFormats();
+
+    if (!m_scratch.empty()) {
+        m_file.write(m_scratch.data(), static_cast<qint64>(m_scratch.size()));
+    }
+
+    for (const auto& item : lost)
+    {
+        BinaryLog::RecordHeader header { BinaryLog::Record_Lost, 0, 0, sizeof(quint32) + sizeof(quint64) };
+        m_file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        m_file.write(reinterpret_cast<const char*>(&item.first), sizeof(item.first));
+        m_file.write(reinterpret_cast<const char*>(&item.second), sizeof(item.second));
+    }
+    m_file.flush();
+
+    // d. 清理已经退出的线程的缓冲区：只剩列表自己持有引用，且数据已经写完
+    QMutexLocker locker(&m_buffersMutex);
+    for (auto it = m_buffers.begin(); it != m_buffers.end();)
+    {
+        if (it->use_count() == 1 && (*it)->data.empty()) {
+            it = m_buffers.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void BinaryLogSink::writeFormats()
+{
+    FormatRegistry& registry = formatRegistry();
+    QMutexLocker locker(&registry.mutex);
+    for (; m_formatsWritten < registry.formats.size(); ++m_formatsWritten)
+    {
+        const QByteArray& format = registry.formats[m_formatsWritten];
+        const quint32 id = static_cast<quint32>(m_formatsWritten);
+        BinaryLog::RecordHeader header { BinaryLog::Record_Format, 0, 0,
+                                         static_cast<quint32>(sizeof(id) + format.size()) };
+        m_file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        m_file.write(reinterpret_cast<const char*>(&id), sizeof(id));
+        m_file.write(format);
+    }
+}
+
+bool BinaryLogSink::openNewFile()
+{
+    QDir dir(m_options.directory);
+    if (!dir.exists() && !dir.mkpath(".")) {
+        qWarning("BinaryLogSink: cannot create log directory %s", qPrintable(m_options.directory));
+        return false;
+    }
+
+    // 文件名形如 inspector_20250101_083000_123.plog，按时间排序即是写入顺序
+    const QDateTime now = QDateTime::currentDateTime();
+    const QString fileName = QString("%1_%2.plog").arg(m_options.filePrefix, now.toString("yyyyMMdd_hhmmss_zzz"));
+    m_file.setFileName(dir.filePath(fileName));
+    if (!m_file.open(QIODevice::WriteOnly)) {
+        qWarning("BinaryLogSink: cannot open log file %s", qPrintable(m_file.fileName()));
+        return false;
+    }
+
+    BinaryLog::FileHeader header;
+    std::memcpy(header.magic, BinaryLog::kFileMagic, sizeof(header.magic));
+    header.version = BinaryLog::kFileVersion;
+    header.reserved = 0;
+    header.createdNs = nowNs();
+    m_file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    m_fileOpenedMs = now.toMSecsSinceEpoch();
+    m_formatsWritten = 0; // 新文件需要重新写出完整的格式字典，保证每个文件都能独立解码
+    return true;
+}
+
+void BinaryLogSink::closeFile()
+{
+    if (m_file.isOpen()) {
+        m_file.close();
+    }
+}
+
+void BinaryLogSink::rotateIfNeeded()
+{
+    const bool tooLarge = m_file.size() >= m_options.maxFileBytes;
+    const bool tooOld = QDateTime::currentMSecsSinceEpoch() - m_fileOpenedMs >= qint64(m_options.maxFileSeconds) * 1000;
+    if (tooLarge || tooOld) {
+        closeFile();
+        openNewFile();
+    }
+}
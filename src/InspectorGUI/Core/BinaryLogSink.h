@@ -0,0 +1,217 @@
+// src/InspectorGUI/Core/BinaryLogSink.h
+
+#ifndef BINARYLOGSINK_H
+#define BINARYLOGSINK_H
+
+#include <QThread>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QFile>
+#include <QString>
+#include <QByteArray>
+
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "BinaryLogFormat.h"
+
+/**
+ * @class BinaryLogSink
+ * @brief 一个把日志以紧凑二进制记录写入磁盘的后台线程，支持按大小和时间滚动文件。
+ *
+ * @details 设计目标是让“热路径”（如检测线程、相机回调线程）记录日志的代价尽可能低：
+ * 1. 调用方不做任何字符串格式化，只写入“格式ID + 原始参数”。
+ * 2. 每个线程拥有自己的缓冲区，写日志时只会锁住自己线程的缓冲区，几乎不存在竞争。
+ * 3. 真正的文件写入由本线程(run)周期性地批量完成。
+ *
+ * 生成的 .plog 文件可以用 LogDecoder 工具离线还原为文本。
+ */
+class BinaryLogSink : public QThread
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @brief 文件输出的配置参数。
+     */
+    struct Options
+    {
+        QString directory;                          // 日志文件所在目录
+        QString filePrefix = "inspector";           // 日志文件名前缀
+        qint64 maxFileBytes = 64 * 1024 * 1024;     // 单个文件达到这个大小后滚动到新文件
+        int maxFileSeconds = 60 * 60;               // 单个文件写入超过这个时长后滚动到新文件
+        int flushIntervalMs = 200;                  // 后台线程批量落盘的周期
+        int threadBufferBytes = 1024 * 1024;        // 每个线程缓冲区的上限，超出的记录会被丢弃并计数
+    };
+
+    explicit BinaryLogSink(const Options& options, QObject *parent = nullptr);
+    ~BinaryLogSink();
+
+    /**
+     * @brief 注册一个格式字符串，并返回它的全局ID。
+     * @details 同一个格式字符串通常只在第一次使用时注册一次（见 LOG_FAST 宏），
+     * 之后每条记录只需携带这个ID。注册表与具体的 sink 实例无关，ID 在整个进程内有效。
+     */
+    static quint32 registerFormat(const char* format);
+
+    /**
+     * @brief [热路径] 记录一条二进制日志。
+     * @param level 日志级别 (QtMsgType 的取值)。
+     * @param formatId 由 registerFormat() 返回的格式ID。
+     * @param args 参数列表，支持整数、浮点数和字符串。
+     */
+    template<typename... Args>
+    void log(quint8 level, quint32 formatId, const Args&... args);
+
+    /**
+     * @brief 记录一条已经格式化好的文本日志 (用于转发 qDebug/qInfo 等普通日志)。
+     */
+    void logText(quint8 level, const QByteArray& utf8);
+
+    /**
+     * @brief 请求后台线程把剩余数据写完并退出。调用后应再调用 wait()。
+     */
+    void stop();
+
+protected:
+    virtual void run() override;
+
+private:
+    /**
+     * @brief 每个线程私有的记录缓冲区。
+     * @details 由 shared_ptr 同时被“所属线程的 thread_local 变量”和“sink 的缓冲区列表”持有，
+     * 因此线程退出后，其中尚未落盘的记录依然会被写出。
+     */
+    struct ThreadBuffer
+    {
+        QMutex mutex;
+        std::vector<char> data;
+        quint64 dropped = 0;
+        quint32 threadId = 0;
+    };
+
+    ThreadBuffer* localBuffer();
+    void beginRecord(ThreadBuffer* buffer, quint8 level, quint32 formatId, quint16 argCount, size_t& headerPos);
+    void endRecord(ThreadBuffer* buffer, size_t headerPos);
+
+    // --- 参数编码 (全部内联在头文件中，避免热路径上的函数调用) ---
+    static void put(std::vector<char>& out, const void* data, size_t size);
+    static void putString(std::vector<char>& out, const char* text, size_t length);
+    template<typename T>
+    static void putArg(std::vector<char>& out, const T& value);
+
+    // --- 后台线程使用的私有函数 ---
+    void flushBuffers();
+    void writeFormats();
+    bool openNewFile();
+    void closeFile();
+    void rotateIfNeeded();
+
+    Options m_options;
+    const quint64 m_generation; // 实例编号，用来让 thread_local 缓存识别“是否属于当前 sink”
+
+    QMutex m_buffersMutex;                              // 保护 m_buffers 列表本身
+    std::vector<std::shared_ptr<ThreadBuffer>> m_buffers; // 所有线程的缓冲区
+
+    QMutex m_wakeMutex;
+    QWaitCondition m_wakeCondition;
+    bool m_stopRequested = false;
+
+    // --- 以下成员只在后台线程中访问 ---
+    QFile m_file;
+    qint64 m_fileOpenedMs = 0;     // 当前文件的打开时刻
+    size_t m_formatsWritten = 0;   // 当前文件中已写入的格式字典条数
+    std::vector<char> m_scratch;   // 从线程缓冲区交换出来的待写数据
+};
+
+
+// =====================================================================
+//  模板与内联函数实现
+// =====================================================================
+
+inline void BinaryLogSink::put(std::vector<char>& out, const void* data, size_t size)
+{
+    const char* bytes = static_cast<const char*>(data);
+    out.insert(out.end(), bytes, bytes + size);
+}
+
+inline void BinaryLogSink::putString(std::vector<char>& out, const char* text, size_t length)
+{
+    const quint8 tag = BinaryLog::Arg_String;
+    const quint16 len = static_cast<quint16>(length > 0xFFFF ? 0xFFFF : length); // 超长字符串截断
+    put(out, &tag, sizeof(tag));
+    put(out, &len, sizeof(len));
+    put(out, text, len);
+}
+
+template<typename T>
+inline void BinaryLogSink::putArg(std::vector<char>& out, const T& value)
+{
+    // 解释: 使用 C++17 的 if constexpr 在编译期根据参数类型选择编码方式，
+    //       运行时只剩下几次 memcpy。
+    using D = std::decay_t<T>;
+    if constexpr (std::is_same_v<D, bool>) {
+        const quint8 tag = BinaryLog::Arg_UInt64;
+        const quint64 v = value ? 1 : 0;
+        put(out, &tag, sizeof(tag));
+        put(out, &v, sizeof(v));
+    } else if constexpr (std::is_enum_v<D>) {
+        const quint8 tag = BinaryLog::Arg_Int64;
+        const qint64 v = static_cast<qint64>(value);
+        put(out, &tag, sizeof(tag));
+        put(out, &v, sizeof(v));
+    } else if constexpr (std::is_integral_v<D> && std::is_signed_v<D>) {
+        const quint8 tag = BinaryLog::Arg_Int64;
+        const qint64 v = static_cast<qint64>(value);
+        put(out, &tag, sizeof(tag));
+        put(out, &v, sizeof(v));
+    } else if constexpr (std::is_integral_v<D>) {
+        const quint8 tag = BinaryLog::Arg_UInt64;
+        const quint64 v = static_cast<quint64>(value);
+        put(out, &tag, sizeof(tag));
+        put(out, &v, sizeof(v));
+    } else if constexpr (std::is_floating_point_v<D>) {
+        const quint8 tag = BinaryLog::Arg_Double;
+        const double v = static_cast<double>(value);
+        put(out, &tag, sizeof(tag));
+        put(out, &v, sizeof(v));
+    } else if constexpr (std::is_same_v<D, const char*> || std::is_same_v<D, char*>) {
+        const char* text = value; // 字符串字面量(数组)在这里退化为指针
+        putString(out, text ? text : "(null)", text ? std::strlen(text) : 6);
+    } else if constexpr (std::is_same_v<D, std::string>) {
+        putString(out, value.data(), value.size());
+    } else if constexpr (std::is_same_v<D, QByteArray>) {
+        putString(out, value.constData(), static_cast<size_t>(value.size()));
+    } else if constexpr (std::is_same_v<D, QString>) {
+        // 注意: QString 需要一次 UTF-8 转换，热路径上应尽量传递数字或 const char*。
+        const QByteArray utf8 = value.toUtf8();
+        putString(out, utf8.constData(), static_cast<size_t>(utf8.size()));
+    } else {
+        static_assert(sizeof(D) == 0, "BinaryLogSink: unsupported log argument type");
+    }
+}
+
+template<typename... Args>
+inline void BinaryLogSink::log(quint8 level, quint32 formatId, const Args&... args)
+{
+    ThreadBuffer* buffer = localBuffer();
+    QMutexLocker locker(&buffer->mutex); // 只锁本线程的缓冲区，仅在后台线程交换数据时才可能短暂竞争
+
+    if (buffer->data.size() >= static_cast<size_t>(m_options.threadBufferBytes)) {
+        // 缓冲区已满（磁盘跟不上），丢弃这条记录而不是阻塞热路径
+        ++buffer->dropped;
+        return;
+    }
+
+    size_t headerPos = 0;
+    beginRecord(buffer, level, formatId, static_cast<quint16>(sizeof...(Args)), headerPos);
+    (putArg(buffer->data, args), ...); // C++17 折叠表达式，依次编码每个参数
+    endRecord(buffer, headerPos);
+}
+
+#endif // BINARYLOGSINK_H
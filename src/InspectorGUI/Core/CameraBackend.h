@@ -0,0 +1,112 @@
+// src/InspectorGUI/Core/CameraBackend.h
+
+#ifndef CAMERABACKEND_H
+#define CAMERABACKEND_H
+
+#include <QStringList>
+#include <functional>
+#include <opencv2/opencv.hpp>
+#include "Inspector.h" // InspectorLib::PixelFormat
+
+/**
+ * @struct CameraFrameInfo
+ * @brief 后端送出一帧图像时附带的信息 (与具体的相机SDK无关)。
+ */
+struct CameraFrameInfo
+{
+    quint32 frameNum = 0;         // 相机帧号，连续采集时逐帧加1，用于发现丢帧
+    quint32 triggerIndex = 0;     // 相机的触发计数 (触发采集时，这一帧对应的是第几次触发)；0 表示后端不提供
+    quint64 deviceTimestamp = 0;  // 相机内部的时间戳 (设备时钟的计数值)
+    qint64 hostTimestampMs = 0;   // 主机端时间戳 (毫秒)
+    quint64 pixelType = 0;        // 像素格式 (SDK定义的枚举值，仅用于日志)
+    InspectorLib::PixelFormat pixelFormat = InspectorLib::PixelFormat_Mono8; // frame 的存放方式，见 InspectorLib::WrapRawFrame
+    quint32 lostPackets = 0;      // 传输中丢失的数据包数
+    int offsetX = 0;              // 这一帧 (ROI) 左上角在传感器上的位置，单位为传感器像素 (未合并的像素)
+    int offsetY = 0;
+    int binning = 1;              // 像素合并系数：图像的一个像素对应 binning x binning 个传感器像素
+};
+
+/**
+ * @class CameraBackend
+ * @brief 相机后端接口：把 CameraManager 的命令队列和触发状态机，与具体的相机SDK隔离开。
+ *
+ * @details 目前有两个实现：
+ *  - HikCameraBackend：海康 MVS SDK，生产环境使用；
+ *  - SimulatedCameraBackend：不需要硬件，用一张图片模拟相机，用于调试和测试触发流程。
+ *
+ * 除了帧回调之外，所有函数都只会在 CameraManager 的命令线程中被调用，实现中不需要加锁。
+ * 帧回调 (FrameHandler) 在后端自己的采集线程中被调用，frame 只在回调期间有效。
+ * 高位深相机送出的是原始数据 (不做转换)，由测量线程直接解包，见 CameraFrameInfo::pixelFormat。
+ */
+class CameraBackend
+{
+public:
+    using FrameHandler = std::function<void(const cv::Mat& frame, const CameraFrameInfo& info)>;
+
+    virtual ~CameraBackend() = default;
+
+    /**
+     * @brief 后端名称，用于日志。
+     */
+    virtual const char* name() const = 0;
+
+    /**
+     * @brief 枚举设备，deviceNames 的下标就是 open() 使用的索引。
+     */
+    virtual bool enumerateDevices(QStringList& deviceNames) = 0;
+
+    virtual bool open(int index) = 0;
+    virtual void close() = 0; // 停止采集并释放设备，未打开时什么也不做
+    virtual bool isOpen() const = 0;
+
+    /**
+     * @brief 切换触发模式。true: 软触发 (每次 fireSoftwareTrigger 出一帧)；false: 连续采集。
+     * @details 海康相机要求在停止采集的状态下切换。
+     */
+    virtual bool setTriggerMode(bool softwareTrigger) = 0;
+    virtual bool startGrabbing() = 0;
+    virtual bool stopGrabbing() = 0;
+
+    /**
+     * @brief 发出一次软触发。要求已经处于软触发模式并且已经开始采集 (即“已布防”)。
+     */
+    virtual bool fireSoftwareTrigger() = 0;
+
+    virtual bool setExposure(double microseconds) = 0;
+    virtual bool setGain(double db) = 0;
+
+    /**
+     * @brief 传感器的完整尺寸 (未合并的像素)。未打开时返回空尺寸。
+     */
+    virtual cv::Size sensorSize() const = 0;
+
+    /**
+     * @brief 设置相机端的感兴趣区域 (ROI)，只传输这部分图像。
+     * @param roi 传感器像素坐标；空矩形表示整幅。实现会按相机要求的步长对齐，并把实际生效的区域写回 roi。
+     * @details 必须在停止采集的状态下调用。
+     */
+    virtual bool setRoi(cv::Rect& roi) = 0;
+
+    /**
+     * @brief 设置像素合并 (binning，相机不支持时尝试抽样 decimation) 系数，1 表示不合并。
+     * @details 必须在停止采集的状态下调用。相机不支持时返回 false，保持不合并。
+     */
+    virtual bool setBinning(int factor) = 0;
+
+    /**
+     * @brief 设置帧回调，必须在 open() 之前调用。
+     */
+    void setFrameHandler(FrameHandler handler) { m_frameHandler = std::move(handler); }
+
+protected:
+    // 供实现类在采集线程中调用
+    void deliverFrame(const cv::Mat& frame, const CameraFrameInfo& info)
+    {
+        if (m_frameHandler) m_frameHandler(frame, info);
+    }
+
+private:
+    FrameHandler m_frameHandler;
+};
+
+#endif // CAMERABACKEND_H
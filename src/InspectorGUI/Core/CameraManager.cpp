@@ -1,167 +1,589 @@
 // src/InspectorGUI/Core/CameraManager.cpp
 
 #include "CameraManager.h"
+#include "HikCameraBackend.h"
+#include "SimulatedCameraBackend.h"
+#include "LogManager.h"
+#include "Metrics.h"
 #include <QDebug>
+#include <QMutexLocker>
+#include <QElapsedTimer>
+
+namespace
+{
+    InspectorLib::Counter& lostTriggerCounter()
+    {
+        static InspectorLib::Counter& lost = InspectorLib::MetricsRegistry::Global().counter(
+            "inspector_triggers_lost_total", "Software triggers that produced no frame within the timeout");
+        return lost;
+    }
+}
+
+// --- 根据环境变量选择默认的相机后端 ---
+std::unique_ptr<CameraBackend> CameraManager::createDefaultBackend()
+{
+    if (qEnvironmentVariableIsSet("PARTINSPECTOR_SIMULATED_CAMERA")) {
+        // 变量的值如果是一个图片路径，模拟相机就输出这张图片
+        return std::unique_ptr<CameraBackend>(new SimulatedCameraBackend(qEnvironmentVariable("PARTINSPECTOR_SIMULATED_CAMERA")));
+    }
+    return std::unique_ptr<CameraBackend>(new HikCameraBackend());
+}
 
 // --- 构造函数 ---
 CameraManager::CameraManager(QObject *parent)
-    : QObject(parent)
+    : CameraManager("camera", createDefaultBackend(), parent)
+{
+}
+
+CameraManager::CameraManager(const QString& name, std::unique_ptr<CameraBackend> backend, QObject *parent)
+    : QThread(parent)
+    , m_framePool(name)
+    , m_backend(std::move(backend))
 {
-    // 初始化时，确保设备列表结构体是干净的
-    memset(&m_deviceList, 0, sizeof(MV_CC_DEVICE_INFO_LIST));
+    // 后端的采集线程通过这个回调把图像交给我们
+    m_backend->setFrameHandler([this](const cv::Mat& frame, const CameraFrameInfo& info) {
+        onBackendFrame(frame, info);
+    });
+    qInfo("Camera backend for %s: %s", name.toStdString().c_str(), m_backend->name());
+
+    // 注册跨线程信号中使用的类型
+    qRegisterMetaType<cv::Mat>("cv::Mat");
+    qRegisterMetaType<FrameTrace>("FrameTrace");
+    qRegisterMetaType<CameraManager::Command>("CameraManager::Command");
+    qRegisterMetaType<CameraManager::AcquisitionState>("CameraManager::AcquisitionState");
+
+    // 命令线程在对象创建后立即启动，空闲时阻塞在等待条件上，不占用CPU
+    start();
 }
 
 // --- 析构函数 ---
 CameraManager::~CameraManager()
 {
-    // 确保在对象被销毁时，相机能被安全地断开和释放
-    disconnectDevice();
+    // 通知命令线程退出：它会执行完当前命令，丢弃队列中剩余的命令，
+    // 然后在自己的线程中关闭相机 (见 run() 的末尾)
+    {
+        QMutexLocker locker(&m_queueMutex);
+        m_stopRequested = true;
+        m_queue.clear();
+    }
+    m_queueCondition.wakeAll();
+    wait();
 }
 
-// --- 搜索设备 ---
+// =====================================================================
+//  公共接口：只负责把命令放入队列
+// =====================================================================
+
 void CameraManager::searchDevices()
 {
-    // 调用海康SDK的枚举设备函数
-    int nRet = MV_CC_EnumDevices(MV_GIGE_DEVICE | MV_USB_DEVICE, &m_deviceList);
-    if (MV_OK != nRet)
+    // 连续点击“搜索”只需要搜索一次
+    enqueue({ Command::SearchDevices }, true);
+}
+
+void CameraManager::connectDevice(int index)
+{
+    PendingCommand pending{ Command::Connect };
+    pending.index = index;
+    enqueue(pending);
+}
+
+void CameraManager::disconnectDevice()
+{
+    enqueue({ Command::Disconnect });
+}
+
+void CameraManager::startGrabbing()
+{
+    enqueue({ Command::StartGrabbing });
+}
+
+void CameraManager::stopGrabbing()
+{
+    enqueue({ Command::StopGrabbing });
+}
+
+void CameraManager::sendSoftwareTrigger(quint64 triggerId)
+{
+    PendingCommand pending{ Command::SoftwareTrigger };
+    pending.triggerId = triggerId;
+    enqueue(pending);
+}
+
+void CameraManager::armTrigger()
+{
+    enqueue({ Command::ArmTrigger }, true);
+}
+
+void CameraManager::setRoiOptions(const RoiController::Options& options)
+{
+    PendingCommand pending{ Command::SetRoiOptions };
+    pending.roiOptions = options;
+    enqueue(pending, true);
+}
+
+void CameraManager::updateRoi(bool partFound, const cv::RotatedRect& sensorBox)
+{
+    PendingCommand pending{ Command::UpdateRoi };
+    pending.partFound = partFound;
+    pending.sensorBox = sensorBox;
+    enqueue(pending, true); // 只有最新的结果有意义
+}
+
+void CameraManager::setExposure(int value)
+{
+    PendingCommand pending{ Command::SetExposure };
+    pending.value = value;
+    enqueue(pending, true); // 【关键】合并：只保留最新的曝光值
+}
+
+void CameraManager::setGain(double value)
+{
+    PendingCommand pending{ Command::SetGain };
+    pending.value = value;
+    enqueue(pending, true); // 【关键】合并：只保留最新的增益值
+}
+
+int CameraManager::pendingCommandCount() const
+{
+    QMutexLocker locker(&m_queueMutex);
+    return static_cast<int>(m_queue.size());
+}
+
+// --- 私有辅助函数：改变连接或采集状态的命令和触发命令，参数命令不能跨过它们合并 ---
+bool CameraManager::isBarrier(Command command)
+{
+    switch (command)
     {
-        qCritical("Failed to enumerate devices. Error code: %#x", nRet);
-        emit errorOccurred("Failed to search for cameras.");
-        return;
+    case Command::SearchDevices:
+    case Command::Connect:
+    case Command::Disconnect:
+    case Command::StartGrabbing:
+    case Command::StopGrabbing:
+    case Command::ArmTrigger:
+    case Command::SoftwareTrigger: // 触发之前排队的参数属于这一次拍照，之后的属于下一次
+        return true;
+    default:
+        return false;
     }
+}
 
-    QStringList deviceNames;
-    for (unsigned int i = 0; i < m_deviceList.nDeviceNum; i++)
+// --- 私有辅助函数：入队 ---
+void CameraManager::enqueue(const PendingCommand& pending, bool coalesce)
+{
+    static InspectorLib::Counter& coalesced = InspectorLib::MetricsRegistry::Global().counter(
+        "inspector_camera_commands_coalesced_total", "Camera commands merged into a pending command of the same type");
     {
-        // 从设备信息中提取一个可读的名字
-        MV_CC_DEVICE_INFO* pDeviceInfo = m_deviceList.pDeviceInfo[i];
-        if (pDeviceInfo->nTLayerType == MV_GIGE_DEVICE) {
-            // 对于网口相机，使用用户自定义名或型号名
-            QString name = (const char*)pDeviceInfo->SpecialInfo.stGigEInfo.chUserDefinedName;
-            if (name.isEmpty()) {
-                name = (const char*)pDeviceInfo->SpecialInfo.stGigEInfo.chModelName;
+        QMutexLocker locker(&m_queueMutex);
+        if (m_stopRequested) return;
+
+        if (coalesce)
+        {
+            // 【关键】从队尾向前找同类命令，遇到连接/断开/开始/停止采集/触发这类"屏障"命令就停止。
+            // 解释: 合并会保留旧命令的排队位置；如果越过屏障，新的参数就会提前到断开之前执行 (作用于旧的会话)，
+            //       或者在重新连接之后丢失。例如 Set→Disconnect→Connect→Set 中的两个 Set 不能合并。
+            for (auto it = m_queue.rbegin(); it != m_queue.rend(); ++it)
+            {
+                if (it->command == pending.command) {
+                    *it = pending; // 保持原来的排队位置，只更新参数
+                    coalesced.inc();
+                    return;
+                }
+                if (isBarrier(it->command)) break;
             }
-            deviceNames.append(name);
         }
+        m_queue.push_back(pending);
     }
+    m_queueCondition.wakeOne();
+}
 
-    // 通过信号将找到的设备列表广播出去
-    emit deviceListUpdated(deviceNames);
-    qInfo("%d devices found.", m_deviceList.nDeviceNum);
+// =====================================================================
+//  命令线程
+// =====================================================================
+
+void CameraManager::run()
+{
+    static InspectorLib::Gauge& queueDepth = InspectorLib::MetricsRegistry::Global().gauge(
+        "inspector_queue_depth", "Items waiting in a cross-thread queue", "queue=\"camera_commands\"");
+
+    while (true)
+    {
+        // 1. 等待下一条命令；空闲时每 kTriggerSweepMs 醒来一次，清理超时的触发
+        PendingCommand pending;
+        bool hasCommand = false;
+        {
+            QMutexLocker locker(&m_queueMutex);
+            if (m_queue.empty() && !m_stopRequested) {
+                m_queueCondition.wait(&m_queueMutex, kTriggerSweepMs);
+            }
+            if (m_stopRequested) break;
+            if (!m_queue.empty()) {
+                pending = m_queue.front();
+                m_queue.pop_front();
+                queueDepth.set(static_cast<double>(m_queue.size()));
+                hasCommand = true;
+            }
+        }
+        expireTriggers(FrameTrace::nowNs()); // 在队列锁之外，两把锁从不同时持有
+        if (!hasCommand) continue;
+
+        // 2. 在锁外执行：SDK调用可能耗时数秒，期间GUI线程仍然可以继续入队 (并合并参数命令)
+        QElapsedTimer timer;
+        timer.start();
+        const bool success = execute(pending);
+        emit commandFinished(pending.command, success, timer.nsecsElapsed() / 1e6);
+    }
+
+    // 3. 退出前在本线程中释放相机，保证所有SDK控制调用都发生在同一个线程
+    closeCamera();
+    m_backend.reset();
 }
 
-// --- 连接设备 ---
-void CameraManager::connectDevice(int index)
+bool CameraManager::execute(const PendingCommand& pending)
 {
-    if (index < 0 || index >= (int)m_deviceList.nDeviceNum) {
-        emit errorOccurred("Invalid device index selected.");
-        return;
+    switch (pending.command)
+    {
+    case Command::SearchDevices:   return doSearchDevices();
+    case Command::Connect:         return doConnect(pending.index);
+    case Command::Disconnect:      return doDisconnect();
+    case Command::StartGrabbing:   return doStartGrabbing();
+    case Command::StopGrabbing:    return doStopGrabbing();
+    case Command::SoftwareTrigger: return doSoftwareTrigger(pending.triggerId);
+    case Command::SetExposure:     return doSetExposure(static_cast<int>(pending.value));
+    case Command::SetGain:         return doSetGain(pending.value);
+    case Command::ArmTrigger:      return doArmTrigger();
+    case Command::SetRoiOptions:   return doSetRoiOptions(pending.roiOptions);
+    case Command::UpdateRoi:       return doUpdateRoi(pending.partFound, pending.sensorBox);
     }
-    if (m_cameraHandle != nullptr) {
-        disconnectDevice(); // 先断开已有的连接
+    return false;
+}
+
+// --- 搜索设备 ---
+bool CameraManager::doSearchDevices()
+{
+    QStringList deviceNames;
+    if (!m_backend->enumerateDevices(deviceNames))
+    {
+        emit errorOccurred("Failed to search for cameras.");
+        return false;
     }
 
-    // 1. 根据索引选择设备，并创建句柄
-    int nRet = MV_CC_CreateHandle(&m_cameraHandle, m_deviceList.pDeviceInfo[index]);
-    if (MV_OK != nRet) {
-        qCritical("Failed to create camera handle. Error: %#x", nRet);
-        emit connectionStatusChanged(false, "Failed to create camera handle.");
-        return;
+    // 通过信号将找到的设备列表广播出去
+    emit deviceListUpdated(deviceNames);
+    qInfo("%d devices found.", static_cast<int>(deviceNames.size()));
+    return true;
+}
+
+// --- 连接设备 ---
+bool CameraManager::doConnect(int index)
+{
+    if (m_backend->isOpen()) {
+        doDisconnect(); // 先断开已有的连接
     }
 
-    // 2. 打开设备
-    nRet = MV_CC_OpenDevice(m_cameraHandle);
-    if (MV_OK != nRet) {
-        MV_CC_DestroyHandle(m_cameraHandle);
-        m_cameraHandle = nullptr;
-        qCritical("Failed to open device. Error: %#x", nRet);
+    if (!m_backend->open(index)) {
         emit connectionStatusChanged(false, "Failed to open camera. It might be in use.");
-        return;
+        return false;
     }
+    setState(AcquisitionState::Idle);
 
-    // 3. 【关键】注册图像数据回调函数
-    // 我们将 this 指针作为用户自定义数据(pUser)传递给回调函数
-    nRet = MV_CC_RegisterImageCallBackEx(m_cameraHandle, frameCallback, this);
-    if (MV_OK != nRet) {
-        qCritical("Failed to register image callback. Error: %#x", nRet);
-        emit errorOccurred("Failed to register image callback.");
+    // 新连接的相机从整幅开始；启用了ROI跟踪时在这里设置合并系数
+    m_roiController.setSensorSize(m_backend->sensorSize());
+    if (m_roiController.options().enabled) {
+        applyRoi(m_roiController.fullFrame(), m_roiController.options().binning);
     }
 
     // 发射连接成功信号
     emit connectionStatusChanged(true, "Camera connected successfully.");
     qInfo("Camera connected.");
+    return true;
 }
 
 // --- 断开设备 ---
-void CameraManager::disconnectDevice()
+bool CameraManager::doDisconnect()
 {
-    if (m_cameraHandle == nullptr) return;
+    if (!m_backend->isOpen()) return true;
 
-    MV_CC_StopGrabbing(m_cameraHandle); // 确保停止采集
-    MV_CC_CloseDevice(m_cameraHandle);
-    MV_CC_DestroyHandle(m_cameraHandle);
-    m_cameraHandle = nullptr;
+    closeCamera();
 
     emit connectionStatusChanged(false, "Camera disconnected.");
     qInfo("Camera disconnected.");
+    return true;
+}
+
+void CameraManager::closeCamera()
+{
+    if (m_backend == nullptr || !m_backend->isOpen()) return;
+
+    m_backend->close(); // 后端会先停止采集
+    clearOutstandingTriggers();
+    setState(AcquisitionState::Closed);
 }
 
 // --- 开始连续采集 ---
-void CameraManager::startGrabbing()
+bool CameraManager::doStartGrabbing()
 {
-    if (m_cameraHandle == nullptr) return;
-    MV_CC_SetEnumValue(m_cameraHandle, "TriggerMode", MV_TRIGGER_MODE_OFF); // 设置为连续模式
-    MV_CC_StartGrabbing(m_cameraHandle);
+    if (!m_backend->isOpen()) return false;
+    if (m_state == AcquisitionState::Continuous) return true;
+
+    // 从布防状态切换过来时，必须先停止采集才能修改触发模式
+    if (m_state == AcquisitionState::Armed) {
+        m_backend->stopGrabbing();
+        clearOutstandingTriggers();
+        setState(AcquisitionState::Idle);
+    }
+    m_backend->setTriggerMode(false); // 设置为连续模式
+    m_hasLastFrame = false; // 采集开始之前回调不会运行，这里重置是安全的
+    if (!m_backend->startGrabbing()) return false;
+    setState(AcquisitionState::Continuous);
+    return true;
 }
 
-// --- 停止连续采集 ---
-void CameraManager::stopGrabbing()
+// --- 停止采集 (连续采集或布防都会停止) ---
+bool CameraManager::doStopGrabbing()
 {
-    if (m_cameraHandle == nullptr) return;
-    MV_CC_StopGrabbing(m_cameraHandle);
+    if (!m_backend->isOpen()) return false;
+    const bool success = m_backend->stopGrabbing();
+    clearOutstandingTriggers();
+    setState(AcquisitionState::Idle);
+    return success;
+}
+
+// --- 布防：软触发模式 + 开始采集，只在状态改变时执行一次 ---
+bool CameraManager::doArmTrigger()
+{
+    if (!m_backend->isOpen()) return false;
+    if (m_state == AcquisitionState::Armed) return true;
+
+    if (m_state == AcquisitionState::Continuous) {
+        m_backend->stopGrabbing();
+        setState(AcquisitionState::Idle);
+    }
+    if (!m_backend->setTriggerMode(true)) return false; // 软触发模式，触发源为软件
+    m_hasLastFrame = false;
+    if (!m_backend->startGrabbing()) return false;       // 必须先开始采集，才能接收触发
+
+    setState(AcquisitionState::Armed);
+    qInfo("Camera armed for software trigger.");
+    return true;
 }
 
 // --- 发送软触发 ---
-void CameraManager::sendSoftwareTrigger()
+bool CameraManager::doSoftwareTrigger(quint64 triggerId)
 {
-    if (m_cameraHandle == nullptr) return;
-    MV_CC_SetEnumValue(m_cameraHandle, "TriggerMode", MV_TRIGGER_MODE_ON);      // 确保为触发模式
-    MV_CC_SetEnumValue(m_cameraHandle, "TriggerSource", MV_TRIGGER_SOURCE_SOFTWARE); // 设置为软触发
-    MV_CC_StartGrabbing(m_cameraHandle); // 必须先开始采集，才能接收触发
-    MV_CC_SetCommandValue(m_cameraHandle, "TriggerSoftware"); // 发送软触发命令
+    static InspectorLib::Counter& fired = InspectorLib::MetricsRegistry::Global().counter(
+        "inspector_software_triggers_total", "Software triggers sent to the camera");
+
+    // 1. 只有第一次 (或者从连续采集切换过来时) 需要布防，之后直接触发
+    if (m_state != AcquisitionState::Armed && !doArmTrigger()) {
+        emit errorOccurred("Failed to arm the camera for software trigger.");
+        return false;
+    }
+
+    // 2. 先登记触发编号再发命令：图像可能在命令返回之前就已经到达回调线程
+    // 多相机工位会给所有相机指定同一个编号，以便按编号合并各相机的结果
+    OutstandingTrigger trigger;
+    trigger.id = triggerId != 0 ? triggerId : m_nextTriggerId++;
+    trigger.firedNs = FrameTrace::nowNs();
+    {
+        QMutexLocker locker(&m_triggerMutex);
+        trigger.sequence = ++m_triggerSequence;
+        m_outstandingTriggers.push_back(trigger);
+    }
+
+    // 3. 【关键】已布防，只需要一条命令
+    if (!m_backend->fireSoftwareTrigger()) {
+        QMutexLocker locker(&m_triggerMutex);
+        if (!m_outstandingTriggers.empty() && m_outstandingTriggers.back().id == trigger.id) {
+            m_outstandingTriggers.pop_back();
+            --m_triggerSequence; // 相机没有收到这次触发，触发计数也不会增加
+        }
+        return false;
+    }
+    fired.inc();
+    LOG_FAST(QtDebugMsg, "Software trigger %llu fired.", static_cast<unsigned long long>(trigger.id));
+    return true;
 }
 
 // --- 设置曝光 ---
-void CameraManager::setExposure(int value)
+bool CameraManager::doSetExposure(int value)
 {
-    if (m_cameraHandle == nullptr) return;
-    MV_CC_SetFloatValue(m_cameraHandle, "ExposureTime", (float)value);
+    if (!m_backend->isOpen() || !m_backend->setExposure(value)) return false;
+    emit exposureApplied(value);
+    return true;
 }
 
 // --- 设置增益 ---
-void CameraManager::setGain(double value)
+bool CameraManager::doSetGain(double value)
+{
+    if (!m_backend->isOpen() || !m_backend->setGain(value)) return false;
+    emit gainApplied(value);
+    return true;
+}
+
+// --- 相机端ROI ---
+bool CameraManager::doSetRoiOptions(const RoiController::Options& options)
 {
-    if (m_cameraHandle == nullptr) return;
-    MV_CC_SetFloatValue(m_cameraHandle, "Gain", (float)value);
+    m_roiController.setOptions(options);
+    if (!m_backend->isOpen()) return true; // 连接时再生效
+
+    // 启用或关闭都先回到整幅；关闭时同时取消合并
+    qInfo("Camera ROI tracking %s.", options.enabled ? "enabled" : "disabled");
+    return applyRoi(m_roiController.fullFrame(), options.enabled ? options.binning : 1);
 }
 
+bool CameraManager::doUpdateRoi(bool partFound, const cv::RotatedRect& sensorBox)
+{
+    if (!m_roiController.options().enabled || !m_backend->isOpen()) return true;
 
-// --- 静态回调函数的实现 ---
-void __stdcall CameraManager::frameCallback(unsigned char* pData, MV_FRAME_OUT_INFO_EX* pFrameInfo, void* pUser)
+    const cv::Rect roi = m_roiController.next(partFound, sensorBox);
+    if (roi == m_roiController.current()) return true; // 不需要修改相机
+    return applyRoi(roi);
+}
+
+bool CameraManager::applyRoi(const cv::Rect& roi, int binning)
 {
-    // 【关键】pUser 就是我们注册回调时传递的 this 指针！
-    // 我们把它转换回 CameraManager* 类型。
-    CameraManager* manager = static_cast<CameraManager*>(pUser);
-    if (manager == nullptr || pData == nullptr || pFrameInfo == nullptr) {
-        return;
+    static InspectorLib::Counter& changes = InspectorLib::MetricsRegistry::Global().counter(
+        "inspector_camera_roi_changes_total", "Times the camera-side ROI was reprogrammed");
+    static InspectorLib::Gauge& fraction = InspectorLib::MetricsRegistry::Global().gauge(
+        "inspector_camera_roi_fraction", "Fraction of the sensor area transferred per frame");
+
+    // 1. 大多数相机只允许在停止采集时修改宽高和合并系数
+    const bool grabbing = m_state == AcquisitionState::Continuous || m_state == AcquisitionState::Armed;
+    if (grabbing) {
+        m_backend->stopGrabbing();
+        clearOutstandingTriggers(); // 停止采集会丢掉正在曝光的触发，避免后续的帧对错编号
     }
 
-    // 将SDK返回的图像数据，包装成一个OpenCV的Mat对象。
-    // 这是一个高效的操作，它与原始数据共享内存，没有发生拷贝。
-    cv::Mat frame(pFrameInfo->nHeight, pFrameInfo->nWidth, CV_8UC1, pData);
+    // 2. 先合并系数，再ROI (合并会改变相机寄存器的像素单位)
+    bool success = true;
+    if (binning > 0 && !m_backend->setBinning(binning)) {
+        m_backend->setBinning(1);
+    }
+    cv::Rect applied = roi;
+    if (m_backend->setRoi(applied)) {
+        m_roiController.setApplied(applied);
+        // 只有真正写入相机时才计数和更新传输比例
+        changes.inc();
+        const cv::Size sensor = m_backend->sensorSize();
+        if (sensor.area() > 0) fraction.set(static_cast<double>(m_roiController.current().area()) / sensor.area());
+        LOG_FAST(QtDebugMsg, "Camera ROI set to %dx%d+%d+%d.", applied.width, applied.height, applied.x, applied.y);
+    } else {
+        success = false;
+        qWarning("Failed to set camera ROI to %dx%d+%d+%d.", roi.width, roi.height, roi.x, roi.y);
+    }
+
+    // 3. 恢复采集
+    m_hasLastFrame = false; // 重新开始采集后帧号可能重置，不算丢帧
+    if (grabbing && !m_backend->startGrabbing()) {
+        emit errorOccurred("Failed to restart grabbing after changing the camera ROI.");
+        return false;
+    }
+    return success;
+}
+
+void CameraManager::setState(AcquisitionState state)
+{
+    if (m_state == state) return;
+    m_state = state;
+    emit acquisitionStateChanged(state);
+}
+
+void CameraManager::clearOutstandingTriggers()
+{
+    expireTriggers(FrameTrace::nowNs());
+    QMutexLocker locker(&m_triggerMutex);
+    m_outstandingTriggers.clear();
+    m_triggerSequence = 0;
+    m_hasTriggerIndexBase = false; // 重新开始采集后相机的触发计数可能重置
+}
+
+void CameraManager::expireTriggers(qint64 nowNs)
+{
+    QMutexLocker locker(&m_triggerMutex);
+    while (!m_outstandingTriggers.empty() && nowNs - m_outstandingTriggers.front().firedNs > kTriggerTimeoutNs) {
+        LOG_FAST(QtWarningMsg, "Software trigger %llu timed out.", static_cast<unsigned long long>(m_outstandingTriggers.front().id));
+        m_outstandingTriggers.pop_front();
+        lostTriggerCounter().inc();
+    }
+}
+
+
+// --- 后端帧回调的实现 ---
+void CameraManager::onBackendFrame(const cv::Mat& frame, const CameraFrameInfo& info)
+{
+    // 记录追踪上下文：收到帧的时刻、相机的设备时间戳和主机时间戳。
+    // 这些信息会随着帧一起流经整个流水线，直到结果显示。
+    FrameTrace trace;
+    trace.receiveNs = FrameTrace::nowNs();
+    trace.frameId = info.frameNum;
+    trace.deviceTimestamp = info.deviceTimestamp;
+    trace.hostTimestampMs = info.hostTimestampMs;
+    trace.roiOffsetX = info.offsetX;
+    trace.roiOffsetY = info.offsetY;
+    trace.roiScale = info.binning;
+    trace.pixelFormat = info.pixelFormat;
+
+    // SDK回调线程属于热路径，这里只使用二进制文件日志
+    LOG_FAST(QtDebugMsg, "Frame %u received: %dx%d, pixel type %#llx, lost packets %u",
+             info.frameNum, frame.cols, frame.rows,
+             static_cast<unsigned long long>(info.pixelType), info.lostPackets);
+
+    // 运行时指标：采集帧率，以及根据帧号的跳变推算出的相机端丢帧数
+    InspectorLib::MetricsRegistry& registry = InspectorLib::MetricsRegistry::Global();
+    static InspectorLib::RateMeter& acquired = registry.meter("inspector_frames_acquired", "Frames delivered by the camera");
+    static InspectorLib::RateMeter& dropped = registry.meter("inspector_frames_dropped", "Frames lost before inspection", "reason=\"camera\"");
+    static InspectorLib::Gauge& guiQueue = registry.gauge("inspector_queue_depth", "Items waiting in a cross-thread queue", "queue=\"camera_to_gui\"");
+    static InspectorLib::Histogram& triggerToFrame = registry.histogram("inspector_trigger_to_frame_seconds", "Time from software trigger to frame arrival");
+    acquired.mark();
+    if (m_hasLastFrame && info.frameNum > m_lastFrameNum + 1) {
+        dropped.mark(info.frameNum - m_lastFrameNum - 1);
+    }
+    m_lastFrameNum = info.frameNum;
+    m_hasLastFrame = true;
+
+    // 已布防时，按相机的触发计数找到这一帧对应的触发 (序号 = 触发计数 - 基准)。
+    // 解释: 丢掉一帧时，如果只按先后顺序取最早的触发，后面每一帧的编号都会错一位，直到触发间隔超过超时时间；
+    //       按计数对应时，序号更早、还没有收到图像的触发就是丢失的帧，直接计入丢失。
+    //       基准由布防后的第一帧确定 (它对应最早的触发)；后端不提供触发计数时只能按先后顺序对应。
+    // 超时的触发说明相机没有响应，同样丢弃。
+    expireTriggers(trace.receiveNs);
+    {
+        QMutexLocker locker(&m_triggerMutex);
+        if (!m_outstandingTriggers.empty()) {
+            quint32 sequence = m_outstandingTriggers.front().sequence;
+            if (info.triggerIndex != 0) {
+                if (!m_hasTriggerIndexBase) {
+                    m_triggerIndexBase = info.triggerIndex - sequence;
+                    m_hasTriggerIndexBase = true;
+                }
+                sequence = info.triggerIndex - m_triggerIndexBase;
+            }
+            // 序号更早的触发没有出图 (按无符号差比较，计数回绕时也成立)
+            while (!m_outstandingTriggers.empty() && static_cast<qint32>(m_outstandingTriggers.front().sequence - sequence) < 0) {
+                LOG_FAST(QtWarningMsg, "Software trigger %llu produced no frame.", static_cast<unsigned long long>(m_outstandingTriggers.front().id));
+                m_outstandingTriggers.pop_front();
+                lostTriggerCounter().inc();
+            }
+            if (!m_outstandingTriggers.empty() && m_outstandingTriggers.front().sequence == sequence) {
+                trace.triggerId = m_outstandingTriggers.front().id;
+                trace.triggerNs = m_outstandingTriggers.front().firedNs;
+                m_outstandingTriggers.pop_front();
+            }
+        }
+    }
+    if (trace.triggerId != 0) {
+        triggerToFrame.observe((trace.receiveNs - trace.triggerNs) * 1e-9);
+        trace.addSpan("Exposure", "Camera", trace.triggerNs, trace.receiveNs); // 曝光 + 读出 + 传输
+    }
 
-    // 【关键】通过manager实例，发射信号，将图像帧传递出去。
+    // 【关键】发射信号，将图像帧传递出去。
     // 因为信号是在不同的线程（SDK的回调线程）中发出的，Qt的信号槽机制会自动
     // 处理线程间的切换，确保槽函数在主GUI线程中被安全地执行。
-    emit manager->newFrameReady(frame.clone()); // .clone()创建一个深拷贝，确保主线程拿到的是独立的数据
+    // SDK 的数据在回调返回后就会被复用，所以必须拷贝一份；拷贝的目标取自缓冲池，避免每帧重新分配内存。
+    cv::Mat copy = m_framePool.acquire(frame.rows, frame.cols, frame.type());
+    frame.copyTo(copy);
+    trace.addSpan("Copy", "Camera", trace.receiveNs, FrameTrace::nowNs());
+    trace.markQueued(); // 从这里开始计算“等待GUI线程处理”的排队时间
+    guiQueue.add(1);    // MainWindow::onNewFrameReady 取出后减1
+    emit newFrameReady(copy, trace);
 }
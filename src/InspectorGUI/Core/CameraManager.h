@@ -3,53 +3,249 @@
 #ifndef CAMERAMANAGER_H
 #define CAMERAMANAGER_H
 
-#include <QObject>
+#include <QThread>
+#include <QMutex>
+#include <QWaitCondition>
 #include <QStringList>
 #include <QImage>
+#include <deque>
+#include <memory>
 #include <opencv2/opencv.hpp>
+#include "FrameTrace.h"
+#include "FramePool.h"
+#include "CameraBackend.h"
+#include "RoiController.h"
 
-// 【重要】包含海康相机的SDK头文件
-// 这是我们项目中唯一一个需要直接和SDK打交道的文件。
-#include "MvCameraControl.h"
+// cv::Mat 需要跨线程(SDK回调线程 -> GUI线程)通过信号传递，必须注册为Qt元类型
+Q_DECLARE_METATYPE(cv::Mat)
 
-class CameraManager : public QObject
+/**
+ * @class CameraManager
+ * @brief 相机管理器：在一个专用的后台线程中执行所有相机控制命令。
+ *
+ * @details 枚举和打开 GigE 相机可能阻塞好几秒，如果在GUI线程中执行会让界面卡死。
+ * 因此所有公共接口函数都只是把一条命令放入队列后立即返回，
+ * 真正的SDK调用由本线程 (run) 按顺序逐条执行，执行结果通过信号异步通知。
+ *
+ * 曝光和增益命令会被“合并”：如果队列中已经有一条还没执行的同类命令，新值直接覆盖旧值，
+ * 这样用户快速滚动 SpinBox 时，相机只会收到最后一个值，而不是几十次中间值。
+ *
+ * 注意：图像帧仍然由SDK自己的回调线程送达 (onBackendFrame)，不经过命令队列。
+ *
+ * 【触发状态机】采集状态在 Closed / Idle / Continuous / Armed 之间切换。
+ * 单次拍照不再每次都设置触发模式、触发源、开始采集，而是第一次触发时“布防”一次
+ * (软触发模式 + 开始采集，进入 Armed)，之后每次触发只需要发送一条 TriggerSoftware 命令。
+ * 每次触发分配一个递增的触发编号，随着 FrameTrace 一直传到测量结果 (MeasurementResults::triggerId)，
+ * 由此可以统计“触发 -> 出图”和“触发 -> 结果”的耗时。帧按相机的触发计数 (CameraFrameInfo::triggerIndex)
+ * 对应到触发，丢掉一帧不会让后面的帧全部错位；后端不提供触发计数时才按先后顺序对应。
+ *
+ * 具体的相机SDK调用由 CameraBackend 完成 (海康相机或模拟相机)。
+ */
+class CameraManager : public QThread
 {
     Q_OBJECT
 
 public:
+    /**
+     * @brief 命令类型，同时用于 commandFinished 信号标识是哪一条命令完成了。
+     */
+    enum class Command
+    {
+        SearchDevices,
+        Connect,
+        Disconnect,
+        StartGrabbing,
+        StopGrabbing,
+        SoftwareTrigger,
+        SetExposure,
+        SetGain,
+        ArmTrigger,
+        SetRoiOptions,
+        UpdateRoi
+    };
+    Q_ENUM(Command)
+
+    /**
+     * @brief 采集状态。
+     */
+    enum class AcquisitionState
+    {
+        Closed,     // 未连接相机
+        Idle,       // 已连接，未采集
+        Continuous, // 连续采集
+        Armed       // 已布防：软触发模式并且已经开始采集，每次触发立即出一帧
+    };
+    Q_ENUM(AcquisitionState)
+
+    // 触发之后超过这个时间还没有收到图像，就认为这次触发丢失了
+    static constexpr qint64 kTriggerTimeoutNs = 2000000000LL;
+    // 命令线程空闲时检查超时触发的间隔：最后一次触发丢失时不会再有后续的帧来发现它
+    static constexpr unsigned long kTriggerSweepMs = 500;
+
+    /**
+     * @brief 使用默认的相机后端：设置了环境变量 PARTINSPECTOR_SIMULATED_CAMERA 时使用模拟相机，否则使用海康相机。
+     */
     explicit CameraManager(QObject *parent = nullptr);
+
+    /**
+     * @brief 使用指定的相机后端 (例如测试时传入 SimulatedCameraBackend)。CameraManager 接管其所有权。
+     * @param name 相机名称，多相机工位中用于区分各台相机 (帧缓冲池指标的 pool 标签)。
+     */
+    CameraManager(const QString& name, std::unique_ptr<CameraBackend> backend, QObject *parent = nullptr);
+
+    /**
+     * @brief 创建默认的相机后端 (见默认构造函数的说明)。
+     */
+    static std::unique_ptr<CameraBackend> createDefaultBackend();
     ~CameraManager();
 
-    // --- 公共接口函数 (由MainWindow调用) ---
+    // --- 公共接口函数 (由MainWindow调用，全部是异步的：放入命令队列后立即返回) ---
     void searchDevices();
     void connectDevice(int index);
     void disconnectDevice();
     void startGrabbing();
     void stopGrabbing();
-    void sendSoftwareTrigger();
+    void sendSoftwareTrigger(quint64 triggerId = 0); // 如果还没有布防，会先自动布防；triggerId 为0时自动分配编号
+    void armTrigger();          // 提前布防，让第一次触发也没有额外的延迟
+
+    /**
+     * @brief 设置相机端ROI跟踪 (见 RoiController)。关闭时恢复整幅、不合并。
+     */
+    void setRoiOptions(const RoiController::Options& options);
+
+    /**
+     * @brief 把一次测量结果交给ROI跟踪，决定后续帧传输哪块区域。未启用ROI跟踪时什么也不做。
+     * @param partFound 是否找到零件。
+     * @param sensorBox 零件外接矩形，整幅传感器坐标 (即 FrameTrace::mapResultsToSensor 之后的结果)。
+     */
+    void updateRoi(bool partFound, const cv::RotatedRect& sensorBox);
     void setExposure(int value);
     void setGain(double value);
 
+    /**
+     * @brief 当前队列中还没有执行的命令数 (用于状态显示和指标)。
+     */
+    int pendingCommandCount() const;
+
 signals:
-    // --- 向外广播状态和数据的信号 (由MainWindow监听) ---
+    // --- 向外广播状态和数据的信号 (由MainWindow监听，都从后台线程发出，Qt会自动排队到接收者线程) ---
     void deviceListUpdated(const QStringList& deviceList); // 设备列表已更新
     void connectionStatusChanged(bool connected, const QString& message); // 连接状态已改变
-    void newFrameReady(const cv::Mat& frame); // 【核心】已捕获到新的图像帧！
+    void newFrameReady(const cv::Mat& frame, const FrameTrace& trace); // 【核心】已捕获到新的图像帧！trace 携带该帧的时间戳和追踪信息
     void errorOccurred(const QString& message); // 发生了错误
 
+    /**
+     * @brief 一条命令执行完毕。
+     * @param command 命令类型。
+     * @param success SDK调用是否成功。
+     * @param elapsedMs 从命令被执行到完成所用的时间 (毫秒)，不包括在队列中等待的时间。
+     */
+    void commandFinished(CameraManager::Command command, bool success, double elapsedMs);
+
+    /**
+     * @brief 曝光/增益已经真正写入相机 (合并之后的最终值)。
+     */
+    void exposureApplied(int value);
+    void gainApplied(double value);
+
+    /**
+     * @brief 采集状态发生了变化 (见 AcquisitionState)。
+     */
+    void acquisitionStateChanged(CameraManager::AcquisitionState state);
+
+protected:
+    /**
+     * @brief 命令处理循环：等待命令、执行命令，直到析构时被要求退出。
+     */
+    virtual void run() override;
+
 private:
-    // --- 内部辅助函数 ---
+    // --- 命令队列中的一项 ---
+    struct PendingCommand
+    {
+        Command command;
+        int index = 0;       // Connect 使用的设备索引
+        double value = 0.0;  // SetExposure/SetGain 使用的参数值
+        quint64 triggerId = 0; // SoftwareTrigger 使用的触发编号 (0 表示自动分配)
+        RoiController::Options roiOptions; // SetRoiOptions 使用
+        bool partFound = false;            // UpdateRoi 使用
+        cv::RotatedRect sensorBox;         // UpdateRoi 使用
+    };
+
+    /**
+     * @brief 把命令放入队列。coalesce 为 true 时，如果队列尾部 (最后一条屏障命令之后) 已有同类命令，就只更新它的参数。
+     */
+    void enqueue(const PendingCommand& pending, bool coalesce = false);
+
     /**
-     * @brief 这是相机SDK的回调函数，将在一个独立的SDK线程中被调用。
-     * @param pData 指向图像数据的指针。
-     * @param pFrameInfo 包含图像帧信息的结构体。
-     * @param pUser 传递给回调的用户自定义指针 (我们将用它来传递 this 指针)。
+     * @brief 是否是合并不能越过的命令 (搜索设备、连接、断开、开始/停止采集、布防、软触发)。
      */
-    static void __stdcall frameCallback(unsigned char* pData, MV_FRAME_OUT_INFO_EX* pFrameInfo, void* pUser);
+    static bool isBarrier(Command command);
+
+    /**
+     * @brief 在命令线程中执行一条命令，返回是否成功。
+     */
+    bool execute(const PendingCommand& pending);
+
+    // --- 以下函数只在命令线程中调用，通过后端与相机交互 ---
+    bool doSearchDevices();
+    bool doConnect(int index);
+    bool doDisconnect();
+    bool doStartGrabbing();
+    bool doStopGrabbing();
+    bool doSoftwareTrigger(quint64 triggerId);
+    bool doSetExposure(int value);
+    bool doSetGain(double value);
+    bool doArmTrigger();
+    bool doSetRoiOptions(const RoiController::Options& options);
+    bool doUpdateRoi(bool partFound, const cv::RotatedRect& sensorBox);
+    bool applyRoi(const cv::Rect& roi, int binning = 0); // binning 为0表示不修改合并系数
+    void closeCamera(); // 停止采集并释放设备，不发出任何信号
+    void setState(AcquisitionState state);
+    void clearOutstandingTriggers(); // 先按超时清理 (计入丢失)，再丢弃其余正在曝光的触发
+
+    /**
+     * @brief 丢弃超过 kTriggerTimeoutNs 还没有收到图像的触发，计入 inspector_triggers_lost_total 并记录日志。
+     * @details 由帧回调、命令线程的定时检查和停止采集调用 (任意线程，内部加锁)。
+     */
+    void expireTriggers(qint64 nowNs);
+
+    /**
+     * @brief 后端的帧回调，在后端的采集线程 (SDK回调线程) 中被调用。
+     * @param frame 图像数据，只在回调期间有效。
+     * @param info 帧号、时间戳等信息。
+     */
+    void onBackendFrame(const cv::Mat& frame, const CameraFrameInfo& info);
+
+    // --- 命令队列 ---
+    mutable QMutex m_queueMutex;            // 保护 m_queue 和 m_stopRequested
+    QWaitCondition m_queueCondition;        // 有新命令或要求退出时唤醒命令线程
+    std::deque<PendingCommand> m_queue;     // 待执行的命令 (先进先出)
+    bool m_stopRequested = false;           // 析构时置位，命令线程处理完当前命令后退出
+
+    // --- 相机状态 (只在命令线程中访问) ---
+    std::unique_ptr<CameraBackend> m_backend;              // 具体的相机实现
+    AcquisitionState m_state = AcquisitionState::Closed;   // 当前采集状态
+    quint64 m_nextTriggerId = 1;                           // 下一次自动分配的触发编号 (0 表示“非触发采集”)
+    RoiController m_roiController;                         // 相机端ROI跟踪
+
+    // --- 已经触发、还没有收到图像的触发 (命令线程写入，回调线程取出，由 m_triggerMutex 保护) ---
+    struct OutstandingTrigger
+    {
+        quint64 id = 0;
+        qint64 firedNs = 0;    // 发出触发命令的时刻 (单调时钟)
+        quint32 sequence = 0;  // 布防以来的第几次触发，与相机的触发计数 (CameraFrameInfo::triggerIndex) 对应
+    };
+    QMutex m_triggerMutex;
+    std::deque<OutstandingTrigger> m_outstandingTriggers;
+    quint32 m_triggerSequence = 0;   // 最近一次触发的序号 (清空未完成的触发时重置)
+    quint32 m_triggerIndexBase = 0;  // 相机触发计数与序号之差，由布防后的第一帧确定
+    bool m_hasTriggerIndexBase = false;
 
-    // --- 成员变量 ---
-    void* m_cameraHandle = nullptr; // 指向相机实例的句柄，由SDK提供
-    MV_CC_DEVICE_INFO_LIST m_deviceList; // 存储搜索到的设备列表
+    // --- 图像回调使用的状态 (由SDK回调线程访问；m_hasLastFrame 在开始采集之前由命令线程重置) ---
+    FramePool m_framePool;               // 回调中拷贝图像使用的缓冲池
+    quint32 m_lastFrameNum = 0;          // 上一帧的SDK帧号，用于发现相机端丢帧
+    bool m_hasLastFrame = false;         // m_lastFrameNum 是否有效 (每次开始采集时重置)
 };
 
 #endif // CAMERAMANAGER_H
@@ -0,0 +1,282 @@
+// src/InspectorGUI/Core/CameraStation.cpp
+
+#include "CameraStation.h"
+#include "CameraManager.h"
+#include "InspectionWorker.h"
+#include "ThreadAffinity.h"
+#include "TraceRecorder.h"
+#include "LogManager.h"
+#include "Metrics.h"
+#include "FlatField.h"
+#include "Calibration.h"
+#include "ShapeModel.h"
+#include "NominalModel.h"
+#include "GoldenModel.h"
+#include "AutoThreshold.h"
+#include "Fitting.h"
+#include "ChangeDetector.h"
+#include <QSettings>
+#include <QFileInfo>
+#include <QDebug>
+#include <algorithm>
+
+// =====================================================================
+//  CameraPipeline
+// =====================================================================
+
+CameraPipeline::CameraPipeline(int index, const Config& config, QObject *parent)
+    : QObject(parent)
+    , m_index(index)
+    , m_config(config)
+{
+    // 1. 相机：每台相机有自己的命令线程、采集线程和帧缓冲池 (池名即相机名)
+    m_camera = new CameraManager(config.name, CameraManager::createDefaultBackend(), this);
+    if (config.roi.enabled) {
+        m_camera->setRoiOptions(config.roi); // 在命令队列中排在连接之前，连接时生效
+    }
+
+    // 2. 测量线程：常驻，按配置绑核
+    for (int i = 0; i < std::max(1, config.workerCount); ++i)
+    {
+        const int core = config.cores.isEmpty() ? -1 : config.cores[i % config.cores.size()];
+        InspectionWorker* worker = new InspectionWorker(index, core, config.inspect, this);
+        connect(worker, &InspectionWorker::inspectionFinished, this, &CameraPipeline::inspectionFinished);
+        worker->start();
+        m_workers.push_back(worker);
+    }
+
+    // 3. 【关键】DirectConnection：图像在采集线程中直接交给测量线程，不绕道GUI线程
+    connect(m_camera, &CameraManager::newFrameReady, this, [this](const cv::Mat& frame, const FrameTrace& trace) {
+        dispatch(frame, trace);
+    }, Qt::DirectConnection);
+
+    // 4. 显示用的副本 (共享内存) 排队发给GUI线程
+    connect(m_camera, &CameraManager::newFrameReady, this, [this](const cv::Mat& frame, const FrameTrace& trace) {
+        emit frameReady(m_index, frame, trace);
+    });
+}
+
+CameraPipeline::~CameraPipeline()
+{
+    // 先关闭相机：相机析构时会等待命令线程结束并停止采集，之后不会再有帧进入 dispatch()
+    delete m_camera;
+    m_camera = nullptr;
+
+    // 再让测量线程退出，它们由 QObject 的父子关系删除
+    for (InspectionWorker* worker : m_workers) {
+        worker->stop();
+    }
+}
+
+void CameraPipeline::dispatch(const cv::Mat& frame, const FrameTrace& trace)
+{
+    static InspectorLib::RateMeter& dropped = InspectorLib::MetricsRegistry::Global().meter(
+        "inspector_frames_dropped", "Frames lost before inspection", "reason=\"inspector_busy\"");
+
+    const int count = static_cast<int>(m_workers.size());
+    for (int i = 0; i < count; ++i)
+    {
+        InspectionWorker* worker = m_workers[(m_nextWorker + i) % count];
+        if (worker->submit(frame, trace)) {
+            m_nextWorker = (m_nextWorker + i + 1) % count;
+            return;
+        }
+    }
+    dropped.mark();
+    LOG_FAST(QtWarningMsg, "Camera %d: all inspection workers busy, frame %llu dropped.",
+             m_index, static_cast<unsigned long long>(trace.frameId));
+}
+
+// =====================================================================
+//  CameraStation
+// =====================================================================
+
+CameraStation::CameraStation(const QVector<CameraPipeline::Config>& configs, QObject *parent)
+    : QObject(parent)
+{
+    for (int i = 0; i < configs.size(); ++i)
+    {
+        CameraPipeline* pipeline = new CameraPipeline(i, configs[i], this);
+        connect(pipeline, &CameraPipeline::frameReady, this, &CameraStation::frameReady);
+        connect(pipeline, &CameraPipeline::inspectionFinished, this, &CameraStation::onInspectionFinished);
+        m_pipelines.push_back(pipeline);
+    }
+
+    m_joiner = new ResultJoiner(cameraCount(), this);
+    connect(m_joiner, &ResultJoiner::partCompleted, this, &CameraStation::partCompleted);
+
+    qInfo("Camera station created with %d cameras.", cameraCount());
+}
+
+CameraStation::~CameraStation()
+{
+}
+
+QVector<CameraPipeline::Config> CameraStation::loadConfig(const QString& iniPath)
+{
+    if (!QFileInfo::exists(iniPath)) {
+        qInfo("Station config %s not found, using 2 cameras with default settings.", iniPath.toStdString().c_str());
+    }
+
+    QSettings settings(iniPath, QSettings::IniFormat);
+    const int cameras = qBound(1, settings.value("station/cameras", 2).toInt(), kMaxCameras);
+
+    QVector<CameraPipeline::Config> configs;
+    for (int i = 0; i < cameras; ++i)
+    {
+        const QString group = QString("camera%1/").arg(i);
+        CameraPipeline::Config config;
+        config.name = settings.value(group + "name", QString("camera%1").arg(i)).toString();
+        config.deviceIndex = settings.value(group + "device", i).toInt();
+        config.workerCount = qBound(1, settings.value(group + "workers", 1).toInt(), 16);
+        // INI 格式把 cores=3,4 读成 QStringList (toString() 得到空串)，单个核心时是 QString，两种都要处理
+        config.cores = ThreadAffinity::parseCoreList(settings.value(group + "cores").toStringList().join(','));
+        config.roi.enabled = settings.value(group + "roi", false).toBool();
+        config.roi.binning = qBound(1, settings.value(group + "binning", 1).toInt(), 4);
+        config.roi.fullFrameInterval = settings.value(group + "fullFrameInterval", config.roi.fullFrameInterval).toInt();
+        config.inspect.bayerHalfResolution = settings.value(group + "bayerHalfResolution", false).toBool();
+        config.inspect.qualityGate.enabled = settings.value(group + "qualityGate", false).toBool();
+        config.inspect.qualityGate.minFocus = settings.value(group + "minFocus", 0.0).toFloat();
+        config.inspect.caliper.enabled = settings.value(group + "calipers", false).toBool();
+        config.inspect.feret.enabled = settings.value(group + "feret", false).toBool();
+        for (const QString& angle : settings.value(group + "feretAngles").toStringList()) {
+            bool ok = false;
+            const float degrees = angle.trimmed().toFloat(&ok);
+            if (ok) {
+                config.inspect.feret.angles.push_back(degrees);
+            } else {
+                qWarning("Camera %d: ignoring invalid Feret angle '%s'.", i, qPrintable(angle));
+            }
+        }
+        if (settings.value(group + "changeDetection", false).toBool()) {
+            config.inspect.changeDetector = std::make_shared<InspectorLib::ChangeDetector>(); // 这台相机的所有测量线程共享
+        }
+        const QString thresholdName = settings.value(group + "threshold", "fixed").toString();
+        if (!InspectorLib::ParseThresholdMethod(thresholdName.toStdString().c_str(), config.inspect.thresholdMethod)) {
+            qWarning("Camera %d: unknown threshold method '%s', using fixed.", i, qPrintable(thresholdName));
+        }
+        if (config.inspect.thresholdMethod != InspectorLib::Threshold_Fixed) {
+            // 每台相机一份直方图状态，由它的所有测量线程共享
+            config.inspect.thresholdTracker = std::make_shared<InspectorLib::AutoThreshold>();
+        }
+        const QString circleFitName = settings.value(group + "circleFit", "hyper").toString();
+        if (!InspectorLib::ParseCircleFitMethod(circleFitName.toStdString().c_str(), config.inspect.circleFit)) {
+            qWarning("Camera %d: unknown circle fit method '%s', using hyper.", i, qPrintable(circleFitName));
+        }
+        const QString flatFieldFile = settings.value(group + "flatField").toString();
+        if (!flatFieldFile.isEmpty()) {
+            const QString path = QFileInfo(iniPath).absoluteDir().absoluteFilePath(flatFieldFile);
+            auto flatField = std::make_shared<InspectorLib::FlatFieldCorrection>();
+            if (flatField->load(path.toStdString())) {
+                config.inspect.flatField = flatField;
+            } else {
+                qWarning("Camera %d: failed to load flat-field calibration %s.", i, qPrintable(path));
+            }
+        }
+        const QString calibrationFile = settings.value(group + "calibration").toString();
+        if (!calibrationFile.isEmpty()) {
+            const QString path = QFileInfo(iniPath).absoluteDir().absoluteFilePath(calibrationFile);
+            auto calibration = std::make_shared<InspectorLib::CameraCalibration>();
+            if (calibration->load(path.toStdString())) {
+                config.inspect.calibration = calibration;
+            } else {
+                qWarning("Camera %d: failed to load camera calibration %s.", i, qPrintable(path));
+            }
+        }
+        const QString shapeModelFile = settings.value(group + "shapeModel").toString();
+        if (!shapeModelFile.isEmpty()) {
+            const QString path = QFileInfo(iniPath).absoluteDir().absoluteFilePath(shapeModelFile);
+            auto model = std::make_shared<InspectorLib::ShapeModel>();
+            if (model->load(path.toStdString())) {
+                config.inspect.shapeModel = model;
+            } else {
+                qWarning("Camera %d: failed to load part shape model %s.", i, qPrintable(path));
+            }
+        }
+        config.inspect.minMatchScore = qBound(0.1f, settings.value(group + "minMatchScore", 0.7).toFloat(), 1.0f);
+        const QString nominalFile = settings.value(group + "nominal").toString();
+        if (!nominalFile.isEmpty()) {
+            const QString path = QFileInfo(iniPath).absoluteDir().absoluteFilePath(nominalFile);
+            const QString layer = settings.value(group + "nominalLayer").toString();
+            auto model = std::make_shared<InspectorLib::NominalModel>();
+            // 编译结果缓存在源文件旁边 (<文件名>.cache)，源文件没有修改时启动不再重新编译
+            if (model->loadCached(path.toStdString(), (path + ".cache").toStdString(), layer.toStdString())) {
+                // 只有 ini 中写了才覆盖：YAML 配方和缓存中已经保存了各类特征的公差
+                if (settings.contains(group + "holeTolerance")) {
+                    model->setTolerance(InspectorLib::NominalFeature::Hole, settings.value(group + "holeTolerance").toFloat());
+                }
+                if (settings.contains(group + "slotTolerance")) {
+                    model->setTolerance(InspectorLib::NominalFeature::Slot, settings.value(group + "slotTolerance").toFloat());
+                }
+                config.inspect.nominal.model = model;
+            } else {
+                qWarning("Camera %d: failed to load nominal model %s.", i, qPrintable(path));
+            }
+        }
+        config.inspect.nominal.pixelSize = qMax(0.0f, settings.value(group + "pixelSize", 0.0).toFloat());
+        config.inspect.nominal.tolerance = qMax(0.0f, settings.value(group + "nominalTolerance", 0.1).toFloat());
+        const QString goldenFile = settings.value(group + "golden").toString();
+        if (!goldenFile.isEmpty()) {
+            const QString path = QFileInfo(iniPath).absoluteDir().absoluteFilePath(goldenFile);
+            auto model = std::make_shared<InspectorLib::GoldenModel>();
+            if (model->load(path.toStdString())) {
+                config.inspect.golden.model = model;
+            } else {
+                qWarning("Camera %d: failed to load golden part model %s.", i, qPrintable(path));
+            }
+        }
+        config.inspect.golden.tolerance = qMax(0.0f, settings.value(group + "goldenTolerance", 2.0).toFloat());
+        configs.append(config);
+    }
+    return configs;
+}
+
+void CameraStation::connectAll()
+{
+    for (CameraPipeline* pipeline : m_pipelines) {
+        // 命令按顺序执行：先搜索 (填充设备列表)，再按序号连接
+        pipeline->camera()->searchDevices();
+        pipeline->camera()->connectDevice(pipeline->config().deviceIndex);
+    }
+}
+
+void CameraStation::disconnectAll()
+{
+    for (CameraPipeline* pipeline : m_pipelines) pipeline->camera()->disconnectDevice();
+}
+
+void CameraStation::startGrabbingAll()
+{
+    for (CameraPipeline* pipeline : m_pipelines) pipeline->camera()->startGrabbing();
+}
+
+void CameraStation::stopGrabbingAll()
+{
+    for (CameraPipeline* pipeline : m_pipelines) pipeline->camera()->stopGrabbing();
+}
+
+quint64 CameraStation::triggerAll()
+{
+    const quint64 triggerId = m_nextTriggerId++;
+    for (CameraPipeline* pipeline : m_pipelines) {
+        pipeline->camera()->sendSoftwareTrigger(triggerId);
+    }
+    return triggerId;
+}
+
+void CameraStation::onInspectionFinished(int cameraIndex, uint32_t status, const InspectorLib::MeasurementResults& results,
+                                         const QImage& resultImage, const FrameTrace& trace)
+{
+    FrameTrace finishedTrace = trace;
+    finishedTrace.addQueueSpan("Queue", "GUI");
+    TraceRecorder::Instance()->record(finishedTrace);
+
+    // 结果已经是传感器坐标 (测量线程中换算过)，交给这台相机的ROI跟踪
+    CameraPipeline* pipeline = (cameraIndex >= 0 && cameraIndex < cameraCount()) ? m_pipelines[cameraIndex] : nullptr;
+    if (pipeline && pipeline->config().roi.enabled) {
+        pipeline->camera()->updateRoi(status == 0, results.boundingBox);
+    }
+
+    emit cameraResultReady(cameraIndex, status, results, resultImage);
+    m_joiner->addResult(cameraIndex, status, results, finishedTrace);
+}
@@ -0,0 +1,158 @@
+// src/InspectorGUI/Core/CameraStation.h
+
+#ifndef CAMERASTATION_H
+#define CAMERASTATION_H
+
+#include <QObject>
+#include <QVector>
+#include <QString>
+#include <QImage>
+#include <vector>
+#include <opencv2/opencv.hpp>
+#include "Inspector.h"
+#include "FrameTrace.h"
+#include "ResultJoiner.h"
+#include "RoiController.h"
+
+class CameraManager;
+class InspectionWorker;
+
+/**
+ * @class CameraPipeline
+ * @brief 一台相机的完整流水线：相机管理器 (命令线程 + 采集线程 + 帧缓冲池) 和若干个测量线程。
+ *
+ * @details 图像在相机的采集线程中直接交给空闲的测量线程，不经过GUI线程；
+ * 所有测量线程都在忙时这一帧被丢弃 (计入 inspector_frames_dropped{reason="inspector_busy"})。
+ * 另外，图像也会 (排队) 发给GUI线程用于实时显示。
+ */
+class CameraPipeline : public QObject
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @brief 一台相机的配置。
+     */
+    struct Config
+    {
+        QString name;         // 相机名称，用于日志、显示和指标标签
+        int deviceIndex = 0;  // 设备序号 (搜索设备列表中的下标)
+        int workerCount = 1;  // 测量线程个数
+        QVector<int> cores;   // 测量线程绑定的核心，第i个线程使用 cores[i % size]；为空表示不绑定
+        RoiController::Options roi; // 相机端ROI跟踪 (默认关闭)
+        InspectorLib::InspectOptions inspect; // 检测参数 (例如彩色相机是否按半分辨率检测)
+    };
+
+    CameraPipeline(int index, const Config& config, QObject *parent = nullptr);
+    ~CameraPipeline();
+
+    int index() const { return m_index; }
+    const Config& config() const { return m_config; }
+    CameraManager* camera() const { return m_camera; }
+
+signals:
+    void frameReady(int cameraIndex, const cv::Mat& frame, const FrameTrace& trace);
+    void inspectionFinished(int cameraIndex, uint32_t status, const InspectorLib::MeasurementResults& results,
+                            const QImage& resultImage, const FrameTrace& trace);
+
+private:
+    /**
+     * @brief 在相机的采集线程中被直接调用：交给第一个空闲的测量线程。
+     */
+    void dispatch(const cv::Mat& frame, const FrameTrace& trace);
+
+    const int m_index;
+    const Config m_config;
+    CameraManager* m_camera;
+    std::vector<InspectionWorker*> m_workers;
+    int m_nextWorker = 0; // 轮询的起点，让各测量线程的负载均匀 (只在采集线程中访问)
+};
+
+/**
+ * @class CameraStation
+ * @brief 多相机工位：一个零件同时由2~4台相机拍摄，每台相机一条独立的流水线，结果按触发编号合并。
+ *
+ * @details 配置从 ini 文件读取 (默认是程序目录下的 station.ini)，例如:
+ *   [station]
+ *   cameras=2
+ *   [camera0]
+ *   name=Top
+ *   device=0
+ *   workers=1
+ *   cores=2
+ *   [camera1]
+ *   name=Side
+ *   device=1
+ *   workers=2
+ *   cores=3,4
+ *   roi=true                 ; 相机端ROI跟踪，只传输零件附近的区域
+ *   binning=2                ; 可选，ROI跟踪时的像素合并系数
+ *   fullFrameInterval=50     ; 可选，每隔多少个零件强制采集一次整幅
+ *   bayerHalfResolution=true ; 可选，彩色 (Bayer) 相机按 2x2 超像素在半分辨率上检测
+ *   threshold=otsu           ; 可选，二值化阈值：fixed (默认)、otsu 或 triangle；自动阈值在这台相机的所有帧上增量更新
+ *   circleFit=hyper          ; 可选，圆孔的拟合方法：hyper (默认)、taubin、kasa 或 min_enclosing (旧版的最小外接圆)
+ *   calipers=true            ; 可选，用卡尺在灰度图上以亚像素精度重新测量外形尺寸和槽口
+ *   feret=true               ; 可选，计算零件和每个内孔的最大/最小 Feret 直径和最大内切圆
+ *   feretAngles=0,45,90      ; 可选，另外测量宽度的方向 (度，相对零件外接矩形的方向)
+ *   qualityGate=true         ; 可选，质量预检：空帧、不完整、过曝/欠曝的帧不做完整检测 (状态码 4 ~ 8)
+ *   minFocus=150             ; 可选，质量预检的清晰度下限 (拉普拉斯方差，需要按镜头和零件试出)，默认不检查
+ *   changeDetection=true     ; 可选，画面没有变化时复用上一次的结果，只有零件内部变化时只重测变化区域里的孔
+ *   flatField=top.yml        ; 可选，平场校正文件 (主窗口 Tools > Flat-Field Calibration 生成)，相对路径相对于 ini 文件
+ *   calibration=top_cal.yml  ; 可选，相机标定文件 (主窗口 Tools > Camera Calibration 生成)，提供时结果同时换算为毫米
+ *   shapeModel=top_part.yml  ; 可选，形状模型文件 (主窗口 Tools > Train Part Model 生成)，提供时先用模板匹配定位零件
+ *   minMatchScore=0.7        ; 可选，形状模板匹配的最低相似度 (0 ~ 1)
+ *   nominal=top_nominal.yml  ; 可选，名义几何模型 (YAML 或客户图纸 .dxf)，提供时报告外形和内孔与名义几何的偏差；
+ *                            ; 编译结果缓存为同目录下的 top_nominal.yml.cache
+ *   nominalLayer=OUTLINE     ; 可选，DXF 中零件轮廓所在的图层 (图框、尺寸在其他图层时必须指定)
+ *   pixelSize=0.02           ; 可选，一个传感器像素对应的毫米数 (名义几何比较用)，不提供时由 calibration 得到
+ *   nominalTolerance=0.1     ; 可选，名义几何比较的公差 (mm)，超出的连续一段记为一处毛刺或缺料
+ *   holeTolerance=0.05       ; 可选，圆孔和槽口各自的公差 (mm)，覆盖模型中保存的值；都没有时与 nominalTolerance 相同
+ *   slotTolerance=0.05
+ *   golden=top_golden.yml    ; 可选，金板模型 (主窗口 Tools > Train Golden Part 生成)，提供时给出边缘与金板的偏差和热力图
+ *   goldenTolerance=2        ; 可选，边缘到金板边缘的距离公差 (像素)
+ */
+class CameraStation : public QObject
+{
+    Q_OBJECT
+
+public:
+    static constexpr int kMaxCameras = 8;
+
+    explicit CameraStation(const QVector<CameraPipeline::Config>& configs, QObject *parent = nullptr);
+    ~CameraStation();
+
+    /**
+     * @brief 读取工位配置。文件不存在时使用默认配置：2台相机，设备0和1，不绑核。
+     */
+    static QVector<CameraPipeline::Config> loadConfig(const QString& iniPath);
+
+    int cameraCount() const { return static_cast<int>(m_pipelines.size()); }
+    CameraPipeline* pipeline(int index) const { return m_pipelines[index]; }
+
+    // --- 对所有相机执行同一个操作 (都是异步的) ---
+    void connectAll();
+    void disconnectAll();
+    void startGrabbingAll();
+    void stopGrabbingAll();
+
+    /**
+     * @brief 用同一个触发编号触发所有相机，返回这个编号。
+     */
+    quint64 triggerAll();
+
+signals:
+    void frameReady(int cameraIndex, const cv::Mat& frame, const FrameTrace& trace);
+    void cameraResultReady(int cameraIndex, uint32_t status, const InspectorLib::MeasurementResults& results, const QImage& resultImage);
+    void partCompleted(const PartResult& part);
+
+private slots:
+    void onInspectionFinished(int cameraIndex, uint32_t status, const InspectorLib::MeasurementResults& results,
+                              const QImage& resultImage, const FrameTrace& trace);
+
+private:
+    std::vector<CameraPipeline*> m_pipelines;
+    ResultJoiner* m_joiner;
+    quint64 m_nextTriggerId = 1;
+};
+
+#endif // CAMERASTATION_H
@@ -0,0 +1,85 @@
+// src/InspectorGUI/Core/FlatFieldCapture.cpp
+
+#include "FlatFieldCapture.h"
+#include "CameraManager.h"
+#include "PixelFormat.h"
+#include <QDebug>
+#include <algorithm>
+
+FlatFieldCapture::FlatFieldCapture(CameraManager* camera, QObject *parent)
+    : QObject(parent)
+    , m_camera(camera)
+{
+    m_timeout.setSingleShot(true);
+    m_timeout.setInterval(kFrameTimeoutMs);
+    connect(&m_timeout, &QTimer::timeout, this, [this]() {
+        fail(tr("Timed out waiting for calibration frames. Is the camera connected?"));
+    });
+    connect(m_camera, &CameraManager::newFrameReady, this, &FlatFieldCapture::onNewFrame);
+}
+
+void FlatFieldCapture::capture(int frameCount)
+{
+    if (isCapturing()) return;
+
+    m_frameCount = std::max(1, frameCount);
+    m_remaining = m_frameCount;
+    m_sum.release();
+    qInfo("Capturing %d frames for flat-field calibration...", m_frameCount);
+
+    // 每收到一帧再发下一次触发，保证平均的都是新曝光的帧
+    m_camera->sendSoftwareTrigger();
+    m_timeout.start();
+}
+
+void FlatFieldCapture::onNewFrame(const cv::Mat& frame, const FrameTrace& trace)
+{
+    // 只处理标定期间由软触发得到的帧
+    if (!isCapturing() || trace.triggerId == 0) return;
+
+    if (trace.roiOffsetX != 0 || trace.roiOffsetY != 0 || trace.roiScale != 1) {
+        fail(tr("Flat-field calibration needs full frames. Disable camera ROI tracking first."));
+        return;
+    }
+
+    // 1. 解包为原始位深的单通道图像 (Bayer 转换为亮度)
+    cv::Mat image;
+    const bool bayer = InspectorLib::IsBayerFormat(trace.pixelFormat);
+    const bool ok = bayer ? InspectorLib::UnpackToMono8(frame, trace.pixelFormat, image)
+                          : InspectorLib::UnpackToMono16(frame, trace.pixelFormat, image);
+    if (!ok) {
+        fail(tr("Unsupported frame format for flat-field calibration."));
+        return;
+    }
+
+    // 2. 累加
+    if (m_sum.empty()) {
+        m_sum = cv::Mat::zeros(image.size(), CV_64FC1);
+        m_bitDepth = bayer ? 8 : InspectorLib::PixelFormatBitDepth(trace.pixelFormat);
+    }
+    else if (m_sum.size() != image.size()) {
+        fail(tr("Frame size changed during flat-field calibration."));
+        return;
+    }
+    cv::accumulate(image, m_sum);
+
+    // 3. 够数了就求平均，否则触发下一帧
+    if (--m_remaining > 0) {
+        m_camera->sendSoftwareTrigger();
+        m_timeout.start();
+        return;
+    }
+    m_timeout.stop();
+    cv::Mat average;
+    m_sum.convertTo(average, CV_32F, 1.0 / m_frameCount);
+    m_sum.release();
+    emit captured(average, m_bitDepth);
+}
+
+void FlatFieldCapture::fail(const QString& message)
+{
+    m_timeout.stop();
+    m_remaining = 0;
+    m_sum.release();
+    emit failed(message);
+}
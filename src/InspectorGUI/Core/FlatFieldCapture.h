@@ -0,0 +1,60 @@
+// src/InspectorGUI/Core/FlatFieldCapture.h
+
+#ifndef FLATFIELDCAPTURE_H
+#define FLATFIELDCAPTURE_H
+
+#include <QObject>
+#include <QTimer>
+#include <opencv2/opencv.hpp>
+#include "FrameTrace.h"
+
+class CameraManager;
+
+/**
+ * @class FlatFieldCapture
+ * @brief 平场标定的采集步骤：发出若干次软触发，把收到的帧平均为一张参考图 (暗场或平场)。
+ *
+ * @details 多帧平均可以压低随机噪声，标定表更干净。参考图的数值保持原始位深
+ * (Bayer 格式为全分辨率的亮度，位深为8)，交给 InspectorLib::FlatFieldCorrection::calibrate 使用。
+ * 标定必须在整幅、不合并的图像上进行，所以收到相机端ROI的帧时直接报错。
+ * 所有函数都在GUI线程中调用。
+ */
+class FlatFieldCapture : public QObject
+{
+    Q_OBJECT
+
+public:
+    static constexpr int kDefaultFrameCount = 16; // 默认平均的帧数
+    static constexpr int kFrameTimeoutMs = 3000;  // 等待一帧的最长时间
+
+    explicit FlatFieldCapture(CameraManager* camera, QObject *parent = nullptr);
+
+    /**
+     * @brief 开始采集一张参考图，完成后发出 captured (或 failed)。
+     */
+    void capture(int frameCount = kDefaultFrameCount);
+    bool isCapturing() const { return m_remaining > 0; }
+
+signals:
+    /**
+     * @param average 平均后的参考图 (CV_32FC1，原始位深)。
+     * @param bitDepth 参考图的位深。
+     */
+    void captured(const cv::Mat& average, int bitDepth);
+    void failed(const QString& message);
+
+private slots:
+    void onNewFrame(const cv::Mat& frame, const FrameTrace& trace);
+
+private:
+    void fail(const QString& message);
+
+    CameraManager* m_camera;
+    QTimer m_timeout;       // 软触发之后迟迟没有收到帧时报错
+    int m_frameCount = 0;   // 本次要平均的帧数
+    int m_remaining = 0;    // 还要采集的帧数 (0 表示空闲)
+    int m_bitDepth = 8;
+    cv::Mat m_sum;          // 累加和 (CV_64FC1)
+};
+
+#endif // FLATFIELDCAPTURE_H
@@ -0,0 +1,94 @@
+// src/InspectorGUI/Core/FramePool.cpp
+
+#include "FramePool.h"
+#include "Metrics.h"
+#include <QMutexLocker>
+
+// --- 构造函数 ---
+FramePool::FramePool(const QString& name, int capacity)
+    : m_capacity(capacity > 0 ? capacity : 1)
+    , m_poolLabel("pool=\"" + name.toStdString() + "\"")
+    , m_exhausted(InspectorLib::MetricsRegistry::Global().counter(
+          "inspector_frame_pool_exhausted_total", "Frames allocated outside the pool because every buffer was in use", m_poolLabel))
+{
+    m_buffers.reserve(static_cast<size_t>(m_capacity));
+
+    // 使用情况在指标被读取时才计算，acquire() 的热路径上不需要维护额外的计数
+    InspectorLib::MetricsRegistry& registry = InspectorLib::MetricsRegistry::Global();
+    const std::string help = "Frame pool buffers by state";
+    registry.setCallbackGauge("inspector_frame_pool_buffers", help, m_poolLabel + ",state=\"in_use\"",
+                              [this]() { return static_cast<double>(inUseCount()); });
+    registry.setCallbackGauge("inspector_frame_pool_buffers", help, m_poolLabel + ",state=\"allocated\"",
+                              [this]() { return static_cast<double>(allocatedCount()); });
+    registry.setCallbackGauge("inspector_frame_pool_buffers", help, m_poolLabel + ",state=\"capacity\"",
+                              [this]() { return static_cast<double>(m_capacity); });
+}
+
+// --- 析构函数 ---
+FramePool::~FramePool()
+{
+    // 【重要】回调引用了 this，必须在销毁前注销
+    InspectorLib::MetricsRegistry& registry = InspectorLib::MetricsRegistry::Global();
+    registry.removeCallbackGauge("inspector_frame_pool_buffers", m_poolLabel + ",state=\"in_use\"");
+    registry.removeCallbackGauge("inspector_frame_pool_buffers", m_poolLabel + ",state=\"allocated\"");
+    registry.removeCallbackGauge("inspector_frame_pool_buffers", m_poolLabel + ",state=\"capacity\"");
+}
+
+// --- 取得缓冲区 ---
+cv::Mat FramePool::acquire(int rows, int cols, int type)
+{
+    {
+        QMutexLocker locker(&m_mutex);
+
+        // a. 优先复用尺寸和类型都相同的空闲缓冲区
+        for (cv::Mat& buffer : m_buffers)
+        {
+            if (isFree(buffer) && buffer.rows == rows && buffer.cols == cols && buffer.type() == type) {
+                return buffer;
+            }
+        }
+
+        // b. 池未满：新分配一块并纳入池中
+        if (static_cast<int>(m_buffers.size()) < m_capacity)
+        {
+            m_buffers.emplace_back(rows, cols, type);
+            return m_buffers.back();
+        }
+
+        // c. 池已满但有尺寸不同的空闲缓冲区 (例如相机分辨率改变了)：就地重新分配
+        for (cv::Mat& buffer : m_buffers)
+        {
+            if (isFree(buffer)) {
+                buffer.create(rows, cols, type);
+                return buffer;
+            }
+        }
+    }
+
+    // d. 所有缓冲区都在使用中：下游处理不过来了，退化为普通分配
+    m_exhausted.inc();
+    return cv::Mat(rows, cols, type);
+}
+
+int FramePool::inUseCount() const
+{
+    QMutexLocker locker(&m_mutex);
+    int count = 0;
+    for (const cv::Mat& buffer : m_buffers)
+    {
+        if (!isFree(buffer)) ++count;
+    }
+    return count;
+}
+
+int FramePool::allocatedCount() const
+{
+    QMutexLocker locker(&m_mutex);
+    return static_cast<int>(m_buffers.size());
+}
+
+// 引用计数为1说明只有池自己持有这块内存
+bool FramePool::isFree(const cv::Mat& buffer)
+{
+    return buffer.u == nullptr || buffer.u->refcount <= 1;
+}
@@ -0,0 +1,62 @@
+// src/InspectorGUI/Core/FramePool.h
+
+#ifndef FRAMEPOOL_H
+#define FRAMEPOOL_H
+
+#include <QMutex>
+#include <QString>
+#include <opencv2/opencv.hpp>
+#include <string>
+#include <vector>
+
+namespace InspectorLib { class Counter; }
+
+/**
+ * @class FramePool
+ * @brief 相机帧缓冲池：反复使用固定的几块图像内存，避免每一帧都重新分配。
+ *
+ * @details acquire() 返回的 cv::Mat 与池中的缓冲区共享内存。只要还有人持有这个 Mat
+ * (例如正在排队等待GUI显示，或者作为当前图像保存在 MainWindow 中)，缓冲区就被视为“使用中”；
+ * 所有持有者释放之后 (cv::Mat 的引用计数回到1，只剩池自己持有)，缓冲区自动回到可用状态。
+ *
+ * 池满且没有空闲缓冲区时，acquire() 退化为普通的分配，并计入 exhausted 指标。
+ * 使用情况通过 InspectorLib::MetricsRegistry 导出：
+ *   inspector_frame_pool_buffers{pool="...",state="in_use|allocated|capacity"}
+ *   inspector_frame_pool_exhausted_total{pool="..."}
+ *
+ * acquire() 可以从任意线程调用 (通常是SDK回调线程)。
+ */
+class FramePool
+{
+public:
+    /**
+     * @param name 池的名称，作为指标的 pool 标签。
+     * @param capacity 最多保留的缓冲区个数。
+     */
+    explicit FramePool(const QString& name, int capacity = 8);
+    ~FramePool();
+
+    FramePool(const FramePool&) = delete;
+    FramePool& operator=(const FramePool&) = delete;
+
+    /**
+     * @brief 取得一块指定尺寸和类型的缓冲区，内容未初始化，调用方负责写满。
+     */
+    cv::Mat acquire(int rows, int cols, int type);
+
+    int inUseCount() const;     // 正在被池外持有的缓冲区个数
+    int allocatedCount() const; // 已经分配的缓冲区个数
+    int capacity() const { return m_capacity; }
+
+private:
+    static bool isFree(const cv::Mat& buffer);
+
+    const int m_capacity;
+    const std::string m_poolLabel; // 指标标签，例如 pool="camera"
+    InspectorLib::Counter& m_exhausted; // 池耗尽次数
+
+    mutable QMutex m_mutex;          // 保护缓冲区列表
+    std::vector<cv::Mat> m_buffers;  // 池持有的缓冲区
+};
+
+#endif // FRAMEPOOL_H
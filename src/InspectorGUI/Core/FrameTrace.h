@@ -0,0 +1,138 @@
+// src/InspectorGUI/Core/FrameTrace.h
+
+#ifndef FRAMETRACE_H
+#define FRAMETRACE_H
+
+#include <QMetaType>
+#include <vector>
+#include "Inspector.h" // MonotonicNowNs()、StageTiming
+
+/**
+ * @brief 一个追踪区间：某个处理阶段在某条“泳道”上的开始和结束时刻。
+ */
+struct TraceSpan
+{
+    const char* name = "";   // 阶段名称，必须是静态字符串 (字面量或 StageName() 的返回值)
+    const char* lane = "";   // 所属泳道 (如 "Camera"、"Inspector"、"GUI")，导出时每条泳道显示为一行
+    qint64 beginNs = 0;      // 开始时刻 (InspectorLib::MonotonicNowNs 的读数)
+    qint64 endNs = 0;        // 结束时刻
+};
+
+/**
+ * @struct FrameTrace
+ * @brief 伴随每一帧图像在流水线中传递的追踪上下文。
+ *
+ * @details 从相机回调开始创建，随着信号在各个模块之间传递，每个模块把自己处理这一帧的
+ * 开始/结束时刻追加到 spans 中；最后交给 TraceRecorder 保存，可以导出为
+ * Chrome/Perfetto 能打开的追踪文件，直观地看到一帧从曝光到结果显示分别花在了哪里。
+ *
+ * 所有时间戳都使用 InspectorLib::MonotonicNowNs()，与 InspectPart 内部的阶段计时是同一个时钟。
+ */
+struct FrameTrace
+{
+    quint64 frameId = 0;          // SDK 帧号 (从文件加载的图像为0)
+    quint64 deviceTimestamp = 0;  // 相机内部的时间戳 (设备时钟的计数值，单位取决于相机型号)
+    qint64 hostTimestampMs = 0;   // SDK 在主机端生成的时间戳 (毫秒)
+    qint64 receiveNs = 0;         // 回调收到这一帧的时刻 (单调时钟)
+    qint64 queuedNs = 0;          // 最近一次被放入跨线程队列的时刻，用于计算排队时间
+    quint64 triggerId = 0;        // 软触发编号 (非触发采集的帧为0)
+    qint64 triggerNs = 0;         // 发出软触发的时刻，用于统计“触发 -> 结果”的耗时
+    int roiOffsetX = 0;           // 相机端ROI左上角在传感器上的位置 (整幅时为0)
+    int roiOffsetY = 0;
+    int roiScale = 1;             // 像素合并系数 (不合并时为1)
+    InspectorLib::PixelFormat pixelFormat = InspectorLib::PixelFormat_Mono8; // 图像的存放方式 (相机原始格式)
+    std::vector<TraceSpan> spans; // 已经记录的各阶段区间
+
+    /**
+     * @brief 当前时刻，所有追踪时间戳都应使用这个函数获取。
+     */
+    static qint64 nowNs() { return InspectorLib::MonotonicNowNs(); }
+
+    /**
+     * @brief 追加一个已经完成的区间。
+     */
+    void addSpan(const char* name, const char* lane, qint64 beginNs, qint64 endNs)
+    {
+        TraceSpan span;
+        span.name = name;
+        span.lane = lane;
+        span.beginNs = beginNs;
+        span.endNs = endNs;
+        spans.push_back(span);
+    }
+
+    /**
+     * @brief 标记“即将进入跨线程队列”。
+     */
+    void markQueued() { queuedNs = nowNs(); }
+
+    /**
+     * @brief 在队列的另一端调用：把从 markQueued() 到现在的等待时间记为一个排队区间。
+     */
+    void addQueueSpan(const char* name, const char* lane)
+    {
+        if (queuedNs != 0) {
+            addSpan(name, lane, queuedNs, nowNs());
+            queuedNs = 0;
+        }
+    }
+
+    /**
+     * @brief 这一帧是相机端ROI或合并之后的子图时，把测量结果换算回整幅传感器坐标。
+     * @details 测量线程在 InspectPart 之后立即调用，之后所有模块看到的都是传感器坐标。
+     */
+    void mapResultsToSensor(InspectorLib::MeasurementResults& results) const
+    {
+        if (roiOffsetX != 0 || roiOffsetY != 0 || roiScale != 1) {
+            InspectorLib::MapResultsToSensor(results, cv::Point2f(static_cast<float>(roiOffsetX), static_cast<float>(roiOffsetY)),
+                                             static_cast<float>(roiScale));
+        }
+    }
+
+    /**
+     * @brief 把这一帧在传感器上的位置填入检测参数 (平场校正需要据此取出对应的区域)。
+     */
+    void applySensorGeometry(InspectorLib::InspectOptions& options) const
+    {
+        options.sensorOffset = cv::Point(roiOffsetX, roiOffsetY);
+        options.sensorScale = roiScale;
+    }
+
+    /**
+     * @brief 把 InspectPart 内部记录的各阶段耗时转换为追踪区间。
+     */
+    void addStageTiming(const InspectorLib::StageTiming& timing, const char* lane)
+    {
+        for (int i = 0; i < InspectorLib::Stage_Count; ++i)
+        {
+            const InspectorLib::InspectStage stage = static_cast<InspectorLib::InspectStage>(i);
+            if (timing.endNs[i] != 0) {
+                addSpan(InspectorLib::StageName(stage), lane, timing.beginNs[i], timing.endNs[i]);
+            }
+        }
+    }
+};
+Q_DECLARE_METATYPE(FrameTrace)
+
+/**
+ * @brief RAII 辅助类：构造时记下开始时刻，析构时把区间追加到 FrameTrace。
+ * @details 用法: { TraceScope scope(trace, "Convert", "GUI"); ...耗时操作... }
+ */
+class TraceScope
+{
+public:
+    TraceScope(FrameTrace& trace, const char* name, const char* lane)
+        : m_trace(trace), m_name(name), m_lane(lane), m_beginNs(FrameTrace::nowNs()) {}
+    ~TraceScope() { m_trace.addSpan(m_name, m_lane, m_beginNs, FrameTrace::nowNs()); }
+
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+
+private:
+    FrameTrace& m_trace;
+    const char* m_name;
+    const char* m_lane;
+    qint64 m_beginNs;
+};
+
+#endif // FRAMETRACE_H
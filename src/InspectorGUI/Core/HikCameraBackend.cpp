@@ -0,0 +1,308 @@
+// src/InspectorGUI/Core/HikCameraBackend.cpp
+
+#include "HikCameraBackend.h"
+#include "LogManager.h"
+#include "PixelFormat.h"
+#include <QDebug>
+#include <algorithm>
+#include <cstring>
+
+// --- 构造函数 ---
+HikCameraBackend::HikCameraBackend()
+{
+    // 初始化时，确保设备列表结构体是干净的
+    memset(&m_deviceList, 0, sizeof(MV_CC_DEVICE_INFO_LIST));
+}
+
+// --- 析构函数 ---
+HikCameraBackend::~HikCameraBackend()
+{
+    close();
+}
+
+// --- 搜索设备 ---
+bool HikCameraBackend::enumerateDevices(QStringList& deviceNames)
+{
+    // 调用海康SDK的枚举设备函数
+    int nRet = MV_CC_EnumDevices(MV_GIGE_DEVICE | MV_USB_DEVICE, &m_deviceList);
+    if (MV_OK != nRet)
+    {
+        qCritical("Failed to enumerate devices. Error code: %#x", nRet);
+        return false;
+    }
+
+    deviceNames.clear();
+    for (unsigned int i = 0; i < m_deviceList.nDeviceNum; i++)
+    {
+        // 从设备信息中提取一个可读的名字
+        MV_CC_DEVICE_INFO* pDeviceInfo = m_deviceList.pDeviceInfo[i];
+        if (pDeviceInfo->nTLayerType == MV_GIGE_DEVICE) {
+            // 对于网口相机，使用用户自定义名或型号名
+            QString name = (const char*)pDeviceInfo->SpecialInfo.stGigEInfo.chUserDefinedName;
+            if (name.isEmpty()) {
+                name = (const char*)pDeviceInfo->SpecialInfo.stGigEInfo.chModelName;
+            }
+            deviceNames.append(name);
+        }
+    }
+    return true;
+}
+
+// --- 打开设备 ---
+bool HikCameraBackend::open(int index)
+{
+    if (index < 0 || index >= (int)m_deviceList.nDeviceNum) {
+        return false;
+    }
+    close(); // 先释放已有的连接
+
+    // 1. 根据索引选择设备，并创建句柄
+    int nRet = MV_CC_CreateHandle(&m_cameraHandle, m_deviceList.pDeviceInfo[index]);
+    if (MV_OK != nRet) {
+        m_cameraHandle = nullptr;
+        qCritical("Failed to create camera handle. Error: %#x", nRet);
+        return false;
+    }
+
+    // 2. 打开设备
+    nRet = MV_CC_OpenDevice(m_cameraHandle);
+    if (MV_OK != nRet) {
+        MV_CC_DestroyHandle(m_cameraHandle);
+        m_cameraHandle = nullptr;
+        qCritical("Failed to open device. Error: %#x", nRet);
+        return false;
+    }
+
+    // 3. 读取传感器尺寸，并恢复整幅、不合并的状态 (上一次程序退出时相机可能还停留在ROI模式)
+    m_binning = 1;
+    setBinning(1);
+    MVCC_INTVALUE_EX widthMax = {}, heightMax = {};
+    MV_CC_GetIntValueEx(m_cameraHandle, "WidthMax", &widthMax);
+    MV_CC_GetIntValueEx(m_cameraHandle, "HeightMax", &heightMax);
+    m_sensorSize = cv::Size(static_cast<int>(widthMax.nCurValue), static_cast<int>(heightMax.nCurValue));
+    cv::Rect fullFrame;
+    setRoi(fullFrame);
+
+    // 4. 【关键】注册图像数据回调函数
+    // 我们将 this 指针作为用户自定义数据(pUser)传递给回调函数
+    nRet = MV_CC_RegisterImageCallBackEx(m_cameraHandle, frameCallback, this);
+    if (MV_OK != nRet) {
+        qCritical("Failed to register image callback. Error: %#x", nRet);
+    }
+    return true;
+}
+
+// --- 关闭设备 ---
+void HikCameraBackend::close()
+{
+    if (m_cameraHandle == nullptr) return;
+
+    MV_CC_StopGrabbing(m_cameraHandle); // 确保停止采集
+    MV_CC_CloseDevice(m_cameraHandle);
+    MV_CC_DestroyHandle(m_cameraHandle);
+    m_cameraHandle = nullptr;
+}
+
+// --- 切换触发模式 ---
+bool HikCameraBackend::setTriggerMode(bool softwareTrigger)
+{
+    if (m_cameraHandle == nullptr) return false;
+    int nRet = MV_CC_SetEnumValue(m_cameraHandle, "TriggerMode", softwareTrigger ? MV_TRIGGER_MODE_ON : MV_TRIGGER_MODE_OFF);
+    if (MV_OK == nRet && softwareTrigger) {
+        nRet = MV_CC_SetEnumValue(m_cameraHandle, "TriggerSource", MV_TRIGGER_SOURCE_SOFTWARE);
+    }
+    if (MV_OK != nRet) {
+        qCritical("Failed to set trigger mode. Error: %#x", nRet);
+        return false;
+    }
+    return true;
+}
+
+bool HikCameraBackend::startGrabbing()
+{
+    if (m_cameraHandle == nullptr) return false;
+    const int nRet = MV_CC_StartGrabbing(m_cameraHandle);
+    if (MV_OK != nRet) {
+        qCritical("Failed to start grabbing. Error: %#x", nRet);
+        return false;
+    }
+    return true;
+}
+
+bool HikCameraBackend::stopGrabbing()
+{
+    if (m_cameraHandle == nullptr) return false;
+    return MV_OK == MV_CC_StopGrabbing(m_cameraHandle);
+}
+
+// --- 发送软触发：已布防时只需要这一条命令 ---
+bool HikCameraBackend::fireSoftwareTrigger()
+{
+    if (m_cameraHandle == nullptr) return false;
+    const int nRet = MV_CC_SetCommandValue(m_cameraHandle, "TriggerSoftware");
+    if (MV_OK != nRet) {
+        qCritical("Failed to send software trigger. Error: %#x", nRet);
+        return false;
+    }
+    return true;
+}
+
+bool HikCameraBackend::setExposure(double microseconds)
+{
+    if (m_cameraHandle == nullptr) return false;
+    const int nRet = MV_CC_SetFloatValue(m_cameraHandle, "ExposureTime", (float)microseconds);
+    if (MV_OK != nRet) {
+        qWarning("Failed to set exposure to %.0f us. Error: %#x", microseconds, nRet);
+        return false;
+    }
+    return true;
+}
+
+bool HikCameraBackend::setGain(double db)
+{
+    if (m_cameraHandle == nullptr) return false;
+    const int nRet = MV_CC_SetFloatValue(m_cameraHandle, "Gain", (float)db);
+    if (MV_OK != nRet) {
+        qWarning("Failed to set gain to %.1f dB. Error: %#x", db, nRet);
+        return false;
+    }
+    return true;
+}
+
+// --- 设置ROI ---
+int64_t HikCameraBackend::increment(const char* key)
+{
+    MVCC_INTVALUE_EX info = {};
+    if (MV_OK != MV_CC_GetIntValueEx(m_cameraHandle, key, &info) || info.nInc <= 0) return 1;
+    return info.nInc;
+}
+
+int64_t HikCameraBackend::setAlignedInt(const char* key, int64_t value, bool roundUp)
+{
+    MVCC_INTVALUE_EX info = {};
+    if (MV_OK != MV_CC_GetIntValueEx(m_cameraHandle, key, &info)) return -1;
+
+    // 对齐到步长，并限制在允许范围内 (向上取整超出最大值时退回一个步长)
+    const int64_t inc = info.nInc > 0 ? info.nInc : 1;
+    value = std::max(info.nMin, std::min(info.nMax, value));
+    value = info.nMin + (value - info.nMin + (roundUp ? inc - 1 : 0)) / inc * inc;
+    if (value > info.nMax) value -= inc;
+    const int nRet = MV_CC_SetIntValueEx(m_cameraHandle, key, value);
+    if (MV_OK != nRet) {
+        qWarning("Failed to set %s to %lld. Error: %#x", key, static_cast<long long>(value), nRet);
+        return -1;
+    }
+    return value;
+}
+
+bool HikCameraBackend::setRoi(cv::Rect& roi)
+{
+    if (m_cameraHandle == nullptr) return false;
+
+    // 相机寄存器使用合并之后的像素单位，这里换算一下
+    const cv::Rect full(0, 0, m_sensorSize.width, m_sensorSize.height);
+    const cv::Rect wanted = roi.area() > 0 ? (roi & full) : full;
+    const int b = m_binning;
+
+    // 【关键】向外对齐：左上角向下取整到偏移的步长，右下角向上取整，再按宽高的步长向上取整。
+    // 解释: 四个值各自向下取整时，窗口的右边和下边最多会比要求的 ROI 小一个步长，零件的边缘就被裁掉了。
+    const int64_t incX = increment("OffsetX");
+    const int64_t incY = increment("OffsetY");
+    const int64_t left = wanted.x / b / incX * incX;
+    const int64_t top = wanted.y / b / incY * incY;
+    const int64_t right = (wanted.x + wanted.width + b - 1) / b;
+    const int64_t bottom = (wanted.y + wanted.height + b - 1) / b;
+
+    // 先把偏移清零，再设置宽高，最后设置偏移：否则“偏移 + 新宽度”可能暂时超出传感器范围而被拒绝。
+    // 宽高向上取整后如果超出传感器的右边/下边，偏移会被限制在允许范围内 (向左/向上移)，窗口仍然包含 ROI。
+    setAlignedInt("OffsetX", 0);
+    setAlignedInt("OffsetY", 0);
+    const int64_t width = setAlignedInt("Width", right - left, true);
+    const int64_t height = setAlignedInt("Height", bottom - top, true);
+    const int64_t offsetX = setAlignedInt("OffsetX", left);
+    const int64_t offsetY = setAlignedInt("OffsetY", top);
+    if (width < 0 || height < 0 || offsetX < 0 || offsetY < 0) {
+        return false;
+    }
+
+    m_roi = cv::Rect(static_cast<int>(offsetX * b), static_cast<int>(offsetY * b), static_cast<int>(width * b), static_cast<int>(height * b));
+    roi = m_roi;
+    return true;
+}
+
+bool HikCameraBackend::setBinning(int factor)
+{
+    if (m_cameraHandle == nullptr) return false;
+
+    // 优先使用 binning (合并像素，信噪比更好)，不支持时退而使用 decimation (隔行隔列抽样)
+    static const char* const keys[][2] = {
+        { "BinningHorizontal", "BinningVertical" },
+        { "DecimationHorizontal", "DecimationVertical" }
+    };
+    for (const auto& pair : keys)
+    {
+        if (MV_OK == MV_CC_SetEnumValue(m_cameraHandle, pair[0], factor) &&
+            MV_OK == MV_CC_SetEnumValue(m_cameraHandle, pair[1], factor)) {
+            m_binning = factor;
+            return true;
+        }
+    }
+    if (factor != 1) {
+        qWarning("Camera supports neither binning nor decimation by %d.", factor);
+    }
+    m_binning = 1;
+    return factor == 1;
+}
+
+// --- 像素格式换算 ---
+bool HikCameraBackend::toPixelFormat(MvGvspPixelType type, InspectorLib::PixelFormat& format)
+{
+    switch (type)
+    {
+    case PixelType_Gvsp_Mono8:         format = InspectorLib::PixelFormat_Mono8; return true;
+    case PixelType_Gvsp_Mono10:        format = InspectorLib::PixelFormat_Mono10; return true;
+    case PixelType_Gvsp_Mono12:        format = InspectorLib::PixelFormat_Mono12; return true;
+    case PixelType_Gvsp_Mono16:        format = InspectorLib::PixelFormat_Mono16; return true;
+    case PixelType_Gvsp_Mono10_Packed: format = InspectorLib::PixelFormat_Mono10Packed; return true;
+    case PixelType_Gvsp_Mono12_Packed: format = InspectorLib::PixelFormat_Mono12Packed; return true;
+    case PixelType_Gvsp_BayerRG8:      format = InspectorLib::PixelFormat_BayerRG8; return true;
+    case PixelType_Gvsp_BayerBG8:      format = InspectorLib::PixelFormat_BayerBG8; return true;
+    case PixelType_Gvsp_BayerGB8:      format = InspectorLib::PixelFormat_BayerGB8; return true;
+    case PixelType_Gvsp_BayerGR8:      format = InspectorLib::PixelFormat_BayerGR8; return true;
+    default: return false;
+    }
+}
+
+// --- 静态回调函数的实现 ---
+void __stdcall HikCameraBackend::frameCallback(unsigned char* pData, MV_FRAME_OUT_INFO_EX* pFrameInfo, void* pUser)
+{
+    // 【关键】pUser 就是我们注册回调时传递的 this 指针！
+    HikCameraBackend* backend = static_cast<HikCameraBackend*>(pUser);
+    if (backend == nullptr || pData == nullptr || pFrameInfo == nullptr) {
+        return;
+    }
+
+    CameraFrameInfo info;
+    info.frameNum = pFrameInfo->nFrameNum;
+    info.triggerIndex = pFrameInfo->nTriggerIndex;
+    info.deviceTimestamp = (static_cast<quint64>(pFrameInfo->nDevTimeStampHigh) << 32) | pFrameInfo->nDevTimeStampLow;
+    info.hostTimestampMs = pFrameInfo->nHostTimeStamp;
+    info.pixelType = static_cast<quint64>(pFrameInfo->enPixelType);
+    info.lostPackets = pFrameInfo->nLostPacket;
+    info.offsetX = backend->m_roi.x;
+    info.offsetY = backend->m_roi.y;
+    info.binning = backend->m_binning;
+
+    // 高位深和 Bayer 格式保持原始数据，解包 (或转换为亮度) 和二值化在测量线程中一遍完成
+    if (!toPixelFormat(pFrameInfo->enPixelType, info.pixelFormat)) {
+        LOG_FAST(QtWarningMsg, "Frame %u dropped: unsupported pixel type %#llx.", info.frameNum,
+                 static_cast<unsigned long long>(info.pixelType));
+        return;
+    }
+
+    // 将SDK返回的图像数据，包装成一个OpenCV的Mat对象。
+    // 这是一个高效的操作，它与原始数据共享内存，没有发生拷贝；pData 在回调返回后就会被SDK复用。
+    cv::Mat frame = InspectorLib::WrapRawFrame(pData, pFrameInfo->nWidth, pFrameInfo->nHeight, info.pixelFormat);
+    if (frame.empty()) return;
+    backend->deliverFrame(frame, info);
+}
@@ -0,0 +1,72 @@
+// src/InspectorGUI/Core/HikCameraBackend.h
+
+#ifndef HIKCAMERABACKEND_H
+#define HIKCAMERABACKEND_H
+
+#include "CameraBackend.h"
+
+// 【重要】包含海康相机的SDK头文件
+// 这是我们项目中唯一一个需要直接和SDK打交道的模块。
+#include "MvCameraControl.h"
+
+/**
+ * @class HikCameraBackend
+ * @brief 基于海康 MVS SDK 的相机后端。
+ * @details SDK的错误码在这里记录到日志，上层 (CameraManager) 只关心成功与否。
+ */
+class HikCameraBackend : public CameraBackend
+{
+public:
+    HikCameraBackend();
+    ~HikCameraBackend() override;
+
+    const char* name() const override { return "HIK MVS"; }
+    bool enumerateDevices(QStringList& deviceNames) override;
+    bool open(int index) override;
+    void close() override;
+    bool isOpen() const override { return m_cameraHandle != nullptr; }
+    bool setTriggerMode(bool softwareTrigger) override;
+    bool startGrabbing() override;
+    bool stopGrabbing() override;
+    bool fireSoftwareTrigger() override;
+    bool setExposure(double microseconds) override;
+    bool setGain(double db) override;
+    cv::Size sensorSize() const override { return m_sensorSize; }
+    bool setRoi(cv::Rect& roi) override;
+    bool setBinning(int factor) override;
+
+private:
+    /**
+     * @brief 把整数节点设置为满足步长要求的最近值 (默认向下取整，roundUp 时向上取整，都限制在允许范围内)，
+     *        返回实际设置的值 (失败返回 -1)。
+     */
+    int64_t setAlignedInt(const char* key, int64_t value, bool roundUp = false);
+
+    /**
+     * @brief 整数节点的步长 (读取失败时为 1)。
+     */
+    int64_t increment(const char* key);
+
+    /**
+     * @brief SDK像素格式 -> InspectorLib::PixelFormat。不支持的格式返回 false。
+     */
+    static bool toPixelFormat(MvGvspPixelType type, InspectorLib::PixelFormat& format);
+
+    /**
+     * @brief 这是相机SDK的回调函数，将在一个独立的SDK线程中被调用。
+     * @param pData 指向图像数据的指针。
+     * @param pFrameInfo 包含图像帧信息的结构体。
+     * @param pUser 传递给回调的用户自定义指针 (我们将用它来传递 this 指针)。
+     */
+    static void __stdcall frameCallback(unsigned char* pData, MV_FRAME_OUT_INFO_EX* pFrameInfo, void* pUser);
+
+    void* m_cameraHandle = nullptr;      // 指向相机实例的句柄，由SDK提供
+    MV_CC_DEVICE_INFO_LIST m_deviceList; // 存储搜索到的设备列表
+
+    // --- 当前生效的 ROI 和合并系数 (只在停止采集时修改，回调线程只读) ---
+    cv::Size m_sensorSize;       // WidthMax/HeightMax (未合并)
+    cv::Rect m_roi;              // 传感器像素坐标
+    int m_binning = 1;
+};
+
+#endif // HIKCAMERABACKEND_H
@@ -6,6 +6,7 @@
 #include <QImage>
 #include <QDebug>
 #include <opencv2/opencv.hpp>
+#include "PixelFormat.h" // InspectorLib::UnpackToMono8
 
 /**
  * @class ImageConverter
@@ -52,6 +53,23 @@ public:
         return QImage(); // 如果格式不支持，返回一个空QImage
     }
 
+    /**
+     * @brief 将相机的原始图像 (可能是 Mono10/12 或打包格式) 转换为用于显示的8位 QImage。
+     * @param format 原始图像的像素格式，见 FrameTrace::pixelFormat。
+     */
+    static QImage rawFrameToQImage(const cv::Mat& rawImage, InspectorLib::PixelFormat format)
+    {
+        if (format == InspectorLib::PixelFormat_Mono8) {
+            return cvMatToQImage(rawImage);
+        }
+        cv::Mat preview;
+        if (!InspectorLib::UnpackToMono8(rawImage, format, preview)) {
+            qWarning("ImageConverter::rawFrameToQImage() - Image does not match pixel format %s", InspectorLib::PixelFormatName(format));
+            return QImage();
+        }
+        return cvMatToQImage(preview);
+    }
+
     /**
      * @brief 将 Qt 的 QImage 转换为 OpenCV 的 cv::Mat。
      * @param image 输入的 QImage 图像。支持多种RGB和灰度格式。
@@ -0,0 +1,106 @@
+// src/InspectorGUI/Core/InspectionWorker.cpp
+
+#include "InspectionWorker.h"
+#include "ImageConverter.h"
+#include "ThreadAffinity.h"
+#include "LogManager.h"
+#include <QMutexLocker>
+
+// --- 构造函数 ---
+InspectionWorker::InspectionWorker(int cameraIndex, int core, const InspectorLib::InspectOptions& options, QObject *parent)
+    : QThread(parent)
+    , m_cameraIndex(cameraIndex)
+    , m_core(core)
+    , m_options(options)
+{
+    qRegisterMetaType<InspectorLib::MeasurementResults>("InspectorLib::MeasurementResults");
+    qRegisterMetaType<FrameTrace>("FrameTrace");
+}
+
+// --- 析构函数 ---
+InspectionWorker::~InspectionWorker()
+{
+    stop();
+}
+
+void InspectionWorker::stop()
+{
+    {
+        QMutexLocker locker(&m_mutex);
+        m_stopRequested = true;
+    }
+    m_jobAvailable.wakeAll();
+    wait();
+}
+
+// --- 提交任务 (任意线程) ---
+bool InspectionWorker::submit(const cv::Mat& image, const FrameTrace& trace)
+{
+    {
+        QMutexLocker locker(&m_mutex);
+        if (m_stopRequested || m_busy || m_hasJob) {
+            return false;
+        }
+        m_image = image; // 只增加引用计数，不拷贝像素
+        m_trace = trace;
+        m_trace.markQueued();
+        m_hasJob = true;
+    }
+    m_jobAvailable.wakeOne();
+    return true;
+}
+
+// --- 线程主循环 ---
+void InspectionWorker::run()
+{
+    // 绑核必须在线程自己内部完成
+    if (m_core >= 0 && ThreadAffinity::pinCurrentThread(m_core)) {
+        qInfo("Inspection worker for camera %d pinned to core %d.", m_cameraIndex, m_core);
+    }
+
+    while (true)
+    {
+        // 1. 取出信箱中的一帧
+        cv::Mat image;
+        FrameTrace trace;
+        {
+            QMutexLocker locker(&m_mutex);
+            while (!m_hasJob && !m_stopRequested) {
+                m_jobAvailable.wait(&m_mutex);
+            }
+            if (m_stopRequested) break;
+            image = m_image;
+            trace = m_trace;
+            m_image.release();
+            m_hasJob = false;
+            m_busy = true;
+        }
+        trace.addQueueSpan("Queue", "Inspector");
+
+        // 2. 测量
+        InspectorLib::MeasurementResults results;
+        cv::Mat resultCanvas;
+        InspectorLib::InspectOptions options = m_options;
+        trace.applySensorGeometry(options);
+        const uint32_t status = InspectorLib::InspectRawFrame(image, trace.pixelFormat, results, resultCanvas, options);
+        results.triggerId = trace.triggerId;
+        trace.mapResultsToSensor(results);
+        trace.addStageTiming(results.timing, "Inspector");
+        LOG_FAST(QtInfoMsg, "Camera %d: InspectPart finished, status=%u, trigger=%llu",
+                 m_cameraIndex, status, static_cast<unsigned long long>(trace.triggerId));
+
+        QImage resultImage;
+        if (status == 0) {
+            TraceScope scope(trace, "ConvertResult", "Inspector");
+            resultImage = ImageConverter::cvMatToQImage(resultCanvas);
+        }
+
+        // 3. 先清除忙标志再发信号，让下一帧尽早进来
+        {
+            QMutexLocker locker(&m_mutex);
+            m_busy = false;
+        }
+        trace.markQueued();
+        emit inspectionFinished(m_cameraIndex, status, results, resultImage, trace);
+    }
+}
@@ -0,0 +1,73 @@
+// src/InspectorGUI/Core/InspectionWorker.h
+
+#ifndef INSPECTIONWORKER_H
+#define INSPECTIONWORKER_H
+
+#include <QThread>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QImage>
+#include <opencv2/opencv.hpp>
+#include "Inspector.h"
+#include "FrameTrace.h"
+
+/**
+ * @class InspectionWorker
+ * @brief 常驻的测量线程，多相机工位中每台相机有一个或多个，可以绑定到指定的CPU核心。
+ *
+ * @details 与 InspectorThread (每测一张图启动一次线程) 不同，这个线程一直运行，
+ * 通过一个只能放一帧的“信箱”接收任务：submit() 可以从任意线程调用 (通常直接在相机的采集线程中调用)，
+ * 图像不经过GUI线程，也不做额外的拷贝 (cv::Mat 共享帧缓冲池中的内存)。
+ * 线程正在测量时 submit() 返回 false，由调用方决定交给别的线程还是丢弃。
+ */
+class InspectionWorker : public QThread
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @param cameraIndex 所属相机在工位中的序号，随结果一起发出。
+     * @param core 绑定的CPU核心，小于0表示不绑定。
+     * @param options 检测参数 (运行期间不变)。
+     */
+    InspectionWorker(int cameraIndex, int core, const InspectorLib::InspectOptions& options, QObject *parent = nullptr);
+    ~InspectionWorker();
+
+    /**
+     * @brief 提交一帧图像。线程空闲时接受并返回 true，正在测量或信箱已满时返回 false。
+     */
+    bool submit(const cv::Mat& image, const FrameTrace& trace);
+
+    /**
+     * @brief 通知线程退出并等待它结束 (析构时会自动调用)。
+     */
+    void stop();
+
+    int core() const { return m_core; }
+
+signals:
+    /**
+     * @brief 一帧测量完成 (无论成功与否)。失败时 resultImage 为空。
+     */
+    void inspectionFinished(int cameraIndex, uint32_t status, const InspectorLib::MeasurementResults& results,
+                            const QImage& resultImage, const FrameTrace& trace);
+
+protected:
+    virtual void run() override;
+
+private:
+    const int m_cameraIndex;
+    const int m_core;
+    const InspectorLib::InspectOptions m_options;
+
+    // --- 信箱，由 m_mutex 保护 ---
+    QMutex m_mutex;
+    QWaitCondition m_jobAvailable;
+    bool m_hasJob = false;   // 信箱里有一帧还没取走
+    bool m_busy = false;     // 正在测量
+    bool m_stopRequested = false;
+    cv::Mat m_image;
+    FrameTrace m_trace;
+};
+
+#endif // INSPECTIONWORKER_H
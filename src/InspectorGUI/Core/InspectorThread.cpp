@@ -9,7 +9,12 @@
 // 我们将在下一步创建这个文件
 #include "ImageConverter.h"
 
+#include "LogManager.h"
+#include "TraceRecorder.h"
+#include "Metrics.h"
+
 #include <QDebug>
+#include <QElapsedTimer>
 
 // --- 构造函数 ---
 InspectorThread::InspectorThread(QObject *parent)
@@ -18,6 +23,7 @@ InspectorThread::InspectorThread(QObject *parent)
     // 在构造时，注册我们自定义的 MeasurementResults 类型。
     // 这样Qt的信号槽系统才能正确地在线程之间传递它。
     qRegisterMetaType<InspectorLib::MeasurementResults>("InspectorLib::MeasurementResults");
+    qRegisterMetaType<FrameTrace>("FrameTrace");
 }
 
 // --- 析构函数 ---
@@ -28,17 +34,34 @@ InspectorThread::~InspectorThread()
 }
 
 // --- 核心公共接口：接收任务 ---
-void InspectorThread::inspectImage(const cv::Mat& imageToInspect)
+bool InspectorThread::inspectImage(const cv::Mat& imageToInspect, const FrameTrace& trace)
 {
+    InspectorLib::MetricsRegistry& registry = InspectorLib::MetricsRegistry::Global();
+    static InspectorLib::RateMeter& dropped = registry.meter("inspector_frames_dropped", "Frames lost before inspection", "reason=\"inspector_busy\"");
+    static InspectorLib::Gauge& queue = registry.gauge("inspector_queue_depth", "Items waiting in a cross-thread queue", "queue=\"inspector\"");
+
+    // 0. 上一次测量还在进行：run() 正在读取 m_imageToInspect，不能覆盖它，这一帧只能丢弃
+    if (isRunning()) {
+        dropped.mark();
+        qWarning("Inspector is busy, frame %llu dropped.", static_cast<unsigned long long>(trace.frameId));
+        return false;
+    }
+
     // 1. 将传入的图像复制一份，存储到成员变量中。
     //    这是一个重要的步骤，可以防止在主线程的图像被销毁后，
     //    后台线程访问一个无效的内存地址。
     m_imageToInspect = imageToInspect.clone();
+    m_trace = trace;
+    m_jobOptions = m_options;
+    m_trace.applySensorGeometry(m_jobOptions);
+    m_trace.markQueued(); // 从这里开始计算“等待后台线程启动”的排队时间
+    queue.set(1);         // run() 开始执行时清零
 
     // 2. 调用 QThread::start() 来启动线程。
     //    【重要】永远不要直接调用 run()！
     //    调用 start() 会创建一个新的操作系统线程，然后在这个新线程中自动调用 run()。
     start();
+    return true;
 }
 
 
@@ -48,12 +71,30 @@ void InspectorThread::run()
     // 解释: 这部分的所有代码，都在一个独立的后台线程中执行，
     //       完全不会影响主GUI线程的响应。
 
+    m_trace.addQueueSpan("Queue", "Inspector");
+
+    InspectorLib::MetricsRegistry& registry = InspectorLib::MetricsRegistry::Global();
+    static InspectorLib::Gauge& queue = registry.gauge("inspector_queue_depth", "Items waiting in a cross-thread queue", "queue=\"inspector\"");
+    static InspectorLib::Gauge& resultQueue = registry.gauge("inspector_queue_depth", "Items waiting in a cross-thread queue", "queue=\"inspector_to_gui\"");
+    queue.set(0);
+
     // 1. 准备用于接收结果的“容器”
     InspectorLib::MeasurementResults results;
     cv::Mat resultCanvas; // 用于接收带标记的可视化结果图
 
     // 2. 【核心调用】在这里，我们调用了我们的DLL！
-    uint32_t statusCode = InspectorLib::InspectPart(m_imageToInspect, results, resultCanvas);
+    QElapsedTimer timer;
+    timer.start();
+    uint32_t statusCode = InspectorLib::InspectRawFrame(m_imageToInspect, m_trace.pixelFormat, results, resultCanvas, m_jobOptions);
+    results.triggerId = m_trace.triggerId; // 把触发编号带到结果中，GUI据此统计触发到结果的耗时
+    m_trace.mapResultsToSensor(results);   // 相机端ROI：把坐标换算回整幅传感器
+
+    // 使用热路径日志记录耗时：只写二进制文件，不做字符串格式化，不经过GUI
+    LOG_FAST(QtInfoMsg, "InspectPart finished: status=%u, size=%dx%d, elapsed=%lld us",
+             statusCode, m_imageToInspect.cols, m_imageToInspect.rows, timer.nsecsElapsed() / 1000);
+
+    // 把算法内部各阶段的耗时追加到追踪上下文中
+    m_trace.addStageTiming(results.timing, "Inspector");
 
     // 3. 检查执行状态
     if (statusCode == 0)
@@ -62,17 +103,32 @@ void InspectorThread::run()
 
         // a. 将OpenCV的BGR格式的Mat，转换为Qt的RGB格式的QImage
         //    我们将在 ImageConverter.h 中实现这个辅助函数。
-        QImage resultQImage = ImageConverter::cvMatToQImage(resultCanvas);
+        QImage resultQImage;
+        {
+            TraceScope scope(m_trace, "ConvertResult", "Inspector");
+            resultQImage = ImageConverter::cvMatToQImage(resultCanvas);
+        }
 
         // b. 发射“完成”信号，将结果安全地传递回主GUI线程
-        emit finishedInspection(results, resultQImage);
+        m_trace.markQueued(); // GUI线程收到信号后会记录排队时间和显示耗时
+        resultQueue.add(1);   // MainWindow::onInspectionFinished 取出后减1
+        emit finishedInspection(results, resultQImage, m_trace);
+    }
+    else if (statusCode >= 4)
+    {
+        // --- 质量预检拒绝 (状态码 4 ~ 8)：预期之内的结果，只报告原因 ---
+        TraceRecorder::Instance()->record(m_trace);
+        emit frameRejected(QString(InspectorLib::StatusName(statusCode)));
     }
     else
     {
         // --- 如果算法失败 ---
 
         // a. 根据错误码，创建一个人类可读的错误信息字符串
-        QString errorMessage = QString("Inspection failed with error code: %1").arg(statusCode);
+        QString errorMessage = QString("Inspection failed with error code: %1 (%2)").arg(statusCode).arg(InspectorLib::StatusName(statusCode));
+
+        // 失败的帧不会再被显示，在这里直接保存追踪
+        TraceRecorder::Instance()->record(m_trace);
 
         // b. 发射“错误”信号，将错误信息传递回主GUI线程
         emit errorOccurred(errorMessage);
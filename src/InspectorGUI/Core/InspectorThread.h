@@ -7,6 +7,7 @@
 #include <QImage>
 #include <opencv2/opencv.hpp>
 #include "Inspector.h" // 包含头文件以使用 MeasurementResults
+#include "FrameTrace.h"
 
 // 这是一个非常重要的Qt元类型声明。
 // 因为我们想在信号和槽之间传递自定义的 MeasurementResults 结构体，
@@ -22,18 +23,27 @@ public:
     ~InspectorThread();
 
     /**
-     * @brief [核心] 启动线程进行测量。
+     * @brief [核心] 启动线程进行测量。如果上一次测量还没有结束，这一帧会被丢弃并计入丢帧指标。
      * @param imageToInspect 要进行测量的OpenCV图像。
+     * @param trace 该图像的追踪上下文，测量各阶段的耗时会追加到其中。
+     * @return 图像被接受返回 true；被丢弃返回 false (此时不会发出任何完成或错误信号)。
      */
-    void inspectImage(const cv::Mat& imageToInspect);
+    bool inspectImage(const cv::Mat& imageToInspect, const FrameTrace& trace = FrameTrace());
+
+    /**
+     * @brief 设置检测参数，从下一次 inspectImage() 开始生效。
+     */
+    void setInspectOptions(const InspectorLib::InspectOptions& options) { m_options = options; }
+    const InspectorLib::InspectOptions& inspectOptions() const { return m_options; }
 
 signals:
     /**
      * @brief 当测量完成时，发出此信号。
      * @param results 包含所有测量数据的结构体。
      * @param resultImage 绘制了可视化结果的图像。
+     * @param trace 追加了测量各阶段耗时的追踪上下文。
      */
-    void finishedInspection(const InspectorLib::MeasurementResults& results, const QImage& resultImage);
+    void finishedInspection(const InspectorLib::MeasurementResults& results, const QImage& resultImage, const FrameTrace& trace);
 
     /**
      * @brief 当测量过程中发生错误时，发出此信号。
@@ -41,6 +51,13 @@ signals:
      */
     void errorOccurred(const QString& message);
 
+    /**
+     * @brief 质量预检拒绝了这一帧 (状态码 4 ~ 8，空帧、不完整、失焦、过曝/欠曝)。
+     * @details 这是产线上的正常结果，不是错误，界面只需要提示，不应该弹出对话框。
+     * @param reason 拒绝原因 (StatusName 的英文名称)。
+     */
+    void frameRejected(const QString& reason);
+
 protected:
     /**
      * @brief QThread的核心虚函数。
@@ -50,6 +67,9 @@ protected:
 
 private:
     cv::Mat m_imageToInspect; // 存储待处理的图像副本
+    FrameTrace m_trace;       // 待处理图像的追踪上下文
+    InspectorLib::InspectOptions m_options;    // GUI线程设置的检测参数
+    InspectorLib::InspectOptions m_jobOptions; // 本次测量使用的参数 (启动线程时从 m_options 复制)
 };
 
 #endif // INSPECTORTHREAD_H
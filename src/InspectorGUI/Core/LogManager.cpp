@@ -5,6 +5,7 @@
 #include <QMutex>    // 用于实现线程安全的单例创建
 #include <QMutexLocker> // 一个方便的RAII类，用于自动加锁和解锁
 #include <QTextStream>  // 用于方便地构建格式化的字符串
+#include <QThread>      // 用于获取当前线程ID
 
 // --- 1. 初始化静态成员变量 ---
 // 在类定义的外部，对静态成员变量进行唯一的定义和初始化。
@@ -27,14 +28,34 @@ void customMessageHandler(QtMsgType type, const QMessageLogContext &context, con
     // 从而避免编译器产生“未使用参数”的警告。
     Q_UNUSED(context);
 
+    // a. 构建一条结构化记录。这里不做任何字符串拼接，格式化被推迟到真正显示时才进行。
+    LogRecord record;
+    record.timestampMs = QDateTime::currentMSecsSinceEpoch();
+    record.level = type;
+    record.threadId = static_cast<quint32>(reinterpret_cast<quintptr>(QThread::currentThreadId()));
+    record.text = msg;
+
+    // b. 如果启用了文件日志，把原始消息(时间戳和级别由二进制记录自带)写入磁盘
+    LogManager::Instance()->logTextToFile(type, msg);
+
+    // c. 【关键】通过LogManager单例，将日志记录广播出去。
+    //    这里不直接与任何UI控件交互，而是通过发射信号来解耦。
+    emit LogManager::Instance()->newRecord(record);
+}
+
+
+// --- 3. LogRecord 的成员函数实现 ---
+
+QString LogRecord::formatted() const
+{
     QString formattedMessage; // 创建一个空字符串来构建完整的日志条目
     QTextStream stream(&formattedMessage); // 使用 QTextStream 来方便地写入
 
     // a. 添加时间戳，格式为 "年-月-日 时:分:秒.毫秒"
-    stream << QDateTime::currentDateTime().toString("yyyy-MM-dd hh:mm:ss.zzz") << " ";
+    stream << QDateTime::fromMSecsSinceEpoch(timestampMs).toString("yyyy-MM-dd hh:mm:ss.zzz") << " ";
 
     // b. 根据消息级别，添加一个可读的文本标签
-    switch (type) {
+    switch (level) {
     case QtDebugMsg:    stream << "[DEBUG]   "; break;
     case QtInfoMsg:     stream << "[INFO]    "; break;
     case QtWarningMsg:  stream << "[WARNING] "; break;
@@ -43,20 +64,31 @@ void customMessageHandler(QtMsgType type, const QMessageLogContext &context, con
     }
 
     // c. 添加原始的日志消息内容
-    stream << msg;
+    stream << text;
+    return formattedMessage;
+}
 
-    // d. 【关键】通过LogManager单例，将格式化好的消息广播出去。
-    //    这里不直接与任何UI控件交互，而是通过发射信号来解耦。
-    emit LogManager::Instance()->newMessage(formattedMessage);
+int LogRecord::severity() const
+{
+    switch (level) {
+    case QtDebugMsg:    return 0;
+    case QtInfoMsg:     return 1;
+    case QtWarningMsg:  return 2;
+    case QtCriticalMsg: return 3;
+    case QtFatalMsg:    return 4;
+    }
+    return 0;
 }
 
 
-// --- 3. LogManager 类的成员函数实现 ---
+// --- 4. LogManager 类的成员函数实现 ---
 
 // 私有构造函数的实现（函数体为空即可）
 LogManager::LogManager(QObject *parent)
     : QObject(parent)
 {
+    // 注册 LogRecord 类型，使其可以通过排队连接在线程之间传递
+    qRegisterMetaType<LogRecord>("LogRecord");
 }
 
 // 获取单例实例的函数
@@ -92,3 +124,37 @@ void LogManager::uninstall()
     // 传递 nullptr 给 qInstallMessageHandler 可以恢复Qt的默认处理器行为。
     qInstallMessageHandler(nullptr);
 }
+
+// 启用二进制文件日志
+void LogManager::enableFileSink(const BinaryLogSink::Options& options)
+{
+    // 如果之前已经启用，先停掉旧的 sink，确保同一时间只有一个文件在写
+    disableFileSink();
+
+    BinaryLogSink* sink = new BinaryLogSink(options);
+    sink->start(QThread::LowPriority); // 落盘不是紧急任务，不与检测线程争抢CPU
+    m_fileSink.store(sink, std::memory_order_release);
+}
+
+// 停用二进制文件日志
+void LogManager::disableFileSink()
+{
+    BinaryLogSink* sink = m_fileSink.exchange(nullptr, std::memory_order_acq_rel);
+    if (sink != nullptr) {
+        // 析构函数会请求后台线程把剩余数据写完并等待其退出
+        delete sink;
+    }
+}
+
+quint32 LogManager::registerFormat(const char* format)
+{
+    return BinaryLogSink::registerFormat(format);
+}
+
+void LogManager::logTextToFile(QtMsgType level, const QString& message)
+{
+    BinaryLogSink* sink = m_fileSink.load(std::memory_order_acquire);
+    if (sink != nullptr) {
+        sink->logText(static_cast<quint8>(level), message.toUtf8());
+    }
+}
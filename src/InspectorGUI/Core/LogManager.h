@@ -5,6 +5,48 @@
 
 #include <QObject>
 #include <QDebug> // 包含QDebug以支持Qt的日志系统
+#include <QString>
+#include <QMetaType>
+#include <atomic>
+#include "BinaryLogSink.h"
+
+/**
+ * @brief 一条结构化的日志记录。
+ * @details LogManager 不预先把日志拼成字符串，而是把时间、级别、线程和原文分开传递，
+ * 让 LogWidget 能按级别/线程过滤，并且只在真正需要显示某一行时才去格式化它。
+ */
+struct LogRecord
+{
+    qint64 timestampMs = 0;       // 产生时刻 (自1970年起的毫秒数)
+    QtMsgType level = QtDebugMsg; // 日志级别
+    quint32 threadId = 0;         // 产生日志的线程ID
+    QString text;                 // 原始日志内容
+
+    /**
+     * @brief 格式化为 "年-月-日 时:分:秒.毫秒 [级别] 内容" 的完整文本。
+     */
+    QString formatted() const;
+
+    /**
+     * @brief 返回级别的严重程度 (Debug=0, Info=1, Warning=2, Critical=3, Fatal=4)，
+     * 便于按“不低于某级别”进行过滤 (QtMsgType 本身的取值并不是按严重程度排列的)。
+     */
+    int severity() const;
+};
+Q_DECLARE_METATYPE(LogRecord)
+
+/**
+ * @brief [热路径日志宏] 以二进制形式记录一条日志，只写入磁盘，不经过 newRecord 信号。
+ * @details 格式字符串只在第一次执行到这一行时注册一次（函数内静态变量），
+ * 之后每次调用只拷贝“格式ID + 参数”，没有任何字符串格式化。
+ * 用法与 printf 相同，例如: LOG_FAST(QtInfoMsg, "Frame %u inspected in %lld us", frameId, elapsedUs);
+ * 未调用 enableFileSink() 时，该宏几乎没有开销。
+ */
+#define LOG_FAST(level, format, ...)                                                  \
+    do {                                                                              \
+        static const quint32 s_logFormatId = LogManager::registerFormat(format);      \
+        LogManager::Instance()->logFast(level, s_logFormatId, ##__VA_ARGS__);         \
+    } while (0)
 
 /**
  * @class LogManager
@@ -14,7 +56,7 @@
  * 1. 确保在整个应用程序中只有一个日志管理实例存在（单例模式）。
  * 2. 提供一个全局访问点 `Instance()` 来获取这个唯一的实例。
  * 3. 提供 `install()` 方法来“劫持”Qt默认的日志输出流（如qDebug, qWarning等）。
- * 4. 将所有被劫持的日志消息，格式化后，通过 `newMessage` 信号发射出去。
+ * 4. 将所有被劫持的日志消息，打包成结构化的 LogRecord，通过 `newRecord` 信号发射出去。
  *
  * 这种设计的目的是将“日志的产生”与“日志的消费（如显示在UI上或写入文件）”完全解耦。
  */
@@ -49,14 +91,53 @@ public:
      */
     void uninstall();
 
+    /**
+     * @brief 启用二进制文件日志。
+     *
+     * @details 启用后，所有 qDebug/qInfo 等日志以及 LOG_FAST 记录都会被写入
+     * options.directory 下的 .plog 文件，文件按大小和时间自动滚动。
+     * 可以用 LogDecoder 工具把 .plog 文件还原为文本。
+     * @param options 文件输出参数（目录、滚动大小、滚动时间等）。
+     */
+    void enableFileSink(const BinaryLogSink::Options& options);
+
+    /**
+     * @brief 停用二进制文件日志，并等待剩余记录全部写入磁盘。
+     * @details 应在其他工作线程停止写日志之后调用（例如主窗口析构时）。
+     */
+    void disableFileSink();
+
+    /**
+     * @brief 注册一个格式字符串，返回其ID。通常由 LOG_FAST 宏自动调用。
+     */
+    static quint32 registerFormat(const char* format);
+
+    /**
+     * @brief [热路径] 把一条“格式ID + 参数”的记录写入文件日志。通常由 LOG_FAST 宏调用。
+     */
+    template<typename... Args>
+    void logFast(QtMsgType level, quint32 formatId, const Args&... args)
+    {
+        BinaryLogSink* sink = m_fileSink.load(std::memory_order_acquire);
+        if (sink != nullptr) {
+            sink->log(static_cast<quint8>(level), formatId, args...);
+        }
+    }
+
+    /**
+     * @brief 把一条已经格式化好的文本日志写入文件日志 (由自定义消息处理器调用)。
+     */
+    void logTextToFile(QtMsgType level, const QString& message);
+
 signals:
     /**
      * @brief 当有新的日志消息被处理时，会发出此信号。
-     * @param message 经过完整格式化（包含时间戳、级别、内容）的日志字符串。
+     * @param record 结构化的日志记录（时间戳、级别、线程、内容），需要文本时调用 record.formatted()。
      *
      * @details 任何关心日志消息的模块（如LogWidget）都可以连接到这个信号。
+     * 信号可能从任意线程发出，跨线程连接时Qt会自动排队传递。
      */
-    void newMessage(const QString& message);
+    void newRecord(const LogRecord& record);
 
 private:
     // --- 单例模式的核心实现 ---
@@ -91,6 +172,12 @@ private:
      * 它在 .cpp 文件中被初始化为 nullptr。
      */
     static LogManager* m_instance;
+
+    /**
+     * @brief 当前启用的二进制文件日志，未启用时为 nullptr。
+     * @details 使用原子指针，热路径上无需加锁即可判断文件日志是否启用。
+     */
+    std::atomic<BinaryLogSink*> m_fileSink { nullptr };
 };
 
 #endif // LOGMANAGER_H
@@ -0,0 +1,101 @@
+// src/InspectorGUI/Core/MetricsServer.cpp
+
+#include "MetricsServer.h"
+#include "Metrics.h"
+
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QTimer>
+
+// --- 构造函数 ---
+MetricsServer::MetricsServer(QObject *parent)
+    : QObject(parent)
+    , m_server(new QTcpServer(this))
+{
+    connect(m_server, &QTcpServer::newConnection, this, &MetricsServer::onNewConnection);
+}
+
+// --- 析构函数 ---
+MetricsServer::~MetricsServer()
+{
+    stop();
+}
+
+bool MetricsServer::start(quint16 port, const QHostAddress& address)
+{
+    if (m_server->isListening()) {
+        m_server->close();
+    }
+    if (!m_server->listen(address, port)) {
+        qWarning("Metrics endpoint could not listen on %s:%u: %s", address.toString().toStdString().c_str(),
+                 port, m_server->errorString().toStdString().c_str());
+        return false;
+    }
+    qInfo("Metrics endpoint listening on http://%s:%u/metrics", address.toString().toStdString().c_str(), port);
+    return true;
+}
+
+void MetricsServer::stop()
+{
+    m_server->close();
+}
+
+bool MetricsServer::isListening() const
+{
+    return m_server->isListening();
+}
+
+// --- 私有槽函数：接受新连接 ---
+void MetricsServer::onNewConnection()
+{
+    while (QTcpSocket* socket = m_server->nextPendingConnection())
+    {
+        connect(socket, &QTcpSocket::readyRead, this, [this, socket]() { handleRequest(socket); });
+        connect(socket, &QTcpSocket::disconnected, socket, &QObject::deleteLater);
+
+        // 客户端连上之后迟迟不发送请求：5秒后强制断开，避免连接一直占用
+        QTimer::singleShot(5000, socket, [socket]() { socket->abort(); socket->deleteLater(); });
+    }
+}
+
+// --- 私有辅助函数：处理请求 ---
+void MetricsServer::handleRequest(QTcpSocket* socket)
+{
+    // 请求行可能分几次到达，等整行收齐再处理；请求头对我们没有用，不需要解析
+    if (!socket->canReadLine()) return;
+
+    const QList<QByteArray> parts = socket->readLine().trimmed().split(' ');
+    disconnect(socket, &QTcpSocket::readyRead, this, nullptr);
+
+    if (parts.size() < 2) {
+        writeResponse(socket, "400 Bad Request", "text/plain", "Bad Request\n");
+        return;
+    }
+
+    const QByteArray& method = parts[0];
+    const QByteArray path = parts[1].split('?').first(); // 忽略查询参数
+    if (method != "GET") {
+        writeResponse(socket, "405 Method Not Allowed", "text/plain", "Only GET is supported\n");
+    }
+    else if (path == "/metrics") {
+        const std::string text = InspectorLib::MetricsRegistry::Global().renderPrometheus();
+        writeResponse(socket, "200 OK", "text/plain; version=0.0.4; charset=utf-8",
+                      QByteArray(text.data(), static_cast<int>(text.size())));
+    }
+    else {
+        writeResponse(socket, "404 Not Found", "text/plain", "Try /metrics\n");
+    }
+}
+
+void MetricsServer::writeResponse(QTcpSocket* socket, const QByteArray& status, const QByteArray& contentType, const QByteArray& body)
+{
+    QByteArray response;
+    response += "HTTP/1.1 " + status + "\r\n";
+    response += "Content-Type: " + contentType + "\r\n";
+    response += "Content-Length: " + QByteArray::number(body.size()) + "\r\n";
+    response += "Connection: close\r\n\r\n";
+    response += body;
+
+    socket->write(response);
+    socket->disconnectFromHost(); // 数据写完后才真正断开，随后 disconnected 信号会删除 socket
+}
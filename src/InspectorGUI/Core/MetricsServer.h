@@ -0,0 +1,56 @@
+// src/InspectorGUI/Core/MetricsServer.h
+
+#ifndef METRICSSERVER_H
+#define METRICSSERVER_H
+
+#include <QObject>
+#include <QHostAddress>
+
+class QTcpServer;
+class QTcpSocket;
+
+/**
+ * @class MetricsServer
+ * @brief 一个极简的内嵌 HTTP 服务，在 GET /metrics 上以 Prometheus 文本格式输出运行时指标。
+ *
+ * @details 指标内容来自 InspectorLib::MetricsRegistry::Global()，与 ExampleMain --metrics-dump
+ * 输出的是同一套指标。只实现抓取所需的最小子集：每个连接读取一行请求，回复后立即关闭连接。
+ * 默认只监听本机地址，由本机的采集代理 (例如 Prometheus 或 node_exporter) 转发到看板。
+ *
+ * 所有操作都在创建它的线程 (GUI 线程) 的事件循环中完成。
+ */
+class MetricsServer : public QObject
+{
+    Q_OBJECT
+
+public:
+    static const quint16 kDefaultPort = 9464;
+
+    explicit MetricsServer(QObject *parent = nullptr);
+    ~MetricsServer();
+
+    /**
+     * @brief 开始监听。
+     * @return 端口被占用等原因导致监听失败时返回 false。
+     */
+    bool start(quint16 port = kDefaultPort, const QHostAddress& address = QHostAddress(QHostAddress::LocalHost));
+
+    void stop();
+
+    bool isListening() const;
+
+private slots:
+    void onNewConnection();
+
+private:
+    /**
+     * @brief 读取到完整的请求行之后生成回复。
+     */
+    void handleRequest(QTcpSocket* socket);
+
+    static void writeResponse(QTcpSocket* socket, const QByteArray& status, const QByteArray& contentType, const QByteArray& body);
+
+    QTcpServer* m_server;
+};
+
+#endif // METRICSSERVER_H
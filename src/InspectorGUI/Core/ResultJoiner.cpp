@@ -0,0 +1,93 @@
+// src/InspectorGUI/Core/ResultJoiner.cpp
+
+#include "ResultJoiner.h"
+#include "Metrics.h"
+#include <QTimer>
+#include <QDebug>
+#include <algorithm>
+
+ResultJoiner::ResultJoiner(int cameraCount, QObject *parent)
+    : QObject(parent)
+    , m_cameraCount(cameraCount)
+{
+    qRegisterMetaType<PartResult>("PartResult");
+
+    m_timer = new QTimer(this);
+    m_timer->setInterval(kJoinTimeoutMs / 4);
+    connect(m_timer, &QTimer::timeout, this, &ResultJoiner::expireStale);
+    m_timer->start();
+}
+
+void ResultJoiner::addResult(int cameraIndex, uint32_t status, const InspectorLib::MeasurementResults& results, const FrameTrace& trace)
+{
+    if (trace.triggerId == 0 || cameraIndex < 0 || cameraIndex >= m_cameraCount) {
+        return;
+    }
+    if (std::find(m_recentlyFinished.begin(), m_recentlyFinished.end(), trace.triggerId) != m_recentlyFinished.end()) {
+        qWarning("Late result from camera %d for trigger %llu discarded.", cameraIndex, static_cast<unsigned long long>(trace.triggerId));
+        return;
+    }
+
+    // 1. 找到 (或新建) 这个触发编号对应的零件
+    auto it = m_pending.find(trace.triggerId);
+    if (it == m_pending.end()) {
+        PartResult part;
+        part.triggerId = trace.triggerId;
+        part.triggerNs = trace.triggerNs;
+        part.statuses.fill(PartResult::kStatusMissing, m_cameraCount);
+        part.results.resize(m_cameraCount);
+        it = m_pending.emplace(trace.triggerId, part).first;
+    }
+    PartResult& part = it->second;
+    if (trace.triggerNs != 0 && (part.triggerNs == 0 || trace.triggerNs < part.triggerNs)) {
+        part.triggerNs = trace.triggerNs;
+    }
+
+    // 2. 填入这台相机的结果
+    part.statuses[cameraIndex] = status;
+    part.results[cameraIndex] = results;
+
+    // 3. 收齐了就发出
+    for (uint32_t s : part.statuses) {
+        if (s == PartResult::kStatusMissing) return;
+    }
+    finish(it, true);
+}
+
+void ResultJoiner::expireStale()
+{
+    const qint64 deadlineNs = FrameTrace::nowNs() - static_cast<qint64>(kJoinTimeoutMs) * 1000000;
+    for (auto it = m_pending.begin(); it != m_pending.end(); )
+    {
+        auto next = std::next(it);
+        if (it->second.triggerNs < deadlineNs) {
+            qWarning("Part for trigger %llu timed out waiting for all cameras.", static_cast<unsigned long long>(it->first));
+            finish(it, false);
+        }
+        it = next;
+    }
+}
+
+void ResultJoiner::finish(std::map<quint64, PartResult>::iterator it, bool complete)
+{
+    InspectorLib::MetricsRegistry& registry = InspectorLib::MetricsRegistry::Global();
+    static InspectorLib::Histogram& latency = registry.histogram("inspector_part_result_seconds", "Time from trigger until results from all cameras were joined");
+    static InspectorLib::Counter& passed = registry.counter("inspector_parts_total", "Parts inspected by the multi-camera station", "result=\"pass\"");
+    static InspectorLib::Counter& failed = registry.counter("inspector_parts_total", "Parts inspected by the multi-camera station", "result=\"fail\"");
+    static InspectorLib::Counter& incomplete = registry.counter("inspector_parts_total", "Parts inspected by the multi-camera station", "result=\"incomplete\"");
+
+    PartResult part = it->second;
+    m_pending.erase(it);
+    m_recentlyFinished.push_back(part.triggerId);
+    if (m_recentlyFinished.size() > 64) m_recentlyFinished.pop_front();
+
+    part.complete = complete;
+    part.completedNs = FrameTrace::nowNs();
+    if (!complete) {
+        incomplete.inc();
+    } else {
+        (part.passed() ? passed : failed).inc();
+        latency.observe((part.completedNs - part.triggerNs) * 1e-9);
+    }
+    emit partCompleted(part);
+}
@@ -0,0 +1,85 @@
+// src/InspectorGUI/Core/ResultJoiner.h
+
+#ifndef RESULTJOINER_H
+#define RESULTJOINER_H
+
+#include <QObject>
+#include <QVector>
+#include <QMetaType>
+#include <deque>
+#include <map>
+#include "Inspector.h"
+#include "FrameTrace.h"
+
+class QTimer;
+
+/**
+ * @struct PartResult
+ * @brief 一个零件的合并结果：同一个触发编号下，工位中所有相机的测量结果。
+ */
+struct PartResult
+{
+    static constexpr uint32_t kStatusMissing = 0xFFFFFFFFu; // 这台相机在超时之前没有返回结果
+
+    quint64 triggerId = 0;
+    qint64 triggerNs = 0;    // 最早一台相机的触发时刻
+    qint64 completedNs = 0;  // 合并完成 (或超时) 的时刻
+    bool complete = false;   // 所有相机都返回了结果
+    QVector<uint32_t> statuses;                          // 每台相机的状态码
+    QVector<InspectorLib::MeasurementResults> results;   // 每台相机的测量结果 (状态码非0时无意义)
+
+    /**
+     * @brief 零件是否合格：所有相机都返回了结果，并且全部成功。
+     */
+    bool passed() const
+    {
+        if (!complete) return false;
+        for (uint32_t status : statuses) {
+            if (status != 0) return false;
+        }
+        return true;
+    }
+};
+Q_DECLARE_METATYPE(PartResult)
+
+/**
+ * @class ResultJoiner
+ * @brief 按触发编号合并多台相机的测量结果。
+ *
+ * @details 工位给所有相机发出同一个触发编号，各相机的测量结果先后到达 (顺序不确定)。
+ * 收齐一个编号下所有相机的结果后发出 partCompleted；超过 kJoinTimeoutMs 还没有收齐的，
+ * 以“不完整”的状态发出，缺失的相机状态码为 PartResult::kStatusMissing。
+ * 只在GUI线程中使用。
+ */
+class ResultJoiner : public QObject
+{
+    Q_OBJECT
+
+public:
+    static constexpr int kJoinTimeoutMs = 3000;
+
+    explicit ResultJoiner(int cameraCount, QObject *parent = nullptr);
+
+    /**
+     * @brief 加入一台相机的结果。triggerId 为0 (连续采集的帧) 的结果不参与合并。
+     */
+    void addResult(int cameraIndex, uint32_t status, const InspectorLib::MeasurementResults& results, const FrameTrace& trace);
+
+    int pendingCount() const { return static_cast<int>(m_pending.size()); }
+
+signals:
+    void partCompleted(const PartResult& part);
+
+private slots:
+    void expireStale(); // 定时检查超时的零件
+
+private:
+    void finish(std::map<quint64, PartResult>::iterator it, bool complete);
+
+    const int m_cameraCount;
+    std::map<quint64, PartResult> m_pending; // 还没有收齐的零件，按触发编号排序
+    std::deque<quint64> m_recentlyFinished;   // 最近已经发出的编号，超时之后迟到的结果直接丢弃
+    QTimer* m_timer;
+};
+
+#endif // RESULTJOINER_H
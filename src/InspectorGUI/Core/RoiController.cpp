@@ -0,0 +1,40 @@
+// src/InspectorGUI/Core/RoiController.cpp
+
+#include "RoiController.h"
+#include <algorithm>
+
+cv::Rect RoiController::next(bool partFound, const cv::RotatedRect& sensorBox)
+{
+    const cv::Rect full = fullFrame();
+    if (!m_options.enabled || full.area() == 0) {
+        return full;
+    }
+
+    // 1. 没有找到零件：回到整幅重新寻找
+    const cv::Rect part = partFound ? (sensorBox.boundingRect() & full) : cv::Rect();
+    if (part.area() == 0) {
+        m_resultsSinceFullFrame = 0;
+        return full;
+    }
+
+    // 2. 定期强制整幅
+    if (!isFullFrame() && m_options.fullFrameInterval > 0 && ++m_resultsSinceFullFrame >= m_options.fullFrameInterval) {
+        m_resultsSinceFullFrame = 0;
+        return full;
+    }
+
+    // 3. 需要的区域：零件外接矩形四周外扩
+    const int marginX = std::max(m_options.minMargin, static_cast<int>(part.width * m_options.margin));
+    const int marginY = std::max(m_options.minMargin, static_cast<int>(part.height * m_options.margin));
+    const cv::Rect wanted = cv::Rect(part.x - marginX, part.y - marginY, part.width + 2 * marginX, part.height + 2 * marginY) & full;
+
+    // 4. 滞回：当前ROI仍然可用就不修改
+    if (!isFullFrame())
+    {
+        const cv::Rect inner = cv::Rect(part.x - marginX / 2, part.y - marginY / 2, part.width + marginX, part.height + marginY) & full;
+        if ((m_current & inner) == inner && m_current.area() <= 2 * wanted.area()) {
+            return m_current;
+        }
+    }
+    return wanted;
+}
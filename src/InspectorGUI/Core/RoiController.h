@@ -0,0 +1,69 @@
+// src/InspectorGUI/Core/RoiController.h
+
+#ifndef ROICONTROLLER_H
+#define ROICONTROLLER_H
+
+#include <opencv2/opencv.hpp>
+
+/**
+ * @class RoiController
+ * @brief 根据零件的位置决定相机下一帧传输哪块区域 (ROI)。
+ *
+ * @details 零件通常只占视野的一小部分，只传输零件周围的区域可以节省 GigE 带宽和主机内存，提高帧率。
+ *  - 找到零件：ROI = 零件外接矩形四周各外扩 margin (比例) 和 minMargin (像素) 中较大的一个；
+ *  - 滞回：零件仍然完整地落在当前ROI内 (保留一半边距)，并且当前ROI不超过需要的2倍时，保持不变。
+ *    修改ROI需要停止/重新开始采集，频繁修改反而得不偿失；
+ *  - 没有找到零件 (零件移出了ROI)：立即回到整幅；
+ *  - 每 fullFrameInterval 次之后强制采集一次整幅，防止视野中出现新的零件或位置漂移时一直看不到。
+ *
+ * 所有坐标都是传感器像素 (未合并)。只在 CameraManager 的命令线程中使用。
+ */
+class RoiController
+{
+public:
+    struct Options
+    {
+        bool enabled = false;       // 是否启用相机端ROI
+        double margin = 0.25;       // 四周外扩的比例 (相对于零件外接矩形的宽高)
+        int minMargin = 32;         // 四周外扩的最小像素数
+        int fullFrameInterval = 50; // 每隔多少次结果强制采集一次整幅 (<=0 表示不强制)
+        int binning = 1;            // 像素合并系数 (1/2/4)，相机不支持时自动退回1
+    };
+
+    RoiController() = default;
+
+    void setOptions(const Options& options) { m_options = options; reset(); }
+    const Options& options() const { return m_options; }
+
+    /**
+     * @brief 设置传感器尺寸，并回到整幅。
+     */
+    void setSensorSize(const cv::Size& size) { m_sensorSize = size; reset(); }
+
+    /**
+     * @brief 根据最近一次测量结果计算下一帧的ROI。
+     * @param partFound 是否找到了零件。
+     * @param sensorBox 零件外接矩形 (传感器坐标)。
+     * @return 下一帧的ROI；与 current() 相同时调用方不需要修改相机。
+     */
+    cv::Rect next(bool partFound, const cv::RotatedRect& sensorBox);
+
+    /**
+     * @brief 相机实际生效的ROI (按步长对齐之后的)。
+     */
+    void setApplied(const cv::Rect& roi) { m_current = roi; }
+
+    cv::Rect current() const { return m_current; }
+    cv::Rect fullFrame() const { return cv::Rect(0, 0, m_sensorSize.width, m_sensorSize.height); }
+    bool isFullFrame() const { return m_current == fullFrame(); }
+
+    void reset() { m_current = fullFrame(); m_resultsSinceFullFrame = 0; }
+
+private:
+    Options m_options;
+    cv::Size m_sensorSize;
+    cv::Rect m_current;
+    int m_resultsSinceFullFrame = 0;
+};
+
+#endif // ROICONTROLLER_H
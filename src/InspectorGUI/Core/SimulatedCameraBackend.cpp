@@ -0,0 +1,221 @@
+// src/InspectorGUI/Core/SimulatedCameraBackend.cpp
+
+#include "SimulatedCameraBackend.h"
+#include <QDateTime>
+#include <QDebug>
+#include <algorithm>
+
+// --- 构造函数 ---
+SimulatedCameraBackend::SimulatedCameraBackend(const QString& imagePath)
+    : m_imagePath(imagePath)
+{
+}
+
+// --- 析构函数 ---
+SimulatedCameraBackend::~SimulatedCameraBackend()
+{
+    close();
+}
+
+bool SimulatedCameraBackend::enumerateDevices(QStringList& deviceNames)
+{
+    deviceNames.clear();
+    for (int i = 0; i < kDeviceCount; i++) {
+        deviceNames << QString("Simulated Camera %1").arg(i);
+    }
+    return true;
+}
+
+bool SimulatedCameraBackend::open(int index)
+{
+    if (index < 0 || index >= kDeviceCount) return false;
+    close();
+
+    if (!m_imagePath.isEmpty()) {
+        m_image = cv::imread(m_imagePath.toStdString(), cv::IMREAD_GRAYSCALE);
+        if (m_image.empty()) {
+            qWarning("Simulated camera: could not load %s, using a synthetic part image.", m_imagePath.toStdString().c_str());
+        }
+    }
+    if (m_image.empty()) {
+        m_image = makeSyntheticPart();
+    }
+    m_clock.start();
+    m_frameNum = 0;
+    m_roi = cv::Rect(0, 0, m_image.cols, m_image.rows);
+    m_binning = 1;
+    return true;
+}
+
+void SimulatedCameraBackend::close()
+{
+    stopGrabbing();
+    m_image.release();
+}
+
+bool SimulatedCameraBackend::setTriggerMode(bool softwareTrigger)
+{
+    QMutexLocker locker(&m_mutex);
+    m_triggerMode = softwareTrigger;
+    return true;
+}
+
+bool SimulatedCameraBackend::startGrabbing()
+{
+    if (!isOpen()) return false;
+    {
+        QMutexLocker locker(&m_mutex);
+        if (m_grabbing) return true;
+        m_grabbing = true;
+        m_pendingTriggers = 0;
+        m_triggerIndex = 0;
+    }
+    m_grabThread = std::thread(&SimulatedCameraBackend::grabLoop, this);
+    return true;
+}
+
+bool SimulatedCameraBackend::stopGrabbing()
+{
+    {
+        QMutexLocker locker(&m_mutex);
+        m_grabbing = false;
+        m_pendingTriggers = 0;
+    }
+    m_wakeUp.wakeAll();
+    if (m_grabThread.joinable()) {
+        m_grabThread.join();
+    }
+    return true;
+}
+
+bool SimulatedCameraBackend::fireSoftwareTrigger()
+{
+    {
+        QMutexLocker locker(&m_mutex);
+        // 与真实相机一样：没有布防 (软触发模式 + 正在采集) 时触发无效
+        if (!m_grabbing || !m_triggerMode) return false;
+        ++m_pendingTriggers;
+    }
+    m_wakeUp.wakeAll();
+    return true;
+}
+
+bool SimulatedCameraBackend::setExposure(double microseconds)
+{
+    if (microseconds <= 0.0) return false;
+    QMutexLocker locker(&m_mutex);
+    m_exposureUs = microseconds;
+    return true;
+}
+
+bool SimulatedCameraBackend::setGain(double db)
+{
+    Q_UNUSED(db); // 模拟相机不改变图像亮度
+    return isOpen();
+}
+
+bool SimulatedCameraBackend::setRoi(cv::Rect& roi)
+{
+    if (!isOpen()) return false;
+    const cv::Rect full(0, 0, m_image.cols, m_image.rows);
+    cv::Rect aligned = roi.area() > 0 ? (roi & full) : full;
+
+    // 与真实相机一样按步长对齐：偏移向下取整，宽高向上取整 (不超过传感器)
+    const int x = aligned.x / kRoiAlignment * kRoiAlignment;
+    const int y = aligned.y / kRoiAlignment * kRoiAlignment;
+    const int right = std::min(full.width, (aligned.x + aligned.width + kRoiAlignment - 1) / kRoiAlignment * kRoiAlignment);
+    const int bottom = std::min(full.height, (aligned.y + aligned.height + kRoiAlignment - 1) / kRoiAlignment * kRoiAlignment);
+    aligned = cv::Rect(x, y, right - x, bottom - y);
+
+    QMutexLocker locker(&m_mutex);
+    m_roi = aligned;
+    roi = aligned;
+    return true;
+}
+
+bool SimulatedCameraBackend::setBinning(int factor)
+{
+    if (factor != 1 && factor != 2 && factor != 4) return false;
+    QMutexLocker locker(&m_mutex);
+    m_binning = factor;
+    return true;
+}
+
+// --- 采集线程 ---
+void SimulatedCameraBackend::grabLoop()
+{
+    while (true)
+    {
+        // 1. 等待出图的时机：连续模式按帧率，触发模式等待触发
+        unsigned long delayUs = 0;
+        cv::Rect roi;
+        int binning = 1;
+        quint32 triggerIndex = 0;
+        {
+            QMutexLocker locker(&m_mutex);
+            while (m_grabbing && m_triggerMode && m_pendingTriggers == 0) {
+                m_wakeUp.wait(&m_mutex);
+            }
+            if (!m_grabbing) return;
+
+            // 读出时间与传输的像素数成正比：ROI 越小、合并越多，帧率越高
+            roi = m_roi;
+            binning = m_binning;
+            const double pixelRatio = static_cast<double>(roi.area()) / (m_image.total() * binning * binning);
+            const unsigned long readoutUs = static_cast<unsigned long>(kReadoutUs * pixelRatio);
+            if (m_triggerMode) {
+                --m_pendingTriggers;
+                triggerIndex = ++m_triggerIndex; // 模拟相机按顺序响应触发，不会丢帧
+                delayUs = static_cast<unsigned long>(m_exposureUs) + readoutUs;
+            } else {
+                delayUs = std::max(static_cast<unsigned long>(m_exposureUs) + readoutUs,
+                                   static_cast<unsigned long>(1000000.0 / kContinuousFps * pixelRatio));
+            }
+
+            // 2. 模拟曝光和读出。新的触发也会唤醒等待，所以要循环等到时间真正到达；停止采集时立即退出
+            QElapsedTimer exposure;
+            exposure.start();
+            qint64 remainingMs = static_cast<qint64>(delayUs / 1000);
+            while (m_grabbing && remainingMs > 0) {
+                m_wakeUp.wait(&m_mutex, static_cast<unsigned long>(remainingMs));
+                remainingMs = static_cast<qint64>(delayUs / 1000) - exposure.elapsed();
+            }
+            if (!m_grabbing) return;
+        }
+
+        // 3. 在锁外送出图像 (回调可能较慢，不能阻塞命令线程的触发调用)
+        CameraFrameInfo info;
+        info.frameNum = ++m_frameNum;
+        info.triggerIndex = triggerIndex;
+        info.deviceTimestamp = static_cast<quint64>(m_clock.nsecsElapsed() / 1000);
+        info.hostTimestampMs = QDateTime::currentMSecsSinceEpoch();
+        info.offsetX = roi.x;
+        info.offsetY = roi.y;
+        info.binning = binning;
+        if (binning == 1) {
+            deliverFrame(m_image(roi), info); // ROI 只是原图的一个视图，不拷贝
+        } else {
+            cv::Mat binned;
+            cv::resize(m_image(roi), binned, cv::Size(roi.width / binning, roi.height / binning), 0, 0, cv::INTER_AREA);
+            deliverFrame(binned, info);
+        }
+    }
+}
+
+// --- 合成零件图 ---
+cv::Mat SimulatedCameraBackend::makeSyntheticPart(int width, int height)
+{
+    cv::Mat image(height, width, CV_8UC1, cv::Scalar(30)); // 深色背景
+
+    // 亮色零件：稍微旋转的矩形，内部两个圆孔
+    const cv::RotatedRect body(cv::Point2f(width * 0.5f, height * 0.5f), cv::Size2f(width * 0.55f, height * 0.35f), 8.0f);
+    cv::Point2f corners[4];
+    body.points(corners);
+    std::vector<cv::Point> polygon(corners, corners + 4);
+    cv::fillConvexPoly(image, polygon, cv::Scalar(220), cv::LINE_AA);
+
+    const int radius = height / 20;
+    cv::circle(image, cv::Point(static_cast<int>(width * 0.38), static_cast<int>(height * 0.47)), radius, cv::Scalar(30), cv::FILLED, cv::LINE_AA);
+    cv::circle(image, cv::Point(static_cast<int>(width * 0.62), static_cast<int>(height * 0.53)), radius, cv::Scalar(30), cv::FILLED, cv::LINE_AA);
+    return image;
+}
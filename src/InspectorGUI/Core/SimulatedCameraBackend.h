@@ -0,0 +1,80 @@
+// src/InspectorGUI/Core/SimulatedCameraBackend.h
+
+#ifndef SIMULATEDCAMERABACKEND_H
+#define SIMULATEDCAMERABACKEND_H
+
+#include "CameraBackend.h"
+#include <QMutex>
+#include <QWaitCondition>
+#include <QElapsedTimer>
+#include <QString>
+#include <thread>
+
+/**
+ * @class SimulatedCameraBackend
+ * @brief 模拟相机：不需要硬件，用一张图片 (或程序生成的零件图) 代替相机输出。
+ *
+ * @details 行为尽量贴近真实相机，方便在没有相机的机器上调试触发流程和测量耗时：
+ *  - 连续模式下按固定帧率出图；
+ *  - 软触发模式下，每次触发在“曝光时间 + 读出时间”之后出一帧；
+ *  - 帧号逐帧递增，图像在独立的采集线程中送出 (与SDK回调线程的行为一致)；
+ *  - 支持ROI (宽度和偏移按 kRoiAlignment 对齐，与常见工业相机的步长一致) 和像素合并。
+ *
+ * 设置环境变量 PARTINSPECTOR_SIMULATED_CAMERA 即可让 CameraManager 使用本后端：
+ * 值为图片路径时使用该图片，否则使用程序生成的零件图。
+ * 设备列表中有 kDeviceCount 台相机 (都输出同一张图)，多相机工位按默认的设备序号也能全部连接。
+ */
+class SimulatedCameraBackend : public CameraBackend
+{
+public:
+    static constexpr int kContinuousFps = 30;    // 整幅连续采集的帧率 (ROI 越小帧率越高)
+    static constexpr int kReadoutUs = 5000;      // 模拟传感器读出 + 传输时间 (整幅)
+    static constexpr int kRoiAlignment = 8;      // ROI 的宽度和偏移必须是它的整数倍
+    static constexpr int kDeviceCount = 8;       // 模拟的设备数，与多相机工位的最大相机数相同
+
+    explicit SimulatedCameraBackend(const QString& imagePath = QString());
+    ~SimulatedCameraBackend() override;
+
+    const char* name() const override { return "Simulated"; }
+    bool enumerateDevices(QStringList& deviceNames) override;
+    bool open(int index) override;
+    void close() override;
+    bool isOpen() const override { return !m_image.empty(); }
+    bool setTriggerMode(bool softwareTrigger) override;
+    bool startGrabbing() override;
+    bool stopGrabbing() override;
+    bool fireSoftwareTrigger() override;
+    bool setExposure(double microseconds) override;
+    bool setGain(double db) override;
+    cv::Size sensorSize() const override { return m_image.size(); }
+    bool setRoi(cv::Rect& roi) override;
+    bool setBinning(int factor) override;
+
+    /**
+     * @brief 生成一张合成的零件图 (外形为旋转的矩形，内部有两个圆孔)，用于没有提供图片时。
+     */
+    static cv::Mat makeSyntheticPart(int width = 1280, int height = 1024);
+
+private:
+    void grabLoop(); // 采集线程
+
+    QString m_imagePath;    // 构造时指定的图片路径 (可以为空)
+    cv::Mat m_image;        // 每一帧输出的图像 (open 之后有效，采集期间只读)
+    QElapsedTimer m_clock;  // 设备时间戳的时钟
+
+    // --- 以下成员由 m_mutex 保护，命令线程和采集线程都会访问 ---
+    QMutex m_mutex;
+    QWaitCondition m_wakeUp;
+    bool m_triggerMode = false;
+    bool m_grabbing = false;
+    int m_pendingTriggers = 0;     // 已触发、还没有出图的次数
+    quint32 m_triggerIndex = 0;    // 触发计数 (与真实相机一样从1开始，每次开始采集时重置)
+    double m_exposureUs = 10000.0;
+    cv::Rect m_roi;                // 传感器像素坐标，open 时为整幅
+    int m_binning = 1;
+    quint32 m_frameNum = 0;
+
+    std::thread m_grabThread;
+};
+
+#endif // SIMULATEDCAMERABACKEND_H
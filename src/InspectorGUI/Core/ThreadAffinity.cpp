@@ -0,0 +1,78 @@
+// src/InspectorGUI/Core/ThreadAffinity.cpp
+
+#include "ThreadAffinity.h"
+#include <QStringList>
+#include <QThread>
+#include <QDebug>
+
+#if defined(Q_OS_WIN)
+#include <windows.h>
+#elif defined(Q_OS_LINUX)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace ThreadAffinity
+{
+
+bool pinCurrentThread(int core)
+{
+    if (core < 0) return true;
+    if (core >= coreCount()) {
+        qWarning("Cannot pin thread to core %d: only %d cores available.", core, coreCount());
+        return false;
+    }
+
+#if defined(Q_OS_WIN)
+    const DWORD_PTR mask = static_cast<DWORD_PTR>(1) << core;
+    if (SetThreadAffinityMask(GetCurrentThread(), mask) == 0) {
+        qWarning("SetThreadAffinityMask(core %d) failed. Error: %lu", core, GetLastError());
+        return false;
+    }
+    return true;
+#elif defined(Q_OS_LINUX)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(core, &set);
+    const int err = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+    if (err != 0) {
+        qWarning("pthread_setaffinity_np(core %d) failed. Error: %d", core, err);
+        return false;
+    }
+    return true;
+#else
+    // 其他平台 (例如 macOS) 不支持硬绑核，线程照常运行
+    return false;
+#endif
+}
+
+QVector<int> parseCoreList(const QString& text)
+{
+    QVector<int> cores;
+    const QStringList parts = text.split(',', Qt::SkipEmptyParts);
+    for (const QString& rawPart : parts)
+    {
+        const QString part = rawPart.trimmed();
+        const int dash = part.indexOf('-');
+        bool ok1 = false, ok2 = false;
+        if (dash > 0) {
+            // 区间，例如 "4-7"
+            const int first = part.left(dash).toInt(&ok1);
+            const int last = part.mid(dash + 1).toInt(&ok2);
+            if (ok1 && ok2) {
+                for (int core = first; core <= last; ++core) cores.append(core);
+            }
+        } else {
+            const int core = part.toInt(&ok1);
+            if (ok1) cores.append(core);
+        }
+    }
+    return cores;
+}
+
+int coreCount()
+{
+    return QThread::idealThreadCount();
+}
+
+} // namespace ThreadAffinity
@@ -0,0 +1,36 @@
+// src/InspectorGUI/Core/ThreadAffinity.h
+
+#ifndef THREADAFFINITY_H
+#define THREADAFFINITY_H
+
+#include <QString>
+#include <QVector>
+
+/**
+ * @brief 线程绑核的辅助函数。
+ *
+ * @details 多相机工位中，每台相机的测量线程绑定到固定的CPU核心上：
+ * 避免操作系统把线程在核心之间来回迁移 (迁移后缓存全部失效)，
+ * 也避免几台相机的测量线程挤在同一个核心上互相抢占，让每台相机的耗时都稳定可预期。
+ */
+namespace ThreadAffinity
+{
+    /**
+     * @brief 把调用这个函数的线程绑定到指定核心。
+     * @param core 核心编号 (从0开始)。小于0表示不绑定，直接返回 true。
+     * @return 成功返回 true；核心编号无效或系统调用失败返回 false (线程仍然可以正常运行)。
+     */
+    bool pinCurrentThread(int core);
+
+    /**
+     * @brief 解析核心列表，例如 "2,3" 或 "4-7"。无法解析的部分被忽略。
+     */
+    QVector<int> parseCoreList(const QString& text);
+
+    /**
+     * @brief 本机的逻辑核心数。
+     */
+    int coreCount();
+}
+
+#endif // THREADAFFINITY_H
@@ -0,0 +1,129 @@
+// src/InspectorGUI/Core/TraceRecorder.cpp
+
+#include "TraceRecorder.h"
+#include <QMutexLocker>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMap>
+
+// --- 初始化静态成员变量 ---
+TraceRecorder* TraceRecorder::m_instance = nullptr;
+
+TraceRecorder::TraceRecorder(QObject *parent)
+    : QObject(parent)
+    , m_ring(4096) // 默认保存最近4096条追踪，足够覆盖连续采集时的最近几十秒
+{
+    qRegisterMetaType<FrameTrace>("FrameTrace");
+}
+
+// 获取单例实例的函数 (与 LogManager 一样使用双重检查锁定)
+TraceRecorder* TraceRecorder::Instance()
+{
+    if (m_instance == nullptr)
+    {
+        static QMutex mutex;
+        QMutexLocker locker(&mutex);
+        if (m_instance == nullptr)
+        {
+            m_instance = new TraceRecorder();
+        }
+    }
+    return m_instance;
+}
+
+void TraceRecorder::record(const FrameTrace& trace)
+{
+    if (trace.spans.empty()) return;
+
+    QMutexLocker locker(&m_mutex);
+    m_ring[m_next] = trace;
+    m_next = (m_next + 1) % m_ring.size();
+    if (m_count < m_ring.size()) ++m_count;
+}
+
+void TraceRecorder::setCapacity(int capacity)
+{
+    QMutexLocker locker(&m_mutex);
+    m_ring.assign(static_cast<size_t>(capacity > 0 ? capacity : 1), FrameTrace());
+    m_next = 0;
+    m_count = 0;
+}
+
+bool TraceRecorder::exportChromeTrace(const QString& filePath) const
+{
+    // 1. 在锁内按时间顺序复制出所有追踪，尽快释放锁，不阻塞流水线
+    std::vector<FrameTrace> traces;
+    {
+        QMutexLocker locker(&m_mutex);
+        traces.reserve(m_count);
+        const size_t first = (m_next + m_ring.size() - m_count) % m_ring.size();
+        for (size_t i = 0; i < m_count; ++i) {
+            traces.push_back(m_ring[(first + i) % m_ring.size()]);
+        }
+    }
+
+    // 2. 构建 Chrome Trace Event 格式的事件列表
+    //    每个区间是一个 "X" (完整区间) 事件，时间单位为微秒；每条泳道对应一个 tid。
+    QJsonArray events;
+    QMap<QString, int> laneIds;
+    for (const FrameTrace& trace : traces)
+    {
+        for (const TraceSpan& span : trace.spans)
+        {
+            const QString lane = QString::fromLatin1(span.lane);
+            if (!laneIds.contains(lane)) {
+                laneIds.insert(lane, laneIds.size() + 1);
+            }
+
+            QJsonObject args;
+            args["frameId"] = static_cast<qint64>(trace.frameId);
+            args["deviceTimestamp"] = static_cast<qint64>(trace.deviceTimestamp);
+            args["hostTimestampMs"] = trace.hostTimestampMs;
+            if (trace.receiveNs != 0) {
+                // 距离收到这一帧已经过去了多久，便于直接读出端到端延迟
+                args["sinceReceiveUs"] = (span.endNs - trace.receiveNs) / 1000.0;
+            }
+
+            QJsonObject event;
+            event["name"] = QString::fromLatin1(span.name);
+            event["cat"] = lane;
+            event["ph"] = "X";
+            event["ts"] = span.beginNs / 1000.0;
+            event["dur"] = (span.endNs - span.beginNs) / 1000.0;
+            event["pid"] = 1;
+            event["tid"] = laneIds.value(lane);
+            event["args"] = args;
+            events.append(event);
+        }
+    }
+
+    // 3. 为每条泳道添加名称元数据，让查看器显示 "Camera"、"Inspector" 等名字而不是数字
+    for (auto it = laneIds.constBegin(); it != laneIds.constEnd(); ++it)
+    {
+        QJsonObject args;
+        args["name"] = it.key();
+        QJsonObject meta;
+        meta["name"] = "thread_name";
+        meta["ph"] = "M";
+        meta["pid"] = 1;
+        meta["tid"] = it.value();
+        meta["args"] = args;
+        events.append(meta);
+    }
+
+    QJsonObject root;
+    root["traceEvents"] = events;
+    root["displayTimeUnit"] = "ms";
+
+    // 4. 写入文件
+    QFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qWarning("TraceRecorder: cannot write trace file %s", qPrintable(filePath));
+        return false;
+    }
+    file.write(QJsonDocument(root).toJson(QJsonDocument::Compact));
+    qInfo("Exported %d frame traces to %s", static_cast<int>(traces.size()), qPrintable(filePath));
+    return true;
+}
@@ -0,0 +1,61 @@
+// src/InspectorGUI/Core/TraceRecorder.h
+
+#ifndef TRACERECORDER_H
+#define TRACERECORDER_H
+
+#include <QObject>
+#include <QMutex>
+#include <QString>
+#include <vector>
+#include "FrameTrace.h"
+
+/**
+ * @class TraceRecorder
+ * @brief 一个采用单例模式设计的全局帧追踪记录器。
+ *
+ * @details 它在一个固定容量的环形缓冲区中保存最近的若干条 FrameTrace，
+ * 程序运行期间随时可以调用 exportChromeTrace() 把它们导出为 Chrome Trace Event 格式的 JSON 文件，
+ * 用 chrome://tracing 或 https://ui.perfetto.dev 打开即可看到每一帧在各阶段的时间线。
+ * record() 可以从任意线程调用。
+ */
+class TraceRecorder : public QObject
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @brief 获取 TraceRecorder 的全局唯一实例 (线程安全的懒汉式加载)。
+     */
+    static TraceRecorder* Instance();
+
+    /**
+     * @brief 保存一条帧追踪。缓冲区已满时覆盖最旧的一条。
+     */
+    void record(const FrameTrace& trace);
+
+    /**
+     * @brief 把缓冲区中的全部追踪导出为 Chrome/Perfetto 可以打开的 JSON 文件。
+     * @param filePath 输出文件路径。
+     * @return 成功写入返回 true。
+     */
+    bool exportChromeTrace(const QString& filePath) const;
+
+    /**
+     * @brief 设置环形缓冲区容量 (会清空已有的追踪)。
+     */
+    void setCapacity(int capacity);
+
+private:
+    explicit TraceRecorder(QObject *parent = nullptr);
+    TraceRecorder(const TraceRecorder&) = delete;
+    TraceRecorder& operator=(const TraceRecorder&) = delete;
+
+    static TraceRecorder* m_instance;
+
+    mutable QMutex m_mutex;           // 保护环形缓冲区
+    std::vector<FrameTrace> m_ring;   // 环形缓冲区
+    size_t m_next = 0;                // 下一条追踪写入的位置
+    size_t m_count = 0;               // 当前保存的追踪条数
+};
+
+#endif // TRACERECORDER_H
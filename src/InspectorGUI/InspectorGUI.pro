@@ -1,4 +1,4 @@
-QT       += core gui
+QT       += core gui network
 
 greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
 DEFINES += QT_DEPRECATED_WARNINGS
@@ -13,21 +13,45 @@ CONFIG += c++17
 
 HEADERS  += \
     Core/CameraManager.h \
+    Core/CameraBackend.h \
+    Core/HikCameraBackend.h \
+    Core/SimulatedCameraBackend.h \
+    Core/RoiController.h \
+    Core/FlatFieldCapture.h \
     Widgets/ControlPanel/CameraPanel.h \
     Widgets/ControlPanel/InspectPanel.h \
     mainwindow.h \
     # 核心逻辑
     Core/InspectorThread.h \
     Core/LogManager.h \
+    Core/BinaryLogFormat.h \
+    Core/BinaryLogSink.h \
     Core/ImageConverter.h \
+    Core/FrameTrace.h \
+    Core/TraceRecorder.h \
+    Core/FramePool.h \
+    Core/MetricsServer.h \
+    Core/ThreadAffinity.h \
+    Core/InspectionWorker.h \
+    Core/ResultJoiner.h \
+    Core/CameraStation.h \
     # 自定义控件
     Widgets/ViewWidget/ImageView.h \
     Widgets/ViewWidget/CustomGraphicView.h \
     Widgets/ViewWidget/CustomImageItem.h \
-    Widgets/LogWidget/LogWidget.h
+    Widgets/ViewWidget/MosaicView.h \
+    Widgets/LogWidget/LogWidget.h \
+    Widgets/LogWidget/LogModel.h \
+    Widgets/LogWidget/LogSearchIndex.h \
+    Widgets/StatsWidget/LatencyStatsDialog.h \
+    Widgets/StationWidget/StationWindow.h
 
 SOURCES  += \
     Core/CameraManager.cpp \
+    Core/HikCameraBackend.cpp \
+    Core/SimulatedCameraBackend.cpp \
+    Core/RoiController.cpp \
+    Core/FlatFieldCapture.cpp \
     Widgets/ControlPanel/CameraPanel.cpp \
     Widgets/ControlPanel/InspectPanel.cpp \
     main.cpp \
@@ -35,11 +59,24 @@ SOURCES  += \
     # 核心逻辑
     Core/InspectorThread.cpp \
     Core/LogManager.cpp \
+    Core/BinaryLogSink.cpp \
+    Core/TraceRecorder.cpp \
+    Core/FramePool.cpp \
+    Core/MetricsServer.cpp \
+    Core/ThreadAffinity.cpp \
+    Core/InspectionWorker.cpp \
+    Core/ResultJoiner.cpp \
+    Core/CameraStation.cpp \
     # 自定义控件
     Widgets/ViewWidget/ImageView.cpp \
     Widgets/ViewWidget/CustomGraphicView.cpp \
     Widgets/ViewWidget/CustomImageItem.cpp \
-    Widgets/LogWidget/LogWidget.cpp
+    Widgets/ViewWidget/MosaicView.cpp \
+    Widgets/LogWidget/LogWidget.cpp \
+    Widgets/LogWidget/LogModel.cpp \
+    Widgets/LogWidget/LogSearchIndex.cpp \
+    Widgets/StatsWidget/LatencyStatsDialog.cpp \
+    Widgets/StationWidget/StationWindow.cpp
 
 # --- 4. 【关键】链接外部库 (OpenCV) ---
 # 解释: 我们的GUI程序本身虽然不直接运行算法，但它内部的线程(我们稍后创建)
@@ -46,6 +46,16 @@ void InspectPanel::clearResults()
     }
 }
 
+// Feret 尺寸的一行 (零件和每个内孔共用)
+static void appendFeret(QTextStream& stream, const InspectorLib::FeretResult& feret)
+{
+    stream << "\t- Feret: max " << feret.maxDiameter << " @ " << feret.maxAngle << " deg, min "
+           << feret.minDiameter << " @ " << feret.minAngle << " deg";
+    if (feret.maxInscribed > 0.0f) stream << ", inscribed " << feret.maxInscribed;
+    for (float width : feret.widths) stream << ", " << width;
+    stream << "\n";
+}
+
 // --- 公共槽函数实现 ---
 void InspectPanel::displayResults(const InspectorLib::MeasurementResults& results)
 {
@@ -63,10 +73,21 @@ void InspectPanel::displayResults(const InspectorLib::MeasurementResults& result
     // 3. 格式化并逐一写入每一项测量数据
     stream << "===== Inspection Results =====\n\n";
 
+    // 有形状模型时，先列出模板匹配的位姿
+    if (results.pose.found)
+    {
+        stream << "[Part Pose]:\n";
+        stream << "\t- Position: (" << results.pose.position.x << ", " << results.pose.position.y << ")\n";
+        stream << "\t- Angle: " << results.pose.angle << " deg\n";
+        stream << "\t- Score: " << results.pose.score << "\n\n";
+    }
+
     stream << "[Outer Bounding Box]:\n";
     stream << "\t- Center: (" << results.boundingBox.center.x << ", " << results.boundingBox.center.y << ")\n";
     stream << "\t- Size: " << results.boundingBox.size.width << " x " << results.boundingBox.size.height << "\n";
-    stream << "\t- Angle: " << results.boundingBox.angle << " deg\n\n";
+    stream << "\t- Angle: " << results.boundingBox.angle << " deg\n";
+    if (results.feret.maxDiameter > 0.0f) appendFeret(stream, results.feret);
+    stream << "\n";
 
     stream << "[Small Circles Found]: " << results.circles.size() << "\n";
     for (size_t i = 0; i < results.circles.size(); ++i)
@@ -74,13 +95,68 @@ void InspectPanel::displayResults(const InspectorLib::MeasurementResults& result
         stream << "  - Circle " << i << ":\n";
         stream << "\t- Center: (" << results.circles[i].center.x << ", " << results.circles[i].center.y << ")\n";
         stream << "\t- Radius: " << results.circles[i].radius << "\n";
+        if (results.circles[i].feret.maxDiameter > 0.0f) appendFeret(stream, results.circles[i].feret);
+    }
+
+    stream << "\n[Slots Found]: " << results.slotResults.size() << "\n";
+    for (size_t i = 0; i < results.slotResults.size(); ++i)
+    {
+        const InspectorLib::SlotResult& slot = results.slotResults[i];
+        stream << "  - Slot " << i << ":\n";
+        stream << "\t- Center: (" << slot.center.x << ", " << slot.center.y << ")\n";
+        stream << "\t- Length: " << slot.length << "\n";
+        stream << "\t- Width: " << slot.width << "\n";
+        stream << "\t- Arc Radii: " << slot.arcRadius[0] << " / " << slot.arcRadius[1] << "\n";
+        stream << "\t- Angle: " << slot.angle << " deg\n";
+        if (slot.feret.maxDiameter > 0.0f) appendFeret(stream, slot.feret);
     }
 
-    stream << "\n[Slot Found]:\n";
-    stream << "\t- Center: (" << results.slot.center.x << ", " << results.slot.center.y << ")\n";
-    stream << "\t- Length: " << results.slot.length << "\n";
-    stream << "\t- Width: " << results.slot.width << " (Arc Radius: " << results.slot.width / 2.0 << ")\n";
-    stream << "\t- Angle: " << results.slot.angle << " deg\n";
+    // 有相机标定时，再列出换算为毫米的结果
+    if (results.metric.valid)
+    {
+        const InspectorLib::MetricResults& metric = results.metric;
+        stream << "\n[Calibrated (mm)]:\n";
+        stream << "\t- Bounding Box: " << metric.boundingBox.size.width << " x " << metric.boundingBox.size.height
+               << " at (" << metric.boundingBox.center.x << ", " << metric.boundingBox.center.y << ")\n";
+        for (size_t i = 0; i < metric.circles.size(); ++i)
+        {
+            stream << "\t- Circle " << i << ": Diameter " << metric.circles[i].radius * 2.0f
+                   << " at (" << metric.circles[i].center.x << ", " << metric.circles[i].center.y << ")\n";
+        }
+        for (size_t i = 0; i < metric.slotResults.size(); ++i)
+        {
+            stream << "\t- Slot " << i << ": " << metric.slotResults[i].length << " x " << metric.slotResults[i].width
+                   << " at (" << metric.slotResults[i].center.x << ", " << metric.slotResults[i].center.y << ")"
+                   << ", arc radii " << metric.slotResults[i].arcRadius[0] << " / " << metric.slotResults[i].arcRadius[1] << "\n";
+        }
+    }
+
+    // 与名义几何比较时，列出偏差和超出公差的各处
+    if (results.deviation.valid)
+    {
+        const InspectorLib::DeviationResult& deviation = results.deviation;
+        stream << "\n[Nominal Deviation (mm)]:\n";
+        stream << "\t- Max: " << deviation.maxDeviation << " (excess " << deviation.maxExcess
+               << ", missing " << deviation.maxMissing << ")\n";
+        stream << "\t- RMS: " << deviation.rms << " over " << deviation.pointCount << " points\n";
+        for (size_t i = 0; i < deviation.defects.size(); ++i)
+        {
+            const InspectorLib::DeviationDefect& defect = deviation.defects[i];
+            stream << "\t- " << (defect.excess ? "Excess " : "Missing ") << i << ": depth " << defect.depth
+                   << ", length " << defect.length << " on feature " << defect.feature
+                   << " at (" << defect.position.x << ", " << defect.position.y << ")\n";
+        }
+    }
+
+    // 与金板比较时，列出边缘的 chamfer 距离
+    if (results.golden.valid)
+    {
+        const InspectorLib::GoldenResult& golden = results.golden;
+        stream << "\n[Golden Part (px)]:\n";
+        stream << "\t- Mean distance: " << golden.meanDistance << ", max " << golden.maxDistance
+               << " at (" << golden.worstPoint.x << ", " << golden.worstPoint.y << ")\n";
+        stream << "\t- Outliers: " << golden.outlierRatio * 100.0f << "% of " << golden.edgeCount << " edge pixels\n";
+    }
 
     // 4. 将最终构建好的完整字符串，一次性设置到文本框中。
     m_resultsText->setText(resultString);
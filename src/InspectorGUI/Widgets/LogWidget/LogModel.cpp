@@ -0,0 +1,231 @@
+// src/InspectorGUI/Widgets/LogWidget/LogModel.cpp
+
+#include "LogModel.h"
+
+#include <QTimer>
+#include <QColor>
+#include <algorithm>
+
+// --- 构造函数 ---
+LogModel::LogModel(int capacity, QObject *parent)
+    : QAbstractListModel(parent)
+    , m_ring(static_cast<size_t>(capacity > 0 ? capacity : 1))
+{
+    // 批量提交定时器：日志洪峰时每50毫秒最多刷新一次视图
+    m_commitTimer = new QTimer(this);
+    m_commitTimer->setSingleShot(true);
+    m_commitTimer->setInterval(50);
+    connect(m_commitTimer, &QTimer::timeout, this, &LogModel::commitPending);
+}
+
+// --- 析构函数 ---
+LogModel::~LogModel()
+{
+}
+
+// --- QAbstractListModel 接口实现 ---
+
+int LogModel::rowCount(const QModelIndex& parent) const
+{
+    // 列表模型没有子项，只有根节点才有行
+    if (parent.isValid()) return 0;
+    return static_cast<int>(m_visible.size());
+}
+
+QVariant LogModel::data(const QModelIndex& index, int role) const
+{
+    if (!index.isValid() || index.row() < 0 || index.row() >= static_cast<int>(m_visible.size())) {
+        return QVariant();
+    }
+
+    const LogRecord& record = recordAt(m_visible[static_cast<size_t>(index.row())]);
+    switch (role)
+    {
+    case Qt::DisplayRole:
+        // 【关键】只有视图真正要绘制这一行时，才把记录格式化为文本
+        return record.formatted();
+    case Qt::ForegroundRole:
+        // 根据消息级别改变文本颜色，让警告和错误一眼可见 (颜色取自 ModernDark.qss 的配色)
+        switch (record.level) {
+        case QtWarningMsg:  return QColor(0xEB, 0xCB, 0x8B);
+        case QtCriticalMsg:
+        case QtFatalMsg:    return QColor(0xBF, 0x61, 0x6A);
+        case QtDebugMsg:    return QColor(0x7B, 0x88, 0xA1);
+        default:            return QVariant(); // 使用样式表中的默认颜色
+        }
+    default:
+        return QVariant();
+    }
+}
+
+// --- 公共接口函数实现 ---
+
+void LogModel::appendRecord(const LogRecord& record)
+{
+    m_pending.append(record);
+    if (!m_commitTimer->isActive()) {
+        m_commitTimer->start();
+    }
+}
+
+void LogModel::clear()
+{
+    beginResetModel();
+    m_pending.clear();
+    m_visible.clear();
+    m_searchIndex.clear();
+    m_firstSeq = m_nextSeq; // 序号继续递增，不回绕，旧序号自然全部失效
+    endResetModel();
+}
+
+void LogModel::setMinimumSeverity(int severity)
+{
+    if (severity == m_minimumSeverity) return;
+    m_minimumSeverity = severity;
+    rebuildVisible();
+}
+
+void LogModel::setThreadFilter(quint32 threadId)
+{
+    if (threadId == m_threadFilter) return;
+    m_threadFilter = threadId;
+    rebuildVisible();
+}
+
+void LogModel::setSearchText(const QString& text)
+{
+    if (text == m_searchText) return;
+
+    const bool refines = !m_searchText.isEmpty() && text.contains(m_searchText, Qt::CaseInsensitive);
+    m_searchText = text;
+
+    if (!refines) {
+        rebuildVisible();
+        return;
+    }
+
+    // 增量搜索：新关键字包含旧关键字，结果一定是当前结果的子集，只需在当前行中继续筛选
+    beginResetModel();
+    m_visible.erase(std::remove_if(m_visible.begin(), m_visible.end(), [this](quint64 seq) {
+        return !matchesSearch(recordAt(seq));
+    }), m_visible.end());
+    endResetModel();
+}
+
+int LogModel::totalCount() const
+{
+    return static_cast<int>(m_nextSeq - m_firstSeq);
+}
+
+// --- 私有槽函数：批量提交 ---
+void LogModel::commitPending()
+{
+    if (m_pending.isEmpty()) return;
+
+    const quint64 capacity = m_ring.size();
+    QList<LogRecord> batch;
+    batch.swap(m_pending);
+
+    // 如果一批日志比整个缓冲区还多，只保留最后 capacity 条
+    int skip = 0;
+    if (static_cast<quint64>(batch.size()) > capacity) {
+        skip = batch.size() - static_cast<int>(capacity);
+        m_nextSeq += static_cast<quint64>(skip);
+    }
+
+    // a. 先计算淘汰：写入这批日志后，最旧的有效序号变为多少。
+    //    在覆盖环形缓冲区之前先把对应的行从视图中移除，保证视图永远不会读到被覆盖的数据。
+    const quint64 newNextSeq = m_nextSeq + static_cast<quint64>(batch.size() - skip);
+    const quint64 newFirstSeq = std::max(m_firstSeq, newNextSeq > capacity ? newNextSeq - capacity : 0);
+
+    size_t evictedRows = 0;
+    while (evictedRows < m_visible.size() && m_visible[evictedRows] < newFirstSeq) {
+        ++evictedRows;
+    }
+    if (evictedRows > 0) {
+        beginRemoveRows(QModelIndex(), 0, static_cast<int>(evictedRows) - 1);
+        m_visible.erase(m_visible.begin(), m_visible.begin() + static_cast<std::ptrdiff_t>(evictedRows));
+        endRemoveRows();
+    }
+    m_firstSeq = newFirstSeq;
+    m_searchIndex.evictBefore(m_firstSeq);
+
+    // b. 写入环形缓冲区并更新搜索索引，同时收集通过过滤条件的新行
+    std::vector<quint64> newRows;
+    for (int i = skip; i < batch.size(); ++i)
+    {
+        const quint64 seq = m_nextSeq++;
+        LogRecord& slot = m_ring[static_cast<size_t>(seq % capacity)];
+        slot = batch[i];
+
+        m_searchIndex.add(seq, slot.text.toLower().toUtf8().toStdString());
+
+        if (!m_knownThreads.contains(slot.threadId)) {
+            m_knownThreads.insert(slot.threadId);
+            emit threadSeen(slot.threadId);
+        }
+        if (passesFilter(slot) && matchesSearch(slot)) {
+            newRows.push_back(seq);
+        }
+    }
+
+    // c. 一次性通知视图插入了多少行
+    if (!newRows.empty()) {
+        const int first = static_cast<int>(m_visible.size());
+        beginInsertRows(QModelIndex(), first, first + static_cast<int>(newRows.size()) - 1);
+        m_visible.insert(m_visible.end(), newRows.begin(), newRows.end());
+        endInsertRows();
+    }
+}
+
+// --- 私有辅助函数 ---
+
+const LogRecord& LogModel::recordAt(quint64 seq) const
+{
+    return m_ring[static_cast<size_t>(seq % m_ring.size())];
+}
+
+bool LogModel::passesFilter(const LogRecord& record) const
+{
+    if (record.severity() < m_minimumSeverity) return false;
+    if (m_threadFilter != 0 && record.threadId != m_threadFilter) return false;
+    return true;
+}
+
+bool LogModel::matchesSearch(const LogRecord& record) const
+{
+    return m_searchText.isEmpty() || record.text.contains(m_searchText, Qt::CaseInsensitive);
+}
+
+void LogModel::rebuildVisible()
+{
+    beginResetModel();
+    m_visible.clear();
+
+    if (m_searchText.isEmpty())
+    {
+        // 没有搜索关键字：只需按级别和线程过滤
+        for (quint64 seq = m_firstSeq; seq < m_nextSeq; ++seq)
+        {
+            if (passesFilter(recordAt(seq))) m_visible.push_back(seq);
+        }
+    }
+    else
+    {
+        // 有搜索关键字：先用三元组索引找出候选块，只在候选块内做精确的子串比较
+        const quint64 blockSize = m_searchIndex.blockSize();
+        const std::vector<uint64_t> blocks = m_searchIndex.candidateBlocks(m_searchText.toLower().toUtf8().toStdString());
+        for (uint64_t block : blocks)
+        {
+            const quint64 begin = std::max<quint64>(block * blockSize, m_firstSeq);
+            const quint64 end = std::min<quint64>((block + 1) * blockSize, m_nextSeq);
+            for (quint64 seq = begin; seq < end; ++seq)
+            {
+                const LogRecord& record = recordAt(seq);
+                if (passesFilter(record) && matchesSearch(record)) m_visible.push_back(seq);
+            }
+        }
+    }
+
+    endResetModel();
+}
@@ -0,0 +1,117 @@
+// src/InspectorGUI/Widgets/LogWidget/LogModel.h
+
+#ifndef LOGMODEL_H
+#define LOGMODEL_H
+
+#include <QAbstractListModel>
+#include <QList>
+#include <QSet>
+#include <deque>
+#include <vector>
+
+#include "../../Core/LogManager.h" // LogRecord
+#include "LogSearchIndex.h"
+
+class QTimer;
+
+/**
+ * @class LogModel
+ * @brief 为日志视图提供数据的列表模型，底层是一个固定容量的环形缓冲区。
+ *
+ * @details 与直接往 QPlainTextEdit 里追加文本相比，这种“模型/视图”结构有几个关键优势：
+ * 1. 视图 (QListView) 只会为当前可见的几十行调用 data()，无论缓冲区里有多少条日志，滚动都很快。
+ * 2. 日志文本只在需要显示时才被格式化。
+ * 3. 环形缓冲区容量固定，程序连续运行几天也不会无限占用内存，最旧的日志会被自动淘汰。
+ * 4. 支持按级别、线程过滤，以及基于三元组索引 (LogSearchIndex) 的增量子串搜索。
+ *
+ * 每条日志有一个全局递增的序号(seq)，模型的每一行对应一个通过了当前过滤条件的序号。
+ */
+class LogModel : public QAbstractListModel
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @brief 构造函数。
+     * @param capacity 环形缓冲区最多保存的日志条数。
+     * @param parent 父对象指针。
+     */
+    explicit LogModel(int capacity = 200000, QObject *parent = nullptr);
+    ~LogModel();
+
+    // --- QAbstractListModel 接口 ---
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+
+    // --- 公共接口函数 ---
+
+    /**
+     * @brief 追加一条日志。
+     * @details 为了避免日志洪峰时逐条刷新视图，新日志先进入待提交队列，
+     * 由定时器每隔一小段时间批量插入模型。
+     */
+    void appendRecord(const LogRecord& record);
+
+    /**
+     * @brief 清空所有日志和索引。
+     */
+    void clear();
+
+    /**
+     * @brief 只显示严重程度不低于 severity 的日志 (参见 LogRecord::severity())。
+     */
+    void setMinimumSeverity(int severity);
+
+    /**
+     * @brief 只显示某个线程的日志。threadId 为 0 表示不按线程过滤。
+     */
+    void setThreadFilter(quint32 threadId);
+
+    /**
+     * @brief 设置搜索关键字 (不区分大小写的子串匹配)，空字符串表示不搜索。
+     * @details 如果新关键字包含旧关键字（例如用户继续输入），只需在当前结果中继续筛选。
+     */
+    void setSearchText(const QString& text);
+
+    /**
+     * @brief 返回缓冲区中的日志总条数 (不考虑过滤条件)。
+     */
+    int totalCount() const;
+
+signals:
+    /**
+     * @brief 第一次见到某个线程的日志时发出，LogWidget 据此更新线程过滤下拉框。
+     */
+    void threadSeen(quint32 threadId);
+
+private slots:
+    /**
+     * @brief 把待提交队列中的日志批量写入环形缓冲区，并通知视图。
+     */
+    void commitPending();
+
+private:
+    const LogRecord& recordAt(quint64 seq) const;
+    bool passesFilter(const LogRecord& record) const;
+    bool matchesSearch(const LogRecord& record) const;
+    void rebuildVisible();
+
+    // --- 环形缓冲区 ---
+    std::vector<LogRecord> m_ring; // 容量固定，seq 对应的位置是 seq % capacity
+    quint64 m_firstSeq = 0;        // 缓冲区中最旧一条日志的序号
+    quint64 m_nextSeq = 0;         // 下一条日志将使用的序号
+
+    // --- 过滤与搜索 ---
+    std::deque<quint64> m_visible; // 通过过滤条件的日志序号，即模型的各行
+    int m_minimumSeverity = 0;
+    quint32 m_threadFilter = 0;
+    QString m_searchText;
+    LogSearchIndex m_searchIndex;
+    QSet<quint32> m_knownThreads;
+
+    // --- 批量提交 ---
+    QList<LogRecord> m_pending;
+    QTimer* m_commitTimer;
+};
+
+#endif // LOGMODEL_H
@@ -0,0 +1,112 @@
+// src/InspectorGUI/Widgets/LogWidget/LogSearchIndex.cpp
+
+#include "LogSearchIndex.h"
+#include <algorithm>
+
+LogSearchIndex::LogSearchIndex(uint64_t blockSize)
+    : m_blockSize(blockSize == 0 ? 1 : blockSize)
+{
+}
+
+uint32_t LogSearchIndex::trigramKey(const std::string& text, size_t pos)
+{
+    // 把连续3个字节拼成一个24位整数作为键
+    return (static_cast<uint32_t>(static_cast<unsigned char>(text[pos])) << 16) |
+           (static_cast<uint32_t>(static_cast<unsigned char>(text[pos + 1])) << 8) |
+            static_cast<uint32_t>(static_cast<unsigned char>(text[pos + 2]));
+}
+
+void LogSearchIndex::add(uint64_t seq, const std::string& lowerUtf8)
+{
+    const uint64_t block = seq / m_blockSize;
+    if (m_empty) {
+        m_firstBlock = block;
+        m_empty = false;
+    }
+    m_lastBlock = block;
+
+    if (lowerUtf8.size() < 3) return;
+    for (size_t i = 0; i + 2 < lowerUtf8.size(); ++i)
+    {
+        std::vector<uint64_t>& list = m_postings[trigramKey(lowerUtf8, i)];
+        // 同一块内的重复三元组只记录一次；因为 seq 递增，只需和末尾元素比较
+        if (list.empty() || list.back() != block) {
+            list.push_back(block);
+        }
+    }
+}
+
+void LogSearchIndex::evictBefore(uint64_t firstSeq)
+{
+    // 只有整块都已被淘汰时才移除该块（块的后半部分可能仍然有效）
+    const uint64_t firstValidBlock = firstSeq / m_blockSize;
+    if (m_empty || firstValidBlock <= m_firstBlock) return;
+
+    m_evictedSincePrune += firstValidBlock - m_firstBlock;
+    m_firstBlock = firstValidBlock;
+
+    // 清理倒排表需要遍历所有三元组，代价较高，所以攒够一批(约1024块)再做一次。
+    // 在此之前，过期的块号由 candidateBlocks() 过滤掉，不影响结果。
+    if (m_evictedSincePrune < 1024) return;
+    m_evictedSincePrune = 0;
+
+    for (auto it = m_postings.begin(); it != m_postings.end();)
+    {
+        std::vector<uint64_t>& list = it->second;
+        list.erase(list.begin(), std::lower_bound(list.begin(), list.end(), m_firstBlock));
+        if (list.empty()) {
+            it = m_postings.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+std::vector<uint64_t> LogSearchIndex::candidateBlocks(const std::string& lowerQuery) const
+{
+    std::vector<uint64_t> result;
+    if (m_empty) return result;
+
+    // a. 查询串太短，无法使用三元组：返回所有有效块，由调用方逐条扫描
+    if (lowerQuery.size() < 3) {
+        for (uint64_t block = m_firstBlock; block <= m_lastBlock; ++block) {
+            result.push_back(block);
+        }
+        return result;
+    }
+
+    // b. 收集查询串中每个三元组的倒排表；任何一个三元组不存在，则结果必然为空
+    std::vector<const std::vector<uint64_t>*> lists;
+    for (size_t i = 0; i + 2 < lowerQuery.size(); ++i)
+    {
+        auto it = m_postings.find(trigramKey(lowerQuery, i));
+        if (it == m_postings.end()) return result;
+        lists.push_back(&it->second);
+    }
+
+    // c. 从最短的列表开始求交集，中间结果越小，后续的二分查找越少
+    std::sort(lists.begin(), lists.end(), [](const std::vector<uint64_t>* a, const std::vector<uint64_t>* b) {
+        return a->size() < b->size();
+    });
+    lists.erase(std::unique(lists.begin(), lists.end()), lists.end());
+
+    const std::vector<uint64_t>& shortest = *lists.front();
+    for (auto it = std::lower_bound(shortest.begin(), shortest.end(), m_firstBlock); it != shortest.end(); ++it)
+    {
+        bool inAll = true;
+        for (size_t k = 1; k < lists.size() && inAll; ++k) {
+            inAll = std::binary_search(lists[k]->begin(), lists[k]->end(), *it);
+        }
+        if (inAll) result.push_back(*it);
+    }
+    return result;
+}
+
+void LogSearchIndex::clear()
+{
+    m_postings.clear();
+    m_firstBlock = 0;
+    m_lastBlock = 0;
+    m_empty = true;
+    m_evictedSincePrune = 0;
+}
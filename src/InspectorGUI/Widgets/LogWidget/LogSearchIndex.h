@@ -0,0 +1,63 @@
+// src/InspectorGUI/Widgets/LogWidget/LogSearchIndex.h
+
+#ifndef LOGSEARCHINDEX_H
+#define LOGSEARCHINDEX_H
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @class LogSearchIndex
+ * @brief 日志文本的三元组 (trigram) 倒排索引，用于在几十万条日志中快速做子串搜索。
+ *
+ * @details 为了控制内存，索引不是按“单条日志”而是按“日志块”建立的：
+ * 连续 blockSize 条日志组成一个块，每个三元组只记录“它出现在哪些块中”。
+ * 搜索时先对查询串的所有三元组的块列表求交集得到候选块，再由调用方
+ * 在候选块内逐条做精确的子串比较（三元组全部命中并不保证真的包含子串）。
+ *
+ * 日志序号(seq)必须严格递增地加入；旧日志被环形缓冲区淘汰后，调用 evictBefore() 同步清理。
+ * 这个类只依赖标准库，输入的文本应为已经转换为小写的 UTF-8 字节串。
+ */
+class LogSearchIndex
+{
+public:
+    explicit LogSearchIndex(uint64_t blockSize = 64);
+
+    /**
+     * @brief 把一条日志加入索引。
+     * @param seq 日志的全局序号，必须大于之前加入的所有序号。
+     * @param lowerUtf8 小写化后的日志文本 (UTF-8)。
+     */
+    void add(uint64_t seq, const std::string& lowerUtf8);
+
+    /**
+     * @brief 淘汰所有序号小于 firstSeq 的日志所在的整块。
+     */
+    void evictBefore(uint64_t firstSeq);
+
+    /**
+     * @brief 返回“可能”包含查询串的块号列表（升序）。
+     * @details 查询串短于3个字节时无法使用三元组，此时返回全部仍在索引中的块。
+     */
+    std::vector<uint64_t> candidateBlocks(const std::string& lowerQuery) const;
+
+    uint64_t blockSize() const { return m_blockSize; }
+
+    void clear();
+
+private:
+    static uint32_t trigramKey(const std::string& text, size_t pos);
+
+    uint64_t m_blockSize;
+    uint64_t m_firstBlock = 0;     // 仍然有效的第一个块
+    uint64_t m_lastBlock = 0;      // 最后一个写入过的块
+    bool m_empty = true;
+    uint64_t m_evictedSincePrune = 0; // 自上次清理以来被淘汰的块数，攒够一批再统一清理倒排表
+
+    // 三元组 -> 出现过该三元组的块号列表 (升序，无重复)
+    std::unordered_map<uint32_t, std::vector<uint64_t>> m_postings;
+};
+
+#endif // LOGSEARCHINDEX_H
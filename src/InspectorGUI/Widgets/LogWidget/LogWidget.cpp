@@ -1,8 +1,14 @@
 #include "LogWidget.h"
+#include "LogModel.h"
 
 // --- 包含我们需要的Qt控件和布局的头文件 ---
-#include <QPlainTextEdit>
+#include <QListView>
+#include <QScrollBar>
 #include <QPushButton>
+#include <QComboBox>
+#include <QLineEdit>
+#include <QLabel>
+#include <QTimer>
 #include <QVBoxLayout> // 垂直布局
 #include <QHBoxLayout> // 水平布局
 
@@ -21,53 +27,129 @@ LogWidget::~LogWidget()
     // 所以这里不需要手动 delete 任何东西，Qt会自动清理。
 }
 
-// --- 公共槽函数：追加消息 ---
-void LogWidget::appendMessage(const QString& message)
+// --- 公共槽函数：追加日志 ---
+void LogWidget::appendRecord(const LogRecord& record)
 {
-    if (m_logOutput) {
-        // 调用 QPlainTextEdit 的 appendPlainText 方法来在末尾追加一行新文本。
-        m_logOutput->appendPlainText(message);
-    }
+    // 模型会把日志先放入待提交队列，再批量插入，避免每条日志都触发一次重绘
+    m_model->appendRecord(record);
 }
 
 // --- 私有槽函数：响应清空按钮点击 ---
 void LogWidget::onClearButtonClicked()
 {
-    if (m_logOutput) {
-        // 调用 QPlainTextEdit 的 clear 方法来清空所有文本。
-        m_logOutput->clear();
+    m_model->clear();
+    updateCountLabel();
+}
+
+// --- 私有槽函数：过滤条件改变 ---
+void LogWidget::onFilterChanged()
+{
+    m_model->setMinimumSeverity(m_levelComboBox->currentData().toInt());
+    m_model->setThreadFilter(m_threadComboBox->currentData().toUInt());
+    updateCountLabel();
+}
+
+// --- 私有槽函数：发现新线程 ---
+void LogWidget::onThreadSeen(quint32 threadId)
+{
+    m_threadComboBox->addItem(tr("Thread %1").arg(threadId), threadId);
+}
+
+// --- 私有槽函数：新行插入后自动滚动 ---
+void LogWidget::onRowsInserted()
+{
+    if (m_stickToBottom) {
+        m_logView->scrollToBottom();
     }
+    updateCountLabel();
+}
+
+// --- 辅助函数：更新计数标签 ---
+void LogWidget::updateCountLabel()
+{
+    m_countLabel->setText(tr("%1 / %2 lines").arg(m_model->rowCount()).arg(m_model->totalCount()));
 }
 
 // --- 辅助函数：创建和布局UI ---
 void LogWidget::setupUi()
 {
-    // --- 1. 创建控件实例 ---
-    // a. 创建文本显示区域
-    m_logOutput = new QPlainTextEdit(this);
-    m_logOutput->setReadOnly(true); // 设置为只读，用户不能手动编辑日志
+    // --- 1. 创建模型和视图 ---
+    m_model = new LogModel(200000, this);
+
+    m_logView = new QListView(this);
+    m_logView->setModel(m_model);
+    m_logView->setUniformItemSizes(true);   // 【关键】所有行高度相同，视图无需逐行测量，滚动时只处理可见行
+    m_logView->setEditTriggers(QAbstractItemView::NoEditTriggers); // 只读
+    m_logView->setSelectionMode(QAbstractItemView::ExtendedSelection);
+    m_logView->setWordWrap(false);
+
+    // --- 2. 创建过滤和搜索控件 ---
+    // a. 级别过滤：显示“不低于”所选级别的日志，数据为 LogRecord::severity() 的阈值
+    m_levelComboBox = new QComboBox(this);
+    m_levelComboBox->addItem(tr("All Levels"), 0);
+    m_levelComboBox->addItem(tr("Info+"), 1);
+    m_levelComboBox->addItem(tr("Warning+"), 2);
+    m_levelComboBox->addItem(tr("Critical+"), 3);
 
-    // b. 创建清空按钮
+    // b. 线程过滤：数据为线程ID，0 表示全部线程。具体的线程在日志中出现后才会加入列表。
+    m_threadComboBox = new QComboBox(this);
+    m_threadComboBox->addItem(tr("All Threads"), 0u);
+
+    // c. 搜索框：带防抖定时器，用户连续输入时不会每个字符都触发一次搜索
+    m_searchEdit = new QLineEdit(this);
+    m_searchEdit->setPlaceholderText(tr("Search..."));
+    m_searchEdit->setClearButtonEnabled(true);
+    m_searchTimer = new QTimer(this);
+    m_searchTimer->setSingleShot(true);
+    m_searchTimer->setInterval(150);
+
+    // d. 计数标签和清空按钮
+    m_countLabel = new QLabel(this);
     m_clearButton = new QPushButton(QIcon(":/Icons/CLear Log.png"),tr("Clear Log"), this);
 
 
-    // --- 2. 创建布局 ---
-    // a. 将按钮放在一个水平布局中，并让它靠右对齐
+    // --- 3. 创建布局 ---
+    // a. 顶部：过滤和搜索控件放在一个水平布局中
+    QHBoxLayout* filterLayout = new QHBoxLayout();
+    filterLayout->addWidget(m_levelComboBox);
+    filterLayout->addWidget(m_threadComboBox);
+    filterLayout->addWidget(m_searchEdit, 1); // 搜索框占据剩余宽度
+
+    // b. 底部：计数标签靠左，按钮靠右
     QHBoxLayout* buttonLayout = new QHBoxLayout();
+    buttonLayout->addWidget(m_countLabel);
     buttonLayout->addStretch(); // 添加一个“弹簧”，会把右边的控件推到最右边
     buttonLayout->addWidget(m_clearButton);
 
-    // b. 创建一个主垂直布局
+    // c. 创建一个主垂直布局
     QVBoxLayout* mainLayout = new QVBoxLayout(this); // `this` 将布局设置给当前Widget
     mainLayout->setContentsMargins(0, 0, 0, 0); // 设置边距为0
     mainLayout->setSpacing(5); // 设置控件之间的间距为5像素
 
-    // c. 将文本区域和按钮布局添加到主布局中
-    mainLayout->addWidget(m_logOutput);   // 文本区域在上方，会占据大部分空间
-    mainLayout->addLayout(buttonLayout); // 按钮布局在下方
+    // d. 将各部分添加到主布局中
+    mainLayout->addLayout(filterLayout);
+    mainLayout->addWidget(m_logView);    // 日志视图在中间，会占据大部分空间
+    mainLayout->addLayout(buttonLayout);
 
 
-    // --- 3. 连接信号与槽 ---
-    // 将“清空”按钮的 clicked() 信号，连接到我们自己的 onClearButtonClicked() 槽函数上。
+    // --- 4. 连接信号与槽 ---
     connect(m_clearButton, &QPushButton::clicked, this, &LogWidget::onClearButtonClicked);
+    connect(m_levelComboBox, QOverload<int>::of(&QComboBox::currentIndexChanged), this, &LogWidget::onFilterChanged);
+    connect(m_threadComboBox, QOverload<int>::of(&QComboBox::currentIndexChanged), this, &LogWidget::onFilterChanged);
+    connect(m_searchEdit, &QLineEdit::textChanged, m_searchTimer, QOverload<>::of(&QTimer::start));
+    connect(m_searchTimer, &QTimer::timeout, this, [this]() {
+        m_model->setSearchText(m_searchEdit->text());
+        updateCountLabel();
+    });
+    connect(m_model, &LogModel::threadSeen, this, &LogWidget::onThreadSeen);
+
+    // 插入新行之前记录视图是否停留在底部；用户向上翻看历史时，不强行跳回底部
+    connect(m_model, &QAbstractItemModel::rowsAboutToBeInserted, this, [this]() {
+        QScrollBar* bar = m_logView->verticalScrollBar();
+        m_stickToBottom = bar->value() >= bar->maximum();
+    });
+    connect(m_model, &QAbstractItemModel::rowsInserted, this, &LogWidget::onRowsInserted);
+    connect(m_model, &QAbstractItemModel::rowsRemoved, this, &LogWidget::updateCountLabel);
+
+    updateCountLabel();
 }
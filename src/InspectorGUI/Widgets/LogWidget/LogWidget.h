@@ -4,12 +4,24 @@
 #define LOGWIDGET_H
 
 #include <QWidget>
+#include "../../Core/LogManager.h" // LogRecord 作为槽函数参数，需要完整的类型定义
 
 // --- 前向声明 ---
-// 解释: 我们将使用这两个Qt控件的指针。在.h文件中使用前向声明是一种好习惯。
-class QPlainTextEdit;
+// 解释: 我们将使用这些Qt控件的指针。在.h文件中使用前向声明是一种好习惯。
+class QListView;
 class QPushButton;
+class QComboBox;
+class QLineEdit;
+class QLabel;
+class QTimer;
+class LogModel;
 
+/**
+ * @class LogWidget
+ * @brief 日志显示窗口：一个由 LogModel 驱动的虚拟化列表，支持级别/线程过滤和搜索。
+ *
+ * @details 视图只绘制当前可见的行，因此即使缓冲区中有几十万条日志，滚动依然流畅。
+ */
 class LogWidget : public QWidget
 {
     Q_OBJECT // 启用信号与槽机制
@@ -20,11 +32,10 @@ public:
 
 public slots:
     /**
-     * @brief 一个公开的槽函数，用于从外部向日志窗口追加一条新消息。
-     * @param message 要显示的日志文本。
-     * @param level (可选) 可以根据消息级别改变文本颜色。
+     * @brief 一个公开的槽函数，用于从外部向日志窗口追加一条新日志。
+     * @param record 结构化的日志记录，级别决定了文本颜色。
      */
-    void appendMessage(const QString& message);
+    void appendRecord(const LogRecord& record);
 
 private slots:
     /**
@@ -32,15 +43,42 @@ private slots:
      */
     void onClearButtonClicked();
 
+    /**
+     * @brief 级别或线程过滤条件改变时调用。
+     */
+    void onFilterChanged();
+
+    /**
+     * @brief 当模型发现新线程时，把它加入线程过滤下拉框。
+     */
+    void onThreadSeen(quint32 threadId);
+
+    /**
+     * @brief 模型插入新行之后调用：如果用户停留在底部，则自动滚动到最新一行。
+     */
+    void onRowsInserted();
+
 private:
     /**
      * @brief 辅助函数，用于创建和布局所有UI控件。
      */
     void setupUi();
 
+    /**
+     * @brief 更新底部的 “显示条数 / 总条数” 标签。
+     */
+    void updateCountLabel();
+
     // --- 成员变量 ---
-    QPlainTextEdit* m_logOutput; // 用于显示日志的文本区域
-    QPushButton* m_clearButton;  // “清空日志”按钮
+    LogModel* m_model;            // 日志数据模型 (环形缓冲区 + 搜索索引)
+    QListView* m_logView;         // 用于显示日志的虚拟化列表视图
+    QComboBox* m_levelComboBox;   // 级别过滤
+    QComboBox* m_threadComboBox;  // 线程过滤
+    QLineEdit* m_searchEdit;      // 搜索关键字输入框
+    QTimer* m_searchTimer;        // 输入防抖：停止输入一小段时间后才真正执行搜索
+    QLabel* m_countLabel;         // 显示条数
+    QPushButton* m_clearButton;   // “清空日志”按钮
+    bool m_stickToBottom = true;  // 插入新行前视图是否停留在底部
 };
 
 #endif // LOGWIDGET_H
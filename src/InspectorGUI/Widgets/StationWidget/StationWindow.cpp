@@ -0,0 +1,225 @@
+// src/InspectorGUI/Widgets/StationWidget/StationWindow.cpp
+
+#include "StationWindow.h"
+#include "../ViewWidget/MosaicView.h"
+#include "../../Core/CameraStation.h"
+#include "../../Core/CameraManager.h"
+#include "../../Core/ImageConverter.h"
+#include "Metrics.h"
+
+#include <QTableWidget>
+#include <QHeaderView>
+#include <QPushButton>
+#include <QLabel>
+#include <QSplitter>
+#include <QVBoxLayout>
+#include <QHBoxLayout>
+#include <QTimer>
+#include <QSignalBlocker>
+
+// --- 构造函数 ---
+StationWindow::StationWindow(const QString& configPath, QWidget *parent)
+    : QWidget(parent, Qt::Window) // 独立的顶层窗口
+{
+    m_station = new CameraStation(CameraStation::loadConfig(configPath), this);
+    m_cameraOpen.fill(false, m_station->cameraCount());
+    m_cameraGrabbing.fill(false, m_station->cameraCount());
+    m_pendingFrames.resize(m_station->cameraCount());
+    setupUi();
+    updateConnectionUi();
+}
+
+// --- 析构函数 ---
+StationWindow::~StationWindow()
+{
+}
+
+// --- 辅助函数：创建和布局UI ---
+void StationWindow::setupUi()
+{
+    setWindowTitle(tr("Multi-Camera Station"));
+    resize(1280, 860);
+
+    // --- 1. 创建控件 ---
+    m_connectButton = new QPushButton(tr("Connect All"), this);
+    m_liveButton = new QPushButton(tr("Live"), this);
+    m_liveButton->setCheckable(true);
+    m_triggerButton = new QPushButton(tr("Trigger"), this);
+    m_summaryLabel = new QLabel(this);
+    m_displayTimer = new QTimer(this);
+    m_displayTimer->setSingleShot(true);
+    m_displayTimer->setInterval(kDisplayIntervalMs);
+
+    QStringList titles;
+    for (int i = 0; i < m_station->cameraCount(); ++i) {
+        titles << m_station->pipeline(i)->config().name;
+    }
+    m_mosaicView = new MosaicView(this);
+    m_mosaicView->setTiles(titles);
+
+    // 表格列: 触发编号、结果、耗时，然后每台相机一列状态
+    QStringList headers = { tr("Trigger"), tr("Result"), tr("Latency (ms)") };
+    headers << titles;
+    m_partTable = new QTableWidget(0, headers.size(), this);
+    m_partTable->setHorizontalHeaderLabels(headers);
+    m_partTable->verticalHeader()->setVisible(false);
+    m_partTable->horizontalHeader()->setSectionResizeMode(QHeaderView::ResizeToContents);
+    m_partTable->horizontalHeader()->setStretchLastSection(true);
+    m_partTable->setEditTriggers(QAbstractItemView::NoEditTriggers);
+
+    // --- 2. 创建布局 ---
+    QHBoxLayout* buttonLayout = new QHBoxLayout();
+    buttonLayout->addWidget(m_connectButton);
+    buttonLayout->addWidget(m_liveButton);
+    buttonLayout->addWidget(m_triggerButton);
+    buttonLayout->addStretch();
+    buttonLayout->addWidget(m_summaryLabel);
+
+    QSplitter* splitter = new QSplitter(Qt::Vertical, this);
+    splitter->addWidget(m_mosaicView);
+    splitter->addWidget(m_partTable);
+    splitter->setStretchFactor(0, 3);
+    splitter->setStretchFactor(1, 1);
+
+    QVBoxLayout* mainLayout = new QVBoxLayout(this);
+    mainLayout->addLayout(buttonLayout);
+    mainLayout->addWidget(splitter, 1);
+
+    // --- 3. 连接信号与槽 ---
+    connect(m_connectButton, &QPushButton::clicked, this, &StationWindow::onConnectClicked);
+    connect(m_liveButton, &QPushButton::toggled, this, &StationWindow::onLiveToggled);
+    connect(m_triggerButton, &QPushButton::clicked, this, &StationWindow::onTriggerClicked);
+    connect(m_station, &CameraStation::frameReady, this, &StationWindow::onFrameReady);
+    connect(m_station, &CameraStation::cameraResultReady, this, &StationWindow::onCameraResultReady);
+    connect(m_station, &CameraStation::partCompleted, this, &StationWindow::onPartCompleted);
+    connect(m_displayTimer, &QTimer::timeout, this, &StationWindow::refreshMosaic);
+
+    // 【关键】按钮由各相机报告的状态驱动：连接是异步的，也可能失败
+    for (int i = 0; i < m_station->cameraCount(); ++i)
+    {
+        CameraManager* camera = m_station->pipeline(i)->camera();
+        connect(camera, &CameraManager::acquisitionStateChanged, this, [this, i](CameraManager::AcquisitionState state) {
+            m_cameraOpen[i] = state != CameraManager::AcquisitionState::Closed;
+            m_cameraGrabbing[i] = state == CameraManager::AcquisitionState::Continuous;
+            updateConnectionUi();
+        });
+        connect(camera, &CameraManager::connectionStatusChanged, this, [this, i](bool, const QString& message) {
+            m_mosaicView->setStatus(i, message);
+        });
+        connect(camera, &CameraManager::commandFinished, this, [this](CameraManager::Command command, bool, double) {
+            if ((command == CameraManager::Command::Connect || command == CameraManager::Command::Disconnect) && m_pendingReplies > 0) {
+                m_pendingReplies--;
+            }
+            // 失败的命令不会改变采集状态，这里同样刷新一次，让按钮回到真实的状态
+            if (command == CameraManager::Command::Connect || command == CameraManager::Command::Disconnect
+                || command == CameraManager::Command::StartGrabbing || command == CameraManager::Command::StopGrabbing) {
+                updateConnectionUi();
+            }
+        });
+    }
+}
+
+void StationWindow::updateConnectionUi()
+{
+    m_connected = m_cameraOpen.contains(true);
+    const bool grabbing = m_cameraGrabbing.contains(true);
+    m_connectButton->setText(m_connected ? tr("Disconnect All") : tr("Connect All"));
+    m_connectButton->setEnabled(m_pendingReplies == 0);
+    m_liveButton->setEnabled(m_connected);
+    {
+        QSignalBlocker blocker(m_liveButton); // 只反映状态，不再发出采集命令
+        m_liveButton->setChecked(grabbing);
+    }
+    m_triggerButton->setEnabled(m_connected && !grabbing);
+}
+
+// --- 按钮响应 ---
+void StationWindow::onConnectClicked()
+{
+    // 各相机的连接结果通过各自的 acquisitionStateChanged 信号更新按钮，connectionStatusChanged 的消息显示在格子里
+    m_pendingReplies = m_station->cameraCount();
+    if (m_connected) {
+        qInfo("Station: disconnecting all cameras...");
+        m_station->disconnectAll();
+    } else {
+        qInfo("Station: connecting all cameras...");
+        m_station->connectAll();
+    }
+    updateConnectionUi();
+}
+
+void StationWindow::onLiveToggled(bool checked)
+{
+    // 按钮先按下去，真正的状态由 acquisitionStateChanged 回来更新
+    if (checked) m_station->startGrabbingAll();
+    else m_station->stopGrabbingAll();
+    m_triggerButton->setEnabled(false);
+}
+
+void StationWindow::onTriggerClicked()
+{
+    const quint64 triggerId = m_station->triggerAll();
+    qInfo("Station: trigger %llu sent to %d cameras.", static_cast<unsigned long long>(triggerId), m_station->cameraCount());
+}
+
+// --- 工位信号响应 ---
+void StationWindow::onFrameReady(int cameraIndex, const cv::Mat& frame, const FrameTrace& trace)
+{
+    static InspectorLib::Gauge& guiQueue = InspectorLib::MetricsRegistry::Global().gauge(
+        "inspector_queue_depth", "Items waiting in a cross-thread queue", "queue=\"camera_to_gui\"");
+    guiQueue.add(-1);
+
+    // 【关键】只记下最新的一帧，转换和重绘留给定时器：多台相机同时连续采集时，
+    // 每一帧都重绘拼图会让GUI线程跟不上，事件队列越积越长
+    PendingFrame& pending = m_pendingFrames[cameraIndex];
+    pending.frame = frame;
+    pending.trace = trace;
+    pending.dirty = true;
+    if (!m_displayTimer->isActive()) m_displayTimer->start();
+}
+
+void StationWindow::refreshMosaic()
+{
+    for (int i = 0; i < m_pendingFrames.size(); ++i)
+    {
+        PendingFrame& pending = m_pendingFrames[i];
+        if (!pending.dirty) continue;
+        m_mosaicView->setImage(i, ImageConverter::rawFrameToQImage(pending.frame, pending.trace.pixelFormat));
+        m_mosaicView->setStatus(i, tr("frame %1").arg(pending.trace.frameId));
+        pending.frame.release(); // 尽快把缓冲还给相机的帧缓冲池
+        pending.dirty = false;
+    }
+}
+
+void StationWindow::onCameraResultReady(int cameraIndex, uint32_t status, const InspectorLib::MeasurementResults& results, const QImage& resultImage)
+{
+    // 触发拍照时，格子里换成带测量标记的结果图
+    if (results.triggerId != 0 && !resultImage.isNull()) {
+        m_mosaicView->setImage(cameraIndex, resultImage);
+        m_pendingFrames[cameraIndex].frame.release(); // 还没显示的原始帧不再覆盖结果图
+        m_pendingFrames[cameraIndex].dirty = false;
+    }
+    m_mosaicView->setStatus(cameraIndex, tr("trigger %1: %2").arg(results.triggerId).arg(InspectorLib::StatusName(status)));
+}
+
+void StationWindow::onPartCompleted(const PartResult& part)
+{
+    const bool passed = part.passed();
+    (passed ? m_passCount : m_failCount)++;
+
+    // 新结果插入到第一行，超出上限的旧行删除
+    m_partTable->insertRow(0);
+    m_partTable->setItem(0, 0, new QTableWidgetItem(QString::number(part.triggerId)));
+    m_partTable->setItem(0, 1, new QTableWidgetItem(!part.complete ? tr("INCOMPLETE") : (passed ? tr("PASS") : tr("FAIL"))));
+    m_partTable->setItem(0, 2, new QTableWidgetItem(part.triggerNs != 0 ? QString::number((part.completedNs - part.triggerNs) / 1e6, 'f', 1) : QString("-")));
+    for (int i = 0; i < part.statuses.size(); ++i)
+    {
+        const uint32_t status = part.statuses[i];
+        m_partTable->setItem(0, 3 + i, new QTableWidgetItem(status == PartResult::kStatusMissing ? tr("missing") : QString(InspectorLib::StatusName(status))));
+    }
+    while (m_partTable->rowCount() > kMaxRows) {
+        m_partTable->removeRow(m_partTable->rowCount() - 1);
+    }
+
+    m_summaryLabel->setText(tr("Pass: %1  Fail: %2").arg(m_passCount).arg(m_failCount));
+}
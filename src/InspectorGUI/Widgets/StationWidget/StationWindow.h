@@ -0,0 +1,87 @@
+// src/InspectorGUI/Widgets/StationWidget/StationWindow.h
+
+#ifndef STATIONWINDOW_H
+#define STATIONWINDOW_H
+
+#include <QWidget>
+#include <QImage>
+#include <QVector>
+#include <opencv2/opencv.hpp>
+#include "Inspector.h"
+#include "../../Core/FrameTrace.h"
+#include "../../Core/ResultJoiner.h"
+
+// --- 前向声明 ---
+class CameraStation;
+class MosaicView;
+class QTableWidget;
+class QPushButton;
+class QLabel;
+class QTimer;
+
+/**
+ * @class StationWindow
+ * @brief 多相机工位窗口：拼图实时画面 + 按零件合并后的结果表格。
+ *
+ * @details 窗口创建时根据配置文件建立 CameraStation (此时还不会打开相机)。
+ * “触发”按钮用同一个触发编号触发所有相机，各相机独立测量，结果合并后显示为表格中的一行。
+ * 按钮的状态跟随各相机报告的采集状态 (而不是按下按钮的时刻)；拼图每 kDisplayIntervalMs 最多刷新一次，
+ * 期间到达的帧只保留每台相机最新的一帧。
+ * 注意：工位和主窗口的单相机模式不要同时打开同一台相机。
+ */
+class StationWindow : public QWidget
+{
+    Q_OBJECT
+
+public:
+    static constexpr int kMaxRows = 200; // 结果表格最多保留的行数
+    static constexpr int kDisplayIntervalMs = 40; // 拼图的最短刷新间隔 (每秒最多 25 次)
+
+    /**
+     * @param configPath 工位配置文件的路径 (见 CameraStation)。
+     */
+    explicit StationWindow(const QString& configPath, QWidget *parent = nullptr);
+    ~StationWindow();
+
+private slots:
+    void onConnectClicked();
+    void onLiveToggled(bool checked);
+    void onTriggerClicked();
+    void onFrameReady(int cameraIndex, const cv::Mat& frame, const FrameTrace& trace);
+    void onCameraResultReady(int cameraIndex, uint32_t status, const InspectorLib::MeasurementResults& results, const QImage& resultImage);
+    void onPartCompleted(const PartResult& part);
+    void refreshMosaic(); // 显示各相机最新的一帧 (由 m_displayTimer 触发)
+
+private:
+    void setupUi();
+    void updateConnectionUi(); // 按各相机的采集状态更新按钮
+
+    CameraStation* m_station;
+    MosaicView* m_mosaicView;       // 各相机的实时画面
+    QTableWidget* m_partTable;      // 按零件合并后的结果
+    QPushButton* m_connectButton;
+    QPushButton* m_liveButton;
+    QPushButton* m_triggerButton;
+    QLabel* m_summaryLabel;
+    QTimer* m_displayTimer;         // 单次定时器：有新帧时启动，到时刷新拼图
+
+    // --- 各相机的状态 (来自 CameraManager::acquisitionStateChanged) ---
+    QVector<bool> m_cameraOpen;
+    QVector<bool> m_cameraGrabbing; // 连续采集中
+    int m_pendingReplies = 0;       // 还没有完成的连接/断开命令数，全部完成之前连接按钮不可用
+    bool m_connected = false;       // 至少一台相机已连接
+
+    // --- 等待显示的帧 (每台相机只保留最新的一帧) ---
+    struct PendingFrame
+    {
+        cv::Mat frame;
+        FrameTrace trace;
+        bool dirty = false;
+    };
+    QVector<PendingFrame> m_pendingFrames;
+
+    int m_passCount = 0;
+    int m_failCount = 0;
+};
+
+#endif // STATIONWINDOW_H
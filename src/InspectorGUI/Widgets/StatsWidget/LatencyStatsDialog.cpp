@@ -0,0 +1,141 @@
+// src/InspectorGUI/Widgets/StatsWidget/LatencyStatsDialog.cpp
+
+#include "LatencyStatsDialog.h"
+#include "Stats.h"
+
+#include <QTableWidget>
+#include <QHeaderView>
+#include <QPushButton>
+#include <QLabel>
+#include <QTimer>
+#include <QVBoxLayout>
+#include <QHBoxLayout>
+#include <QMessageBox>
+
+// --- 构造函数 ---
+LatencyStatsDialog::LatencyStatsDialog(QWidget *parent)
+    : QDialog(parent)
+{
+    setupUi();
+}
+
+// --- 析构函数 ---
+LatencyStatsDialog::~LatencyStatsDialog()
+{
+}
+
+// --- 窗口显示/隐藏时启停定时刷新，隐藏的窗口不做无用功 ---
+void LatencyStatsDialog::showEvent(QShowEvent* event)
+{
+    QDialog::showEvent(event);
+    refresh();
+    m_refreshTimer->start();
+}
+
+void LatencyStatsDialog::hideEvent(QHideEvent* event)
+{
+    m_refreshTimer->stop();
+    QDialog::hideEvent(event);
+}
+
+// --- 私有槽函数：刷新表格 ---
+void LatencyStatsDialog::refresh()
+{
+    const InspectorLib::Stats& stats = InspectorLib::Stats::Global();
+    const std::vector<uint32_t> outcomes = stats.observedOutcomes();
+
+    // 行的顺序：各阶段，各结果，最后是总计
+    m_table->setRowCount(InspectorLib::Stage_Count + static_cast<int>(outcomes.size()) + 1);
+
+    int row = 0;
+    for (int i = 0; i < InspectorLib::Stage_Count; ++i)
+    {
+        const InspectorLib::InspectStage stage = static_cast<InspectorLib::InspectStage>(i);
+        setRow(row++, tr("Stage: %1").arg(InspectorLib::StageName(stage)), stats.stageHistogram(stage));
+    }
+    for (uint32_t status : outcomes)
+    {
+        setRow(row++, tr("Result: %1 (%2)").arg(InspectorLib::StatusName(status)).arg(status), stats.outcomeHistogram(status));
+    }
+
+    const InspectorLib::LatencyHistogram total = stats.totalHistogram();
+    setRow(row, tr("Total"), total);
+    m_summaryLabel->setText(tr("%1 inspections recorded. Times in milliseconds.").arg(total.totalCount()));
+}
+
+// --- 私有槽函数：清空统计 ---
+void LatencyStatsDialog::onResetClicked()
+{
+    if (QMessageBox::question(this, tr("Reset Statistics"), tr("Discard all recorded latency statistics?")) != QMessageBox::Yes) {
+        return;
+    }
+    InspectorLib::Stats::Global().reset();
+    qInfo("Latency statistics reset by user.");
+    refresh();
+}
+
+// --- 辅助函数：填写一行 ---
+void LatencyStatsDialog::setRow(int row, const QString& name, const InspectorLib::LatencyHistogram& histogram)
+{
+    // 列: 名称、次数、平均、p50、p90、p99、p99.9、最大
+    const double values[] = {
+        histogram.meanNs() * 1e-6,
+        histogram.valueAtPercentile(50.0) * 1e-6,
+        histogram.valueAtPercentile(90.0) * 1e-6,
+        histogram.valueAtPercentile(99.0) * 1e-6,
+        histogram.valueAtPercentile(99.9) * 1e-6,
+        histogram.maxNs() * 1e-6
+    };
+
+    auto setCell = [this, row](int column, const QString& text) {
+        QTableWidgetItem* item = m_table->item(row, column);
+        if (item == nullptr) {
+            item = new QTableWidgetItem();
+            item->setTextAlignment(column == 0 ? (Qt::AlignLeft | Qt::AlignVCenter) : (Qt::AlignRight | Qt::AlignVCenter));
+            m_table->setItem(row, column, item);
+        }
+        item->setText(text);
+    };
+
+    setCell(0, name);
+    setCell(1, QString::number(histogram.totalCount()));
+    for (int i = 0; i < 6; ++i) {
+        setCell(2 + i, histogram.totalCount() ? QString::number(values[i], 'f', 3) : QString("-"));
+    }
+}
+
+// --- 辅助函数：创建和布局UI ---
+void LatencyStatsDialog::setupUi()
+{
+    setWindowTitle(tr("Latency Statistics"));
+    resize(760, 360);
+
+    // --- 1. 创建控件 ---
+    m_table = new QTableWidget(0, 8, this);
+    m_table->setHorizontalHeaderLabels({ tr("Item"), tr("Count"), tr("Mean"), tr("p50"), tr("p90"), tr("p99"), tr("p99.9"), tr("Max") });
+    m_table->verticalHeader()->setVisible(false);
+    m_table->horizontalHeader()->setSectionResizeMode(QHeaderView::ResizeToContents);
+    m_table->horizontalHeader()->setStretchLastSection(true);
+    m_table->setEditTriggers(QAbstractItemView::NoEditTriggers); // 只读
+    m_table->setSelectionMode(QAbstractItemView::NoSelection);
+
+    m_summaryLabel = new QLabel(this);
+    m_resetButton = new QPushButton(tr("Reset"), this);
+
+    m_refreshTimer = new QTimer(this);
+    m_refreshTimer->setInterval(1000);
+
+    // --- 2. 创建布局 ---
+    QHBoxLayout* bottomLayout = new QHBoxLayout();
+    bottomLayout->addWidget(m_summaryLabel);
+    bottomLayout->addStretch();
+    bottomLayout->addWidget(m_resetButton);
+
+    QVBoxLayout* mainLayout = new QVBoxLayout(this);
+    mainLayout->addWidget(m_table);
+    mainLayout->addLayout(bottomLayout);
+
+    // --- 3. 连接信号与槽 ---
+    connect(m_refreshTimer, &QTimer::timeout, this, &LatencyStatsDialog::refresh);
+    connect(m_resetButton, &QPushButton::clicked, this, &LatencyStatsDialog::onResetClicked);
+}
@@ -0,0 +1,56 @@
+// src/InspectorGUI/Widgets/StatsWidget/LatencyStatsDialog.h
+
+#ifndef LATENCYSTATSDIALOG_H
+#define LATENCYSTATSDIALOG_H
+
+#include <QDialog>
+
+// --- 前向声明 ---
+class QTableWidget;
+class QPushButton;
+class QLabel;
+class QTimer;
+
+namespace InspectorLib { class LatencyHistogram; }
+
+/**
+ * @class LatencyStatsDialog
+ * @brief 耗时统计窗口：按阶段和按结果显示 InspectPart 的耗时百分位 (p50/p90/p99/p99.9)。
+ *
+ * @details 数据来自 InspectorLib::Stats::Global()，窗口打开期间每秒刷新一次。
+ * 统计采用 HDR 直方图，内存固定，程序运行多久都可以查询全部历史数据的尾部延迟。
+ */
+class LatencyStatsDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    explicit LatencyStatsDialog(QWidget *parent = nullptr);
+    ~LatencyStatsDialog();
+
+protected:
+    void showEvent(QShowEvent* event) override;
+    void hideEvent(QHideEvent* event) override;
+
+private slots:
+    /**
+     * @brief 重新读取统计快照并刷新表格。
+     */
+    void refresh();
+
+    /**
+     * @brief 清空全局统计 (例如切换配方之后重新开始统计)。
+     */
+    void onResetClicked();
+
+private:
+    void setupUi();
+    void setRow(int row, const QString& name, const InspectorLib::LatencyHistogram& histogram);
+
+    QTableWidget* m_table;       // 统计表格
+    QLabel* m_summaryLabel;      // 表格下方的总计信息
+    QPushButton* m_resetButton;  // “清空统计”按钮
+    QTimer* m_refreshTimer;      // 定时刷新
+};
+
+#endif // LATENCYSTATSDIALOG_H
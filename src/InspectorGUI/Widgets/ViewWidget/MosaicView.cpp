@@ -0,0 +1,69 @@
+// src/InspectorGUI/Widgets/ViewWidget/MosaicView.cpp
+
+#include "MosaicView.h"
+#include "ImageView.h"
+
+#include <QGridLayout>
+#include <QVBoxLayout>
+#include <QLabel>
+#include <algorithm>
+#include <cmath>
+
+// --- 构造函数 ---
+MosaicView::MosaicView(QWidget *parent)
+    : QWidget(parent)
+{
+    m_grid = new QGridLayout(this);
+    m_grid->setContentsMargins(0, 0, 0, 0);
+    m_grid->setSpacing(4);
+}
+
+// --- 析构函数 ---
+MosaicView::~MosaicView()
+{
+}
+
+void MosaicView::setTiles(const QStringList& titles)
+{
+    // 1. 删除旧的格子
+    for (int i = 0; i < m_views.size(); ++i) {
+        QWidget* tile = m_views[i]->parentWidget();
+        m_grid->removeWidget(tile);
+        delete tile;
+    }
+    m_views.clear();
+    m_labels.clear();
+    m_titles = titles;
+
+    // 2. 按网格创建新的格子：每个格子 = 标题 + 图像视图
+    const int columns = std::max(1, static_cast<int>(std::ceil(std::sqrt(static_cast<double>(titles.size())))));
+    for (int i = 0; i < titles.size(); ++i)
+    {
+        QWidget* tile = new QWidget(this);
+        QLabel* label = new QLabel(titles[i], tile);
+        ImageView* view = new ImageView(tile);
+
+        QVBoxLayout* layout = new QVBoxLayout(tile);
+        layout->setContentsMargins(0, 0, 0, 0);
+        layout->addWidget(label);
+        layout->addWidget(view, 1);
+
+        m_grid->addWidget(tile, i / columns, i % columns);
+        m_views.append(view);
+        m_labels.append(label);
+    }
+}
+
+void MosaicView::setImage(int index, const QImage& image)
+{
+    if (index >= 0 && index < m_views.size()) {
+        m_views[index]->setImage(image);
+    }
+}
+
+void MosaicView::setStatus(int index, const QString& status)
+{
+    if (index >= 0 && index < m_labels.size()) {
+        m_labels[index]->setText(status.isEmpty() ? m_titles[index] : QString("%1  -  %2").arg(m_titles[index], status));
+    }
+}
@@ -0,0 +1,53 @@
+// src/InspectorGUI/Widgets/ViewWidget/MosaicView.h
+
+#ifndef MOSAICVIEW_H
+#define MOSAICVIEW_H
+
+#include <QWidget>
+#include <QImage>
+#include <QStringList>
+#include <QVector>
+
+// --- 前向声明 ---
+class ImageView;
+class QLabel;
+class QGridLayout;
+
+/**
+ * @class MosaicView
+ * @brief 拼图视图：把多台相机的画面按网格排列同时显示，每个格子上方显示相机名称和状态。
+ * @details 格子的列数为 ceil(sqrt(N))，例如2台相机排成1行2列，4台排成2行2列。
+ */
+class MosaicView : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit MosaicView(QWidget *parent = nullptr);
+    ~MosaicView();
+
+    /**
+     * @brief 重新创建格子，titles 的个数就是格子数。
+     */
+    void setTiles(const QStringList& titles);
+
+    int tileCount() const { return m_views.size(); }
+
+    /**
+     * @brief 设置某个格子显示的图像。
+     */
+    void setImage(int index, const QImage& image);
+
+    /**
+     * @brief 设置某个格子标题后面的状态文字 (例如帧号、测量结果)。
+     */
+    void setStatus(int index, const QString& status);
+
+private:
+    QGridLayout* m_grid;
+    QStringList m_titles;
+    QVector<ImageView*> m_views;
+    QVector<QLabel*> m_labels;
+};
+
+#endif // MOSAICVIEW_H
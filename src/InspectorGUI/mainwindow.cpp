@@ -9,10 +9,25 @@
 #include "Widgets/LogWidget/LogWidget.h"
 #include "Widgets/ControlPanel/InspectPanel.h"
 #include "Widgets/ControlPanel/CameraPanel.h"
+#include "Widgets/StatsWidget/LatencyStatsDialog.h"
+#include "Widgets/StationWidget/StationWindow.h"
 #include "Core/InspectorThread.h"
 #include "Core/CameraManager.h"
 #include "Core/LogManager.h"
 #include "Core/ImageConverter.h"
+#include "Core/TraceRecorder.h"
+#include "Core/MetricsServer.h"
+#include "Core/FlatFieldCapture.h"
+#include "Metrics.h"
+#include "FlatField.h"
+#include "AutoThreshold.h"
+#include "Fitting.h"
+#include "ChangeDetector.h"
+#include "Calibration.h"
+#include "ShapeModel.h"
+#include "NominalModel.h"
+#include "DxfReader.h"
+#include "GoldenModel.h"
 
 // --- 包含所有需要的Qt类 ---
 #include <QVBoxLayout>
@@ -20,6 +35,15 @@
 #include <QFileDialog>
 #include <QMessageBox>
 #include <QStatusBar> // 用于在窗口底部显示状态信息
+#include <QCoreApplication>
+#include <QMenuBar>
+#include <QMenu>
+#include <QAction>
+#include <QActionGroup>
+#include <QDateTime>
+#include <QMetaEnum>
+#include <QFileInfo>
+#include <QInputDialog>
 
 // --- 构造函数 ---
 MainWindow::MainWindow(QWidget *parent)
@@ -28,6 +52,7 @@ MainWindow::MainWindow(QWidget *parent)
     // 调用辅助函数，分步完成初始化，让构造函数保持整洁
     setupUi();          // 1. 创建和布局所有UI控件
     setupConnections(); // 2. 连接所有模块的信号和槽
+    setupMenus();       // 3. 创建菜单栏
 
     // 设置窗口的初始大小、标题、图标
     resize(1280, 800);
@@ -37,15 +62,43 @@ MainWindow::MainWindow(QWidget *parent)
     // 【关键】安装并启动我们的全局日志系统
     LogManager::Instance()->install();
 
+    // 同时启用二进制文件日志，所有日志记录都会被写入程序目录下的 logs 文件夹（按大小和时间滚动）
+    BinaryLogSink::Options logOptions;
+    logOptions.directory = QCoreApplication::applicationDirPath() + "/logs";
+    LogManager::Instance()->enableFileSink(logOptions);
+
+    // 启动本机指标接口，供 Prometheus 抓取 http://127.0.0.1:9464/metrics
+    m_metricsServer->start();
+
     // 发出第一条日志，这条消息会被LogManager捕获，并通过信号发送给LogWidget显示
     qInfo("Application started successfully.");
+
+    loadFlatField();
+    loadCalibration();
+    loadShapeModel();
+    loadNominalModel();
+    loadGoldenModel();
 }
 
 // --- 析构函数 ---
 MainWindow::~MainWindow()
 {
+    // 【关键】先停止所有会写日志的后台线程，再停用文件日志
+    // 解释: LOG_FAST 在任意线程中直接使用文件日志对象，不加锁；如果等到Qt的父子关系自动删除这些对象，
+    //       它们的线程 (相机命令线程、SDK回调、测量线程、工位的测量线程) 还在运行时文件日志就已经被释放了。
+    //       工位窗口的析构会关闭它的相机并等待测量线程退出；平场采集引用了相机管理器，要在它之前删除。
+    delete m_stationWindow;
+    m_stationWindow = nullptr;
+    delete m_flatFieldCapture;
+    m_flatFieldCapture = nullptr;
+    delete m_cameraManager; // 等待命令线程结束，相机在命令线程中关闭，之后不会再有帧回调
+    m_cameraManager = nullptr;
+    m_inspectorThread->wait();
+
     // 在程序退出前，卸载我们的日志处理器，恢复Qt默认行为。这是一个好习惯。
     LogManager::Instance()->uninstall();
+    // 停用文件日志，等待后台线程把剩余记录写入磁盘
+    LogManager::Instance()->disableFileSink();
     // 所有在setupUi中创建的、以this为parent的子控件和后台对象，
     // 都会在这里被Qt的父子关系系统自动、安全地delete，无需我们手动操作。
 }
@@ -66,6 +119,8 @@ void MainWindow::setupUi()
     m_resultImageView = new ImageView(this);
     m_cameraManager = new CameraManager(this);     // 创建相机管理器
     m_inspectorThread = new InspectorThread(this); // 创建后台测量线程
+    m_metricsServer = new MetricsServer(this);     // 创建指标接口 (在构造函数中启动)
+    m_flatFieldCapture = new FlatFieldCapture(m_cameraManager, this); // 平场标定的采集 (平时空闲)
 
     // --- 2. 使用 QSplitter 组合出灵活的、可拖拽的布局 ---
 
@@ -103,8 +158,8 @@ void MainWindow::setupConnections()
     // 解释: 这是整个应用程序的“神经中枢”。我们在这里将所有独立的模块连接起来。
 
     // 连接1: 全局日志系统
-    // 将 LogManager(广播室) 的 newMessage 信号，连接到 LogWidget(公告屏) 的 appendMessage 槽。
-    connect(LogManager::Instance(), &LogManager::newMessage, m_logWidget, &LogWidget::appendMessage);
+    // 将 LogManager(广播室) 的 newRecord 信号，连接到 LogWidget(公告屏) 的 appendRecord 槽。
+    connect(LogManager::Instance(), &LogManager::newRecord, m_logWidget, &LogWidget::appendRecord);
 
     // 连接2: 相机面板的用户请求 -> MainWindow 的处理槽
     connect(m_cameraPanel, &CameraPanel::searchDevicesRequested, this, &MainWindow::onSearchDevicesRequested);
@@ -126,10 +181,160 @@ void MainWindow::setupConnections()
     connect(m_cameraManager, &CameraManager::errorOccurred, this, [this](const QString& msg){
         qCritical("CameraManager Error: %s", msg.toStdString().c_str());
     });
+    // 相机命令在后台线程中异步执行，参数真正写入相机之后才记录日志
+    connect(m_cameraManager, &CameraManager::exposureApplied, this, [](int value){
+        qInfo("Exposure set to %d us.", value);
+    });
+    connect(m_cameraManager, &CameraManager::gainApplied, this, [](double value){
+        qInfo("Gain set to %.1f dB.", value);
+    });
+    connect(m_cameraManager, &CameraManager::commandFinished, this, [](CameraManager::Command command, bool success, double elapsedMs){
+        const char* name = QMetaEnum::fromType<CameraManager::Command>().valueToKey(static_cast<int>(command));
+        qDebug("Camera command %s %s in %.1f ms.", name, success ? "finished" : "failed", elapsedMs);
+    });
+    connect(m_cameraManager, &CameraManager::acquisitionStateChanged, this, [](CameraManager::AcquisitionState state){
+        qDebug("Camera acquisition state: %s", QMetaEnum::fromType<CameraManager::AcquisitionState>().valueToKey(static_cast<int>(state)));
+    });
 
     // 连接5: 检测线程(算法)的反馈 -> MainWindow 的处理槽
     connect(m_inspectorThread, &InspectorThread::finishedInspection, this, &MainWindow::onInspectionFinished);
     connect(m_inspectorThread, &InspectorThread::errorOccurred, this, &MainWindow::onInspectionError);
+    connect(m_inspectorThread, &InspectorThread::frameRejected, this, &MainWindow::onFrameRejected);
+}
+
+
+void MainWindow::setupMenus()
+{
+    // “工具”菜单：存放诊断相关的功能
+    QMenu* toolsMenu = menuBar()->addMenu(tr("Tools"));
+    QAction* exportTraceAction = toolsMenu->addAction(tr("Export Frame Trace..."));
+    connect(exportTraceAction, &QAction::triggered, this, &MainWindow::onExportTraceRequested);
+    QAction* latencyStatsAction = toolsMenu->addAction(tr("Latency Statistics..."));
+    connect(latencyStatsAction, &QAction::triggered, this, &MainWindow::onLatencyStatsRequested);
+    toolsMenu->addSeparator();
+    QAction* stationAction = toolsMenu->addAction(tr("Multi-Camera Station..."));
+    connect(stationAction, &QAction::triggered, this, &MainWindow::onStationRequested);
+    toolsMenu->addSeparator();
+    m_roiTrackingAction = toolsMenu->addAction(tr("Camera ROI Tracking"));
+    m_roiTrackingAction->setCheckable(true);
+    m_roiTrackingAction->setToolTip(tr("Transfer only the area around the last located part (periodic full frames)"));
+    connect(m_roiTrackingAction, &QAction::toggled, this, &MainWindow::onRoiTrackingToggled);
+    QAction* bayerHalfAction = toolsMenu->addAction(tr("Half-Resolution Colour Inspection"));
+    bayerHalfAction->setCheckable(true);
+    bayerHalfAction->setToolTip(tr("Inspect Bayer frames on 2x2 superpixels (faster, lower precision)"));
+    connect(bayerHalfAction, &QAction::toggled, this, [this](bool checked) {
+        InspectorLib::InspectOptions options = m_inspectorThread->inspectOptions();
+        options.bayerHalfResolution = checked;
+        m_inspectorThread->setInspectOptions(options);
+        qInfo("Half-resolution colour inspection %s.", checked ? "enabled" : "disabled");
+    });
+    QAction* qualityGateAction = toolsMenu->addAction(tr("Frame Quality Gate"));
+    qualityGateAction->setCheckable(true);
+    qualityGateAction->setToolTip(tr("Reject empty, truncated and badly exposed frames before the full inspection"));
+    connect(qualityGateAction, &QAction::toggled, this, [this](bool checked) {
+        InspectorLib::InspectOptions options = m_inspectorThread->inspectOptions();
+        options.qualityGate.enabled = checked;
+        m_inspectorThread->setInspectOptions(options);
+        qInfo("Frame quality gate %s.", checked ? "enabled" : "disabled");
+    });
+    QAction* changeDetectionAction = toolsMenu->addAction(tr("Skip Unchanged Frames"));
+    changeDetectionAction->setCheckable(true);
+    changeDetectionAction->setToolTip(tr("Reuse the last result while the scene is unchanged; re-measure only holes in changed areas"));
+    connect(changeDetectionAction, &QAction::toggled, this, [this](bool checked) {
+        InspectorLib::InspectOptions options = m_inspectorThread->inspectOptions();
+        options.changeDetector = checked ? std::make_shared<InspectorLib::ChangeDetector>() : nullptr;
+        m_inspectorThread->setInspectOptions(options);
+        qInfo("Change detection %s.", checked ? "enabled" : "disabled");
+    });
+    QAction* caliperAction = toolsMenu->addAction(tr("Caliper Measurement"));
+    caliperAction->setCheckable(true);
+    caliperAction->setToolTip(tr("Re-measure the outer size and the slot with sub-pixel calipers on the grey image"));
+    connect(caliperAction, &QAction::toggled, this, [this](bool checked) {
+        InspectorLib::InspectOptions options = m_inspectorThread->inspectOptions();
+        options.caliper.enabled = checked;
+        m_inspectorThread->setInspectOptions(options);
+        qInfo("Caliper measurement %s.", checked ? "enabled" : "disabled");
+    });
+    QAction* feretAction = toolsMenu->addAction(tr("Feret Measurements"));
+    feretAction->setCheckable(true);
+    feretAction->setToolTip(tr("Report max/min Feret diameters and the largest inscribed circle of the part and every hole"));
+    connect(feretAction, &QAction::toggled, this, [this](bool checked) {
+        InspectorLib::InspectOptions options = m_inspectorThread->inspectOptions();
+        options.feret.enabled = checked;
+        m_inspectorThread->setInspectOptions(options);
+        qInfo("Feret measurements %s.", checked ? "enabled" : "disabled");
+    });
+    toolsMenu->addSeparator();
+    QAction* flatFieldCalibrationAction = toolsMenu->addAction(tr("Flat-Field Calibration..."));
+    connect(flatFieldCalibrationAction, &QAction::triggered, this, &MainWindow::onFlatFieldCalibrationRequested);
+    m_flatFieldAction = toolsMenu->addAction(tr("Flat-Field Correction"));
+    m_flatFieldAction->setCheckable(true);
+    m_flatFieldAction->setEnabled(false); // 有校正表之后才可用
+    m_flatFieldAction->setToolTip(tr("Compensate uneven illumination and dark offset while binarising"));
+    connect(m_flatFieldAction, &QAction::toggled, this, &MainWindow::onFlatFieldToggled);
+    QAction* cameraCalibrationAction = toolsMenu->addAction(tr("Camera Calibration..."));
+    connect(cameraCalibrationAction, &QAction::triggered, this, &MainWindow::onCameraCalibrationRequested);
+    m_calibrationAction = toolsMenu->addAction(tr("Measure in Millimetres"));
+    m_calibrationAction->setCheckable(true);
+    m_calibrationAction->setEnabled(false); // 有标定之后才可用
+    m_calibrationAction->setToolTip(tr("Correct lens distortion and convert the measured features to millimetres"));
+    connect(m_calibrationAction, &QAction::toggled, this, &MainWindow::onCalibrationToggled);
+    QAction* shapeModelTrainingAction = toolsMenu->addAction(tr("Train Part Model..."));
+    connect(shapeModelTrainingAction, &QAction::triggered, this, &MainWindow::onShapeModelTrainingRequested);
+    m_shapeModelAction = toolsMenu->addAction(tr("Locate Part by Shape Model"));
+    m_shapeModelAction->setCheckable(true);
+    m_shapeModelAction->setEnabled(false); // 有模型之后才可用
+    m_shapeModelAction->setToolTip(tr("Find the part by its edge shape before searching contours, ignoring clutter around it"));
+    connect(m_shapeModelAction, &QAction::toggled, this, &MainWindow::onShapeModelToggled);
+    QAction* nominalModelLoadAction = toolsMenu->addAction(tr("Load Nominal Model..."));
+    connect(nominalModelLoadAction, &QAction::triggered, this, &MainWindow::onNominalModelLoadRequested);
+    m_nominalAction = toolsMenu->addAction(tr("Compare to Nominal Geometry"));
+    m_nominalAction->setCheckable(true);
+    m_nominalAction->setEnabled(false); // 有名义模型之后才可用
+    m_nominalAction->setToolTip(tr("Compare the part outline and holes with the CAD geometry and mark burrs and missing material"));
+    connect(m_nominalAction, &QAction::toggled, this, &MainWindow::onNominalModelToggled);
+    QAction* goldenModelTrainingAction = toolsMenu->addAction(tr("Train Golden Part..."));
+    connect(goldenModelTrainingAction, &QAction::triggered, this, &MainWindow::onGoldenModelTrainingRequested);
+    m_goldenAction = toolsMenu->addAction(tr("Compare to Golden Part"));
+    m_goldenAction->setCheckable(true);
+    m_goldenAction->setEnabled(false); // 有金板模型之后才可用
+    m_goldenAction->setToolTip(tr("Score the part edges against the golden part and show where the shape differs"));
+    connect(m_goldenAction, &QAction::toggled, this, &MainWindow::onGoldenModelToggled);
+
+    // 阈值方式：三个互斥的选项
+    QMenu* thresholdMenu = toolsMenu->addMenu(tr("Binarisation Threshold"));
+    QActionGroup* thresholdGroup = new QActionGroup(this);
+    const QString thresholdLabels[InspectorLib::Threshold_Count] = {
+        tr("Fixed"), tr("Automatic (Otsu)"), tr("Automatic (Triangle)")
+    };
+    for (int i = 0; i < InspectorLib::Threshold_Count; ++i) {
+        QAction* action = thresholdMenu->addAction(thresholdLabels[i]);
+        action->setCheckable(true);
+        action->setChecked(i == InspectorLib::Threshold_Fixed);
+        thresholdGroup->addAction(action);
+        connect(action, &QAction::triggered, this, [this, i]() { onThresholdMethodSelected(i); });
+    }
+
+    // 圆孔的拟合方法：四个互斥的选项
+    QMenu* circleFitMenu = toolsMenu->addMenu(tr("Hole Circle Fit"));
+    QActionGroup* circleFitGroup = new QActionGroup(this);
+    const QString circleFitLabels[InspectorLib::CircleFit_Count] = {
+        tr("Minimum Enclosing Circle"), tr("Least Squares (Kasa)"), tr("Least Squares (Taubin)"), tr("Least Squares (Hyper)")
+    };
+    for (int i = 0; i < InspectorLib::CircleFit_Count; ++i) {
+        QAction* action = circleFitMenu->addAction(circleFitLabels[i]);
+        action->setCheckable(true);
+        action->setChecked(i == InspectorLib::InspectOptions().circleFit);
+        circleFitGroup->addAction(action);
+        connect(action, &QAction::triggered, this, [this, i]() { onCircleFitSelected(i); });
+    }
+
+    connect(m_flatFieldCapture, &FlatFieldCapture::captured, this, &MainWindow::onFlatFieldCaptured);
+    connect(m_flatFieldCapture, &FlatFieldCapture::failed, this, [this](const QString& message) {
+        m_flatFieldDark.release();
+        qWarning("Flat-field calibration failed: %s", qPrintable(message));
+        QMessageBox::warning(this, tr("Flat-Field Calibration"), message);
+    });
 }
 
 
@@ -156,6 +361,7 @@ void MainWindow::onImageLoadRequested()
 
     qInfo("Image loaded: %s", filePath.toStdString().c_str());
     m_currentImagePath = filePath;
+    m_currentTrace = FrameTrace(); // 从文件加载的图像没有相机时间戳，帧号为0
     m_mainImageView->setImage(ImageConverter::cvMatToQImage(m_currentCvImage));
     m_resultImageView->setImage(QImage());
     m_inspectPanel->clearResults();
@@ -168,10 +374,14 @@ void MainWindow::onInspectRequested()
         qWarning("Inspect requested but no image is available.");
         return;
     }
+    if (!m_inspectorThread->inspectImage(m_currentCvImage, m_currentTrace)) {
+        // 上一次测量还没有结束，这一帧已被丢弃 (计入丢帧指标)
+        statusBar()->showMessage(tr("Inspector is busy, frame skipped."), 3000);
+        return;
+    }
     m_inspectPanel->setInspectButtonEnabled(false);
     statusBar()->showMessage(tr("Inspecting, please wait..."));
     qInfo("Inspection started...");
-    m_inspectorThread->inspectImage(m_currentCvImage);
 }
 
 // --- 响应来自 CameraPanel 的槽 ---
@@ -184,7 +394,8 @@ void MainWindow::onSearchDevicesRequested()
 void MainWindow::onConnectDeviceRequested(int index)
 {
     qInfo("Connecting to device at index %d...", index);
-    m_cameraManager->connectDevice(index);
+    statusBar()->showMessage(tr("Connecting to camera..."));
+    m_cameraManager->connectDevice(index); // 异步执行，结果通过 connectionStatusChanged 信号返回
 }
 
 void MainWindow::onDisconnectDeviceRequested()
@@ -196,7 +407,7 @@ void MainWindow::onDisconnectDeviceRequested()
 void MainWindow::onSingleShotRequested()
 {
     qInfo("Software trigger for single shot requested.");
-    m_cameraManager->sendSoftwareTrigger();
+    m_cameraManager->sendSoftwareTrigger(); // 第一次触发时自动布防，之后每次只发送一条触发命令
 }
 
 void MainWindow::onContinuousShotToggled(bool checked)
@@ -212,24 +423,51 @@ void MainWindow::onContinuousShotToggled(bool checked)
 
 void MainWindow::onExposureChanged(int value)
 {
+    // 快速连续的修改会在命令队列中合并，只有最后一个值会被写入相机 (见 exposureApplied)
     m_cameraManager->setExposure(value);
-    qInfo("Exposure set to %d us.", value);
 }
 
 void MainWindow::onGainChanged(double value)
 {
     m_cameraManager->setGain(value);
-    qInfo("Gain set to %.1f dB.", value);
 }
 
 // --- 响应来自后台线程的槽 ---
-void MainWindow::onInspectionFinished(const InspectorLib::MeasurementResults& results, const QImage& resultImage)
+void MainWindow::onInspectionFinished(const InspectorLib::MeasurementResults& results, const QImage& resultImage, const FrameTrace& trace)
 {
-    qInfo("Inspection finished successfully.");
-    statusBar()->showMessage(tr("Inspection successful."), 5000); // 状态栏信息显示5秒
-    m_resultImageView->setImage(resultImage);
-    m_inspectPanel->displayResults(results);
+    static InspectorLib::Gauge& resultQueue = InspectorLib::MetricsRegistry::Global().gauge(
+        "inspector_queue_depth", "Items waiting in a cross-thread queue", "queue=\"inspector_to_gui\"");
+    resultQueue.add(-1);
+
+    FrameTrace finishedTrace = trace;
+    finishedTrace.addQueueSpan("Queue", "GUI"); // 结果在GUI事件队列中等待的时间
+
+    if (results.triggerId != 0) {
+        // 软触发的帧：统计从发出触发到结果显示的完整耗时
+        static InspectorLib::Histogram& triggerToResult = InspectorLib::MetricsRegistry::Global().histogram(
+            "inspector_trigger_to_result_seconds", "Time from software trigger to inspection result on screen");
+        const double latencyMs = (FrameTrace::nowNs() - trace.triggerNs) / 1e6;
+        triggerToResult.observe(latencyMs / 1000.0);
+        qInfo("Inspection finished for trigger %llu, %.1f ms after trigger.", static_cast<unsigned long long>(results.triggerId), latencyMs);
+        statusBar()->showMessage(tr("Inspection successful (trigger to result: %1 ms).").arg(latencyMs, 0, 'f', 1), 5000);
+    } else {
+        qInfo("Inspection finished successfully.");
+        statusBar()->showMessage(tr("Inspection successful."), 5000); // 状态栏信息显示5秒
+    }
+    {
+        TraceScope scope(finishedTrace, "DisplayResult", "GUI");
+        m_resultImageView->setImage(resultImage);
+        m_inspectPanel->displayResults(results);
+    }
     m_inspectPanel->setInspectButtonEnabled(true);
+
+    // 相机采集的帧：用零件位置 (传感器坐标) 更新相机端ROI，未启用时 CameraManager 直接忽略
+    if (trace.receiveNs != 0) {
+        m_cameraManager->updateRoi(true, results.boundingBox);
+    }
+
+    // 这一帧的测量流程到此结束，保存追踪
+    TraceRecorder::Instance()->record(finishedTrace);
 }
 
 void MainWindow::onInspectionError(const QString& message)
@@ -238,6 +476,24 @@ void MainWindow::onInspectionError(const QString& message)
     statusBar()->showMessage("Inspection failed!", 5000);
     QMessageBox::critical(this, "Inspection Error", message);
     m_inspectPanel->setInspectButtonEnabled(true);
+
+    // 没有找到零件：下一帧回到整幅重新搜索
+    if (m_currentTrace.receiveNs != 0) {
+        m_cameraManager->updateRoi(false, cv::RotatedRect());
+    }
+}
+
+void MainWindow::onFrameRejected(const QString& reason)
+{
+    // 开启质量预检时每一张不合格的帧都会走到这里，弹出模态对话框会阻塞操作员
+    qWarning("Frame rejected by the quality gate: %s", reason.toStdString().c_str());
+    statusBar()->showMessage(tr("Frame rejected: %1").arg(reason), 5000);
+    m_inspectPanel->setInspectButtonEnabled(true);
+
+    // 与测量失败相同：下一帧回到整幅重新搜索
+    if (m_currentTrace.receiveNs != 0) {
+        m_cameraManager->updateRoi(false, cv::RotatedRect());
+    }
 }
 
 // --- 响应来自相机管理器的槽 ---
@@ -253,13 +509,472 @@ void MainWindow::onConnectionStatusChanged(bool connected, const QString& messag
     statusBar()->showMessage(message, 5000);
 }
 
-void MainWindow::onNewFrameReady(const cv::Mat& frame)
+void MainWindow::onNewFrameReady(const cv::Mat& frame, const FrameTrace& trace)
 {
+    static InspectorLib::Gauge& guiQueue = InspectorLib::MetricsRegistry::Global().gauge(
+        "inspector_queue_depth", "Items waiting in a cross-thread queue", "queue=\"camera_to_gui\"");
+    guiQueue.add(-1);
+
+    FrameTrace frameTrace = trace;
+    frameTrace.addQueueSpan("Queue", "GUI"); // 帧在GUI事件队列中等待的时间
+
     // 当收到新的一帧时 (可能来自连续采集)
     m_currentCvImage = frame; // 更新当前图像
-    m_mainImageView->setImage(ImageConverter::cvMatToQImage(m_currentCvImage));
+    QImage image;
+    {
+        TraceScope scope(frameTrace, "Convert", "GUI");
+        image = ImageConverter::rawFrameToQImage(m_currentCvImage, frameTrace.pixelFormat);
+    }
+    {
+        TraceScope scope(frameTrace, "Display", "GUI");
+        m_mainImageView->setImage(image);
+    }
+
+    // 采集和显示这一段到此结束，保存追踪；之后如果对这一帧执行测量，
+    // 测量阶段会以相同的帧号另行记录，在追踪查看器中可以按 frameId 关联起来。
+    TraceRecorder::Instance()->record(frameTrace);
+    m_currentTrace = frameTrace;
+    m_currentTrace.spans.clear();
 
     // --- 【在这里添加这行代码!】 ---
     // 解释: 既然我们已经成功获取了一张新图，现在就应该允许用户对其进行测量。
     m_inspectPanel->setInspectButtonEnabled(true);
+
+    // 软触发的帧是“拍一张测一张”，直接送去测量，触发编号会随着追踪上下文带到结果中
+    if (m_currentTrace.triggerId != 0) {
+        onInspectRequested();
+    }
+}
+
+// --- 响应菜单操作的槽 ---
+void MainWindow::onExportTraceRequested()
+{
+    const QString defaultName = QString("frame_trace_%1.json").arg(QDateTime::currentDateTime().toString("yyyyMMdd_hhmmss"));
+    QString filePath = QFileDialog::getSaveFileName(this, tr("Export Frame Trace"), defaultName, tr("Trace Files (*.json)"));
+    if (filePath.isEmpty()) {
+        return;
+    }
+
+    if (TraceRecorder::Instance()->exportChromeTrace(filePath)) {
+        statusBar()->showMessage(tr("Frame trace exported. Open it in chrome://tracing or ui.perfetto.dev."), 5000);
+    } else {
+        QMessageBox::critical(this, tr("Error"), tr("Failed to write the trace file."));
+    }
+}
+
+void MainWindow::onLatencyStatsRequested()
+{
+    // 非模态窗口：打开统计的同时可以继续采集和测量，窗口会自动刷新
+    if (m_latencyStatsDialog == nullptr) {
+        m_latencyStatsDialog = new LatencyStatsDialog(this);
+    }
+    m_latencyStatsDialog->show();
+    m_latencyStatsDialog->raise();
+    m_latencyStatsDialog->activateWindow();
+}
+
+void MainWindow::onRoiTrackingToggled(bool checked)
+{
+    RoiController::Options options;
+    options.enabled = checked;
+    m_cameraManager->setRoiOptions(options);
+}
+
+QString MainWindow::flatFieldPath() const
+{
+    return QCoreApplication::applicationDirPath() + "/flatfield.yml";
+}
+
+void MainWindow::loadFlatField()
+{
+    if (!QFileInfo::exists(flatFieldPath())) return;
+
+    auto flatField = std::make_shared<InspectorLib::FlatFieldCorrection>();
+    if (!flatField->load(flatFieldPath().toStdString())) {
+        qWarning("Failed to load flat-field calibration %s.", qPrintable(flatFieldPath()));
+        return;
+    }
+    m_flatField = flatField;
+    m_flatFieldAction->setEnabled(true);
+    m_flatFieldAction->setChecked(true); // 有标定结果时默认启用
+    qInfo("Flat-field calibration loaded (%dx%d).", flatField->sensorSize().width, flatField->sensorSize().height);
+}
+
+void MainWindow::onFlatFieldCalibrationRequested()
+{
+    if (m_flatFieldCapture->isCapturing()) return;
+
+    // 标定分两步，每一步由操作员准备好场景之后再采集
+    const auto answer = QMessageBox::information(this, tr("Flat-Field Calibration (1/2)"),
+        tr("Switch off the illumination or cover the lens, then click OK to capture the dark frame."),
+        QMessageBox::Ok | QMessageBox::Cancel);
+    if (answer != QMessageBox::Ok) return;
+
+    m_flatFieldDark.release();
+    m_flatFieldCapture->capture();
+}
+
+void MainWindow::onFlatFieldCaptured(const cv::Mat& average, int bitDepth)
+{
+    // 第一步：保存暗场，提示准备平场
+    if (m_flatFieldDark.empty()) {
+        m_flatFieldDark = average;
+        const auto answer = QMessageBox::information(this, tr("Flat-Field Calibration (2/2)"),
+            tr("Switch on the backlight with no part in view, then click OK to capture the flat frame."),
+            QMessageBox::Ok | QMessageBox::Cancel);
+        if (answer != QMessageBox::Ok) {
+            m_flatFieldDark.release();
+            return;
+        }
+        m_flatFieldCapture->capture();
+        return;
+    }
+
+    // 第二步：生成校正表并保存
+    auto flatField = std::make_shared<InspectorLib::FlatFieldCorrection>();
+    const bool ok = flatField->calibrate(m_flatFieldDark, average, bitDepth);
+    m_flatFieldDark.release();
+    if (!ok) {
+        QMessageBox::warning(this, tr("Flat-Field Calibration"),
+            tr("The flat frame is not brighter than the dark frame. Check the illumination and try again."));
+        return;
+    }
+    if (!flatField->save(flatFieldPath().toStdString())) {
+        qWarning("Failed to save flat-field calibration to %s.", qPrintable(flatFieldPath()));
+    }
+
+    m_flatField = flatField;
+    m_flatFieldAction->setEnabled(true);
+    if (m_flatFieldAction->isChecked()) {
+        onFlatFieldToggled(true); // 已经启用时直接换上新表
+    } else {
+        m_flatFieldAction->setChecked(true);
+    }
+    qInfo("Flat-field calibration finished and saved to %s.", qPrintable(flatFieldPath()));
+}
+
+void MainWindow::onFlatFieldToggled(bool checked)
+{
+    InspectorLib::InspectOptions options = m_inspectorThread->inspectOptions();
+    options.flatField = checked ? m_flatField : nullptr;
+    m_inspectorThread->setInspectOptions(options);
+    qInfo("Flat-field correction %s.", checked ? "enabled" : "disabled");
+}
+
+QString MainWindow::calibrationPath() const
+{
+    return QCoreApplication::applicationDirPath() + "/calibration.yml";
+}
+
+void MainWindow::loadCalibration()
+{
+    if (!QFileInfo::exists(calibrationPath())) return;
+
+    auto calibration = std::make_shared<InspectorLib::CameraCalibration>();
+    if (!calibration->load(calibrationPath().toStdString())) {
+        qWarning("Failed to load camera calibration %s.", qPrintable(calibrationPath()));
+        return;
+    }
+    m_calibration = calibration;
+    m_calibrationAction->setEnabled(true);
+    m_calibrationAction->setChecked(true); // 有标定结果时默认启用
+    qInfo("Camera calibration loaded (%dx%d).", calibration->sensorSize().width, calibration->sensorSize().height);
+}
+
+void MainWindow::onCameraCalibrationRequested()
+{
+    // 1. 选择图像：先是用于求畸变的多张棋盘格图像，再是平放在检测平面上的一张
+    const QString imageFilter = tr("Image Files (*.png *.jpg *.bmp *.tif *.tiff)");
+    const QStringList boardFiles = QFileDialog::getOpenFileNames(this,
+        tr("Camera Calibration (1/2): Checkerboard Images"), "", imageFilter);
+    if (boardFiles.isEmpty()) return;
+    const QString planeFile = QFileDialog::getOpenFileName(this,
+        tr("Camera Calibration (2/2): Checkerboard Lying on the Inspection Plane"), QFileInfo(boardFiles.first()).absolutePath(), imageFilter);
+    if (planeFile.isEmpty()) return;
+
+    // 2. 棋盘格参数
+    bool ok = false;
+    const int columns = QInputDialog::getInt(this, tr("Camera Calibration"), tr("Inner corners per row:"), 9, 3, 100, 1, &ok);
+    if (!ok) return;
+    const int rows = QInputDialog::getInt(this, tr("Camera Calibration"), tr("Inner corners per column:"), 6, 3, 100, 1, &ok);
+    if (!ok) return;
+    const double squareSize = QInputDialog::getDouble(this, tr("Camera Calibration"), tr("Square size (mm):"), 5.0, 0.01, 1000.0, 3, &ok);
+    if (!ok) return;
+
+    // 3. 标定 (图像必须是整幅、不合并的)
+    std::vector<cv::Mat> boardImages;
+    for (const QString& file : boardFiles) {
+        cv::Mat image = cv::imread(file.toStdString(), cv::IMREAD_GRAYSCALE);
+        if (!image.empty()) boardImages.push_back(image);
+    }
+    const cv::Mat planeImage = cv::imread(planeFile.toStdString(), cv::IMREAD_GRAYSCALE);
+
+    auto calibration = std::make_shared<InspectorLib::CameraCalibration>();
+    double rmsError = 0.0;
+    if (!calibration->calibrate(boardImages, planeImage, cv::Size(columns, rows), static_cast<float>(squareSize), &rmsError)) {
+        QMessageBox::warning(this, tr("Camera Calibration"),
+            tr("The checkerboard was not found in enough images (at least 3 plus the plane image, all full-frame and the same size)."));
+        return;
+    }
+    if (!calibration->save(calibrationPath().toStdString())) {
+        qWarning("Failed to save camera calibration to %s.", qPrintable(calibrationPath()));
+    }
+
+    m_calibration = calibration;
+    m_calibrationAction->setEnabled(true);
+    if (m_calibrationAction->isChecked()) {
+        onCalibrationToggled(true); // 已经启用时直接换上新标定
+    } else {
+        m_calibrationAction->setChecked(true);
+    }
+    qInfo("Camera calibration finished (RMS reprojection error %.3f px) and saved to %s.", rmsError, qPrintable(calibrationPath()));
+}
+
+void MainWindow::onCalibrationToggled(bool checked)
+{
+    InspectorLib::InspectOptions options = m_inspectorThread->inspectOptions();
+    options.calibration = checked ? m_calibration : nullptr;
+    m_inspectorThread->setInspectOptions(options);
+    qInfo("Millimetre measurement %s.", checked ? "enabled" : "disabled");
+}
+
+QString MainWindow::shapeModelPath() const
+{
+    return QCoreApplication::applicationDirPath() + "/partmodel.yml";
+}
+
+void MainWindow::loadShapeModel()
+{
+    if (!QFileInfo::exists(shapeModelPath())) return;
+
+    auto model = std::make_shared<InspectorLib::ShapeModel>();
+    if (!model->load(shapeModelPath().toStdString())) {
+        qWarning("Failed to load part shape model %s.", qPrintable(shapeModelPath()));
+        return;
+    }
+    m_shapeModel = model;
+    m_shapeModelAction->setEnabled(true);
+    m_shapeModelAction->setChecked(true); // 有模型时默认启用
+    qInfo("Part shape model loaded (%dx%d, %d pyramid levels).", model->size().width, model->size().height, model->levels());
+}
+
+void MainWindow::onShapeModelTrainingRequested()
+{
+    // 金板图像的分辨率必须与检测时的图像相同 (Bayer 半分辨率检测时用半分辨率的图像)
+    const QString file = QFileDialog::getOpenFileName(this, tr("Train Part Model: Golden Image"), "",
+        tr("Image Files (*.png *.jpg *.bmp *.tif *.tiff)"));
+    if (file.isEmpty()) return;
+
+    const cv::Mat golden = cv::imread(file.toStdString(), cv::IMREAD_GRAYSCALE);
+    auto model = std::make_shared<InspectorLib::ShapeModel>();
+    if (golden.empty() || !model->train(golden, InspectorLib::ShapeModelOptions())) {
+        QMessageBox::warning(this, tr("Train Part Model"),
+            tr("Not enough edges were found in the golden image. Crop it to a single part with some background around it."));
+        return;
+    }
+    if (!model->save(shapeModelPath().toStdString())) {
+        qWarning("Failed to save part shape model to %s.", qPrintable(shapeModelPath()));
+    }
+
+    m_shapeModel = model;
+    m_shapeModelAction->setEnabled(true);
+    if (m_shapeModelAction->isChecked()) {
+        onShapeModelToggled(true); // 已经启用时直接换上新模型
+    } else {
+        m_shapeModelAction->setChecked(true);
+    }
+    qInfo("Part shape model trained (%d pyramid levels) and saved to %s.", model->levels(), qPrintable(shapeModelPath()));
+}
+
+void MainWindow::onShapeModelToggled(bool checked)
+{
+    InspectorLib::InspectOptions options = m_inspectorThread->inspectOptions();
+    options.shapeModel = checked ? m_shapeModel : nullptr;
+    m_inspectorThread->setInspectOptions(options);
+    qInfo("Shape-model part location %s.", checked ? "enabled" : "disabled");
+}
+
+QString MainWindow::nominalModelPath() const
+{
+    return QCoreApplication::applicationDirPath() + "/nominal.yml";
+}
+
+void MainWindow::loadNominalModel()
+{
+    if (!QFileInfo::exists(nominalModelPath())) return;
+
+    // 编译结果缓存在 nominal.yml.cache，模型没有换过时启动不再重新编译
+    auto model = std::make_shared<InspectorLib::NominalModel>();
+    if (!model->loadCached(nominalModelPath().toStdString(), (nominalModelPath() + ".cache").toStdString())) {
+        qWarning("Failed to load nominal model %s.", qPrintable(nominalModelPath()));
+        return;
+    }
+    m_nominalModel = model;
+    m_nominalAction->setEnabled(true);
+    m_nominalAction->setChecked(true); // 有模型时默认启用 (像素尺寸由相机标定得到，见 onNominalModelLoadRequested)
+    qInfo("Nominal model loaded (%.2f x %.2f mm, %zu loops).", model->size().width, model->size().height, model->loops().size());
+}
+
+void MainWindow::onNominalModelLoadRequested()
+{
+    // 1. 名义轮廓文件：NominalModel::save 的 YAML 格式，或客户图纸 (DXF)
+    const QString file = QFileDialog::getOpenFileName(this, tr("Load Nominal Model"), "",
+                                                      tr("Nominal Model (*.yml *.yaml *.dxf)"));
+    if (file.isEmpty()) return;
+
+    auto model = std::make_shared<InspectorLib::NominalModel>();
+    bool loaded = false;
+    if (file.endsWith(".dxf", Qt::CaseInsensitive)) {
+        // DXF：图框和尺寸通常在其他图层，只读取零件轮廓所在的图层
+        bool ok = false;
+        const QString layer = QInputDialog::getText(this, tr("Load Nominal Model"),
+            tr("Layer with the part geometry (empty = all layers):"), QLineEdit::Normal, "", &ok);
+        if (!ok) return;
+        std::vector<InspectorLib::NominalLoop> loops;
+        InspectorLib::DxfSummary summary;
+        loaded = InspectorLib::ReadDxf(file.toStdString(), layer.toStdString(), loops, &summary) && model->compile(loops);
+        qInfo("DXF %s: %d entities, %zu closed loops, %d open chains dropped, %d unsupported entities, unit scale %g.",
+              qPrintable(file), summary.entities, loops.size(), summary.openChains, summary.unsupported, summary.unitScale);
+    } else {
+        loaded = model->load(file.toStdString());
+    }
+    if (!loaded) {
+        QMessageBox::warning(this, tr("Load Nominal Model"), tr("The file does not contain a closed part outline."));
+        return;
+    }
+
+    // 2. 像素尺寸：0 表示由相机标定得到 (需要先启用毫米换算)
+    bool ok = false;
+    const double pixelSize = QInputDialog::getDouble(this, tr("Load Nominal Model"),
+        tr("Pixel size (mm per sensor pixel, 0 = use the camera calibration):"),
+        m_inspectorThread->inspectOptions().nominal.pixelSize, 0.0, 100.0, 5, &ok);
+    if (!ok) return;
+    if (!model->save(nominalModelPath().toStdString())) {
+        qWarning("Failed to save nominal model to %s.", qPrintable(nominalModelPath()));
+    }
+
+    InspectorLib::InspectOptions options = m_inspectorThread->inspectOptions();
+    options.nominal.pixelSize = static_cast<float>(pixelSize);
+    m_inspectorThread->setInspectOptions(options);
+
+    m_nominalModel = model;
+    m_nominalAction->setEnabled(true);
+    if (m_nominalAction->isChecked()) {
+        onNominalModelToggled(true); // 已经启用时直接换上新模型
+    } else {
+        m_nominalAction->setChecked(true);
+    }
+    qInfo("Nominal model loaded from %s (%.2f x %.2f mm, %zu features) and saved to %s.", qPrintable(file),
+          model->size().width, model->size().height, model->features().size(), qPrintable(nominalModelPath()));
+}
+
+void MainWindow::onNominalModelToggled(bool checked)
+{
+    InspectorLib::InspectOptions options = m_inspectorThread->inspectOptions();
+    options.nominal.model = checked ? m_nominalModel : nullptr;
+    m_inspectorThread->setInspectOptions(options);
+    if (checked && options.nominal.pixelSize <= 0.0f && !options.calibration) {
+        qWarning("Nominal comparison needs a pixel size or an enabled camera calibration; no deviation will be reported.");
+    }
+    qInfo("Nominal geometry comparison %s.", checked ? "enabled" : "disabled");
+}
+
+QString MainWindow::goldenModelPath() const
+{
+    return QCoreApplication::applicationDirPath() + "/golden.yml";
+}
+
+void MainWindow::loadGoldenModel()
+{
+    if (!QFileInfo::exists(goldenModelPath())) return;
+
+    auto model = std::make_shared<InspectorLib::GoldenModel>();
+    if (!model->load(goldenModelPath().toStdString())) {
+        qWarning("Failed to load golden part model %s.", qPrintable(goldenModelPath()));
+        return;
+    }
+    m_goldenModel = model;
+    m_goldenAction->setEnabled(true);
+    m_goldenAction->setChecked(true); // 有模型时默认启用
+    qInfo("Golden part model loaded (%d edge pixels).", model->edgeCount());
+}
+
+void MainWindow::onGoldenModelTrainingRequested()
+{
+    // 1. 金板图像：分辨率必须与检测时的图像相同 (Bayer 半分辨率检测时用半分辨率的图像)
+    const QString file = QFileDialog::getOpenFileName(this, tr("Train Golden Part: Golden Image"), "",
+        tr("Image Files (*.png *.jpg *.bmp *.tif *.tiff)"));
+    if (file.isEmpty()) return;
+
+    const cv::Mat golden = cv::imread(file.toStdString(), cv::IMREAD_GRAYSCALE);
+    auto model = std::make_shared<InspectorLib::GoldenModel>();
+    if (golden.empty() || !model->train(golden, InspectorLib::GoldenModelOptions())) {
+        QMessageBox::warning(this, tr("Train Golden Part"),
+            tr("No part with edges was found in the golden image."));
+        return;
+    }
+
+    // 2. 公差：边缘像素到金板边缘的最大距离
+    bool ok = false;
+    const double tolerance = QInputDialog::getDouble(this, tr("Train Golden Part"),
+        tr("Edge distance tolerance (pixels):"), m_inspectorThread->inspectOptions().golden.tolerance,
+        0.0, InspectorLib::GoldenModel::kMaxDistance, 1, &ok);
+    if (!ok) return;
+    if (!model->save(goldenModelPath().toStdString())) {
+        qWarning("Failed to save golden part model to %s.", qPrintable(goldenModelPath()));
+    }
+
+    InspectorLib::InspectOptions options = m_inspectorThread->inspectOptions();
+    options.golden.tolerance = static_cast<float>(tolerance);
+    m_inspectorThread->setInspectOptions(options);
+
+    m_goldenModel = model;
+    m_goldenAction->setEnabled(true);
+    if (m_goldenAction->isChecked()) {
+        onGoldenModelToggled(true); // 已经启用时直接换上新模型
+    } else {
+        m_goldenAction->setChecked(true);
+    }
+    qInfo("Golden part model trained (%d edge pixels) and saved to %s.", model->edgeCount(), qPrintable(goldenModelPath()));
+}
+
+void MainWindow::onGoldenModelToggled(bool checked)
+{
+    InspectorLib::InspectOptions options = m_inspectorThread->inspectOptions();
+    options.golden.model = checked ? m_goldenModel : nullptr;
+    m_inspectorThread->setInspectOptions(options);
+    qInfo("Golden part comparison %s.", checked ? "enabled" : "disabled");
+}
+
+void MainWindow::onCircleFitSelected(int method)
+{
+    InspectorLib::InspectOptions options = m_inspectorThread->inspectOptions();
+    options.circleFit = static_cast<InspectorLib::CircleFitMethod>(method);
+    m_inspectorThread->setInspectOptions(options);
+    qInfo("Hole circle fit: %s.", InspectorLib::CircleFitMethodName(options.circleFit));
+}
+
+void MainWindow::onThresholdMethodSelected(int method)
+{
+    InspectorLib::InspectOptions options = m_inspectorThread->inspectOptions();
+    options.thresholdMethod = static_cast<InspectorLib::ThresholdMethod>(method);
+    if (options.thresholdMethod == InspectorLib::Threshold_Fixed) {
+        options.thresholdTracker.reset();
+    } else {
+        // 切换方式时重新开始统计，旧的直方图对应的可能是另一种光照
+        options.thresholdTracker = std::make_shared<InspectorLib::AutoThreshold>();
+    }
+    m_inspectorThread->setInspectOptions(options);
+    qInfo("Binarisation threshold: %s.", InspectorLib::ThresholdMethodName(options.thresholdMethod));
+}
+
+void MainWindow::onStationRequested()
+{
+    // 工位窗口关闭时只是隐藏，相机保持连接；主窗口销毁时随之销毁
+    if (m_stationWindow == nullptr) {
+        m_stationWindow = new StationWindow(QCoreApplication::applicationDirPath() + "/station.ini", this);
+    }
+    m_stationWindow->show();
+    m_stationWindow->raise();
+    m_stationWindow->activateWindow();
 }
@@ -5,7 +5,9 @@
 
 #include <QMainWindow> // QMainWindow是Qt应用程序主窗口的标准基类
 #include <QImage>
+#include <memory>
 #include "Inspector.h" // 包含后端库头文件，以使用MeasurementResults
+#include "Core/FrameTrace.h" // 每一帧的追踪上下文
 
 // --- 前向声明 (Forward Declarations) ---
 // 解释: 在头文件中，我们只需要知道这些类的“名字”即可声明它们的指针。
@@ -19,7 +21,13 @@ class InspectPanel;
 class CameraPanel;
 class InspectorThread;
 class CameraManager;
+class MetricsServer;
+class LatencyStatsDialog;
+class StationWindow;
 class QSplitter;
+class QAction;
+class FlatFieldCapture;
+namespace InspectorLib { class FlatFieldCorrection; class CameraCalibration; class ShapeModel; class NominalModel; class GoldenModel; }
 
 /**
  * @class MainWindow
@@ -75,8 +83,9 @@ private slots:
      * @brief 当后台测量成功完成时，此槽函数被调用。
      * @param results 测量结果数据包。
      * @param resultImage 带有可视化标记的结果图。
+     * @param trace 这一帧的追踪上下文 (已包含测量各阶段的耗时)。
      */
-    void onInspectionFinished(const InspectorLib::MeasurementResults& results, const QImage& resultImage);
+    void onInspectionFinished(const InspectorLib::MeasurementResults& results, const QImage& resultImage, const FrameTrace& trace);
 
     /**
      * @brief 当后台测量发生错误时，此槽函数被调用。
@@ -84,30 +93,147 @@ private slots:
      */
     void onInspectionError(const QString& message);
 
+    /**
+     * @brief 质量预检拒绝了这一帧：只在状态栏和日志中提示原因，不弹出对话框。
+     * @param reason 拒绝原因。
+     */
+    void onFrameRejected(const QString& reason);
+
     // --- 响应来自相机管理器 CameraManager 的信号 ---
 
     void onDeviceListUpdated(const QStringList& deviceList);
     void onConnectionStatusChanged(bool connected, const QString& message);
-    void onNewFrameReady(const cv::Mat& frame); // 当相机传来新的一帧图像时被调用
+    void onNewFrameReady(const cv::Mat& frame, const FrameTrace& trace); // 当相机传来新的一帧图像时被调用
+
+    // --- 响应菜单操作 ---
+
+    /**
+     * @brief 把最近的帧追踪导出为 Chrome/Perfetto 可以打开的 JSON 文件。
+     */
+    void onExportTraceRequested();
+
+    /**
+     * @brief 打开耗时统计窗口 (各阶段/各结果的 p50 ~ p99.9)。
+     */
+    void onLatencyStatsRequested();
+
+    /**
+     * @brief 打开多相机工位窗口 (配置文件为程序目录下的 station.ini)。
+     */
+    void onStationRequested();
+
+    /**
+     * @brief 打开/关闭相机端ROI跟踪：只传输上一个零件附近的区域，定期采集整幅。
+     */
+    void onRoiTrackingToggled(bool checked);
+
+    /**
+     * @brief 平场标定：依次采集暗场和平场 (各平均多帧)，生成校正表并保存到程序目录下的 flatfield.yml。
+     */
+    void onFlatFieldCalibrationRequested();
+    void onFlatFieldCaptured(const cv::Mat& average, int bitDepth);
+
+    /**
+     * @brief 打开/关闭平场校正 (校正融合在二值化中，不额外遍历图像)。
+     */
+    void onFlatFieldToggled(bool checked);
+
+    /**
+     * @brief 相机标定：选择棋盘格图像和平放在检测平面上的棋盘格图像，求畸变和毫米换算，保存到程序目录下的 calibration.yml。
+     */
+    void onCameraCalibrationRequested();
+
+    /**
+     * @brief 打开/关闭毫米换算 (只换算测量结果中的点，不对图像去畸变)。
+     */
+    void onCalibrationToggled(bool checked);
+
+    /**
+     * @brief 训练形状模型：选择一张金板图像 (只包含一个摆正的零件)，训练后保存到程序目录下的 partmodel.yml。
+     */
+    void onShapeModelTrainingRequested();
+
+    /**
+     * @brief 打开/关闭形状模板匹配定位 (先用模型定位零件，再在模型区域内找轮廓)。
+     */
+    void onShapeModelToggled(bool checked);
+
+    /**
+     * @brief 加载名义几何模型 (YAML 或 DXF 图纸) 并输入像素尺寸，保存到程序目录下的 nominal.yml。
+     */
+    void onNominalModelLoadRequested();
+
+    /**
+     * @brief 打开/关闭与名义几何的比较 (外形和内孔的偏差、毛刺和缺料)。
+     */
+    void onNominalModelToggled(bool checked);
+
+    /**
+     * @brief 训练金板模型：选择一张金板图像，提取零件边缘并做距离变换，保存到程序目录下的 golden.yml。
+     */
+    void onGoldenModelTrainingRequested();
+
+    /**
+     * @brief 打开/关闭与金板的比较 (边缘的 chamfer 距离和局部偏差热力图)。
+     */
+    void onGoldenModelToggled(bool checked);
+
+    /**
+     * @brief 切换二值化阈值的选取方式 (固定 / 大津法 / 三角法)。
+     */
+    void onThresholdMethodSelected(int method);
+
+    /**
+     * @brief 切换圆孔的拟合方法 (最小外接圆 / Kasa / Taubin / Hyper)。
+     */
+    void onCircleFitSelected(int method);
 
 private:
     // --- 私有辅助函数 ---
     void setupUi();           // 负责创建和布局所有UI控件
     void setupConnections();  // 负责连接所有模块的信号与槽
+    void setupMenus();        // 负责创建菜单栏
+    void loadFlatField();     // 启动时加载上次保存的平场校正表
+    QString flatFieldPath() const;
+    void loadCalibration();   // 启动时加载上次保存的相机标定
+    QString calibrationPath() const;
+    void loadShapeModel();    // 启动时加载上次训练的形状模型
+    QString shapeModelPath() const;
+    void loadNominalModel();  // 启动时加载上次使用的名义模型
+    QString nominalModelPath() const;
+    void loadGoldenModel();   // 启动时加载上次训练的金板模型
+    QString goldenModelPath() const;
 
     // --- 核心数据成员 ---
     QString m_currentImagePath; // 存储当前从文件加载的图片路径
     cv::Mat m_currentCvImage;   // 存储当前加载或由相机采集的OpenCV格式图像，用于传递给测量线程
+    FrameTrace m_currentTrace;  // 当前图像的追踪上下文，测量时随图像一起交给测量线程
 
     // --- 后台逻辑对象指针 ---
     InspectorThread* m_inspectorThread; // 后台测量线程
-    CameraManager* m_cameraManager;     // 相机硬件管理器
+    CameraManager* m_cameraManager;     // 相机硬件管理器 (自带命令线程，所有调用都是异步的)
+    MetricsServer* m_metricsServer;     // 本机 HTTP 指标接口 (/metrics)
 
     // --- UI控件成员指针 ---
     // 左侧面板
     CameraPanel* m_cameraPanel;     // 相机控制面板
     InspectPanel* m_inspectPanel;   // 检测控制面板
     LogWidget* m_logWidget;         // 日志显示窗口
+    LatencyStatsDialog* m_latencyStatsDialog = nullptr; // 耗时统计窗口 (第一次打开时才创建)
+    StationWindow* m_stationWindow = nullptr;           // 多相机工位窗口 (第一次打开时才创建)
+    QAction* m_roiTrackingAction = nullptr;             // “相机端ROI跟踪”菜单项
+    QAction* m_flatFieldAction = nullptr;               // “平场校正”菜单项 (有校正表之后才可用)
+    FlatFieldCapture* m_flatFieldCapture = nullptr;     // 平场标定的多帧采集
+    cv::Mat m_flatFieldDark;                            // 标定过程中已经采集的暗场 (为空表示正在采集暗场)
+    std::shared_ptr<const InspectorLib::FlatFieldCorrection> m_flatField; // 当前的平场校正表
+    QAction* m_calibrationAction = nullptr;             // “毫米换算”菜单项 (有标定之后才可用)
+    std::shared_ptr<const InspectorLib::CameraCalibration> m_calibration; // 当前的相机标定
+    QAction* m_shapeModelAction = nullptr;              // “形状模型定位”菜单项 (有模型之后才可用)
+    std::shared_ptr<const InspectorLib::ShapeModel> m_shapeModel; // 当前的形状模型
+    QAction* m_nominalAction = nullptr;                 // “与名义几何比较”菜单项 (有名义模型之后才可用)
+    std::shared_ptr<const InspectorLib::NominalModel> m_nominalModel; // 当前的名义模型
+    QAction* m_goldenAction = nullptr;                  // “与金板比较”菜单项 (有金板模型之后才可用)
+    std::shared_ptr<const InspectorLib::GoldenModel> m_goldenModel; // 当前的金板模型
     QSplitter* m_leftSplitter;      // 用于上下分割左侧三个面板
 
     // 右侧显示区
@@ -0,0 +1,183 @@
+﻿// AutoThreshold.cpp
+
+#include "AutoThreshold.h"
+#include "PixelFormat.h"
+
+#include <cctype>
+#include <cstring>
+
+namespace InspectorLib
+{
+    const char* INSPECTOR_API ThresholdMethodName(ThresholdMethod method)
+    {
+        static const char* const names[Threshold_Count] = { "fixed", "otsu", "triangle" };
+        return (method >= 0 && method < Threshold_Count) ? names[method] : "unknown";
+    }
+
+    bool INSPECTOR_API ParseThresholdMethod(const char* name, ThresholdMethod& method)
+    {
+        if (name == nullptr) return false;
+        for (int i = 0; i < Threshold_Count; ++i)
+        {
+            const char* candidate = ThresholdMethodName(static_cast<ThresholdMethod>(i));
+            size_t k = 0;
+            while (name[k] != '\0' && std::tolower(static_cast<unsigned char>(name[k])) == candidate[k]) ++k;
+            if (name[k] == '\0' && candidate[k] == '\0') {
+                method = static_cast<ThresholdMethod>(i);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    AutoThreshold::AutoThreshold()
+    {
+        resetLocked();
+    }
+
+    void AutoThreshold::resetLocked()
+    {
+        std::memset(m_phaseHistograms, 0, sizeof(m_phaseHistograms));
+        std::memset(m_histogram, 0, sizeof(m_histogram));
+        m_nextPhase = 0;
+        m_threshold = -1;
+        m_frameSize = cv::Size();
+        m_format = PixelFormat_Mono8;
+    }
+
+    void AutoThreshold::reset()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        resetLocked();
+    }
+
+    int AutoThreshold::threshold() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_threshold;
+    }
+
+    int AutoThreshold::update(const cv::Mat& rawImage, PixelFormat format, ThresholdMethod method)
+    {
+        // 1. 在锁外采样 (只读图像，不涉及共享状态)
+        uint32_t sample[256] = {};
+        std::unique_lock<std::mutex> lock(m_mutex);
+        const int phase = m_nextPhase;
+        lock.unlock();
+        if (SampleHistogram(rawImage, format, kPhaseCount, phase, sample) <= 0) return threshold();
+
+        // 2. 用新的采样替换同一相位的旧统计
+        lock.lock();
+        if (rawImage.size() != m_frameSize || format != m_format)
+        {
+            const int keepThreshold = m_threshold; // 尺寸改变 (例如切换相机端ROI) 时保留上一次的阈值作为后备
+            resetLocked();
+            m_threshold = keepThreshold;
+            m_frameSize = rawImage.size();
+            m_format = format;
+        }
+        uint32_t* old = m_phaseHistograms[phase];
+        for (int b = 0; b < 256; ++b)
+        {
+            m_histogram[b] += sample[b];
+            m_histogram[b] -= old[b];
+            old[b] = sample[b];
+        }
+        m_nextPhase = (phase + 1) % kPhaseCount;
+
+        // 3. 计算阈值 (只有256个 bin，开销可以忽略)
+        const int t = FromHistogram(m_histogram, method);
+        if (t >= 0) m_threshold = t;
+        return m_threshold;
+    }
+
+    int AutoThreshold::Compute(const cv::Mat& rawImage, PixelFormat format, ThresholdMethod method)
+    {
+        uint32_t sample[256] = {};
+        if (SampleHistogram(rawImage, format, 1, 0, sample) <= 0) return -1;
+        uint64_t histogram[256];
+        for (int b = 0; b < 256; ++b) histogram[b] = sample[b];
+        return FromHistogram(histogram, method);
+    }
+
+    int AutoThreshold::FromHistogram(const uint64_t* histogram, ThresholdMethod method)
+    {
+        switch (method)
+        {
+        case Threshold_Otsu: return Otsu(histogram);
+        case Threshold_Triangle: return Triangle(histogram);
+        default: return -1;
+        }
+    }
+
+    // 大津法：选取 t 使 [0, t] 和 (t, 255] 两类的类间方差 w0 * w1 * (m0 - m1)^2 最大
+    int AutoThreshold::Otsu(const uint64_t* histogram)
+    {
+        double total = 0.0, sum = 0.0;
+        int levels = 0;
+        for (int b = 0; b < 256; ++b)
+        {
+            total += static_cast<double>(histogram[b]);
+            sum += static_cast<double>(b) * histogram[b];
+            if (histogram[b] != 0) ++levels;
+        }
+        if (levels < 2) return -1;
+
+        // 【注意】两个峰完全分开时，两峰之间的空白处方差都相同；取这一段的中点而不是第一个，
+        //        光照漂移时阈值离两个峰都最远
+        double w0 = 0.0, sum0 = 0.0, bestVariance = -1.0;
+        int bestLow = -1, bestHigh = -1;
+        for (int t = 0; t < 255; ++t)
+        {
+            w0 += static_cast<double>(histogram[t]);
+            sum0 += static_cast<double>(t) * histogram[t];
+            const double w1 = total - w0;
+            if (w0 == 0.0 || w1 == 0.0) continue;
+            const double diff = sum0 / w0 - (sum - sum0) / w1;
+            const double variance = w0 * w1 * diff * diff;
+            if (variance > bestVariance * (1.0 + 1e-12)) {
+                bestVariance = variance;
+                bestLow = bestHigh = t;
+            }
+            else if (variance >= bestVariance * (1.0 - 1e-12) && bestHigh == t - 1) {
+                bestHigh = t;
+            }
+        }
+        return (bestLow + bestHigh) / 2;
+    }
+
+    // 三角法：从直方图的峰向较远的一端连一条直线，阈值取直方图离这条直线最远的位置
+    int AutoThreshold::Triangle(const uint64_t* histogram)
+    {
+        int left = 0, right = 255, peak = 0;
+        while (left < 256 && histogram[left] == 0) ++left;
+        while (right >= 0 && histogram[right] == 0) --right;
+        if (left >= right) return -1;
+        for (int b = left; b <= right; ++b) {
+            if (histogram[b] > histogram[peak]) peak = b;
+        }
+
+        // 峰离右端更近时，在镜像的直方图上计算 (统一为“峰在左、长尾在右”)
+        const bool flip = (peak - left) > (right - peak);
+        auto at = [histogram, flip](int b) { return static_cast<double>(histogram[flip ? 255 - b : b]); };
+        const int p = flip ? 255 - peak : peak;
+        const int end = flip ? 255 - left : right;
+
+        // 直线 (p, h[p]) -> (end, 0)，各点到直线的距离与 h[p] * (end - b) - (end - p) * h[b] 成正比
+        const double height = at(p);
+        const double span = end - p;
+        double bestDistance = -1.0;
+        int best = p;
+        for (int b = p + 1; b <= end; ++b)
+        {
+            const double distance = height * (end - b) - span * at(b);
+            if (distance > bestDistance) {
+                bestDistance = distance;
+                best = b;
+            }
+        }
+        // 阈值取在三角形的顶点处，镜像时换算回来 (value > 阈值 的一侧始终是长尾)
+        return flip ? 255 - best - 1 : best;
+    }
+
+} // namespace InspectorLib
@@ -0,0 +1,85 @@
+﻿// AutoThreshold.h (自动二值化阈值：大津法 / 三角法，直方图在稀疏网格上增量统计)
+
+#ifndef INSPECTOR_AUTOTHRESHOLD_H
+#define INSPECTOR_AUTOTHRESHOLD_H
+
+#include "Inspector.h" // INSPECTOR_API、PixelFormat、ThresholdMethod
+
+#include <cstdint>
+#include <mutex>
+
+namespace InspectorLib
+{
+    /**
+     * @brief 返回阈值方法的英文名称 ("fixed"、"otsu"、"triangle"，用于日志和配置文件)。
+     */
+    const char* INSPECTOR_API ThresholdMethodName(ThresholdMethod method);
+
+    /**
+     * @brief 由名称查找阈值方法 (不区分大小写)，未知的名称返回 false。
+     */
+    bool INSPECTOR_API ParseThresholdMethod(const char* name, ThresholdMethod& method);
+
+    /**
+     * @brief 连续检测时的自动阈值：直方图在多帧之间增量更新，阈值跟随光照的缓慢变化。
+     *
+     * @details 采样网格 (见 SampleHistogram) 按行分成 kPhaseCount 个相位，每一帧只采样其中一个相位，
+     * 约为整幅像素的 1/256，比一次二值化扫描便宜得多。每个相位的直方图单独保存，
+     * 新的一帧替换掉同一相位 kPhaseCount 帧之前的统计，所以总直方图始终是最近 kPhaseCount 帧的滑动窗口：
+     * 既有足够的样本，又能在几十帧之内跟上光照的变化。
+     * 图像尺寸或像素格式改变时自动重新开始统计。
+     *
+     * 所有函数都有锁保护，同一个对象可以在多个测量线程之间共享 (通常每台相机一个)。
+     */
+    class INSPECTOR_API AutoThreshold
+    {
+    public:
+        static const int kPhaseCount = 16; // 采样网格的相位数 (即采样的行间隔)
+
+        AutoThreshold();
+
+        /**
+         * @brief 采样这一帧的一个相位，更新直方图，返回新的阈值 (8位刻度)。
+         * @return 直方图不足以确定阈值时返回上一次的结果，从来没有成功过时返回 -1。
+         */
+        int update(const cv::Mat& rawImage, PixelFormat format, ThresholdMethod method);
+
+        /**
+         * @brief 最近一次的阈值，没有时返回 -1。
+         */
+        int threshold() const;
+
+        /**
+         * @brief 清空统计 (例如更换了光源或零件型号)。
+         */
+        void reset();
+
+        /**
+         * @brief 单帧的自动阈值：一次采样整个网格 (约为整幅像素的 1/4)。
+         * @return 阈值 (8位刻度)；无法确定时返回 -1。
+         */
+        static int Compute(const cv::Mat& rawImage, PixelFormat format, ThresholdMethod method);
+
+        /**
+         * @brief 在256个 bin 的直方图上计算阈值 (二值化规则为 value > 阈值)。
+         * @return 直方图中少于两种灰度时返回 -1。
+         */
+        static int FromHistogram(const uint64_t* histogram, ThresholdMethod method);
+        static int Otsu(const uint64_t* histogram);
+        static int Triangle(const uint64_t* histogram);
+
+    private:
+        void resetLocked();
+
+        mutable std::mutex m_mutex;
+        uint32_t m_phaseHistograms[kPhaseCount][256]; // 每个相位最近一次的统计
+        uint64_t m_histogram[256];                    // 所有相位之和
+        int m_nextPhase;
+        int m_threshold;
+        cv::Size m_frameSize; // 统计对应的图像尺寸和格式，改变时重新开始
+        PixelFormat m_format;
+    };
+
+} // namespace InspectorLib
+
+#endif // INSPECTOR_AUTOTHRESHOLD_H
@@ -0,0 +1,233 @@
+﻿// Calibration.cpp
+
+#include "Calibration.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace InspectorLib
+{
+    namespace
+    {
+        // 棋盘格内角点的毫米坐标 (z = 0)，按 findChessboardCorners 的顺序逐行排列
+        std::vector<cv::Point3f> BoardPoints(const cv::Size& patternSize, float squareSizeMm)
+        {
+            std::vector<cv::Point3f> points;
+            for (int r = 0; r < patternSize.height; ++r) {
+                for (int c = 0; c < patternSize.width; ++c) {
+                    points.emplace_back(c * squareSizeMm, r * squareSizeMm, 0.0f);
+                }
+            }
+            return points;
+        }
+
+        bool FindCorners(const cv::Mat& image, const cv::Size& patternSize, std::vector<cv::Point2f>& corners)
+        {
+            if (image.empty() || image.type() != CV_8UC1) return false;
+            if (!cv::findChessboardCorners(image, patternSize, corners,
+                    cv::CALIB_CB_ADAPTIVE_THRESH | cv::CALIB_CB_NORMALIZE_IMAGE)) return false;
+            cv::cornerSubPix(image, corners, cv::Size(11, 11), cv::Size(-1, -1),
+                cv::TermCriteria(cv::TermCriteria::EPS + cv::TermCriteria::COUNT, 30, 0.01));
+            return true;
+        }
+
+        float Distance(const cv::Point2f& a, const cv::Point2f& b)
+        {
+            return std::hypot(a.x - b.x, a.y - b.y);
+        }
+
+        // Feret 尺寸按局部比例换算为毫米 (各项都是长度；角度的微小变化忽略)
+        FeretResult ScaleFeret(const FeretResult& feret, float s)
+        {
+            FeretResult mm = feret;
+            mm.maxDiameter *= s;
+            mm.minDiameter *= s;
+            mm.maxInscribed *= s;
+            for (float& width : mm.widths) width *= s;
+            return mm;
+        }
+    }
+
+    bool CameraCalibration::calibrate(const std::vector<cv::Mat>& images, const cv::Mat& planeImage,
+        const cv::Size& patternSize, float squareSizeMm, double* rmsError)
+    {
+        if (images.size() < 3 || planeImage.empty() || squareSizeMm <= 0.0f) return false;
+        const cv::Size imageSize = planeImage.size();
+
+        // 1. 内参和畸变系数：所有找到角点的图像都参与
+        const std::vector<cv::Point3f> board = BoardPoints(patternSize, squareSizeMm);
+        std::vector<std::vector<cv::Point3f>> objectPoints;
+        std::vector<std::vector<cv::Point2f>> imagePoints;
+        for (const cv::Mat& image : images)
+        {
+            std::vector<cv::Point2f> corners;
+            if (image.size() != imageSize || !FindCorners(image, patternSize, corners)) continue;
+            objectPoints.push_back(board);
+            imagePoints.push_back(corners);
+        }
+        if (imagePoints.size() < 3) return false;
+
+        cv::Mat cameraMatrix, distCoeffs;
+        std::vector<cv::Mat> rvecs, tvecs;
+        const double rms = cv::calibrateCamera(objectPoints, imagePoints, imageSize, cameraMatrix, distCoeffs, rvecs, tvecs);
+
+        // 2. 检测平面的单应性：去畸变之后的像素坐标 (仍以像素为单位，P = K) -> 毫米坐标
+        std::vector<cv::Point2f> planeCorners, undistorted;
+        if (!FindCorners(planeImage, patternSize, planeCorners)) return false;
+        cv::undistortPoints(planeCorners, undistorted, cameraMatrix, distCoeffs, cv::noArray(), cameraMatrix);
+        std::vector<cv::Point2f> boardMm;
+        for (const cv::Point3f& p : board) boardMm.emplace_back(p.x, p.y);
+        cv::Mat homography = cv::findHomography(undistorted, boardMm);
+        if (homography.empty()) return false;
+
+        m_sensorSize = imageSize;
+        m_cameraMatrix = cameraMatrix;
+        m_distCoeffs = distCoeffs;
+        m_homography = homography;
+        if (rmsError) *rmsError = rms;
+        return buildLut();
+    }
+
+    bool CameraCalibration::buildLut()
+    {
+        // 节点覆盖整个传感器 (最后一个节点可以超出边缘)，一次性换算所有节点
+        const int cols = (m_sensorSize.width - 1 + kLutStep - 1) / kLutStep + 1;
+        const int rows = (m_sensorSize.height - 1 + kLutStep - 1) / kLutStep + 1;
+        if (cols < 2 || rows < 2) return false;
+
+        std::vector<cv::Point2f> nodes, undistorted, mm;
+        nodes.reserve(cols * rows);
+        for (int i = 0; i < rows; ++i) {
+            for (int j = 0; j < cols; ++j) nodes.emplace_back(static_cast<float>(j * kLutStep), static_cast<float>(i * kLutStep));
+        }
+        cv::undistortPoints(nodes, undistorted, m_cameraMatrix, m_distCoeffs, cv::noArray(), m_cameraMatrix);
+        cv::perspectiveTransform(undistorted, mm, m_homography);
+
+        m_lut.create(rows, cols, CV_32FC2);
+        for (int i = 0; i < rows; ++i) {
+            cv::Point2f* row = m_lut.ptr<cv::Point2f>(i);
+            for (int j = 0; j < cols; ++j) row[j] = mm[i * cols + j];
+        }
+        return true;
+    }
+
+    bool CameraCalibration::save(const std::string& path) const
+    {
+        if (!isValid()) return false;
+        cv::FileStorage fs(path, cv::FileStorage::WRITE);
+        if (!fs.isOpened()) return false;
+        fs << "sensorWidth" << m_sensorSize.width;
+        fs << "sensorHeight" << m_sensorSize.height;
+        fs << "cameraMatrix" << m_cameraMatrix;
+        fs << "distCoeffs" << m_distCoeffs;
+        fs << "homography" << m_homography;
+        return true;
+    }
+
+    bool CameraCalibration::load(const std::string& path)
+    {
+        cv::FileStorage fs(path, cv::FileStorage::READ);
+        if (!fs.isOpened()) return false;
+
+        int width = 0, height = 0;
+        cv::Mat cameraMatrix, distCoeffs, homography;
+        fs["sensorWidth"] >> width;
+        fs["sensorHeight"] >> height;
+        fs["cameraMatrix"] >> cameraMatrix;
+        fs["distCoeffs"] >> distCoeffs;
+        fs["homography"] >> homography;
+        if (width <= 0 || height <= 0 || cameraMatrix.empty() || homography.empty()) return false;
+
+        m_sensorSize = cv::Size(width, height);
+        m_cameraMatrix = cameraMatrix;
+        m_distCoeffs = distCoeffs;
+        m_homography = homography;
+        return buildLut();
+    }
+
+    cv::Point2f CameraCalibration::toMillimetres(const cv::Point2f& sensorPoint) const
+    {
+        // 所在的格子 (超出传感器的点用边上的格子线性外推)
+        const float gx = sensorPoint.x / kLutStep;
+        const float gy = sensorPoint.y / kLutStep;
+        const int j = std::max(0, std::min(m_lut.cols - 2, static_cast<int>(std::floor(gx))));
+        const int i = std::max(0, std::min(m_lut.rows - 2, static_cast<int>(std::floor(gy))));
+        const float fx = gx - j;
+        const float fy = gy - i;
+
+        const cv::Point2f* top = m_lut.ptr<cv::Point2f>(i);
+        const cv::Point2f* bottom = m_lut.ptr<cv::Point2f>(i + 1);
+        const cv::Point2f upper = top[j] * (1.0f - fx) + top[j + 1] * fx;
+        const cv::Point2f lower = bottom[j] * (1.0f - fx) + bottom[j + 1] * fx;
+        return upper * (1.0f - fy) + lower * fy;
+    }
+
+    void CameraCalibration::toMillimetres(std::vector<cv::Point2f>& points) const
+    {
+        for (cv::Point2f& p : points) p = toMillimetres(p);
+    }
+
+    void CameraCalibration::apply(MeasurementResults& results, const cv::Point2f& offset, float scale) const
+    {
+        MetricResults& metric = results.metric;
+        metric = MetricResults();
+        if (!isValid()) return;
+
+        // 子图坐标 -> 传感器坐标 -> 毫米
+        auto toMm = [this, &offset, scale](const cv::Point2f& p) {
+            return toMillimetres(cv::Point2f(p.x * scale + offset.x, p.y * scale + offset.y));
+        };
+        // 某一点附近的局部比例 (mm / 子图像素)：横竖两个方向的平均
+        auto localScale = [&toMm](const cv::Point2f& c) {
+            const float dx = Distance(toMm(c + cv::Point2f(1.0f, 0.0f)), toMm(c - cv::Point2f(1.0f, 0.0f)));
+            const float dy = Distance(toMm(c + cv::Point2f(0.0f, 1.0f)), toMm(c - cv::Point2f(0.0f, 1.0f)));
+            return (dx + dy) / 4.0f;
+        };
+
+        // 1. 外接矩形：换算四个顶点 (points 的顺序为左下、左上、右上、右下，0-1 边为 height，1-2 边为 width)
+        cv::Point2f vertices[4];
+        results.boundingBox.points(vertices);
+        for (cv::Point2f& v : vertices) v = toMm(v);
+        const cv::Point2f widthEdge = vertices[2] - vertices[1];
+        metric.boundingBox = cv::RotatedRect(toMm(results.boundingBox.center),
+            cv::Size2f(Distance(vertices[2], vertices[1]), Distance(vertices[1], vertices[0])),
+            static_cast<float>(std::atan2(widthEdge.y, widthEdge.x) * 180.0 / CV_PI));
+
+        metric.feret = ScaleFeret(results.feret, localScale(results.boundingBox.center));
+
+        // 2. 圆孔：圆心换算，半径取圆心处四个方向的平均
+        for (const CircleResult& circle : results.circles)
+        {
+            CircleResult mm;
+            mm.center = toMm(circle.center);
+            const float r = circle.radius;
+            mm.radius = (Distance(toMm(circle.center + cv::Point2f(r, 0.0f)), mm.center)
+                       + Distance(toMm(circle.center - cv::Point2f(r, 0.0f)), mm.center)
+                       + Distance(toMm(circle.center + cv::Point2f(0.0f, r)), mm.center)
+                       + Distance(toMm(circle.center - cv::Point2f(0.0f, r)), mm.center)) / 4.0f;
+            mm.feret = ScaleFeret(circle.feret, localScale(circle.center));
+            metric.circles.push_back(mm);
+        }
+
+        // 3. 槽口：中心换算，长宽和圆弧半径按中心处的局部比例，角度取长度方向换算之后的方向
+        for (const SlotResult& slot : results.slotResults)
+        {
+            const float s = localScale(slot.center);
+            const double rad = slot.angle * CV_PI / 180.0;
+            const cv::Point2f axis(static_cast<float>(std::cos(rad)), static_cast<float>(std::sin(rad)));
+            const cv::Point2f mappedAxis = toMm(slot.center + axis) - toMm(slot.center - axis);
+            SlotResult mm;
+            mm.center = toMm(slot.center);
+            mm.length = slot.length * s;
+            mm.width = slot.width * s;
+            mm.angle = static_cast<float>(std::atan2(mappedAxis.y, mappedAxis.x) * 180.0 / CV_PI);
+            mm.arcRadius[0] = slot.arcRadius[0] * s;
+            mm.arcRadius[1] = slot.arcRadius[1] * s;
+            mm.feret = ScaleFeret(slot.feret, s);
+            metric.slotResults.push_back(mm);
+        }
+
+        metric.valid = true;
+    }
+
+} // namespace InspectorLib
@@ -0,0 +1,78 @@
+﻿// Calibration.h (相机标定：镜头畸变 + 检测平面的单应性，测量结果换算为毫米)
+
+#ifndef INSPECTOR_CALIBRATION_H
+#define INSPECTOR_CALIBRATION_H
+
+#include "Inspector.h" // INSPECTOR_API、MeasurementResults、MetricResults
+
+#include <string>
+#include <vector>
+
+namespace InspectorLib
+{
+    /**
+     * @brief 相机标定：把传感器像素坐标换算为检测平面上的毫米坐标，同时去除镜头畸变。
+     *
+     * @details 标定时使用多张棋盘格图像求相机内参和畸变系数 (cv::calibrateCamera)，
+     * 再用一张棋盘格平放在检测平面上的图像求单应性 H：去畸变之后的像素坐标 -> 平面上的毫米坐标。
+     *
+     * 【关键】检测时并不对整幅图像做 cv::undistort/remap：只有测量结果中的几个到几千个点需要换算。
+     * 换算用一张稀疏的查找表 (每隔 kLutStep 个传感器像素一个节点，节点上预先算好“去畸变 + H”的结果)，
+     * 节点之间双线性插值。畸变是缓慢变化的，插值误差远小于边缘定位的误差。
+     *
+     * 标定必须在整幅、不合并的图像上进行；换算的输入是传感器坐标 (相机端ROI和合并由 apply 的参数换算)。
+     * 标定之后对象只读，可以被多个测量线程共享。
+     */
+    class INSPECTOR_API CameraCalibration
+    {
+    public:
+        static const int kLutStep = 16; // 查找表的节点间距 (传感器像素)
+
+        /**
+         * @brief 由棋盘格图像标定。
+         * @param images 用于求内参的棋盘格图像 (CV_8UC1，至少3张，角度和位置尽量分散，尺寸相同)。
+         * @param planeImage 棋盘格平放在检测平面上的图像，定义毫米坐标系 (原点为第一个内角点)。
+         * @param patternSize 棋盘格内角点的列数和行数 (例如 9 x 6)。
+         * @param squareSizeMm 棋盘格方格的边长 (mm)。
+         * @param rmsError 不为 nullptr 时输出重投影误差 (像素)。
+         * @return 找不到角点或图像太少时返回 false，原有的标定保持不变。
+         */
+        bool calibrate(const std::vector<cv::Mat>& images, const cv::Mat& planeImage,
+            const cv::Size& patternSize, float squareSizeMm, double* rmsError = nullptr);
+
+        /**
+         * @brief 保存/加载标定 (OpenCV YAML 格式，只保存内参、畸变系数和 H，查找表在加载时重新生成)。
+         */
+        bool save(const std::string& path) const;
+        bool load(const std::string& path);
+
+        bool isValid() const { return !m_lut.empty(); }
+        cv::Size sensorSize() const { return m_sensorSize; }
+
+        /**
+         * @brief 传感器像素坐标 -> 毫米坐标 (查表插值)。
+         */
+        cv::Point2f toMillimetres(const cv::Point2f& sensorPoint) const;
+        void toMillimetres(std::vector<cv::Point2f>& points) const;
+
+        /**
+         * @brief 把测量结果换算为毫米，写入 results.metric。
+         * @details 坐标按 sensor = sub * scale + offset 换算到传感器坐标之后查表。长度按所在位置的局部比例换算：
+         * 外接矩形换算四个顶点，圆的半径取圆心处四个方向的平均，槽口的长宽按中心处的比例换算。
+         * @param offset 子图左上角在传感器上的位置 (相机端ROI)，scale 为合并系数。
+         */
+        void apply(MeasurementResults& results, const cv::Point2f& offset = cv::Point2f(), float scale = 1.0f) const;
+
+    private:
+        bool buildLut();
+
+        cv::Size m_sensorSize;
+        cv::Mat m_cameraMatrix; // 3x3 内参 (CV_64F)
+        cv::Mat m_distCoeffs;   // 畸变系数
+        cv::Mat m_homography;   // 去畸变的像素坐标 -> 平面毫米坐标 (3x3)
+        cv::Mat m_lut;          // 查找表，CV_32FC2，节点 (i, j) 对应传感器像素 (j * kLutStep, i * kLutStep)
+    };
+
+} // namespace InspectorLib
+
+#endif // INSPECTOR_CALIBRATION_H
@@ -0,0 +1,189 @@
+﻿// Caliper.cpp
+
+#include "Caliper.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "Simd.h" // INSPECTOR_SSE2
+
+namespace InspectorLib
+{
+    namespace
+    {
+        const float kRelativeStrength = 0.25f; // 弱于最强边缘的这个比例的极值视为纹理或噪声
+
+        // 点 (x, y) 是否可以双线性插值 (右下邻点也在图像内)
+        inline bool Inside(const cv::Mat& image, const cv::Point2f& p)
+        {
+            return p.x >= 0.0f && p.y >= 0.0f && p.x < image.cols - 1 && p.y < image.rows - 1;
+        }
+
+        inline float Bilinear(const cv::Mat& image, float x, float y)
+        {
+            const int xi = static_cast<int>(x);
+            const int yi = static_cast<int>(y);
+            const float fx = x - xi, fy = y - yi;
+            const uint8_t* p = image.ptr<uint8_t>(yi) + xi;
+            const uint8_t* q = p + image.step;
+            const float top = p[0] + fx * (p[1] - p[0]);
+            const float bottom = q[0] + fx * (q[1] - q[0]);
+            return top + fy * (bottom - top);
+        }
+
+        // 采样线上第 i 个点 (i 从0开始) 的图像坐标
+        inline cv::Point2f ScanStart(const Caliper& caliper)
+        {
+            const float half = (caliper.length - 1) * 0.5f;
+            return caliper.center - caliper.direction * half;
+        }
+    }
+
+    bool INSPECTOR_API SampleProfile(const cv::Mat& image, const Caliper& caliper, float* profile)
+    {
+        if (image.type() != CV_8UC1 || caliper.length < 3 || caliper.width < 1) return false;
+
+        // 1. 采样区域是一个矩形，四个角都在图像内时所有采样点都在图像内
+        const cv::Point2f dir = caliper.direction;
+        const cv::Point2f normal(-dir.y, dir.x);
+        const float halfWidth = (caliper.width - 1) * 0.5f;
+        const cv::Point2f start = ScanStart(caliper) - normal * halfWidth;
+        const cv::Point2f along = dir * static_cast<float>(caliper.length - 1);
+        const cv::Point2f across = normal * static_cast<float>(caliper.width - 1);
+        if (!Inside(image, start) || !Inside(image, start + along) || !Inside(image, start + across)
+            || !Inside(image, start + along + across)) return false;
+
+        // 2. 逐条采样线累加
+        const int length = caliper.length;
+        std::fill(profile, profile + length, 0.0f);
+        const uint8_t* base = image.data;
+        const size_t step = image.step;
+        for (int j = 0; j < caliper.width; ++j)
+        {
+            const cv::Point2f origin = start + normal * static_cast<float>(j);
+            int i = 0;
+#ifdef INSPECTOR_SSE2
+            const __m128 ox = _mm_set1_ps(origin.x), oy = _mm_set1_ps(origin.y);
+            const __m128 dx = _mm_set1_ps(dir.x), dy = _mm_set1_ps(dir.y);
+            const __m128 lane = _mm_setr_ps(0.0f, 1.0f, 2.0f, 3.0f);
+            alignas(16) int xi[4], yi[4];
+            alignas(16) float p00[4], p01[4], p10[4], p11[4];
+            for (; i + 4 <= length; i += 4)
+            {
+                const __m128 k = _mm_add_ps(_mm_set1_ps(static_cast<float>(i)), lane);
+                const __m128 x = _mm_add_ps(ox, _mm_mul_ps(k, dx));
+                const __m128 y = _mm_add_ps(oy, _mm_mul_ps(k, dy));
+                // 坐标非负，截断即向下取整
+                const __m128i xInt = _mm_cvttps_epi32(x);
+                const __m128i yInt = _mm_cvttps_epi32(y);
+                const __m128 fx = _mm_sub_ps(x, _mm_cvtepi32_ps(xInt));
+                const __m128 fy = _mm_sub_ps(y, _mm_cvtepi32_ps(yInt));
+                _mm_store_si128(reinterpret_cast<__m128i*>(xi), xInt);
+                _mm_store_si128(reinterpret_cast<__m128i*>(yi), yInt);
+                for (int l = 0; l < 4; ++l)
+                {
+                    const uint8_t* p = base + yi[l] * step + xi[l];
+                    p00[l] = p[0];
+                    p01[l] = p[1];
+                    p10[l] = p[step];
+                    p11[l] = p[step + 1];
+                }
+                const __m128 a = _mm_load_ps(p00), b = _mm_load_ps(p01), c = _mm_load_ps(p10), d = _mm_load_ps(p11);
+                const __m128 top = _mm_add_ps(a, _mm_mul_ps(fx, _mm_sub_ps(b, a)));
+                const __m128 bottom = _mm_add_ps(c, _mm_mul_ps(fx, _mm_sub_ps(d, c)));
+                const __m128 value = _mm_add_ps(top, _mm_mul_ps(fy, _mm_sub_ps(bottom, top)));
+                _mm_storeu_ps(profile + i, _mm_add_ps(_mm_loadu_ps(profile + i), value));
+            }
+#endif
+            for (; i < length; ++i) profile[i] += Bilinear(image, origin.x + i * dir.x, origin.y + i * dir.y);
+        }
+
+        const float scale = 1.0f / caliper.width;
+        for (int i = 0; i < length; ++i) profile[i] *= scale;
+        return true;
+    }
+
+    int INSPECTOR_API FindEdges(const float* profile, const Caliper& caliper, float minStrength,
+        EdgePolarity polarity, std::vector<CaliperEdge>& edges)
+    {
+        edges.clear();
+        const int length = caliper.length;
+        if (length < 5) return 0;
+
+        // 1. 中心差分梯度 (两端各少一个点)
+        std::vector<float> gradient(length, 0.0f);
+        float strongest = 0.0f;
+        for (int i = 1; i < length - 1; ++i)
+        {
+            gradient[i] = 0.5f * (profile[i + 1] - profile[i - 1]);
+            strongest = std::max(strongest, std::fabs(gradient[i]));
+        }
+        const float limit = std::max(minStrength, kRelativeStrength * strongest);
+
+        // 2. 梯度绝对值的局部极值 (平台取第一个点)，抛物线插值
+        const cv::Point2f start = ScanStart(caliper);
+        for (int i = 2; i < length - 2; ++i)
+        {
+            const float g = gradient[i];
+            const float a = std::fabs(g);
+            if (a < limit || a < std::fabs(gradient[i - 1]) || a <= std::fabs(gradient[i + 1])) continue;
+            if (polarity == Edge_Rising && g < 0.0f) continue;
+            if (polarity == Edge_Falling && g > 0.0f) continue;
+
+            const float left = gradient[i - 1], right = gradient[i + 1];
+            const float curvature = left - 2.0f * g + right;
+            const float offset = curvature != 0.0f ? std::max(-0.5f, std::min(0.5f, 0.5f * (left - right) / curvature)) : 0.0f;
+
+            CaliperEdge edge;
+            edge.position = i + offset;
+            edge.strength = g;
+            edge.point = start + caliper.direction * edge.position;
+            edges.push_back(edge);
+        }
+        return static_cast<int>(edges.size());
+    }
+
+    bool INSPECTOR_API MeasurePair(const cv::Mat& image, const Caliper& caliper, float minStrength, CaliperPair& pair)
+    {
+        // 剖面缓冲按线程复用，连续测量时不分配内存
+        thread_local std::vector<float> profile;
+        thread_local std::vector<CaliperEdge> edges;
+        profile.resize(std::max(caliper.length, 0));
+        if (!SampleProfile(image, caliper, profile.data())) return false;
+        if (FindEdges(profile.data(), caliper, minStrength, Edge_Any, edges) < 2) return false;
+
+        const CaliperEdge& first = edges.front();
+        for (auto it = edges.rbegin(); it != edges.rend(); ++it)
+        {
+            if (&*it == &first) break;
+            if ((it->strength > 0.0f) == (first.strength > 0.0f)) continue;
+            pair.first = first;
+            pair.second = *it;
+            pair.width = it->position - first.position;
+            pair.center = (first.point + it->point) * 0.5f;
+            return true;
+        }
+        return false;
+    }
+
+    std::vector<Caliper> INSPECTOR_API MakeArcCalipers(const cv::Point2f& center, float radius,
+        float startAngle, float sweepAngle, int count, int length, int width)
+    {
+        std::vector<Caliper> calipers;
+        for (int k = 0; k < count; ++k)
+        {
+            // 整圆时首尾不重合；圆弧时包含两个端点
+            const bool fullCircle = std::fabs(sweepAngle) >= 360.0f;
+            const float t = count == 1 ? 0.5f : static_cast<float>(k) / (fullCircle ? count : count - 1);
+            const double angle = (startAngle + sweepAngle * t) * CV_PI / 180.0;
+            Caliper caliper;
+            caliper.direction = cv::Point2f(static_cast<float>(std::cos(angle)), static_cast<float>(std::sin(angle)));
+            caliper.center = center + caliper.direction * radius;
+            caliper.length = length;
+            caliper.width = width;
+            calipers.push_back(caliper);
+        }
+        return calipers;
+    }
+
+} // namespace InspectorLib
@@ -0,0 +1,88 @@
+﻿// Caliper.h (卡尺工具：沿直线或圆弧采样一维灰度剖面，定位亚像素边缘并配对为宽度)
+
+#ifndef INSPECTOR_CALIPER_H
+#define INSPECTOR_CALIPER_H
+
+#include "Inspector.h" // INSPECTOR_API、CaliperOptions
+
+#include <vector>
+
+namespace InspectorLib
+{
+    /**
+     * @brief 边缘的极性 (沿扫描方向)。
+     */
+    enum EdgePolarity
+    {
+        Edge_Any = 0,
+        Edge_Rising,  // 由暗到亮
+        Edge_Falling  // 由亮到暗
+    };
+
+    /**
+     * @brief 一把卡尺：以 center 为中点、沿 direction 扫描 length 个采样点 (间隔1像素)，
+     * 垂直方向上取 width 条平行线平均，抑制噪声和边缘上的毛刺。
+     */
+    struct Caliper
+    {
+        cv::Point2f center;
+        cv::Point2f direction = cv::Point2f(1.0f, 0.0f); // 单位向量
+        int length = 0;
+        int width = 5;
+    };
+
+    /**
+     * @brief 剖面上的一个边缘。
+     */
+    struct CaliperEdge
+    {
+        float position = 0.0f; // 距扫描起点的距离 (像素，亚像素精度)
+        float strength = 0.0f; // 梯度 (灰度/像素)，正为由暗到亮
+        cv::Point2f point;     // 图像坐标
+    };
+
+    /**
+     * @brief 一对边缘 (宽度)。
+     */
+    struct CaliperPair
+    {
+        CaliperEdge first;
+        CaliperEdge second;
+        float width = 0.0f;    // 两个边缘之间的距离 (像素)
+        cv::Point2f center;    // 两个边缘的中点
+    };
+
+    /**
+     * @brief 双线性插值采样灰度剖面。
+     * @details 每条采样线一次处理4个点 (SSE2)：坐标和插值在向量寄存器中计算，只有取4个邻点是标量读取。
+     * @param image 8位灰度图 (CV_8UC1)。
+     * @param profile 输出，caliper.length 个值 (width 条线的平均)。
+     * @return 卡尺超出图像时返回 false。
+     */
+    bool INSPECTOR_API SampleProfile(const cv::Mat& image, const Caliper& caliper, float* profile);
+
+    /**
+     * @brief 在剖面上查找边缘：中心差分梯度的局部极值，抛物线插值得到亚像素位置。
+     * @details 梯度的绝对值低于 minStrength，或低于剖面上最强边缘的 1/4 (纹理和噪声) 的极值忽略。
+     * @return 找到的边缘数，按位置从小到大排列。
+     */
+    int INSPECTOR_API FindEdges(const float* profile, const Caliper& caliper, float minStrength,
+        EdgePolarity polarity, std::vector<CaliperEdge>& edges);
+
+    /**
+     * @brief 测量最外侧的一对边缘：从起点开始的第一个边缘，以及从终点开始的第一个相反极性的边缘。
+     * @details 卡尺跨过一个零件 (或一个孔) 时，这一对边缘就是它的两侧；卡尺长度应只比被测宽度稍长。
+     * @return 采样失败或找不到这样一对边缘时返回 false。
+     */
+    bool INSPECTOR_API MeasurePair(const cv::Mat& image, const Caliper& caliper, float minStrength, CaliperPair& pair);
+
+    /**
+     * @brief 沿圆弧均匀排列 count 把径向卡尺 (由内向外扫描)，用于测量圆弧的半径和位置。
+     * @param startAngle 和 sweepAngle 以度为单位，方向与 cv::RotatedRect 的角度相同 (图像坐标，顺时针)。
+     */
+    std::vector<Caliper> INSPECTOR_API MakeArcCalipers(const cv::Point2f& center, float radius,
+        float startAngle, float sweepAngle, int count, int length, int width = 5);
+
+} // namespace InspectorLib
+
+#endif // INSPECTOR_CALIPER_H
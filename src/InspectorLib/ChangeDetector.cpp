@@ -0,0 +1,69 @@
+﻿// ChangeDetector.cpp
+
+#include "ChangeDetector.h"
+#include "PixelFormat.h"
+
+#include <cmath>
+
+namespace InspectorLib
+{
+    ChangeDetector::ChangeDetector(float tolerance, int refreshInterval)
+        : m_tolerance(tolerance)
+        , m_refreshInterval(refreshInterval)
+    {
+    }
+
+    bool ChangeDetector::ComputeSignature(const cv::Mat& rawImage, PixelFormat format, std::vector<float>& signature)
+    {
+        signature.resize(kGridSize * kGridSize);
+        return SampleTileMeans(rawImage, format, kGridSize, kRowStep, signature.data());
+    }
+
+    int ChangeDetector::compare(const Snapshot& snapshot, const std::vector<float>& signature, std::vector<uint8_t>& changedTiles) const
+    {
+        changedTiles.assign(signature.size(), 0);
+        if (snapshot.signature.size() != signature.size()) {
+            changedTiles.assign(signature.size(), 1);
+            return static_cast<int>(signature.size());
+        }
+
+        int changed = 0;
+        for (size_t i = 0; i < signature.size(); ++i)
+        {
+            if (std::fabs(signature[i] - snapshot.signature[i]) > m_tolerance) {
+                changedTiles[i] = 1;
+                ++changed;
+            }
+        }
+        return changed;
+    }
+
+    std::shared_ptr<const ChangeDetector::Snapshot> ChangeDetector::snapshot() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_snapshot;
+    }
+
+    void ChangeDetector::store(std::shared_ptr<const Snapshot> snapshot, bool fullRun)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_snapshot = std::move(snapshot);
+        if (fullRun) m_reuseCount = 0;
+    }
+
+    bool ChangeDetector::allowReuse()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_refreshInterval > 0 && m_reuseCount >= m_refreshInterval) return false;
+        ++m_reuseCount;
+        return true;
+    }
+
+    void ChangeDetector::reset()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_snapshot.reset();
+        m_reuseCount = 0;
+    }
+
+} // namespace InspectorLib
@@ -0,0 +1,102 @@
+﻿// ChangeDetector.h (变化检测：画面没有变化时复用上一次的检测结果)
+
+#ifndef INSPECTOR_CHANGEDETECTOR_H
+#define INSPECTOR_CHANGEDETECTOR_H
+
+#include "Inspector.h" // INSPECTOR_API、PixelFormat、InspectOptions、MeasurementResults
+
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace InspectorLib
+{
+    /**
+     * @brief 连续检测时的变化检测：零件静止不动时，不必每一帧都重新检测同一个画面。
+     *
+     * @details 每一帧先计算一个粗网格的签名 (kGridSize x kGridSize 块的平均灰度，见 SampleTileMeans，
+     * 只读取 1/kRowStep 的行)，与上一次检测的帧比较，平均灰度的变化超过 tolerance 的块视为变化：
+     *  - 没有块变化：直接返回缓存的结果和结果图；
+     *  - 只有零件内部的块变化 (例如孔里落入了碎屑)：只对变化的区域重新二值化、查找轮廓，更新其中的孔；
+     *  - 其它情况 (零件移动、光照整体变化、设置改变等)：完整检测，并更新缓存。
+     * 连续复用 refreshInterval 次之后强制完整检测一次，避免缓慢的变化一直累积在容差之内。
+     *
+     * 缓存以不可修改的快照 (Snapshot) 保存，所有函数都有锁保护，同一个对象可以在多个测量线程之间共享。
+     */
+    class INSPECTOR_API ChangeDetector
+    {
+    public:
+        static const int kGridSize = 16; // 签名的网格 (16 x 16 块)
+        static const int kRowStep = 4;   // 签名每4行采样一行
+
+        /**
+         * @brief 一次完整检测 (或局部重测) 之后的缓存。只由 InspectRawFrame 创建和使用。
+         */
+        struct Snapshot
+        {
+            // --- 缓存的键：图像或检测设置改变时缓存无效 ---
+            cv::Size frameSize;
+            int frameType = 0;
+            PixelFormat format = PixelFormat_Mono8;
+            InspectOptions settings; // 不含 changeDetector (避免循环引用)
+
+            std::vector<float> signature; // 检测的那一帧的签名 (局部重测后更新变化的块)
+            uint32_t status = 0;
+            MeasurementResults results;
+            cv::Mat resultImage;          // 只读，复用时直接返回给调用方
+
+            // --- 局部重测需要的信息 (只在 status 为0时有效，输出坐标) ---
+            cv::Mat preview;                    // 画布的8位底图
+            std::vector<cv::Point> partContour; // 零件外轮廓
+            std::vector<cv::Rect> circleRects;  // 每个圆孔的外接矩形，与 results.circles 一一对应
+            std::vector<cv::RotatedRect> slotBoxes; // 每个槽口的最小外接矩形，与 results.slotResults 一一对应
+        };
+
+        /**
+         * @param tolerance 块的平均灰度 (8位刻度) 变化不超过它时视为没有变化，需要大于噪声和光源的闪烁。
+         * @param refreshInterval 连续复用 (含局部重测) 多少次之后强制完整检测一次 (<=0 表示不强制)。
+         */
+        explicit ChangeDetector(float tolerance = 3.0f, int refreshInterval = 100);
+
+        /**
+         * @brief 计算图像的签名 (kGridSize * kGridSize 个块的平均灰度)。
+         */
+        static bool ComputeSignature(const cv::Mat& rawImage, PixelFormat format, std::vector<float>& signature);
+
+        /**
+         * @brief 与缓存的签名比较，返回变化的块数；changedTiles[i] 为1表示第 i 块 (行优先) 变化。
+         */
+        int compare(const Snapshot& snapshot, const std::vector<float>& signature, std::vector<uint8_t>& changedTiles) const;
+
+        /**
+         * @brief 当前的缓存，没有时返回空指针。
+         */
+        std::shared_ptr<const Snapshot> snapshot() const;
+
+        /**
+         * @brief 替换缓存。fullRun 为 true 表示这是一次完整检测 (重新开始计算连续复用的次数)。
+         */
+        void store(std::shared_ptr<const Snapshot> snapshot, bool fullRun);
+
+        /**
+         * @brief 每次复用之前调用：连续复用达到 refreshInterval 次时返回 false (调用方改为完整检测)。
+         */
+        bool allowReuse();
+
+        /**
+         * @brief 清空缓存 (例如修改了质量预检等检测参数之后)。
+         */
+        void reset();
+
+    private:
+        const float m_tolerance;
+        const int m_refreshInterval;
+
+        mutable std::mutex m_mutex;
+        std::shared_ptr<const Snapshot> m_snapshot;
+        int m_reuseCount = 0; // 上次完整检测之后连续复用的次数
+    };
+
+} // namespace InspectorLib
+
+#endif // INSPECTOR_CHANGEDETECTOR_H
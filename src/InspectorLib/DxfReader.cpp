@@ -0,0 +1,329 @@
+﻿// DxfReader.cpp
+
+#include "DxfReader.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cfloat>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <utility>
+
+namespace InspectorLib
+{
+    namespace
+    {
+        // 一个图元：类型 (组码 0 的值) 和它的所有组码/值
+        struct DxfEntity
+        {
+            std::string type;
+            std::vector<std::pair<int, std::string>> groups;
+
+            double number(int code, double fallback = 0.0) const
+            {
+                for (const auto& g : groups) if (g.first == code) return std::atof(g.second.c_str());
+                return fallback;
+            }
+            std::string text(int code) const
+            {
+                for (const auto& g : groups) if (g.first == code) return g.second;
+                return std::string();
+            }
+        };
+
+        // 多段线的一个顶点：位置和到下一个顶点这一段的凸度 (tan(圆心角 / 4)，逆时针为正)
+        struct DxfVertex
+        {
+            cv::Point2f position;
+            double bulge = 0.0;
+        };
+
+        std::string Trim(const std::string& s)
+        {
+            size_t begin = 0, end = s.size();
+            while (begin < end && std::isspace(static_cast<unsigned char>(s[begin]))) ++begin;
+            while (end > begin && std::isspace(static_cast<unsigned char>(s[end - 1]))) --end;
+            return s.substr(begin, end - begin);
+        }
+
+        bool SameLayer(const std::string& a, const std::string& b)
+        {
+            if (a.size() != b.size()) return false;
+            for (size_t i = 0; i < a.size(); ++i)
+                if (std::toupper(static_cast<unsigned char>(a[i])) != std::toupper(static_cast<unsigned char>(b[i]))) return false;
+            return true;
+        }
+
+        // $INSUNITS -> mm (0 为未指定，按 mm 处理)
+        float UnitScale(int units)
+        {
+            switch (units)
+            {
+            case 1: return 25.4f;    // 英寸
+            case 2: return 304.8f;   // 英尺
+            case 5: return 10.0f;    // 厘米
+            case 6: return 1000.0f;  // 米
+            case 8: return 25.4e-6f; // 微英寸
+            case 9: return 25.4e-3f; // 千分之一英寸 (mil)
+            case 13: return 1e-3f;   // 微米
+            default: return 1.0f;
+            }
+        }
+
+        NominalSegment MakeLine(const cv::Point2f& a, const cv::Point2f& b)
+        {
+            NominalSegment s;
+            s.type = NominalSegment::Line;
+            s.start = a;
+            s.end = b;
+            return s;
+        }
+
+        // 圆弧 (角度为度，sweep 带方向)，同时填好两个端点用于拼接
+        NominalSegment MakeArc(const cv::Point2f& center, float radius, double startAngle, double sweepAngle)
+        {
+            NominalSegment s;
+            s.type = NominalSegment::Arc;
+            s.center = center;
+            s.radius = radius;
+            s.startAngle = static_cast<float>(startAngle);
+            s.sweepAngle = static_cast<float>(sweepAngle);
+            const double a0 = startAngle * CV_PI / 180.0, a1 = (startAngle + sweepAngle) * CV_PI / 180.0;
+            s.start = center + radius * cv::Point2f(static_cast<float>(std::cos(a0)), static_cast<float>(std::sin(a0)));
+            s.end = center + radius * cv::Point2f(static_cast<float>(std::cos(a1)), static_cast<float>(std::sin(a1)));
+            return s;
+        }
+
+        void Reverse(NominalSegment& s)
+        {
+            std::swap(s.start, s.end);
+            if (s.type == NominalSegment::Arc) {
+                s.startAngle += s.sweepAngle;
+                s.sweepAngle = -s.sweepAngle;
+            }
+        }
+
+        // 拉伸方向为 (0, 0, -1) 的图元在 OCS 中绘制，相当于关于 y 轴镜像
+        void MirrorX(NominalSegment& s)
+        {
+            s.start.x = -s.start.x;
+            s.end.x = -s.end.x;
+            if (s.type == NominalSegment::Arc) {
+                s.center.x = -s.center.x;
+                s.startAngle = 180.0f - s.startAngle;
+                s.sweepAngle = -s.sweepAngle;
+            }
+        }
+
+        // 多段线的顶点 -> 各段 (凸度不为0的段是圆弧)
+        void PolylineSegments(const std::vector<DxfVertex>& vertices, bool closed, std::vector<NominalSegment>& segments)
+        {
+            const size_t n = vertices.size();
+            const size_t count = closed ? n : (n > 0 ? n - 1 : 0);
+            for (size_t k = 0; k < count; ++k)
+            {
+                const cv::Point2f& a = vertices[k].position;
+                const cv::Point2f& b = vertices[(k + 1) % n].position;
+                const float chord = static_cast<float>(cv::norm(b - a));
+                if (chord <= 0.0f) continue;
+                const double bulge = vertices[k].bulge;
+                if (std::fabs(bulge) < 1e-9) {
+                    segments.push_back(MakeLine(a, b));
+                    continue;
+                }
+                // 圆心角 theta = 4 atan(bulge)；圆心在弦的中垂线上，逆时针时位于弦的左侧
+                const double theta = 4.0 * std::atan(bulge);
+                const double radius = chord / (2.0 * std::sin(std::fabs(theta) / 2.0));
+                const double offset = (chord / 2.0) / std::tan(theta / 2.0);
+                const cv::Point2f u = (b - a) * (1.0f / chord);
+                const cv::Point2f center = 0.5f * (a + b) + static_cast<float>(offset) * cv::Point2f(-u.y, u.x);
+                const double startAngle = std::atan2(a.y - center.y, a.x - center.x) * 180.0 / CV_PI;
+                segments.push_back(MakeArc(center, static_cast<float>(radius), startAngle, theta * 180.0 / CV_PI));
+            }
+        }
+
+        // 按端点把各段拼接为闭合轮廓，剩下不能闭合的链计入 openChains
+        void ChainSegments(std::vector<NominalSegment>& segments, float tolerance, std::vector<NominalLoop>& loops, int& openChains)
+        {
+            std::vector<bool> used(segments.size(), false);
+            for (size_t i = 0; i < segments.size(); ++i)
+            {
+                if (used[i]) continue;
+                used[i] = true;
+                NominalLoop loop(1, segments[i]);
+                const cv::Point2f start = segments[i].start;
+                while (cv::norm(loop.back().end - start) > tolerance)
+                {
+                    const cv::Point2f end = loop.back().end;
+                    size_t best = segments.size();
+                    bool reversed = false;
+                    double bestDistance = tolerance;
+                    for (size_t j = 0; j < segments.size(); ++j)
+                    {
+                        if (used[j]) continue;
+                        const double ds = cv::norm(segments[j].start - end), de = cv::norm(segments[j].end - end);
+                        if (ds <= bestDistance) { bestDistance = ds; best = j; reversed = false; }
+                        if (de < bestDistance) { bestDistance = de; best = j; reversed = true; }
+                    }
+                    if (best == segments.size()) break;
+                    used[best] = true;
+                    if (reversed) Reverse(segments[best]);
+                    loop.push_back(segments[best]);
+                }
+                if (cv::norm(loop.back().end - start) <= tolerance) loops.push_back(loop);
+                else ++openChains;
+            }
+        }
+    }
+
+    bool ReadDxf(const std::string& path, const std::string& layer, std::vector<NominalLoop>& loops, DxfSummary* summary)
+    {
+        std::ifstream file(path);
+        if (!file.is_open()) return false;
+
+        DxfSummary stats;
+        std::vector<NominalSegment> open;     // 待拼接的各段
+        std::vector<NominalLoop> closed;      // 本身闭合的轮廓 (圆、闭合的多段线)
+        std::string section, headerVariable;
+        int units = 0;
+
+        // 旧式 POLYLINE：顶点是后续的 VERTEX 图元，直到 SEQEND
+        bool inPolyline = false, polylineClosed = false, polylineMirrored = false;
+        std::vector<DxfVertex> polyline;
+
+        // 每条图元读完 (遇到下一个组码 0) 时处理
+        auto finish = [&](const DxfEntity& e) {
+            if (e.type.empty() || section != "ENTITIES") return;
+            if (inPolyline && (e.type == "VERTEX" || e.type == "SEQEND"))
+            {
+                if (e.type == "VERTEX") {
+                    DxfVertex v;
+                    v.position = cv::Point2f(static_cast<float>(e.number(10)), static_cast<float>(e.number(20)));
+                    v.bulge = e.number(42);
+                    polyline.push_back(v);
+                    return;
+                }
+                inPolyline = false;
+                std::vector<NominalSegment> segments;
+                PolylineSegments(polyline, polylineClosed, segments);
+                if (polylineMirrored) for (NominalSegment& s : segments) MirrorX(s);
+                if (polylineClosed && !segments.empty()) closed.push_back(segments);
+                else open.insert(open.end(), segments.begin(), segments.end());
+                return;
+            }
+            if (!layer.empty() && !SameLayer(Trim(e.text(8)), layer)) return;
+
+            const bool mirrored = e.number(230, 1.0) < 0.0;
+            std::vector<NominalSegment> segments;
+            bool isLoop = false;
+            if (e.type == "LINE")
+            {
+                const cv::Point2f a(static_cast<float>(e.number(10)), static_cast<float>(e.number(20)));
+                const cv::Point2f b(static_cast<float>(e.number(11)), static_cast<float>(e.number(21)));
+                if (cv::norm(b - a) > 0.0) segments.push_back(MakeLine(a, b));
+            }
+            else if (e.type == "ARC" || e.type == "CIRCLE")
+            {
+                const cv::Point2f center(static_cast<float>(e.number(10)), static_cast<float>(e.number(20)));
+                const float radius = static_cast<float>(e.number(40));
+                if (radius > 0.0f) {
+                    isLoop = e.type == "CIRCLE";
+                    // ARC 的角度都是逆时针的，终止角小于起始角时跨过 0 度
+                    double sweep = 360.0;
+                    if (!isLoop) {
+                        sweep = std::fmod(e.number(51) - e.number(50), 360.0);
+                        if (sweep <= 0.0) sweep += 360.0;
+                    }
+                    segments.push_back(MakeArc(center, radius, isLoop ? 0.0 : e.number(50), sweep));
+                }
+            }
+            else if (e.type == "LWPOLYLINE")
+            {
+                // 顶点按顺序出现：每个组码 10 开始一个新顶点，42 是这个顶点的凸度
+                std::vector<DxfVertex> vertices;
+                for (const auto& g : e.groups)
+                {
+                    if (g.first == 10) { vertices.emplace_back(); vertices.back().position.x = static_cast<float>(std::atof(g.second.c_str())); }
+                    else if (g.first == 20 && !vertices.empty()) vertices.back().position.y = static_cast<float>(std::atof(g.second.c_str()));
+                    else if (g.first == 42 && !vertices.empty()) vertices.back().bulge = std::atof(g.second.c_str());
+                }
+                isLoop = (static_cast<int>(e.number(70)) & 1) != 0;
+                PolylineSegments(vertices, isLoop, segments);
+            }
+            else if (e.type == "POLYLINE")
+            {
+                ++stats.entities;
+                inPolyline = true;
+                polylineClosed = (static_cast<int>(e.number(70)) & 1) != 0;
+                polylineMirrored = mirrored;
+                polyline.clear();
+                return;
+            }
+            else
+            {
+                // 尺寸、文字、填充、视口等不是几何轮廓，不计入
+                static const char* const kUnsupported[] = { "SPLINE", "ELLIPSE", "INSERT", "3DFACE", "SOLID", "REGION" };
+                for (const char* type : kUnsupported) if (e.type == type) ++stats.unsupported;
+                return;
+            }
+
+            ++stats.entities;
+            if (mirrored) for (NominalSegment& s : segments) MirrorX(s);
+            if (isLoop && !segments.empty()) closed.push_back(segments);
+            else open.insert(open.end(), segments.begin(), segments.end());
+        };
+
+        // --- 按 (组码, 值) 成对读取 ---
+        DxfEntity entity;
+        std::string codeLine, valueLine;
+        while (std::getline(file, codeLine) && std::getline(file, valueLine))
+        {
+            const std::string codeText = Trim(codeLine);
+            char* parseEnd = nullptr;
+            const long code = std::strtol(codeText.c_str(), &parseEnd, 10);
+            if (codeText.empty() || *parseEnd != '\0') return false; // 不是 ASCII DXF (二进制 DXF 以 "AutoCAD Binary DXF" 开头)
+            const std::string value = Trim(valueLine);
+
+            if (code == 0)
+            {
+                finish(entity);
+                entity = DxfEntity();
+                if (value == "ENDSEC") section.clear();
+                else if (value == "EOF") break;
+                else entity.type = value;
+                continue;
+            }
+            if (entity.type == "SECTION" && code == 2) { section = value; entity = DxfEntity(); continue; }
+            if (section == "HEADER")
+            {
+                if (code == 9) headerVariable = value;
+                else if (code == 70 && headerVariable == "$INSUNITS") units = std::atoi(value.c_str());
+                continue;
+            }
+            if (section == "ENTITIES" && !entity.type.empty()) entity.groups.emplace_back(static_cast<int>(code), value);
+        }
+        finish(entity);
+
+        // --- 换算为 mm，拼接 ---
+        stats.unitScale = UnitScale(units);
+        auto scale = [&](NominalSegment& s) {
+            s.start *= stats.unitScale;
+            s.end *= stats.unitScale;
+            s.center *= stats.unitScale;
+            s.radius *= stats.unitScale;
+        };
+        float extent = 0.0f;
+        for (NominalSegment& s : open) {
+            scale(s);
+            extent = std::max(extent, std::max(std::fabs(s.start.x), std::fabs(s.start.y)));
+        }
+        for (NominalLoop& loop : closed) for (NominalSegment& s : loop) scale(s);
+
+        loops = closed;
+        ChainSegments(open, std::max(1e-3f, 1e-5f * extent), loops, stats.openChains);
+        if (summary) *summary = stats;
+        return !loops.empty();
+    }
+
+} // namespace InspectorLib
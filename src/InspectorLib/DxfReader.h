@@ -0,0 +1,41 @@
+﻿// DxfReader.h (读取客户图纸的 DXF 文件：直线、圆弧、圆和多段线拼接为名义几何的闭合轮廓)
+
+#ifndef INSPECTOR_DXFREADER_H
+#define INSPECTOR_DXFREADER_H
+
+#include "NominalModel.h" // INSPECTOR_API、NominalLoop
+
+#include <string>
+#include <vector>
+
+namespace InspectorLib
+{
+    /**
+     * @brief 读取 DXF 文件的统计，用于提示图纸中被忽略的内容。
+     */
+    struct DxfSummary
+    {
+        int entities = 0;      // 读取的图元数 (选定图层上的 LINE、ARC、CIRCLE、LWPOLYLINE、POLYLINE)
+        int unsupported = 0;   // 选定图层上不支持的图元数 (SPLINE、ELLIPSE、INSERT 等)
+        int openChains = 0;    // 首尾不能闭合而被丢弃的线段链数 (通常是中心线、尺寸引线，或者图纸上的缺口)
+        float unitScale = 1.0f; // 图纸单位 ($INSUNITS) 换算为 mm 的系数
+    };
+
+    /**
+     * @brief 读取 ASCII 格式的 DXF 文件，把 ENTITIES 段中的图元拼接为闭合轮廓 (单位 mm)。
+     * @details
+     *  - 圆和闭合的多段线各自就是一条轮廓；直线、圆弧和不闭合的多段线按端点 (容差 1 µm 或图纸范围的 1e-5)
+     *    首尾相接，能回到起点的成为一条轮廓 (方向可以任意，需要时把一段反向)；
+     *  - 多段线的凸度 (bulge) 换算为圆弧；拉伸方向为 (0, 0, -1) 的图元 (镜像绘制) 按 x 取反处理；
+     *  - 块引用 (INSERT) 不展开，尺寸、文字、填充等图元忽略。
+     * 图纸中往往还有图框、中心线和尺寸：layer 不为空时只读取这一个图层 (不区分大小写)，
+     * 否则图框会被当成面积最大的轮廓 (零件外形)。
+     * @param summary 可选，读取的统计。
+     * @return 文件无法读取、不是 ASCII DXF 或没有任何闭合轮廓时返回 false。
+     */
+    bool INSPECTOR_API ReadDxf(const std::string& path, const std::string& layer, std::vector<NominalLoop>& loops,
+                               DxfSummary* summary = nullptr);
+
+} // namespace InspectorLib
+
+#endif // INSPECTOR_DXFREADER_H
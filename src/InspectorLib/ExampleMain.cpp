@@ -2,7 +2,10 @@
 
 // --- 1. Ҫͷļ ---
 #include <iostream>             // ڿ̨ӡı (std::cout)
+#include <cstring>              // ڱȽв (std::strcmp)
+#include <cstdio>               // ڽ --tray-grid Ĳ (std::sscanf)
 #include "Inspector.h"          // ԼĿӿڣ
+#include "Metrics.h"            // ʱָ (--metrics-dump)
 #include <opencv2/opencv.hpp>   // OpenCVΪmainҲҪغʾͼ
 
 // --- 2. ʹռ ---
@@ -13,21 +16,51 @@ using namespace InspectorLib; // Ҳʹ
 /**
  * @brief תεϢӡ̨
  */
-void printBox(const RotatedRect& box)
+void printBox(ostream& out, const RotatedRect& box)
 {
-    cout << "\t - Center: (" << box.center.x << ", " << box.center.y << ")" << endl;
-    cout << "\t - Size: " << box.size.width << " x " << box.size.height << endl;
-    cout << "\t - Angle: " << box.angle << " degrees" << endl;
+    out << "\t - Center: (" << box.center.x << ", " << box.center.y << ")" << endl;
+    out << "\t - Size: " << box.size.width << " x " << box.size.height << endl;
+    out << "\t - Angle: " << box.angle << " degrees" << endl;
 }
 
 // --- 3. C++ ---
-int main()
+// ÷: ExampleMain [ͼƬ·] [--tray [--tray-grid ,,x0,y0,м,м]] [--metrics-dump]
+//   --tray           () ⣺ͼеÿһݽ̵С ( InspectParts)
+//   --tray-grid     о (أx0,y0 Ϊ0е0иӵ)оߵĸһһӦոҲг
+//   --metrics-dump  ޽ģʽͼ񴰿ڣʱָ갴 Prometheus ıʽ stdout
+//                   ֱӽ node_exporter  textfile ռضļ
+//                   ʱʾϢΪ stderr֤ stdout ָֻꡣ
+int main(int argc, char* argv[])
 {
-    cout << "Starting Inspector Test..." << endl;
-
-    // --- a. ҪԵͼƬ· ---
+    // --- a. в ---
     // Ŀִļ bin/ Ŀ¼УͼƬĿĿ¼µ images/ ļС
     string imagePath = "C:/Users/Administrator/Desktop/PartInspectorProject/images/bracket_tilted_02.png";
+    bool metricsDump = false;
+    bool tray = false;
+    InspectOptions options;
+    for (int i = 1; i < argc; i++)
+    {
+        if (std::strcmp(argv[i], "--metrics-dump") == 0) {
+            metricsDump = true;
+        }
+        else if (std::strcmp(argv[i], "--tray") == 0) {
+            tray = true;
+        }
+        else if (std::strcmp(argv[i], "--tray-grid") == 0 && i + 1 < argc) {
+            TrayOptions& t = options.tray;
+            if (std::sscanf(argv[++i], "%d,%d,%f,%f,%f,%f", &t.rows, &t.columns, &t.origin.x, &t.origin.y, &t.pitch.x, &t.pitch.y) != 6) {
+                cerr << "Invalid --tray-grid, expected rows,columns,x0,y0,pitchX,pitchY" << endl;
+                return -1;
+            }
+            tray = true;
+        }
+        else {
+            imagePath = argv[i]; // ѡΪͼƬ·
+        }
+    }
+    ostream& out = metricsDump ? cerr : cout;
+
+    out << "Starting Inspector Test..." << endl;
 
     // --- b. زͼ ---
     // : cv::imread()ԻҶģʽ(IMREAD_GRAYSCALE)ͼ㷨Ҫĸʽ
@@ -35,7 +68,7 @@ int main()
 
     if (testImage.empty())
     {
-        cout << "!!! FATAL ERROR: Could not load image from: " << imagePath << endl;
+        out << "!!! FATAL ERROR: Could not load image from: " << imagePath << endl;
         return -1;
     }
 
@@ -45,40 +78,70 @@ int main()
 
     // --- d. ĵáִǵ㷨棡 ---
     // ǵÿ⺯Сͷ嵽ϡ
-    uint32_t statusCode = InspectPart(testImage, results, debugCanvas);
+    // ģʽÿһݽģʽֻ results һ
+    std::vector<MeasurementResults> parts;
+    uint32_t statusCode = tray ? InspectParts(testImage, PixelFormat_Mono8, parts, debugCanvas, options)
+                               : InspectPart(testImage, results, debugCanvas);
+    if (!tray) parts.push_back(results);
 
     // --- e. ִ״̬ ---
     if (statusCode != 0)
     {
         // ص״̬벻0˵㷨ڲˡ
-        cout << "!!! ALGORITHM FAILED with error code: " << statusCode << endl;
+        out << "!!! ALGORITHM FAILED with error code: " << statusCode << " (" << StatusName(statusCode) << ")" << endl;
+        if (metricsDump) {
+            cout << MetricsRegistry::Global().renderPrometheus(); // ʧܵļָͬ
+        }
         return -1;
     }
 
     // --- f. ֤ɹݴӡ̨ ---
-    cout << "\n===== Inspection Results =====\n" << endl;
+    out << "\n===== Inspection Results =====\n" << endl;
 
-    cout << "[Outer Bounding Box]:" << endl;
-    printBox(results.boundingBox);
-
-    cout << "\n[Small Circles Found]: " << results.circles.size() << endl;
-    for (size_t i = 0; i < results.circles.size(); i++)
+    for (const MeasurementResults& part : parts)
     {
-        cout << "  - Circle " << i << ":" << endl;
-        cout << "\t - Center: (" << results.circles[i].center.x << ", " << results.circles[i].center.y << ")" << endl;
-        cout << "\t - Radius: " << results.circles[i].radius << endl;
+        if (tray) out << "##### Part (row " << part.trayRow << ", column " << part.trayColumn << ") #####" << endl;
+        if (part.trayEmpty) {
+            out << "[Empty]" << endl << endl; // оߵһû
+            continue;
+        }
+
+        out << "[Outer Bounding Box]:" << endl;
+        printBox(out, part.boundingBox);
+
+        out << "\n[Small Circles Found]: " << part.circles.size() << endl;
+        for (size_t i = 0; i < part.circles.size(); i++)
+        {
+            out << "  - Circle " << i << ":" << endl;
+            out << "\t - Center: (" << part.circles[i].center.x << ", " << part.circles[i].center.y << ")" << endl;
+            out << "\t - Radius: " << part.circles[i].radius << endl;
+        }
+
+        out << "\n[Slots Found]: " << part.slotResults.size() << endl;
+        for (size_t i = 0; i < part.slotResults.size(); i++)
+        {
+            const SlotResult& slot = part.slotResults[i];
+            out << "  - Slot " << i << ":" << endl;
+            out << "\t - Center: (" << slot.center.x << ", " << slot.center.y << ")" << endl;
+            out << "\t - Length: " << slot.length << endl;
+            out << "\t - Width: " << slot.width << endl;
+            out << "\t - Arc Radii: " << slot.arcRadius[0] << " / " << slot.arcRadius[1] << endl;
+            out << "\t - Angle: " << slot.angle << endl;
+        }
+        out << endl;
     }
 
-    cout << "\n[Slot Found]:" << endl;
-    cout << "\t - Center: (" << results.slot.center.x << ", " << results.slot.center.y << ")" << endl;
-    cout << "\t - Length: " << results.slot.length << endl;
-    cout << "\t - Width: " << results.slot.width << " (Arc Radius: " << results.slot.width / 2.0 << ")" << endl;
-    cout << "\t - Angle: " << results.slot.angle << endl;
+    out << "\n===============================" << endl;
 
-    cout << "\n===============================" << endl;
 
+    // --- g. ޽ģʽֱָ˳ ---
+    if (metricsDump)
+    {
+        cout << MetricsRegistry::Global().renderPrometheus();
+        return 0;
+    }
 
-    // --- g. ӻ֤ʾͼ ---
+    // --- h. ӻ֤ʾͼ ---
     cv::imshow("Source Image", testImage);      // ʾԭʼͼ
     cv::imshow("Result Canvas", debugCanvas); // ʾ㷨ƵĽͼ
 
@@ -0,0 +1,161 @@
+﻿// Feret.cpp
+
+#include "Feret.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace InspectorLib
+{
+    namespace
+    {
+        // 二维叉积 (a - o) x (b - o)，用 int64 避免大图像上溢出
+        inline int64_t Cross(const cv::Point& o, const cv::Point& a, const cv::Point& b)
+        {
+            return static_cast<int64_t>(a.x - o.x) * (b.y - o.y) - static_cast<int64_t>(a.y - o.y) * (b.x - o.x);
+        }
+
+        inline int64_t SquaredDistance(const cv::Point& a, const cv::Point& b)
+        {
+            const int64_t dx = a.x - b.x, dy = a.y - b.y;
+            return dx * dx + dy * dy;
+        }
+
+        // 填充轮廓围成的区域：外接矩形四周各留1个像素的背景，区域边界上的距离才从0开始。offset 为轮廓坐标 -> mask 坐标
+        cv::Mat FillRegion(const std::vector<cv::Point>& contour, cv::Point& offset)
+        {
+            const cv::Rect bounds = cv::boundingRect(contour);
+            offset = cv::Point(1 - bounds.x, 1 - bounds.y);
+            cv::Mat mask = cv::Mat::zeros(bounds.height + 2, bounds.width + 2, CV_8UC1);
+            const cv::Point* points = contour.data();
+            const int count = static_cast<int>(contour.size());
+            cv::fillPoly(mask, &points, &count, 1, cv::Scalar(255), cv::LINE_8, 0, offset);
+            return mask;
+        }
+
+        // 前景区域的最大内切圆直径：一次欧氏距离变换取最大值
+        float InscribedDiameter(const cv::Mat& mask)
+        {
+            cv::Mat distance;
+            cv::distanceTransform(mask, distance, cv::DIST_L2, cv::DIST_MASK_PRECISE);
+            double maxDistance = 0.0;
+            cv::minMaxLoc(distance, nullptr, &maxDistance);
+            // 中心像素到最近背景像素的距离为 (宽度 + 1) / 2 个像素
+            return static_cast<float>(std::max(0.0, 2.0 * maxDistance - 1.0));
+        }
+
+        // 方向角 (度) 归一化到 [0, 180)：宽度和直径的方向没有正反
+        inline float NormalizeDirection(double radians)
+        {
+            double degrees = radians * 180.0 / CV_PI;
+            degrees = std::fmod(degrees, 180.0);
+            if (degrees < 0.0) degrees += 180.0;
+            return static_cast<float>(degrees >= 180.0 ? 0.0 : degrees);
+        }
+    }
+
+    void INSPECTOR_API ConvexHullOf(const std::vector<cv::Point>& contour, std::vector<cv::Point>& hull)
+    {
+        hull.clear();
+        if (contour.empty()) return;
+        cv::convexHull(contour, hull, false, true);
+    }
+
+    bool INSPECTOR_API MeasureFeret(const std::vector<cv::Point>& hull, FeretResult& feret)
+    {
+        const int n = static_cast<int>(hull.size());
+        if (n == 0) return false;
+        feret.minDiameter = feret.maxDiameter = 0.0f;
+        feret.minAngle = feret.maxAngle = 0.0f;
+        if (n == 1) return true;
+        if (n == 2)
+        {
+            // 线段：最大直径是它的长度，垂直方向上宽度为0
+            const cv::Point d = hull[1] - hull[0];
+            feret.maxDiameter = static_cast<float>(std::sqrt(static_cast<double>(SquaredDistance(hull[0], hull[1]))));
+            feret.maxAngle = NormalizeDirection(std::atan2(d.y, d.x));
+            feret.minAngle = NormalizeDirection(std::atan2(d.y, d.x) + CV_PI / 2);
+            return true;
+        }
+
+        // 凸包的方向 (cv::convexHull 的顺时针/逆时针与 y 轴方向有关)，统一成叉积为正的方向前进
+        int64_t area2 = 0;
+        for (int i = 0; i < n; ++i) area2 += Cross(hull[0], hull[i], hull[(i + 1) % n]);
+        const int64_t orientation = area2 >= 0 ? 1 : -1;
+
+        double minWidth = -1.0;
+        int64_t maxSquared = -1;
+        int maxA = 0, maxB = 0;
+        int j = 1; // 当前边的对踵点
+        for (int i = 0; i < n; ++i)
+        {
+            const int next = (i + 1) % n;
+            // 对踵点沿凸包前进，直到离边 (i, next) 的距离不再增大 (叉积即两倍三角形面积)
+            while (orientation * Cross(hull[i], hull[next], hull[(j + 1) % n]) > orientation * Cross(hull[i], hull[next], hull[j])) {
+                j = (j + 1) % n;
+            }
+
+            // 最小宽度：卡尺一侧贴着这条边时，两侧之间的距离
+            const cv::Point edge = hull[next] - hull[i];
+            const double edgeLength = std::sqrt(static_cast<double>(edge.x) * edge.x + static_cast<double>(edge.y) * edge.y);
+            const double width = static_cast<double>(orientation * Cross(hull[i], hull[next], hull[j])) / edgeLength;
+            if (minWidth < 0.0 || width < minWidth)
+            {
+                minWidth = width;
+                feret.minAngle = NormalizeDirection(std::atan2(edge.x, -edge.y)); // 宽度沿边的法线方向测量
+            }
+
+            // 最大直径：对踵点对 (i, j) 和 (next, j)
+            const int64_t d1 = SquaredDistance(hull[i], hull[j]);
+            const int64_t d2 = SquaredDistance(hull[next], hull[j]);
+            if (d1 > maxSquared) { maxSquared = d1; maxA = i; maxB = j; }
+            if (d2 > maxSquared) { maxSquared = d2; maxA = next; maxB = j; }
+        }
+
+        const cv::Point d = hull[maxB] - hull[maxA];
+        feret.minDiameter = static_cast<float>(minWidth);
+        feret.maxDiameter = static_cast<float>(std::sqrt(static_cast<double>(maxSquared)));
+        feret.maxAngle = NormalizeDirection(std::atan2(d.y, d.x));
+        return true;
+    }
+
+    float INSPECTOR_API FeretWidth(const std::vector<cv::Point>& hull, float angle)
+    {
+        if (hull.empty()) return 0.0f;
+        const double rad = angle * CV_PI / 180.0;
+        const double c = std::cos(rad), s = std::sin(rad);
+        double lo = hull[0].x * c + hull[0].y * s, hi = lo;
+        for (const cv::Point& p : hull)
+        {
+            const double t = p.x * c + p.y * s;
+            lo = std::min(lo, t);
+            hi = std::max(hi, t);
+        }
+        return static_cast<float>(hi - lo);
+    }
+
+    float INSPECTOR_API MaxInscribedDiameter(const std::vector<cv::Point>& contour)
+    {
+        if (contour.size() < 3) return 0.0f;
+        cv::Point offset;
+        return InscribedDiameter(FillRegion(contour, offset));
+    }
+
+    float INSPECTOR_API MaxInscribedDiameter(const std::vector<std::vector<cv::Point>>& contours,
+                                             const std::vector<cv::Vec4i>& hierarchy, int index)
+    {
+        if (contours[index].size() < 3) return 0.0f;
+        cv::Point offset;
+        cv::Mat mask = FillRegion(contours[index], offset);
+
+        // 【关键】挖掉内孔 (第一个孩子，再沿兄弟链表)：先把孔填为背景，再把孔的轮廓线画回前景。
+        // 解释: findContours 的孔轮廓走在零件的像素上 (与孔相邻的那一圈)，它们属于区域本身
+        for (int child = hierarchy[index][2]; child >= 0; child = hierarchy[child][0])
+        {
+            cv::drawContours(mask, contours, child, cv::Scalar(0), cv::FILLED, cv::LINE_8, cv::noArray(), 0, offset);
+            cv::drawContours(mask, contours, child, cv::Scalar(255), 1, cv::LINE_8, cv::noArray(), 0, offset);
+        }
+        return InscribedDiameter(mask);
+    }
+
+} // namespace InspectorLib
@@ -0,0 +1,48 @@
+﻿// Feret.h (凸包上的旋转卡尺：最大/最小 Feret 直径、任意方向的宽度，以及最大内切圆)
+
+#ifndef INSPECTOR_FERET_H
+#define INSPECTOR_FERET_H
+
+#include "Inspector.h" // INSPECTOR_API、FeretResult
+
+#include <vector>
+
+namespace InspectorLib
+{
+    /**
+     * @brief 轮廓的凸包 (顶点按轮廓方向排列，去掉共线的点)。
+     * @details Feret 尺寸只由凸包决定：凸包在 Feret 测量时由轮廓计算 (轮廓阶段不计算凸包，这里是每条轮廓唯一的一次)，
+     * O(n log n)；之后的各项测量都只遍历凸包的 h 个顶点 (h 通常只有轮廓点数的几分之一)。
+     */
+    void INSPECTOR_API ConvexHullOf(const std::vector<cv::Point>& contour, std::vector<cv::Point>& hull);
+
+    /**
+     * @brief 旋转卡尺：一遍扫描凸包的边，同时得到最小 Feret 直径 (最小宽度) 和最大 Feret 直径，O(h)。
+     * @details 最小宽度一定出现在卡尺的一侧贴着凸包某条边的方向上，最大直径一定是一对对踵点之间的距离；
+     * 沿凸包前进时对踵点只会单调前进，所以整个扫描是线性的。结果写入 feret 的 min/max 字段，角度在 [0, 180)。
+     */
+    bool INSPECTOR_API MeasureFeret(const std::vector<cv::Point>& hull, FeretResult& feret);
+
+    /**
+     * @brief 凸包在 angle 方向 (度，与图像 x 轴的夹角) 上的宽度：投影的最大值减最小值，O(h)。
+     */
+    float INSPECTOR_API FeretWidth(const std::vector<cv::Point>& hull, float angle);
+
+    /**
+     * @brief 轮廓围成区域的最大内切圆直径 (能放进区域的最大圆，像素精度)。
+     * @details 在轮廓的外接矩形内填充区域，做一次欧氏距离变换，取最大值。与凸包无关，
+     * 对内孔就是能通过的最大销规直径。区域内部的孔不会被挖掉，零件外形请用下面带轮廓树的版本。
+     */
+    float INSPECTOR_API MaxInscribedDiameter(const std::vector<cv::Point>& contour);
+
+    /**
+     * @brief contours[index] 围成的区域去掉它的子轮廓 (轮廓树中的内孔) 之后的最大内切圆直径。
+     * @details 对零件外形就是去掉内孔之后最厚处的厚度；只填充外轮廓时内孔被填平，量到的是没有孔的外形。
+     * @param hierarchy cv::findContours (RETR_TREE 或 RETR_CCOMP) 输出的轮廓树。
+     */
+    float INSPECTOR_API MaxInscribedDiameter(const std::vector<std::vector<cv::Point>>& contours,
+                                             const std::vector<cv::Vec4i>& hierarchy, int index);
+
+} // namespace InspectorLib
+
+#endif // INSPECTOR_FERET_H
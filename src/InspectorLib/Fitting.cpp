@@ -0,0 +1,539 @@
+﻿// Fitting.cpp
+
+#include "Fitting.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstring>
+#include <string>
+
+#include "Simd.h" // INSPECTOR_SSE2
+
+namespace InspectorLib
+{
+    namespace
+    {
+        const char* const kCircleFitNames[CircleFit_Count] = { "min_enclosing", "kasa", "taubin", "hyper" };
+
+        // 块内用 float 累加，每 kBlock 个点把部分和转为 double：既保持4路并行，又不会因为点数多而丢失精度
+        const size_t kBlock = 256;
+        // 稳健重加权：Tukey 双权的调节常数 (正态噪声下效率95%)，以及尺度的下限 (像素)，避免完美数据的尺度为零
+        const float kTukeyC = 4.685f;
+        const float kMinSigma = 0.05f;
+
+        // --- a. 标量和向量的统一运算，让同一段矩公式同时用于 SIMD 主循环和标量尾部 ---
+        inline float Mul(float a, float b) { return a * b; }
+        inline float Add(float a, float b) { return a + b; }
+        inline float One(float) { return 1.0f; }
+#ifdef INSPECTOR_SSE2
+        inline __m128 Mul(__m128 a, __m128 b) { return _mm_mul_ps(a, b); }
+        inline __m128 Add(__m128 a, __m128 b) { return _mm_add_ps(a, b); }
+        inline __m128 One(__m128) { return _mm_set1_ps(1.0f); }
+
+        inline double HorizontalSum(__m128 v)
+        {
+            alignas(16) float lanes[4];
+            _mm_store_ps(lanes, v);
+            return (static_cast<double>(lanes[0]) + lanes[1]) + (static_cast<double>(lanes[2]) + lanes[3]);
+        }
+#endif
+
+        /**
+         * 加权求和：sums[k] = Σ w_i * terms_k(dx_i, dy_i)，其中 dx = (x - cx) * s，dy = (y - cy) * s。
+         * terms 是一个泛型函数对象 (auto 参数)，对 float 和 __m128 都能调用，写出 N 个单项式。
+         * w 为 nullptr 时所有点的权重为1。
+         */
+        template <int N, typename Terms>
+        void SumTerms(const PointSet& points, const float* w, float cx, float cy, float s, Terms terms, double* sums)
+        {
+            std::fill(sums, sums + N, 0.0);
+            const float* xs = points.x();
+            const float* ys = points.y();
+            const size_t n = points.size();
+            size_t i = 0;
+#ifdef INSPECTOR_SSE2
+            const __m128 vcx = _mm_set1_ps(cx), vcy = _mm_set1_ps(cy), vs = _mm_set1_ps(s), one = _mm_set1_ps(1.0f);
+            const size_t vectorEnd = n & ~size_t(3);
+            while (i < vectorEnd)
+            {
+                const size_t blockEnd = std::min(vectorEnd, i + kBlock);
+                __m128 acc[N];
+                for (int k = 0; k < N; ++k) acc[k] = _mm_setzero_ps();
+                for (; i < blockEnd; i += 4)
+                {
+                    const __m128 dx = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(xs + i), vcx), vs);
+                    const __m128 dy = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(ys + i), vcy), vs);
+                    const __m128 wv = w ? _mm_loadu_ps(w + i) : one;
+                    __m128 t[N];
+                    terms(dx, dy, t);
+                    for (int k = 0; k < N; ++k) acc[k] = _mm_add_ps(acc[k], _mm_mul_ps(wv, t[k]));
+                }
+                for (int k = 0; k < N; ++k) sums[k] += HorizontalSum(acc[k]);
+            }
+#endif
+            for (; i < n; ++i)
+            {
+                const float wi = w ? w[i] : 1.0f;
+                float t[N];
+                terms((xs[i] - cx) * s, (ys[i] - cy) * s, t);
+                for (int k = 0; k < N; ++k) sums[k] += static_cast<double>(wi) * t[k];
+            }
+        }
+
+        // 加权质心。权重之和为零时返回 false
+        bool WeightedMean(const PointSet& points, const float* w, double& sw, float& mx, float& my)
+        {
+            double sums[3];
+            SumTerms<3>(points, w, 0.0f, 0.0f, 1.0f,
+                [](auto x, auto y, auto* t) { t[0] = One(x); t[1] = x; t[2] = y; }, sums);
+            sw = sums[0];
+            if (!(sw > 0.0)) return false;
+            mx = static_cast<float>(sums[1] / sw);
+            my = static_cast<float>(sums[2] / sw);
+            return true;
+        }
+
+        // --- b. 残差 (有符号的几何距离) ---
+        void CircleResiduals(const PointSet& points, const CircleFit& fit, float* residuals)
+        {
+            const float* xs = points.x();
+            const float* ys = points.y();
+            const size_t n = points.size();
+            size_t i = 0;
+#ifdef INSPECTOR_SSE2
+            const __m128 cx = _mm_set1_ps(fit.center.x), cy = _mm_set1_ps(fit.center.y), r = _mm_set1_ps(fit.radius);
+            for (; i + 4 <= n; i += 4)
+            {
+                const __m128 dx = _mm_sub_ps(_mm_loadu_ps(xs + i), cx);
+                const __m128 dy = _mm_sub_ps(_mm_loadu_ps(ys + i), cy);
+                const __m128 d = _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)));
+                _mm_storeu_ps(residuals + i, _mm_sub_ps(d, r));
+            }
+#endif
+            for (; i < n; ++i) residuals[i] = std::hypot(xs[i] - fit.center.x, ys[i] - fit.center.y) - fit.radius;
+        }
+
+        void LineResiduals(const PointSet& points, const LineFit& fit, float* residuals)
+        {
+            // 到直线的有符号距离 = (p - p0) · n，n 为法向量 (-dy, dx)
+            const float* xs = points.x();
+            const float* ys = points.y();
+            const size_t n = points.size();
+            const float nx = -fit.direction.y, ny = fit.direction.x;
+            size_t i = 0;
+#ifdef INSPECTOR_SSE2
+            const __m128 px = _mm_set1_ps(fit.point.x), py = _mm_set1_ps(fit.point.y);
+            const __m128 vnx = _mm_set1_ps(nx), vny = _mm_set1_ps(ny);
+            for (; i + 4 <= n; i += 4)
+            {
+                const __m128 dx = _mm_sub_ps(_mm_loadu_ps(xs + i), px);
+                const __m128 dy = _mm_sub_ps(_mm_loadu_ps(ys + i), py);
+                _mm_storeu_ps(residuals + i, _mm_add_ps(_mm_mul_ps(dx, vnx), _mm_mul_ps(dy, vny)));
+            }
+#endif
+            for (; i < n; ++i) residuals[i] = (xs[i] - fit.point.x) * nx + (ys[i] - fit.point.y) * ny;
+        }
+
+        // --- c. 稳健重加权 ---
+        // Tukey 双权：尺度 sigma = 1.4826 * median(|r|)，|r| >= 4.685 sigma 的点权重为零。
+        // 权重不为零的点少于 minPoints 时返回 false (保持上一次的拟合)
+        bool TukeyWeights(const std::vector<float>& residuals, std::vector<float>& scratch, std::vector<float>& weights, int minPoints)
+        {
+            const size_t n = residuals.size();
+            scratch.resize(n);
+            for (size_t i = 0; i < n; ++i) scratch[i] = std::fabs(residuals[i]);
+            std::nth_element(scratch.begin(), scratch.begin() + n / 2, scratch.end());
+            const float sigma = std::max(kMinSigma, 1.4826f * scratch[n / 2]);
+            const float inv = 1.0f / (kTukeyC * sigma);
+
+            weights.resize(n);
+            int inliers = 0;
+            for (size_t i = 0; i < n; ++i)
+            {
+                const float u = residuals[i] * inv;
+                const float t = std::max(0.0f, 1.0f - u * u);
+                weights[i] = t * t;
+                inliers += t > 0.0f;
+            }
+            return inliers >= minPoints;
+        }
+
+        // 加权均方根残差和权重不为零的点数
+        void Summarise(const std::vector<float>& residuals, const float* w, float& rms, int& inliers)
+        {
+            double sum = 0.0, sw = 0.0;
+            inliers = 0;
+            for (size_t i = 0; i < residuals.size(); ++i)
+            {
+                const double wi = w ? w[i] : 1.0;
+                sum += wi * residuals[i] * residuals[i];
+                sw += wi;
+                inliers += wi > 0.0;
+            }
+            rms = sw > 0.0 ? static_cast<float>(std::sqrt(sum / sw)) : 0.0f;
+        }
+
+        /**
+         * 迭代重加权的公共流程：solve(w) 按当前权重拟合，residuals(r) 求残差。
+         * 第0轮不加权；之后每轮由上一轮的残差求权重。
+         */
+        template <typename Fit, typename Solve, typename Residuals>
+        bool FitRobust(const PointSet& points, int robustIterations, int minPoints, Fit& fit, Solve solve, Residuals residualsOf)
+        {
+            std::vector<float> residuals(points.size()), weights, nextWeights, scratch;
+            const float* w = nullptr;
+            if (!solve(w, fit)) return false;
+            residualsOf(fit, residuals.data());
+            for (int iter = 0; iter < robustIterations; ++iter)
+            {
+                if (!TukeyWeights(residuals, scratch, nextWeights, minPoints)) break;
+                Fit candidate = fit;
+                if (!solve(nextWeights.data(), candidate)) break;
+                fit = candidate;
+                weights.swap(nextWeights);
+                w = weights.data();
+                residualsOf(fit, residuals.data());
+            }
+            Summarise(residuals, w, fit.rms, fit.inliers);
+            return true;
+        }
+
+        // --- d. 圆：由6个中心矩求解 (Chernov 的 Kasa / Taubin / Hyper 形式) ---
+        bool SolveCircle(const PointSet& points, const float* w, CircleFitMethod method, CircleFit& fit)
+        {
+            double sw;
+            float mx, my;
+            if (!WeightedMean(points, w, sw, mx, my)) return false;
+
+            // z = x^2 + y^2 (相对质心)
+            double m[6];
+            SumTerms<6>(points, w, mx, my, 1.0f, [](auto x, auto y, auto* t) {
+                const auto xx = Mul(x, x);
+                const auto yy = Mul(y, y);
+                const auto z = Add(xx, yy);
+                t[0] = xx; t[1] = yy; t[2] = Mul(x, y); t[3] = Mul(x, z); t[4] = Mul(y, z); t[5] = Mul(z, z);
+            }, m);
+            const double Mxx = m[0] / sw, Myy = m[1] / sw, Mxy = m[2] / sw, Mxz = m[3] / sw, Myz = m[4] / sw, Mzz = m[5] / sw;
+            const double Mz = Mxx + Myy;
+            const double covXY = Mxx * Myy - Mxy * Mxy;
+
+            // x 为特征多项式的根 (Kasa 为0)，Hyper 的半径另有修正项
+            double x = 0.0;
+            if (method == CircleFit_Taubin || method == CircleFit_Hyper)
+            {
+                const double varZ = Mzz - Mz * Mz;
+                const double A3 = method == CircleFit_Taubin ? 4.0 * Mz : 0.0;
+                const double A2 = method == CircleFit_Taubin ? -3.0 * Mz * Mz - Mzz : 4.0 * covXY - 3.0 * Mz * Mz - Mzz;
+                const double A1 = varZ * Mz + 4.0 * covXY * Mz - Mxz * Mxz - Myz * Myz;
+                const double A0 = Mxz * (Mxz * Myy - Myz * Mxy) + Myz * (Myz * Mxx - Mxz * Mxy) - varZ * covXY;
+                const double A4 = method == CircleFit_Hyper ? 4.0 : 0.0; // Hyper: A0 + A1 x + A2 x^2 + 4 x^4
+
+                // 从 x = 0 开始的牛顿迭代，单调收敛到最小的正根
+                double y = A0;
+                for (int iter = 0; iter < 99; ++iter)
+                {
+                    const double dy = A1 + x * (2.0 * A2 + x * (3.0 * A3 + x * 4.0 * A4));
+                    const double xNew = x - y / dy;
+                    if (xNew == x || !std::isfinite(xNew)) break;
+                    const double yNew = A0 + xNew * (A1 + xNew * (A2 + xNew * (A3 + xNew * A4)));
+                    if (std::fabs(yNew) >= std::fabs(y)) break;
+                    x = xNew;
+                    y = yNew;
+                }
+            }
+
+            const double det = x * x - x * Mz + covXY;
+            if (std::fabs(det) < 1e-12) return false; // 点共线
+            const double cx = (Mxz * (Myy - x) - Myz * Mxy) / det / 2.0;
+            const double cy = (Myz * (Mxx - x) - Mxz * Mxy) / det / 2.0;
+            const double r2 = cx * cx + cy * cy + Mz - (method == CircleFit_Hyper ? 2.0 * x : 0.0);
+            if (!(r2 > 0.0) || !std::isfinite(r2)) return false;
+
+            fit.center = cv::Point2f(static_cast<float>(cx + mx), static_cast<float>(cy + my));
+            fit.radius = static_cast<float>(std::sqrt(r2));
+            return true;
+        }
+
+        // --- e. 直线：协方差矩阵的主方向 ---
+        bool SolveLine(const PointSet& points, const float* w, LineFit& fit)
+        {
+            double sw;
+            float mx, my;
+            if (!WeightedMean(points, w, sw, mx, my)) return false;
+
+            double m[3];
+            SumTerms<3>(points, w, mx, my, 1.0f, [](auto x, auto y, auto* t) {
+                t[0] = Mul(x, x); t[1] = Mul(y, y); t[2] = Mul(x, y);
+            }, m);
+            if (m[0] + m[1] <= 0.0) return false; // 所有点重合
+            const double theta = 0.5 * std::atan2(2.0 * m[2], m[0] - m[1]);
+            fit.point = cv::Point2f(mx, my);
+            fit.direction = cv::Point2f(static_cast<float>(std::cos(theta)), static_cast<float>(std::sin(theta)));
+            return true;
+        }
+
+        // --- f. 椭圆：Halir-Flusser ---
+        struct Conic
+        {
+            double a[6];      // A u^2 + B uv + C v^2 + D u + E v + F = 0 (归一化坐标)
+            float mx, my, s;  // 归一化：u = (x - mx) * s
+        };
+
+        // 3x3 矩阵的实特征值 (三次特征多项式)，返回个数
+        int RealEigenvalues3(const double M[3][3], double roots[3])
+        {
+            const double p2 = -(M[0][0] + M[1][1] + M[2][2]);
+            const double p1 = M[0][0] * M[1][1] - M[0][1] * M[1][0]
+                            + M[0][0] * M[2][2] - M[0][2] * M[2][0]
+                            + M[1][1] * M[2][2] - M[1][2] * M[2][1];
+            const double p0 = -(M[0][0] * (M[1][1] * M[2][2] - M[1][2] * M[2][1])
+                              - M[0][1] * (M[1][0] * M[2][2] - M[1][2] * M[2][0])
+                              + M[0][2] * (M[1][0] * M[2][1] - M[1][1] * M[2][0]));
+
+            // 化为 t^3 + p t + q = 0，lambda = t - p2 / 3
+            const double p = p1 - p2 * p2 / 3.0;
+            const double q = 2.0 * p2 * p2 * p2 / 27.0 - p2 * p1 / 3.0 + p0;
+            const double disc = q * q / 4.0 + p * p * p / 27.0;
+            int count = 0;
+            if (disc < 0.0)
+            {
+                const double r = 2.0 * std::sqrt(-p / 3.0);
+                const double phi = std::acos(std::max(-1.0, std::min(1.0, 3.0 * q / (p * r))));
+                for (int k = 0; k < 3; ++k) roots[count++] = r * std::cos((phi - 2.0 * CV_PI * k) / 3.0) - p2 / 3.0;
+            }
+            else
+            {
+                const double sq = std::sqrt(disc);
+                roots[count++] = std::cbrt(-q / 2.0 + sq) + std::cbrt(-q / 2.0 - sq) - p2 / 3.0;
+            }
+            // 牛顿法修正一次，减小三角公式的舍入误差
+            for (int k = 0; k < count; ++k)
+            {
+                const double l = roots[k];
+                const double f = ((l + p2) * l + p1) * l + p0;
+                const double df = (3.0 * l + 2.0 * p2) * l + p1;
+                if (df != 0.0) roots[k] = l - f / df;
+            }
+            return count;
+        }
+
+        // (M - lambda I) 的零空间：取两行叉积中最大的一个
+        void EigenVector3(const double M[3][3], double lambda, double v[3])
+        {
+            double R[3][3];
+            for (int i = 0; i < 3; ++i) for (int j = 0; j < 3; ++j) R[i][j] = M[i][j] - (i == j ? lambda : 0.0);
+            double best = -1.0;
+            const int pairs[3][2] = { {0, 1}, {0, 2}, {1, 2} };
+            for (const auto& pr : pairs)
+            {
+                const double* a = R[pr[0]];
+                const double* b = R[pr[1]];
+                const double c[3] = { a[1] * b[2] - a[2] * b[1], a[2] * b[0] - a[0] * b[2], a[0] * b[1] - a[1] * b[0] };
+                const double norm = c[0] * c[0] + c[1] * c[1] + c[2] * c[2];
+                if (norm > best) { best = norm; std::memcpy(v, c, sizeof(c)); }
+            }
+        }
+
+        bool Invert3(const double S[3][3], double inv[3][3])
+        {
+            const double c00 = S[1][1] * S[2][2] - S[1][2] * S[2][1];
+            const double c01 = S[1][2] * S[2][0] - S[1][0] * S[2][2];
+            const double c02 = S[1][0] * S[2][1] - S[1][1] * S[2][0];
+            const double det = S[0][0] * c00 + S[0][1] * c01 + S[0][2] * c02;
+            if (std::fabs(det) < 1e-300) return false;
+            inv[0][0] = c00 / det;
+            inv[0][1] = (S[0][2] * S[2][1] - S[0][1] * S[2][2]) / det;
+            inv[0][2] = (S[0][1] * S[1][2] - S[0][2] * S[1][1]) / det;
+            inv[1][0] = c01 / det;
+            inv[1][1] = (S[0][0] * S[2][2] - S[0][2] * S[2][0]) / det;
+            inv[1][2] = (S[0][2] * S[1][0] - S[0][0] * S[1][2]) / det;
+            inv[2][0] = c02 / det;
+            inv[2][1] = (S[0][1] * S[2][0] - S[0][0] * S[2][1]) / det;
+            inv[2][2] = (S[0][0] * S[1][1] - S[0][1] * S[1][0]) / det;
+            return true;
+        }
+
+        bool SolveEllipse(const PointSet& points, const float* w, Conic& conic)
+        {
+            double sw;
+            float mx, my;
+            if (!WeightedMean(points, w, sw, mx, my)) return false;
+
+            // 归一化：平移到质心，缩放到平均半径约为1 (四阶矩的数量级不再随零件尺寸变化)
+            double spread[2];
+            SumTerms<2>(points, w, mx, my, 1.0f, [](auto x, auto y, auto* t) { t[0] = Mul(x, x); t[1] = Mul(y, y); }, spread);
+            const double meanSq = (spread[0] + spread[1]) / sw;
+            if (!(meanSq > 0.0)) return false;
+            const float s = static_cast<float>(1.0 / std::sqrt(meanSq));
+
+            // 0~4 阶的15个矩 m[a][b] = Σ w u^a v^b
+            double r[15];
+            SumTerms<15>(points, w, mx, my, s, [](auto u, auto v, auto* t) {
+                const auto uu = Mul(u, u), uv = Mul(u, v), vv = Mul(v, v);
+                t[0] = One(u); t[1] = u; t[2] = v;
+                t[3] = uu; t[4] = uv; t[5] = vv;
+                t[6] = Mul(uu, u); t[7] = Mul(uu, v); t[8] = Mul(vv, u); t[9] = Mul(vv, v);
+                t[10] = Mul(uu, uu); t[11] = Mul(uu, uv); t[12] = Mul(uu, vv); t[13] = Mul(uv, vv); t[14] = Mul(vv, vv);
+            }, r);
+            const double m00 = r[0], m10 = r[1], m01 = r[2], m20 = r[3], m11 = r[4], m02 = r[5];
+            const double m30 = r[6], m21 = r[7], m12 = r[8], m03 = r[9];
+            const double m40 = r[10], m31 = r[11], m22 = r[12], m13 = r[13], m04 = r[14];
+
+            // 设计矩阵 D1 = [u^2, uv, v^2]，D2 = [u, v, 1]
+            const double S1[3][3] = { {m40, m31, m22}, {m31, m22, m13}, {m22, m13, m04} };
+            const double S2[3][3] = { {m30, m21, m20}, {m21, m12, m11}, {m12, m03, m02} };
+            const double S3[3][3] = { {m20, m11, m10}, {m11, m02, m01}, {m10, m01, m00} };
+            double S3inv[3][3];
+            if (!Invert3(S3, S3inv)) return false;
+
+            // T = -S3^-1 S2^T，M = S1 + S2 T，再左乘约束矩阵的逆
+            double T[3][3], M[3][3], C[3][3];
+            for (int i = 0; i < 3; ++i)
+                for (int j = 0; j < 3; ++j)
+                    T[i][j] = -(S3inv[i][0] * S2[j][0] + S3inv[i][1] * S2[j][1] + S3inv[i][2] * S2[j][2]);
+            for (int i = 0; i < 3; ++i)
+                for (int j = 0; j < 3; ++j)
+                    M[i][j] = S1[i][j] + S2[i][0] * T[0][j] + S2[i][1] * T[1][j] + S2[i][2] * T[2][j];
+            for (int j = 0; j < 3; ++j)
+            {
+                C[0][j] = M[2][j] / 2.0;
+                C[1][j] = -M[1][j];
+                C[2][j] = M[0][j] / 2.0;
+            }
+
+            // 满足椭圆约束 4AC - B^2 > 0 的特征向量
+            double roots[3], best = 0.0, a1[3] = { 0.0, 0.0, 0.0 };
+            const int count = RealEigenvalues3(C, roots);
+            for (int k = 0; k < count; ++k)
+            {
+                double v[3];
+                EigenVector3(C, roots[k], v);
+                const double norm = v[0] * v[0] + v[1] * v[1] + v[2] * v[2];
+                if (norm <= 0.0) continue;
+                const double cond = (4.0 * v[0] * v[2] - v[1] * v[1]) / norm;
+                if (cond > best) { best = cond; std::memcpy(a1, v, sizeof(v)); }
+            }
+            if (best <= 0.0) return false;
+
+            conic.a[0] = a1[0]; conic.a[1] = a1[1]; conic.a[2] = a1[2];
+            for (int i = 0; i < 3; ++i) conic.a[3 + i] = T[i][0] * a1[0] + T[i][1] * a1[1] + T[i][2] * a1[2];
+            conic.mx = mx;
+            conic.my = my;
+            conic.s = s;
+            return true;
+        }
+
+        // 二次曲线 -> 中心、轴长、方向 (像素坐标)
+        bool ConicToBox(const Conic& conic, cv::RotatedRect& box)
+        {
+            const double A = conic.a[0], B = conic.a[1], C = conic.a[2], D = conic.a[3], E = conic.a[4], F = conic.a[5];
+            const double det = 4.0 * A * C - B * B;
+            if (!(det > 0.0)) return false;
+            const double u0 = (B * E - 2.0 * C * D) / det;
+            const double v0 = (B * D - 2.0 * A * E) / det;
+            const double f0 = F + (D * u0 + E * v0) / 2.0;
+
+            const double theta = 0.5 * std::atan2(B, A - C);
+            const double c = std::cos(theta), s = std::sin(theta);
+            const double l1 = A * c * c + B * c * s + C * s * s;
+            const double l2 = A * s * s - B * c * s + C * c * c;
+            if (!(-f0 / l1 > 0.0) || !(-f0 / l2 > 0.0)) return false;
+
+            const double scale = 1.0 / conic.s;
+            box.center = cv::Point2f(static_cast<float>(conic.mx + u0 * scale), static_cast<float>(conic.my + v0 * scale));
+            box.size = cv::Size2f(static_cast<float>(2.0 * std::sqrt(-f0 / l1) * scale), static_cast<float>(2.0 * std::sqrt(-f0 / l2) * scale));
+            box.angle = static_cast<float>(theta * 180.0 / CV_PI);
+            return true;
+        }
+
+        // Sampson 距离 |Q| / |grad Q|，换算为像素 (标量循环，编译器可以自动向量化)
+        void EllipseResiduals(const PointSet& points, const Conic& conic, float* residuals)
+        {
+            const float A = static_cast<float>(conic.a[0]), B = static_cast<float>(conic.a[1]), C = static_cast<float>(conic.a[2]);
+            const float D = static_cast<float>(conic.a[3]), E = static_cast<float>(conic.a[4]), F = static_cast<float>(conic.a[5]);
+            const float* xs = points.x();
+            const float* ys = points.y();
+            const float toPixels = 1.0f / conic.s;
+            for (size_t i = 0; i < points.size(); ++i)
+            {
+                const float u = (xs[i] - conic.mx) * conic.s;
+                const float v = (ys[i] - conic.my) * conic.s;
+                const float q = A * u * u + B * u * v + C * v * v + D * u + E * v + F;
+                const float gu = 2.0f * A * u + B * v + D;
+                const float gv = B * u + 2.0f * C * v + E;
+                residuals[i] = q / std::max(1e-12f, std::sqrt(gu * gu + gv * gv)) * toPixels;
+            }
+        }
+    }
+
+    const char* INSPECTOR_API CircleFitMethodName(CircleFitMethod method)
+    {
+        return method >= 0 && method < CircleFit_Count ? kCircleFitNames[method] : "unknown";
+    }
+
+    bool INSPECTOR_API ParseCircleFitMethod(const char* name, CircleFitMethod& method)
+    {
+        if (!name) return false;
+        std::string lower(name);
+        std::transform(lower.begin(), lower.end(), lower.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        for (int i = 0; i < CircleFit_Count; ++i)
+        {
+            if (lower == kCircleFitNames[i]) { method = static_cast<CircleFitMethod>(i); return true; }
+        }
+        return false;
+    }
+
+    void PointSet::assign(const std::vector<cv::Point>& points)
+    {
+        m_x.resize(points.size());
+        m_y.resize(points.size());
+        for (size_t i = 0; i < points.size(); ++i)
+        {
+            m_x[i] = static_cast<float>(points[i].x);
+            m_y[i] = static_cast<float>(points[i].y);
+        }
+    }
+
+    void PointSet::assign(const std::vector<cv::Point2f>& points)
+    {
+        m_x.resize(points.size());
+        m_y.resize(points.size());
+        for (size_t i = 0; i < points.size(); ++i)
+        {
+            m_x[i] = points[i].x;
+            m_y[i] = points[i].y;
+        }
+    }
+
+    bool INSPECTOR_API FitCircle(const PointSet& points, CircleFitMethod method, CircleFit& fit, int robustIterations)
+    {
+        if (points.size() < 3 || method <= CircleFit_MinEnclosing || method >= CircleFit_Count) return false;
+        return FitRobust(points, robustIterations, 3, fit,
+            [&points, method](const float* w, CircleFit& f) { return SolveCircle(points, w, method, f); },
+            [&points](const CircleFit& f, float* r) { CircleResiduals(points, f, r); });
+    }
+
+    bool INSPECTOR_API FitLine(const PointSet& points, LineFit& fit, int robustIterations)
+    {
+        if (points.size() < 2) return false;
+        return FitRobust(points, robustIterations, 2, fit,
+            [&points](const float* w, LineFit& f) { return SolveLine(points, w, f); },
+            [&points](const LineFit& f, float* r) { LineResiduals(points, f, r); });
+    }
+
+    bool INSPECTOR_API FitEllipse(const PointSet& points, EllipseFit& fit, int robustIterations)
+    {
+        if (points.size() < 5) return false;
+        // 残差需要二次曲线的系数，拟合过程中保存在 conic 里，最后换算为外接矩形
+        struct State { Conic conic; float rms; int inliers; } state;
+        const bool ok = FitRobust(points, robustIterations, 5, state,
+            [&points](const float* w, State& st) { return SolveEllipse(points, w, st.conic); },
+            [&points](const State& st, float* r) { EllipseResiduals(points, st.conic, r); });
+        if (!ok || !ConicToBox(state.conic, fit.box)) return false;
+        fit.rms = state.rms;
+        fit.inliers = state.inliers;
+        return true;
+    }
+
+} // namespace InspectorLib
@@ -0,0 +1,94 @@
+﻿// Fitting.h (几何拟合内核：代数圆拟合、总体最小二乘直线拟合、椭圆拟合，可选稳健重加权)
+
+#ifndef INSPECTOR_FITTING_H
+#define INSPECTOR_FITTING_H
+
+#include "Inspector.h" // INSPECTOR_API、CircleFitMethod
+
+#include <vector>
+
+namespace InspectorLib
+{
+    /**
+     * @brief 返回圆拟合方法的英文名称 ("min_enclosing"、"kasa"、"taubin"、"hyper"，用于日志和配置文件)。
+     */
+    const char* INSPECTOR_API CircleFitMethodName(CircleFitMethod method);
+
+    /**
+     * @brief 由名称查找圆拟合方法 (不区分大小写)，未知的名称返回 false。
+     */
+    bool INSPECTOR_API ParseCircleFitMethod(const char* name, CircleFitMethod& method);
+
+    /**
+     * @brief 拟合用的点集，按 SoA (x 和 y 分别连续存放) 保存。
+     * @details 拟合内核一次处理4个点 (SSE2)：矩的累加、残差和权重都是对连续数组的顺序扫描。
+     * 同一个对象可以反复 assign，容量只增不减，连续测量时不再分配内存。
+     */
+    class INSPECTOR_API PointSet
+    {
+    public:
+        void assign(const std::vector<cv::Point>& points);
+        void assign(const std::vector<cv::Point2f>& points);
+
+        size_t size() const { return m_x.size(); }
+        const float* x() const { return m_x.data(); }
+        const float* y() const { return m_y.data(); }
+
+    private:
+        std::vector<float> m_x;
+        std::vector<float> m_y;
+    };
+
+    /**
+     * @brief 拟合结果。rms 为最终权重下的均方根几何距离 (像素)，inliers 为权重不为零的点数。
+     */
+    struct CircleFit
+    {
+        cv::Point2f center;
+        float radius = 0.0f;
+        float rms = 0.0f;
+        int inliers = 0;
+    };
+
+    struct LineFit
+    {
+        cv::Point2f point;     // 直线上的一点 (加权质心)
+        cv::Point2f direction; // 单位方向向量
+        float rms = 0.0f;
+        int inliers = 0;
+    };
+
+    struct EllipseFit
+    {
+        cv::RotatedRect box;   // 与 cv::fitEllipse 相同：size 为两轴全长，angle 为 width 轴的方向 (度)
+        float rms = 0.0f;      // 按 Sampson 距离 (几何距离的一阶近似) 计算
+        int inliers = 0;
+    };
+
+    /**
+     * @brief 代数圆拟合 (最小二乘)。
+     * @details Kasa 最快，但半径在只有一段圆弧时明显偏小；Taubin 和 Hyper 几乎没有这种偏差，
+     * Hyper 的半径在统计上无偏，是测量孔径的推荐方法。三者都只需一遍扫描求6个矩，之后是常数时间的求解。
+     * robustIterations > 0 时做迭代重加权 (Tukey 双权，尺度取残差的中位数绝对偏差)，
+     * 毛刺、粘连的碎屑等离群点的权重降为零。
+     * @param method 不接受 CircleFit_MinEnclosing (它不是最小二乘拟合，调用方直接使用 cv::minEnclosingCircle)。
+     * @return 点数少于3、点共线或方法无效时返回 false。
+     */
+    bool INSPECTOR_API FitCircle(const PointSet& points, CircleFitMethod method, CircleFit& fit, int robustIterations = 0);
+
+    /**
+     * @brief 总体最小二乘直线拟合 (点到直线的垂直距离平方和最小，等同于 cv::fitLine 的 DIST_L2)。
+     * @return 点数少于2时返回 false。
+     */
+    bool INSPECTOR_API FitLine(const PointSet& points, LineFit& fit, int robustIterations = 0);
+
+    /**
+     * @brief 直接椭圆拟合 (Fitzgibbon 方法的 Halir-Flusser 数值稳定形式，保证结果是椭圆)。
+     * @details 坐标先平移到质心并归一化，矩在一遍扫描中求出，3x3 的特征值问题直接求解，不分配 cv::Mat。
+     * @return 点数少于5或点集退化时返回 false。
+     */
+    bool INSPECTOR_API FitEllipse(const PointSet& points, EllipseFit& fit, int robustIterations = 0);
+
+} // namespace InspectorLib
+
+#endif // INSPECTOR_FITTING_H
@@ -0,0 +1,105 @@
+﻿// FlatField.cpp
+
+#include "FlatField.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace InspectorLib
+{
+    const float FlatFieldCorrection::kMinGain = 0.05f;
+    const float FlatFieldCorrection::kMaxGain = 20.0f;
+
+    bool FlatFieldCorrection::calibrate(const cv::Mat& dark, const cv::Mat& flat, int bitDepth)
+    {
+        if (dark.empty() || dark.size() != flat.size() || dark.channels() != 1 || flat.channels() != 1) return false;
+
+        // 1. 按块求平均 (INTER_AREA 即块内均值)，同时去掉了单个像素的噪声
+        const cv::Size blocks((dark.cols + kBlockSize - 1) / kBlockSize, (dark.rows + kBlockSize - 1) / kBlockSize);
+        cv::Mat darkF, flatF, darkBlocks, flatBlocks;
+        dark.convertTo(darkF, CV_32F);
+        flat.convertTo(flatF, CV_32F);
+        cv::resize(darkF, darkBlocks, blocks, 0, 0, cv::INTER_AREA);
+        cv::resize(flatF, flatBlocks, blocks, 0, 0, cv::INTER_AREA);
+
+        // 2. 增益 g = (F - D) / mean(F - D)
+        cv::Mat signal = flatBlocks - darkBlocks;
+        const double meanSignal = cv::mean(signal)[0];
+        if (meanSignal <= 1.0) return false; // 平场不比暗场亮：多半是光源没有打开
+        cv::Mat gain = signal / meanSignal;
+        cv::max(gain, kMinGain, gain);
+        cv::min(gain, kMaxGain, gain);
+
+        std::lock_guard<std::mutex> lock(m_cacheMutex);
+        m_sensorSize = dark.size();
+        m_bitDepth = bitDepth;
+        m_dark = darkBlocks;
+        m_gain = gain;
+        m_cachedMap.release();
+        return true;
+    }
+
+    bool FlatFieldCorrection::save(const std::string& path) const
+    {
+        if (!isValid()) return false;
+        cv::FileStorage fs(path, cv::FileStorage::WRITE);
+        if (!fs.isOpened()) return false;
+        fs << "blockSize" << kBlockSize;
+        fs << "sensorWidth" << m_sensorSize.width;
+        fs << "sensorHeight" << m_sensorSize.height;
+        fs << "bitDepth" << m_bitDepth;
+        fs << "dark" << m_dark;
+        fs << "gain" << m_gain;
+        return true;
+    }
+
+    bool FlatFieldCorrection::load(const std::string& path)
+    {
+        cv::FileStorage fs(path, cv::FileStorage::READ);
+        if (!fs.isOpened()) return false;
+
+        int blockSize = 0, width = 0, height = 0, bitDepth = 0;
+        cv::Mat dark, gain;
+        fs["blockSize"] >> blockSize;
+        fs["sensorWidth"] >> width;
+        fs["sensorHeight"] >> height;
+        fs["bitDepth"] >> bitDepth;
+        fs["dark"] >> dark;
+        fs["gain"] >> gain;
+        if (blockSize != kBlockSize || width <= 0 || height <= 0 || dark.empty() || dark.size() != gain.size()) return false;
+
+        std::lock_guard<std::mutex> lock(m_cacheMutex);
+        m_sensorSize = cv::Size(width, height);
+        m_bitDepth = bitDepth;
+        m_dark = dark;
+        m_gain = gain;
+        m_cachedMap.release();
+        return true;
+    }
+
+    cv::Mat FlatFieldCorrection::thresholdMap(uint16_t threshold, int bitDepth, const cv::Size& frameSize, const cv::Point& offset, int scale) const
+    {
+        if (!isValid() || scale < 1) return cv::Mat();
+
+        std::lock_guard<std::mutex> lock(m_cacheMutex);
+
+        // 1. 缓存未命中时，生成整幅传感器 (按 scale 缩放) 的阈值表: D + T * g，块之间双线性插值
+        if (m_cachedMap.empty() || m_cachedThreshold != threshold || m_cachedBitDepth != bitDepth || m_cachedScale != scale)
+        {
+            const double depthScale = std::ldexp(1.0, bitDepth - m_bitDepth); // 位深不同时换算暗场
+            cv::Mat blockMap = m_dark * depthScale + m_gain * static_cast<double>(threshold);
+            cv::Mat fullMap;
+            cv::resize(blockMap, fullMap, cv::Size(m_sensorSize.width / scale, m_sensorSize.height / scale), 0, 0, cv::INTER_LINEAR);
+            fullMap.convertTo(m_cachedMap, CV_16U); // 饱和转换，超出范围的阈值截断到 0 ~ 65535
+            m_cachedThreshold = threshold;
+            m_cachedBitDepth = bitDepth;
+            m_cachedScale = scale;
+        }
+
+        // 2. 取出与这一帧对应的区域 (不拷贝；缓存被替换时，已经返回的表仍然有效)
+        const cv::Rect region(offset.x / scale, offset.y / scale, frameSize.width, frameSize.height);
+        if ((region & cv::Rect(0, 0, m_cachedMap.cols, m_cachedMap.rows)) != region) return cv::Mat();
+        return m_cachedMap(region);
+    }
+
+} // namespace InspectorLib
@@ -0,0 +1,77 @@
+﻿// FlatField.h (平场校正：暗场 + 平场参考图 -> 逐像素二值化阈值)
+
+#ifndef INSPECTOR_FLATFIELD_H
+#define INSPECTOR_FLATFIELD_H
+
+#include "Inspector.h" // INSPECTOR_API
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+
+namespace InspectorLib
+{
+    /**
+     * @brief 平场校正表：补偿背光的暗角 (vignetting) 和传感器的暗电流偏置。
+     *
+     * @details 标定时采集两张参考图 (通常各取多帧平均)：
+     *  - 暗场 D：关闭光源或盖上镜头；
+     *  - 平场 F：打开背光，视野中没有零件。
+     * 校正后的像素值为 c = (raw - D) * mean(F - D) / (F - D)。暗角是缓慢变化的，
+     * 所以只按 kBlockSize x kBlockSize 的块保存 D 和增益 g = (F - D) / mean(F - D)，文件只有几百KB。
+     *
+     * 【关键】检测时并不真的去校正图像：c > T 等价于 raw > D + T * g，
+     * 所以校正被折算成一张逐像素的阈值表，二值化内核在同一遍扫描中与它比较 (见 UnpackAndThreshold)，
+     * 不需要额外的整幅处理。阈值表按 (阈值, 位深, 缩放) 缓存，只在第一次使用时生成。
+     *
+     * 标定之后对象只读 (thresholdMap 内部的缓存有锁保护)，可以被多个测量线程共享。
+     */
+    class INSPECTOR_API FlatFieldCorrection
+    {
+    public:
+        static const int kBlockSize = 16;    // 校正表的块大小 (传感器像素)
+        static const float kMinGain;         // 增益的下限，防止平场中的坏点或遮挡产生极端的阈值
+        static const float kMaxGain;
+
+        /**
+         * @brief 由暗场和平场参考图建立校正表。
+         * @param dark 暗场，单通道，任意深度 (内部转换为 float)，数值为原始位深 (例如 Mono12 为 0 ~ 4095)。
+         * @param flat 平场，尺寸和位深与 dark 相同。
+         * @param bitDepth 参考图的位深。
+         * @return 尺寸不一致或平场不比暗场亮时返回 false。
+         */
+        bool calibrate(const cv::Mat& dark, const cv::Mat& flat, int bitDepth);
+
+        bool save(const std::string& path) const; // 保存为 OpenCV 的 YAML/XML 文件 (由扩展名决定)
+        bool load(const std::string& path);
+
+        bool isValid() const { return !m_gain.empty(); }
+        cv::Size sensorSize() const { return m_sensorSize; }
+
+        /**
+         * @brief 返回与一帧图像对应的逐像素阈值表 (CV_16UC1，尺寸为 frameSize)。
+         * @param threshold 未校正时使用的阈值 (原始位深)。
+         * @param bitDepth 当前图像的位深，与标定时不同时自动换算暗场。
+         * @param offset 图像左上角在传感器上的位置 (相机端ROI，传感器像素)。
+         * @param scale 图像一个像素对应的传感器像素数 (合并、半分辨率)。
+         * @return 图像超出标定的传感器范围时返回空 Mat (此时调用方应退回固定阈值)。
+         */
+        cv::Mat thresholdMap(uint16_t threshold, int bitDepth, const cv::Size& frameSize, const cv::Point& offset, int scale) const;
+
+    private:
+        cv::Size m_sensorSize;  // 标定时的图像尺寸
+        int m_bitDepth = 8;     // 标定时的位深
+        cv::Mat m_dark;         // 每块的暗场均值 (CV_32FC1)
+        cv::Mat m_gain;         // 每块的增益 (CV_32FC1)
+
+        // --- 阈值表缓存 (整幅传感器按 scale 缩放后的尺寸) ---
+        mutable std::mutex m_cacheMutex;
+        mutable cv::Mat m_cachedMap;
+        mutable uint16_t m_cachedThreshold = 0;
+        mutable int m_cachedBitDepth = 0;
+        mutable int m_cachedScale = 0;
+    };
+
+} // namespace InspectorLib
+
+#endif // INSPECTOR_FLATFIELD_H
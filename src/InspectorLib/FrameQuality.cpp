@@ -0,0 +1,116 @@
+﻿// FrameQuality.cpp
+
+#include "FrameQuality.h"
+#include "PixelFormat.h"
+
+#include <algorithm>
+#include <vector>
+
+namespace InspectorLib
+{
+    namespace
+    {
+        const int kIntensityRowStep = 8; // 灰度分布：每8行采样一行 (每行 1/4 的像素)
+        const int kBorderInset = 2;      // 边界离图像边缘的距离，避开镜像边界和传感器边缘的坏列
+        const int kBorderRowStep = 4;    // 左右两列的采样行间隔
+        const int kFocusRowStep = 16;    // 清晰度：每16行采样一行
+        const int kFocusSegment = 16;    // 清晰度：每隔 kFocusStride 个像素取连续的16个像素
+        const int kFocusStride = 64;
+    }
+
+    bool INSPECTOR_API MeasureFrameQuality(const cv::Mat& rawImage, PixelFormat format,
+        const QualityGateOptions& options, FrameQuality& quality)
+    {
+        quality = FrameQuality();
+        const int width = RawFrameWidth(rawImage, format);
+        if (width <= 0) return false;
+        const bool bayer = IsBayerFormat(format);
+        const int rows = bayer ? rawImage.rows / 2 : rawImage.rows; // 与 ReadPixels8 相同，Bayer 按超像素计算
+        const int cols = bayer ? width / 2 : width;
+        if (rows < 2 * kBorderInset + 3 || cols < 2 * kBorderInset + 4) return false;
+
+        // --- a. 灰度分布 ---
+        uint32_t histogram[256] = {};
+        const int samples = SampleHistogram(rawImage, format, kIntensityRowStep, 0, histogram);
+        if (samples <= 0) return false;
+
+        const int level = std::max(0, std::min(255, options.foregroundLevel));
+        uint32_t foreground = 0;
+        for (int b = level + 1; b < 256; ++b) foreground += histogram[b];
+        quality.foregroundFraction = static_cast<float>(foreground) / samples;
+        quality.saturatedFraction = static_cast<float>(histogram[255]) / samples;
+
+        uint32_t above = 0; // 从亮的一端累加，直到超过 1%
+        int bright = 255;
+        while (bright > 0 && (above + histogram[bright]) * 100 < static_cast<uint32_t>(samples)) {
+            above += histogram[bright];
+            --bright;
+        }
+        quality.brightLevel = bright;
+
+        // --- b. 边界占用 ---
+        std::vector<uint8_t> line(cols);
+        uint32_t borderSamples = 0, borderForeground = 0;
+        auto countLine = [&](const uint8_t* values, int n) {
+            for (int i = 0; i < n; ++i) borderForeground += values[i] > level;
+            borderSamples += n;
+        };
+        // 上下两行整行读取 (打包格式要求起点和长度为偶数，所以从第0列开始)
+        const int evenCols = cols & ~1;
+        for (int y : { kBorderInset, rows - 1 - kBorderInset })
+        {
+            if (ReadPixels8(rawImage, format, y, 0, evenCols, line.data())) {
+                countLine(line.data() + kBorderInset, evenCols - 2 * kBorderInset);
+            }
+        }
+        // 左右两列：每次读取两个像素 (起点为偶数)
+        const int rightX = (cols - kBorderInset - 2) & ~1;
+        for (int y = kBorderInset + 1; y < rows - 1 - kBorderInset; y += kBorderRowStep)
+        {
+            uint8_t pair[2];
+            if (ReadPixels8(rawImage, format, y, kBorderInset, 2, pair)) countLine(pair, 1);
+            if (ReadPixels8(rawImage, format, y, rightX, 2, pair)) countLine(pair + 1, 1);
+        }
+        quality.borderFraction = borderSamples > 0 ? static_cast<float>(borderForeground) / borderSamples : 0.0f;
+
+        // --- c. 清晰度 (只在需要时计算) ---
+        if (options.minFocus > 0.0f)
+        {
+            uint8_t up[kFocusSegment], mid[kFocusSegment], down[kFocusSegment];
+            double sum = 0.0, sumSq = 0.0;
+            int count = 0;
+            for (int y = kFocusRowStep / 2; y + 1 < rows; y += kFocusRowStep)
+            {
+                for (int x = 0; x + kFocusSegment <= cols; x += kFocusStride)
+                {
+                    if (!ReadPixels8(rawImage, format, y - 1, x, kFocusSegment, up) ||
+                        !ReadPixels8(rawImage, format, y, x, kFocusSegment, mid) ||
+                        !ReadPixels8(rawImage, format, y + 1, x, kFocusSegment, down)) continue;
+                    for (int i = 1; i + 1 < kFocusSegment; ++i)
+                    {
+                        const int response = 4 * mid[i] - mid[i - 1] - mid[i + 1] - up[i] - down[i];
+                        sum += response;
+                        sumSq += static_cast<double>(response) * response;
+                        ++count;
+                    }
+                }
+            }
+            if (count > 0) {
+                const double mean = sum / count;
+                quality.focus = static_cast<float>(sumSq / count - mean * mean);
+            }
+        }
+        return true;
+    }
+
+    uint32_t INSPECTOR_API CheckFrameQuality(const FrameQuality& quality, const QualityGateOptions& options)
+    {
+        if (quality.brightLevel < options.minBrightLevel) return 8;                   // underexposed
+        if (quality.saturatedFraction > options.maxSaturatedFraction) return 7;       // overexposed
+        if (quality.foregroundFraction < options.minForegroundFraction) return 4;     // empty_frame
+        if (quality.borderFraction > options.maxBorderFraction) return 5;             // part_truncated
+        if (options.minFocus > 0.0f && quality.focus < options.minFocus) return 6;    // out_of_focus
+        return 0;
+    }
+
+} // namespace InspectorLib
@@ -0,0 +1,36 @@
+﻿// FrameQuality.h (图像质量预检：在完整检测之前拒绝空帧、不完整、模糊和曝光异常的图像)
+
+#ifndef INSPECTOR_FRAMEQUALITY_H
+#define INSPECTOR_FRAMEQUALITY_H
+
+#include "Inspector.h" // INSPECTOR_API、PixelFormat、QualityGateOptions、FrameQuality
+
+#include <cstdint>
+
+namespace InspectorLib
+{
+    /**
+     * @brief 在稀疏的采样网格上统计图像质量 (只读取整幅像素的百分之几，不需要解包整幅图像)。
+     *
+     * @details 三类统计：
+     *  - 灰度分布：每隔 kIntensityRowStep 行采样 (见 SampleHistogram)，得到零件像素、饱和像素的比例和 99% 分位；
+     *  - 边界占用：离边缘 kBorderInset 个像素的上下两行 (整行) 和左右两列 (每隔 kBorderRowStep 行)；
+     *  - 清晰度：每隔 kFocusRowStep 行、在采样网格的小段上计算4邻域拉普拉斯响应 4c - l - r - u - d 的方差。
+     *    图像越模糊，边缘越平缓，响应越小。只在 options.minFocus > 0 时计算。
+     * Bayer 格式的统计在 2x2 超像素上进行。
+     * @return rawImage 的类型与 format 不匹配或图像太小时返回 false。
+     */
+    bool INSPECTOR_API MeasureFrameQuality(const cv::Mat& rawImage, PixelFormat format,
+        const QualityGateOptions& options, FrameQuality& quality);
+
+    /**
+     * @brief 按阈值判断质量统计，返回 0 (通过) 或拒绝原因的状态码。
+     * @details 按以下顺序检查，返回第一个不满足的条件：
+     *  8 "underexposed"、7 "overexposed"、4 "empty_frame"、5 "part_truncated"、6 "out_of_focus"。
+     * 曝光放在最前面：光源故障时，空帧、不完整等判断都没有意义。
+     */
+    uint32_t INSPECTOR_API CheckFrameQuality(const FrameQuality& quality, const QualityGateOptions& options);
+
+} // namespace InspectorLib
+
+#endif // INSPECTOR_FRAMEQUALITY_H
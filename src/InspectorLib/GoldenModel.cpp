@@ -0,0 +1,311 @@
+﻿// GoldenModel.cpp
+
+#include "GoldenModel.h"
+
+#include <algorithm>
+#include <climits>
+#include <cmath>
+
+#include "Simd.h" // INSPECTOR_AVX2：gather 指令只有 AVX2 才有，没有时退回标量查表，结果相同
+
+namespace InspectorLib
+{
+    namespace
+    {
+        // 块内用 float 累加，每 kBlock 个像素把部分和转为 double (与 Fitting.cpp 相同的做法)
+        const size_t kBlock = 1024;
+
+        // 零件附近的 Canny 边缘 (roi 内的坐标)：外轮廓填充后向外扩 kEdgeBand 像素作为掩膜，背景上的边缘不要
+        void PartEdges(const cv::Mat& image, const std::vector<cv::Point>& contour, const cv::Rect& roi,
+                       const GoldenModelOptions& options, cv::Mat& edges)
+        {
+            thread_local std::vector<std::vector<cv::Point>> polygon(1);
+            thread_local cv::Mat mask;
+            polygon[0] = contour;
+            cv::Canny(image(roi), edges, options.cannyLow, options.cannyHigh);
+            mask.create(roi.size(), CV_8U);
+            mask.setTo(cv::Scalar(0));
+            cv::drawContours(mask, polygon, 0, cv::Scalar(255), cv::FILLED, cv::LINE_8, cv::noArray(), INT_MAX, -roi.tl());
+            cv::drawContours(mask, polygon, 0, cv::Scalar(255), 2 * GoldenModel::kEdgeBand + 1, cv::LINE_8, cv::noArray(), INT_MAX, -roi.tl());
+            cv::bitwise_and(edges, mask, edges);
+        }
+
+        // 外接矩形的长短边之差小于长边的这个比例时按近似正方形处理，长边方向不可靠，±90° 也要打分
+        const float kSquareTolerance = 0.1f;
+
+        // 外接矩形长边的方向 (度)
+        float LongSideAngle(const cv::RotatedRect& box)
+        {
+            return box.size.width < box.size.height ? box.angle + 90.0f : box.angle;
+        }
+
+        // 图像 -> 金板距离图：g = R(-theta) (p - center) + goldenCenter
+        cv::Matx23f ImageToGolden(const cv::Point2f& center, float theta, const cv::Point2f& goldenCenter)
+        {
+            const double rad = theta * CV_PI / 180.0;
+            const float c = static_cast<float>(std::cos(rad)), s = static_cast<float>(std::sin(rad));
+            return cv::Matx23f(c, s, goldenCenter.x - (c * center.x + s * center.y),
+                               -s, c, goldenCenter.y - (-s * center.x + c * center.y));
+        }
+
+        /**
+         * chamfer 打分：每个边缘像素按 m 换算到距离图 (取最近的像素，图外钳位到边界)，距离写入 out，返回距离之和。
+         * 距离图必须是连续存放的 (下标 = y * cols + x)。
+         */
+        double ChamferScore(const float* xs, const float* ys, size_t n, const cv::Matx23f& m, const cv::Mat& distance, float* out)
+        {
+            const float* base = distance.ptr<float>();
+            const int cols = distance.cols, rows = distance.rows;
+            double sum = 0.0;
+            size_t i = 0;
+#ifdef INSPECTOR_AVX2
+            const __m256 m00 = _mm256_set1_ps(m(0, 0)), m01 = _mm256_set1_ps(m(0, 1)), m02 = _mm256_set1_ps(m(0, 2));
+            const __m256 m10 = _mm256_set1_ps(m(1, 0)), m11 = _mm256_set1_ps(m(1, 1)), m12 = _mm256_set1_ps(m(1, 2));
+            const __m256i zero = _mm256_setzero_si256(), stride = _mm256_set1_epi32(cols);
+            const __m256i maxX = _mm256_set1_epi32(cols - 1), maxY = _mm256_set1_epi32(rows - 1);
+            const size_t vectorEnd = n & ~size_t(7);
+            while (i < vectorEnd)
+            {
+                const size_t blockEnd = std::min(vectorEnd, i + kBlock);
+                __m256 acc = _mm256_setzero_ps();
+                for (; i < blockEnd; i += 8)
+                {
+                    const __m256 x = _mm256_loadu_ps(xs + i), y = _mm256_loadu_ps(ys + i);
+                    const __m256 gx = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(m00, x), _mm256_mul_ps(m01, y)), m02);
+                    const __m256 gy = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(m10, x), _mm256_mul_ps(m11, y)), m12);
+                    // 四舍五入 (与标量的 cvRound 相同)，钳位到距离图内，8个下标一次 gather
+                    const __m256i ix = _mm256_min_epi32(_mm256_max_epi32(_mm256_cvtps_epi32(gx), zero), maxX);
+                    const __m256i iy = _mm256_min_epi32(_mm256_max_epi32(_mm256_cvtps_epi32(gy), zero), maxY);
+                    const __m256i index = _mm256_add_epi32(_mm256_mullo_epi32(iy, stride), ix);
+                    const __m256 d = _mm256_i32gather_ps(base, index, 4);
+                    _mm256_storeu_ps(out + i, d);
+                    acc = _mm256_add_ps(acc, d);
+                }
+                alignas(32) float lanes[8];
+                _mm256_store_ps(lanes, acc);
+                for (float lane : lanes) sum += lane;
+            }
+#endif
+            for (; i < n; ++i)
+            {
+                const int ix = std::min(std::max(cvRound(m(0, 0) * xs[i] + m(0, 1) * ys[i] + m(0, 2)), 0), cols - 1);
+                const int iy = std::min(std::max(cvRound(m(1, 0) * xs[i] + m(1, 1) * ys[i] + m(1, 2)), 0), rows - 1);
+                out[i] = base[iy * cols + ix];
+                sum += out[i];
+            }
+            return sum;
+        }
+    }
+
+    bool GoldenModel::train(const cv::Mat& golden, const GoldenModelOptions& options)
+    {
+        if (golden.empty() || golden.type() != CV_8UC1) return false;
+
+        // 1. 零件外轮廓 (面积最大的外轮廓)
+        cv::Mat binary;
+        if (options.threshold > 0) cv::threshold(golden, binary, options.threshold, 255, cv::THRESH_BINARY);
+        else cv::threshold(golden, binary, 0, 255, cv::THRESH_BINARY | cv::THRESH_OTSU);
+        std::vector<std::vector<cv::Point>> contours;
+        cv::findContours(binary, contours, cv::RETR_EXTERNAL, cv::CHAIN_APPROX_SIMPLE);
+        int part = -1;
+        double maxArea = 0.0;
+        for (int i = 0; i < static_cast<int>(contours.size()); ++i)
+        {
+            const double area = cv::contourArea(contours[i]);
+            if (area > maxArea) { maxArea = area; part = i; }
+        }
+        if (part < 0) return false;
+
+        // 2. 零件附近的边缘 (距离图只覆盖零件的外接矩形加上 margin)
+        const int margin = std::max(options.margin, kEdgeBand + 1);
+        const cv::Rect bounds = cv::boundingRect(contours[part]);
+        const cv::Rect roi = cv::Rect(bounds.x - margin, bounds.y - margin, bounds.width + 2 * margin, bounds.height + 2 * margin)
+                             & cv::Rect(0, 0, golden.cols, golden.rows);
+        cv::Mat edges;
+        PartEdges(golden, contours[part], roi, options, edges);
+        std::vector<cv::Point> points;
+        cv::findNonZero(edges, points);
+        if (points.empty()) return false;
+
+        // 3. 金板坐标系：外接矩形的中心 (距离图的坐标) 和长边方向
+        const cv::RotatedRect box = cv::minAreaRect(contours[part]);
+        m_options = options;
+        m_center = box.center - cv::Point2f(roi.tl());
+        m_angle = LongSideAngle(box);
+        m_origin = cv::Point2f((golden.cols - 1) * 0.5f - roi.x, (golden.rows - 1) * 0.5f - roi.y); // 与 ShapeModel 的模型原点相同
+        m_hasOrigin = true;
+        m_size = roi.size();
+        m_edges = points;
+        return finish();
+    }
+
+    bool GoldenModel::finish()
+    {
+        // 边缘像素为0的图做欧氏距离变换，得到每个像素到最近的边缘的距离
+        cv::Mat notEdge(m_size, CV_8U, cv::Scalar(255));
+        for (const cv::Point& p : m_edges) notEdge.at<uchar>(p) = 0;
+        cv::Mat distance;
+        cv::distanceTransform(notEdge, distance, cv::DIST_L2, cv::DIST_MASK_PRECISE);
+        cv::min(distance, static_cast<double>(kMaxDistance), distance);
+        m_distance = distance;
+        return true;
+    }
+
+    bool GoldenModel::save(const std::string& path) const
+    {
+        if (!isValid()) return false;
+        cv::FileStorage fs(path, cv::FileStorage::WRITE);
+        if (!fs.isOpened()) return false;
+        fs << "threshold" << m_options.threshold;
+        fs << "cannyLow" << m_options.cannyLow;
+        fs << "cannyHigh" << m_options.cannyHigh;
+        fs << "margin" << m_options.margin;
+        fs << "width" << m_size.width;
+        fs << "height" << m_size.height;
+        fs << "centerX" << m_center.x;
+        fs << "centerY" << m_center.y;
+        fs << "angle" << m_angle;
+        fs << "originX" << m_origin.x;
+        fs << "originY" << m_origin.y;
+        fs << "edges" << cv::Mat(m_edges).reshape(1); // 每行一个边缘像素：x, y
+        return true;
+    }
+
+    bool GoldenModel::load(const std::string& path)
+    {
+        cv::FileStorage fs(path, cv::FileStorage::READ);
+        if (!fs.isOpened()) return false;
+
+        GoldenModelOptions options;
+        int width = 0, height = 0;
+        cv::Point2f center;
+        float angle = 0.0f;
+        cv::Mat edges;
+        fs["threshold"] >> options.threshold;
+        fs["cannyLow"] >> options.cannyLow;
+        fs["cannyHigh"] >> options.cannyHigh;
+        fs["margin"] >> options.margin;
+        fs["width"] >> width;
+        fs["height"] >> height;
+        fs["centerX"] >> center.x;
+        fs["centerY"] >> center.y;
+        fs["angle"] >> angle;
+        const bool hasOrigin = !fs["originX"].empty() && !fs["originY"].empty();
+        cv::Point2f origin;
+        if (hasOrigin) {
+            fs["originX"] >> origin.x;
+            fs["originY"] >> origin.y;
+        }
+        fs["edges"] >> edges;
+        if (width <= 0 || height <= 0 || edges.empty() || edges.cols != 2 || edges.type() != CV_32S) return false;
+
+        std::vector<cv::Point> points(edges.rows);
+        for (int i = 0; i < edges.rows; ++i)
+        {
+            points[i] = cv::Point(edges.at<int>(i, 0), edges.at<int>(i, 1));
+            if (points[i].x < 0 || points[i].y < 0 || points[i].x >= width || points[i].y >= height) return false;
+        }
+        m_options = options;
+        m_center = center;
+        m_angle = angle;
+        m_origin = origin;
+        m_hasOrigin = hasOrigin;
+        m_size = cv::Size(width, height);
+        m_edges = points;
+        return finish();
+    }
+
+    bool GoldenModel::compare(const cv::Mat& image, const std::vector<cv::Point>& partContour, const cv::RotatedRect& box,
+                              const PartPose& pose, float tolerance, GoldenResult& result) const
+    {
+        result = GoldenResult();
+        if (!isValid() || image.empty() || image.type() != CV_8UC1 || partContour.empty() || tolerance < 0.0f) return false;
+
+        // 1. 这一帧零件附近的边缘像素 (图像坐标，SoA 便于向量化)
+        const cv::Rect bounds = cv::boundingRect(partContour);
+        const int pad = kEdgeBand + 1;
+        const cv::Rect roi = cv::Rect(bounds.x - pad, bounds.y - pad, bounds.width + 2 * pad, bounds.height + 2 * pad)
+                             & cv::Rect(0, 0, image.cols, image.rows);
+        if (roi.empty()) return false;
+        thread_local cv::Mat edges;
+        thread_local std::vector<cv::Point> points;
+        thread_local std::vector<float> xs, ys, distances, flipped;
+        PartEdges(image, partContour, roi, m_options, edges);
+        cv::findNonZero(edges, points);
+        const size_t n = points.size();
+        if (n == 0) return false;
+        xs.resize(n);
+        ys.resize(n);
+        distances.resize(n);
+        flipped.resize(n);
+        for (size_t i = 0; i < n; ++i) {
+            xs[i] = static_cast<float>(points[i].x + roi.x);
+            ys[i] = static_cast<float>(points[i].y + roi.y);
+        }
+
+        // 2. 对齐：金板坐标系的中心 (m_center) 在这一帧中的位置和转角
+        // 解释: 有形状模型的位姿时，模型原点对 m_origin，转角就是位姿的角度，金板中心随之换算过来；
+        //       否则外接矩形的中心对金板中心，长边方向对金板的长边方向，正反两种方向都打分 (接近正方形时再加上 ±90°)，取距离小的一种
+        cv::Point2f center = box.center;
+        float theta = LongSideAngle(box) - m_angle;
+        double sum = 0.0;
+        if (pose.found && m_hasOrigin)
+        {
+            theta = pose.angle;
+            const double rad = theta * CV_PI / 180.0;
+            const float c = static_cast<float>(std::cos(rad)), s = static_cast<float>(std::sin(rad));
+            const cv::Point2f d = m_center - m_origin;
+            center = cv::Point2f(pose.position.x + c * d.x - s * d.y, pose.position.y + s * d.x + c * d.y);
+            sum = ChamferScore(xs.data(), ys.data(), n, ImageToGolden(center, theta, m_center), m_distance, distances.data());
+        }
+        else
+        {
+            const float longSide = std::max(box.size.width, box.size.height);
+            const int turns = std::abs(box.size.width - box.size.height) < kSquareTolerance * longSide ? 4 : 2;
+            const float base = theta;
+            for (int k = 0; k < turns; ++k)
+            {
+                const float candidate = base + (turns == 4 ? 90.0f : 180.0f) * k;
+                const double candidateSum = ChamferScore(xs.data(), ys.data(), n, ImageToGolden(center, candidate, m_center), m_distance, flipped.data());
+                if (k == 0 || candidateSum < sum) {
+                    sum = candidateSum;
+                    theta = candidate;
+                    distances.swap(flipped);
+                }
+            }
+        }
+        const cv::Matx23f m = ImageToGolden(center, theta, m_center);
+
+        // 3. 统计和热力图：每格取格内边缘距离的最大值
+        cv::Mat heatmap((m_size.height + kHeatCell - 1) / kHeatCell, (m_size.width + kHeatCell - 1) / kHeatCell, CV_32F, cv::Scalar(0));
+        int outliers = 0;
+        for (size_t i = 0; i < n; ++i)
+        {
+            const float d = distances[i];
+            if (d > tolerance) ++outliers;
+            if (d > result.maxDistance) { result.maxDistance = d; result.worstPoint = cv::Point2f(xs[i], ys[i]); }
+            const int ix = std::min(std::max(cvRound(m(0, 0) * xs[i] + m(0, 1) * ys[i] + m(0, 2)), 0), m_size.width - 1);
+            const int iy = std::min(std::max(cvRound(m(1, 0) * xs[i] + m(1, 1) * ys[i] + m(1, 2)), 0), m_size.height - 1);
+            float& cell = heatmap.at<float>(iy / kHeatCell, ix / kHeatCell);
+            cell = std::max(cell, d);
+        }
+        result.meanDistance = static_cast<float>(sum / n);
+        result.outlierRatio = static_cast<float>(outliers) / n;
+        result.edgeCount = static_cast<int>(n);
+        result.center = center;
+        result.angle = theta;
+        result.heatmap = heatmap;
+        result.valid = true;
+        return true;
+    }
+
+    cv::Point2f GoldenModel::toImage(const GoldenResult& result, const cv::Point2f& goldenPoint) const
+    {
+        // g = R(-theta) (p - center) + m_center 的逆变换
+        const double rad = result.angle * CV_PI / 180.0;
+        const float c = static_cast<float>(std::cos(rad)), s = static_cast<float>(std::sin(rad));
+        const cv::Point2f d = goldenPoint - m_center;
+        return cv::Point2f(result.center.x + c * d.x - s * d.y, result.center.y + s * d.x + c * d.y);
+    }
+
+} // namespace InspectorLib
@@ -0,0 +1,98 @@
+﻿// GoldenModel.h (与金板比较：金板边缘图的距离变换只算一次，逐帧按零件位姿对齐后对边缘像素做 chamfer 打分)
+
+#ifndef INSPECTOR_GOLDENMODEL_H
+#define INSPECTOR_GOLDENMODEL_H
+
+#include "Inspector.h" // INSPECTOR_API、GoldenResult
+
+#include <string>
+#include <vector>
+
+namespace InspectorLib
+{
+    /**
+     * @brief 训练参数。金板和检测时的边缘用同一组参数提取。
+     */
+    struct GoldenModelOptions
+    {
+        int threshold = 0;         // 找零件外轮廓的二值化阈值 (8位灰度)，0 为 Otsu
+        double cannyLow = 40.0;    // Canny 边缘的双阈值
+        double cannyHigh = 120.0;
+        int margin = 16;           // 距离图在零件外接矩形之外保留的像素
+    };
+
+    /**
+     * @brief 金板模型：金板图像 (golden image) 上零件边缘的距离变换。
+     *
+     * @details 训练 (每个配方一次)：
+     *  1. 二值化找出面积最大的外轮廓，它的最小外接矩形 (中心和长边方向) 是金板的坐标系，与 MeasurementResults::boundingBox 的约定相同；
+     *     同时记下金板图像的中心，它是形状模型 (ShapeModel) 的原点，用形状模型的位姿对齐时以它为基准；
+     *  2. 在零件附近 (外轮廓填充后向外扩 kEdgeBand 像素) 提取 Canny 边缘，对边缘图做一次欧氏距离变换，
+     *     距离截断在 kMaxDistance。
+     *
+     * 逐帧比较：这一帧的边缘用同样的方法提取，每个边缘像素按零件的位姿换算到金板坐标，在距离图上取值 (chamfer 距离)。
+     * 有形状模型的位姿时按位姿对齐 (金板模型和形状模型必须由同一张金板图像训练)；否则按外接矩形对齐，
+     * 毛刺会让外接矩形的中心和方向偏移，整个零件随之错位，所以有形状模型时应优先用位姿。
+     * 距离图是预先算好的，比较只是一遍对边缘像素的查表和求和 (AVX2 时8个像素一组 gather)。
+     * 金板上没有的边缘 (毛刺、裂纹、压痕、异物、形状不对的轮廓) 距离大，在热力图上标出；
+     * 圆孔和槽口的测量只看拟合出的尺寸，这类局部的形状缺陷它们看不到。
+     * 注意这是单向的距离：金板上有、这一帧缺失的边缘只有在附近出现了别的边缘时才会被发现。
+     *
+     * 训练之后对象只读，可以被多个测量线程共享。金板与检测图像的分辨率必须相同
+     * (Bayer 半分辨率检测时，金板也应该是半分辨率的预览图)。
+     */
+    class INSPECTOR_API GoldenModel
+    {
+    public:
+        static const int kMaxDistance = 16; // 距离的截断值 (像素)：更远的边缘都按这个距离计分
+        static const int kEdgeBand = 3;     // 零件轮廓向外扩的像素，只在这个范围内取边缘 (背景上的杂物不参与比较)
+        static const int kHeatCell = 8;     // 热力图一格的边长 (金板像素)
+
+        /**
+         * @brief 由金板图像训练 (CV_8UC1)。
+         * @return 图像为空、找不到零件或零件上没有边缘时返回 false，原有的模型保持不变。
+         */
+        bool train(const cv::Mat& golden, const GoldenModelOptions& options = GoldenModelOptions());
+
+        /**
+         * @brief 保存/加载模型 (OpenCV YAML 格式，保存金板的边缘点和坐标系，距离图在加载时重新计算)。
+         */
+        bool save(const std::string& path) const;
+        bool load(const std::string& path);
+
+        bool isValid() const { return !m_distance.empty(); }
+        int edgeCount() const { return static_cast<int>(m_edges.size()); }
+
+        /**
+         * @brief 比较一帧中的零件与金板。
+         * @param image 检测用的8位灰度图 (处理图像)。
+         * @param partContour 零件外轮廓 (同一坐标)，限定取边缘的范围。
+         * @param box 零件外接矩形，没有位姿时用它对齐 (长边方向有正反两种可能，接近正方形时再加上 ±90°，取距离小的一种)。
+         * @param pose 形状模型找到的位姿 (同一坐标)，found 时按它对齐，box 不再使用。
+         * @param tolerance 距离超过它的边缘像素计为离群点 (像素)。
+         * @return 参数无效或这一帧的零件上没有边缘时返回 false，result.valid 与返回值相同。
+         */
+        bool compare(const cv::Mat& image, const std::vector<cv::Point>& partContour, const cv::RotatedRect& box,
+                     const PartPose& pose, float tolerance, GoldenResult& result) const;
+
+        /**
+         * @brief 金板坐标 (热力图的格子以 kHeatCell 为单位换算) 在这一帧图像中的位置，用于绘制热力图。
+         */
+        cv::Point2f toImage(const GoldenResult& result, const cv::Point2f& goldenPoint) const;
+
+    private:
+        bool finish(); // 由边缘点计算距离图
+
+        GoldenModelOptions m_options;
+        cv::Point2f m_center;            // 金板坐标系：零件外接矩形的中心 (距离图的坐标) 和长边方向 (度)
+        float m_angle = 0.0f;
+        cv::Point2f m_origin;            // 金板图像的中心 (形状模型的原点) 在距离图中的坐标
+        bool m_hasOrigin = false;        // 旧的模型文件没有保存 m_origin，只能按外接矩形对齐
+        cv::Size m_size;                 // 距离图的尺寸
+        std::vector<cv::Point> m_edges;  // 金板的边缘像素 (距离图的坐标)
+        cv::Mat m_distance;              // 到最近的金板边缘的距离 (像素，截断在 kMaxDistance)，CV_32FC1
+    };
+
+} // namespace InspectorLib
+
+#endif // INSPECTOR_GOLDENMODEL_H
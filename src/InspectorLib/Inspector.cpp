@@ -1,40 +1,634 @@
 // Inspector.cpp (㷨)
 
 #include "Inspector.h"
+#include "Metrics.h"
+#include "Stats.h"
+#include "PixelFormat.h"
+#include "FlatField.h"
+#include "AutoThreshold.h"
+#include "FrameQuality.h"
+#include "ChangeDetector.h"
+#include "Calibration.h"
+#include "Fitting.h"
+#include "Caliper.h"
+#include "ShapeModel.h"
+#include "Feret.h"
+#include "NominalModel.h"
+#include "GoldenModel.h"
 #include <vector>
+#include <algorithm>
+#include <chrono>
+#include <string>
 
 // ɫ (BGRʽ)
 const cv::Scalar COLOR_BLUE(255, 0, 0);
 const cv::Scalar COLOR_GREEN(0, 255, 0);
 const cv::Scalar COLOR_RED(0, 0, 255);
 const cv::Scalar COLOR_YELLOW(0, 255, 255);
+const cv::Scalar COLOR_MAGENTA(255, 0, 255);
+const cv::Scalar COLOR_ORANGE(0, 165, 255);
+
+// ֵֵ (8λҶȿ̶)̶ֵҲԶֵʧʱĺֵ
+const int BINARY_THRESHOLD = 50;
 
 namespace InspectorLib
 {
-    // ǵĺĺʵ
-    uint32_t INSPECTOR_API InspectPart(const cv::Mat& srcImage,
-        MeasurementResults& results,
-        cv::Mat& resultImage)
+    // ׶ ( InspectStage ˳һһӦ)
+    const char* INSPECTOR_API StageName(InspectStage stage)
+    {
+        static const char* const names[Stage_Count] = {
+            "QualityGate", "Canvas", "Threshold", "ShapeMatch", "FindContours", "LocatePart", "Features", "Deviation", "Golden"
+        };
+        return (stage >= 0 && stage < Stage_Count) ? names[stage] : "Unknown";
+    }
+
+    // ״̬ ( InspectPart ķֵһһӦ)
+    const char* INSPECTOR_API StatusName(uint32_t status)
+    {
+        switch (status)
+        {
+        case 0: return "ok";
+        case 1: return "empty_image";
+        case 2: return "not_grayscale";
+        case 3: return "part_not_found";
+        case 4: return "empty_frame";
+        case 5: return "part_truncated";
+        case 6: return "out_of_focus";
+        case 7: return "overexposed";
+        case 8: return "underexposed";
+        default: return "unknown";
+        }
+    }
+
+    // ʱӣϵͳʱӰ죬ʺϲʱ
+    int64_t INSPECTOR_API MonotonicNowNs()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    // һμĽͺʱȫָ (GUI  /metrics ӿں ExampleMain --metrics-dump ȡ)
+    static void RecordInspectMetrics(uint32_t status, const MeasurementResults& results, int64_t elapsedNs)
+    {
+        const StageTiming& timing = results.timing;
+        MetricsRegistry& registry = MetricsRegistry::Global();
+
+        // ؼָֻڵһεʱֱ֮ʹûã·û
+        static RateMeter& inspected = registry.meter("inspector_frames_inspected", "Frames processed by InspectPart");
+        static Histogram& latency = registry.histogram("inspector_inspect_latency_seconds", "InspectPart wall time in seconds");
+        static Gauge& binaryThreshold = registry.gauge("inspector_binary_threshold", "Binarisation threshold used by the last inspection (8-bit scale)");
+        static Histogram* stageLatency[Stage_Count] = {};
+        static std::once_flag stageOnce;
+        std::call_once(stageOnce, [&registry]() {
+            for (int i = 0; i < Stage_Count; ++i) {
+                const std::string labels = std::string("stage=\"") + StageName(static_cast<InspectStage>(i)) + "\"";
+                stageLatency[i] = &registry.histogram("inspector_stage_latency_seconds", "InspectPart stage time in seconds", labels);
+            }
+        });
+
+        inspected.mark();
+        latency.observe(elapsedNs * 1e-9);
+        if (timing.endNs[Stage_Threshold] != 0) binaryThreshold.set(results.threshold); // ǰشʱûжֵ
+        for (int i = 0; i < Stage_Count; ++i)
+        {
+            if (timing.endNs[i] != 0) {
+                stageLatency[i]->observe(timing.durationNs(static_cast<InspectStage>(i)) * 1e-9);
+            }
+        }
+
+        // ״̬٣
+        const std::string labels = std::string("result=\"") + (status == 0 ? "pass" : "fail")
+                                 + "\",status=\"" + StatusName(status) + "\"";
+        registry.counter("inspector_inspections_total", "Inspections by result and InspectPart status", labels).inc();
+    }
+
+    // 8λ̶ȵֵ㵽ԭʼλ: 8λֵ v > T ȼԭʼֵ >= (T + 1) << shift
+    // ˸λͼĶֵ롰תΪ8λٶֵȫͬ
+    static uint16_t NativeThreshold(int threshold8, int bitDepth)
+    {
+        return static_cast<uint16_t>(((threshold8 + 1) << (bitDepth - 8)) - 1);
+    }
+
+    // ѡȡһֵ֡ (8λ̶)Զֵϡֱͼϼ㣬ʧʱ˻ع̶ֵ
+    static int SelectThreshold(const cv::Mat& srcImage, PixelFormat format, const InspectOptions& options)
+    {
+        if (options.thresholdMethod == Threshold_Fixed) return BINARY_THRESHOLD;
+        const int threshold = options.thresholdTracker
+            ? options.thresholdTracker->update(srcImage, format, options.thresholdMethod) // ⣺
+            : AutoThreshold::Compute(srcImage, format, options.thresholdMethod);          // ֡
+        return threshold >= 0 ? threshold : BINARY_THRESHOLD;
+    }
+
+    // ƽУȡһ֡ () ӦֵûУͼ񳬳궨Χʱؿ Mat (ʹͳһֵ)
+    static cv::Mat FlatFieldThresholds(const cv::Mat& srcImage, PixelFormat format, const InspectOptions& options, uint16_t threshold)
+    {
+        if (!options.flatField) return cv::Mat();
+        const bool halfResolution = options.bayerHalfResolution && IsBayerFormat(format);
+        const int scale = std::max(1, options.sensorScale) * (halfResolution ? 2 : 1);
+        const int width = RawFrameWidth(srcImage, format);
+        const cv::Size frameSize = halfResolution ? cv::Size(width / 2, srcImage.rows / 2) : cv::Size(width, srcImage.rows);
+        return options.flatField->thresholdMap(threshold, PixelFormatBitDepth(format), frameSize, options.sensorOffset, scale);
+    }
+
+    // --- ͼ (;ֲز⹲) ---
+    static void DrawPartOutline(cv::Mat& resultImage, const std::vector<cv::Point>& contour, const cv::RotatedRect& box)
+    {
+        // ͼɫߺͺɫľο
+        cv::polylines(resultImage, contour, true, COLOR_GREEN, 2);
+        cv::Point2f vertices[4];
+        box.points(vertices);
+        for (int i = 0; i < 4; i++)
+        {
+            cv::line(resultImage, vertices[i], vertices[(i + 1) % 4], COLOR_RED, 2);
+        }
+    }
+
+    // ͼ״ƥλˣģ (ɫ) ģ͵ x ᷽
+    static void DrawPose(cv::Mat& resultImage, const ShapeModel& model, const PartPose& pose)
+    {
+        const cv::RotatedRect region = model.region(pose);
+        cv::Point2f vertices[4];
+        region.points(vertices);
+        for (int i = 0; i < 4; i++)
+        {
+            cv::line(resultImage, vertices[i], vertices[(i + 1) % 4], COLOR_YELLOW, 1);
+        }
+        const double rad = pose.angle * CV_PI / 180.0;
+        const float axis = 0.25f * region.size.width;
+        const cv::Point2f tip(pose.position.x + axis * static_cast<float>(std::cos(rad)), pose.position.y + axis * static_cast<float>(std::sin(rad)));
+        cv::drawMarker(resultImage, pose.position, COLOR_YELLOW, cv::MARKER_CROSS, 12, 1);
+        cv::arrowedLine(resultImage, pose.position, tip, COLOR_YELLOW, 1);
+    }
+
+    // ¼ͼڻΪʱʲôҲⲢвʱٰ֮˳ͳһ
+    static void DrawCircle(cv::Mat& resultImage, const CircleResult& circle)
+    {
+        if (resultImage.empty()) return;
+        cv::circle(resultImage, circle.center, (int)circle.radius, COLOR_BLUE, 2); // ɫԲ
+    }
+
+    static void DrawSlot(cv::Mat& resultImage, const cv::RotatedRect& slotBox)
+    {
+        if (resultImage.empty()) return;
+        cv::Point2f slotVertices[4]; // ɫĲۿھ
+        slotBox.points(slotVertices);
+        for (int j = 0; j < 4; j++) {
+            cv::line(resultImage, slotVertices[j], slotVertices[(j + 1) % 4], COLOR_YELLOW, 2);
+        }
+    }
+
+    // --- ߲ ( Caliper.h) ---
+    // ˳ȵĳȣ㹻λֲ絽ڵıԵ
+    static float CaliperMargin(float extent, float fraction, float minimum)
+    {
+        return std::max(minimum, fraction * extent);
+    }
+
+    //  axis  extent  count ѿߣڴֱϾȷֲ center  spreadسɹĶ
+    static int MeasureAcross(const cv::Mat& image, const CaliperOptions& options, const cv::Point2f& center,
+        const cv::Point2f& axis, float extent, float margin, int count, float spread, std::vector<CaliperPair>& pairs)
+    {
+        pairs.clear();
+        const cv::Point2f normal(-axis.y, axis.x);
+        for (int k = 0; k < count; ++k)
+        {
+            const float t = count == 1 ? 0.0f : spread * (2.0f * k / (count - 1) - 1.0f);
+            Caliper caliper;
+            caliper.center = center + normal * t;
+            caliper.direction = axis;
+            caliper.length = cvRound(extent + 2.0f * margin);
+            caliper.width = options.width;
+            CaliperPair pair;
+            if (MeasurePair(image, caliper, options.minStrength, pair)) pairs.push_back(pair);
+        }
+        return static_cast<int>(pairs.size());
+    }
+
+    static float MedianWidth(const std::vector<CaliperPair>& pairs)
+    {
+        std::vector<float> widths;
+        for (const CaliperPair& pair : pairs) widths.push_back(pair.width);
+        std::nth_element(widths.begin(), widths.begin() + widths.size() / 2, widths.end());
+        return widths[widths.size() / 2];
+    }
+
+    // е center  axis ϵƽƫ
+    static float MeanOffset(const std::vector<CaliperPair>& pairs, const cv::Point2f& center, const cv::Point2f& axis)
+    {
+        float sum = 0.0f;
+        for (const CaliperPair& pair : pairs) sum += (pair.center - center).dot(axis);
+        return pairs.empty() ? 0.0f : sum / pairs.size();
+    }
+
+    // һıԵֱߣ side ת ()ʱ false
+    static bool SideRotation(const std::vector<cv::Point2f>& points, const cv::Point2f& side, float& rotation)
+    {
+        if (points.size() < 3) return false;
+        thread_local PointSet set;
+        set.assign(points);
+        LineFit line;
+        if (!FitLine(set, line)) return false;
+        cv::Point2f d = line.direction;
+        if (d.dot(side) < 0.0f) d = d * -1.0f; // ֱߵķû֮
+        rotation = std::atan2(side.x * d.y - side.y * d.x, side.dot(d));
+        return true;
+    }
+
+    static void DrawCaliperEdges(cv::Mat& resultImage, const std::vector<CaliperPair>& pairs)
+    {
+        if (resultImage.empty()) return;
+        for (const CaliperPair& pair : pairs) {
+            cv::drawMarker(resultImage, pair.first.point, COLOR_MAGENTA, cv::MARKER_CROSS, 8, 1);
+            cv::drawMarker(resultImage, pair.second.point, COLOR_MAGENTA, cv::MARKER_CROSS, 8, 1);
+        }
+    }
+
+    //  minAreaRect λúͷϣÿ²Σȡߵλ
+    // ȡԵеƽϵıԵֱһϳɹĿ߲һʱԭ
+    static bool RefineBoxWithCalipers(const cv::Mat& image, const CaliperOptions& options, cv::RotatedRect& box, cv::Mat& resultImage)
+    {
+        const int count = std::max(1, options.count);
+        const int needed = (count + 1) / 2;
+        const double rad = box.angle * CV_PI / 180.0;
+        const cv::Point2f u(static_cast<float>(std::cos(rad)), static_cast<float>(std::sin(rad))); // width 
+        const cv::Point2f v(-u.y, u.x);                                                             // height 
+
+        std::vector<CaliperPair> across, down;
+        if (MeasureAcross(image, options, box.center, u, box.size.width, CaliperMargin(box.size.width, 0.05f, 6.0f),
+                count, 0.35f * box.size.height, across) < needed) return false;
+        if (MeasureAcross(image, options, box.center, v, box.size.height, CaliperMargin(box.size.height, 0.05f, 6.0f),
+                count, 0.35f * box.size.width, down) < needed) return false;
+
+        // 򣺿ȵĿߵıԵ v ϣ߶ȵ u 
+        std::vector<cv::Point2f> sides[4];
+        for (const CaliperPair& pair : across) { sides[0].push_back(pair.first.point); sides[1].push_back(pair.second.point); }
+        for (const CaliperPair& pair : down) { sides[2].push_back(pair.first.point); sides[3].push_back(pair.second.point); }
+        float rotationSum = 0.0f;
+        int rotations = 0;
+        for (int i = 0; i < 4; ++i)
+        {
+            float rotation;
+            if (SideRotation(sides[i], i < 2 ? v : u, rotation)) { rotationSum += rotation; ++rotations; }
+        }
+
+        const cv::Point2f center = box.center + u * MeanOffset(across, box.center, u) + v * MeanOffset(down, box.center, v);
+        box = cv::RotatedRect(center, cv::Size2f(MedianWidth(across), MedianWidth(down)),
+            box.angle + (rotations > 0 ? static_cast<float>(rotationSum / rotations * 180.0 / CV_PI) : 0.0f));
+        DrawCaliperEdges(resultImage, across);
+        DrawCaliperEdges(resultImage, down);
+        return true;
+    }
+
+    // ۿڣȵĿֱ߶ϣһسᴩĵĿ (ԲĶ)
+    static bool RefineSlotWithCalipers(const cv::Mat& image, const CaliperOptions& options, const cv::RotatedRect& box,
+        SlotResult& slot, cv::Mat& resultImage)
+    {
+        const double rad = box.angle * CV_PI / 180.0;
+        const cv::Point2f u(static_cast<float>(std::cos(rad)), static_cast<float>(std::sin(rad)));
+        const cv::Point2f v(-u.y, u.x);
+        const bool alongU = box.size.width >= box.size.height;
+        const cv::Point2f longAxis = alongU ? u : v;
+        const cv::Point2f shortAxis = alongU ? v : u;
+        const float straight = std::max(0.0f, slot.length - slot.width); // ֱ߶εĳ
+
+        std::vector<CaliperPair> widths, lengths;
+        const int count = straight > 4.0f ? std::max(1, options.count) : 1;
+        if (MeasureAcross(image, options, box.center, shortAxis, slot.width, CaliperMargin(slot.width, 0.15f, 4.0f),
+                count, 0.4f * straight, widths) < (count + 1) / 2) return false;
+        if (MeasureAcross(image, options, box.center, longAxis, slot.length, CaliperMargin(slot.width, 0.15f, 4.0f),
+                1, 0.0f, lengths) < 1) return false;
+
+        slot.width = MedianWidth(widths);
+        slot.length = lengths[0].width;
+        slot.center = box.center + longAxis * MeanOffset(lengths, box.center, longAxis)
+                    + shortAxis * MeanOffset(widths, box.center, shortAxis);
+        DrawCaliperEdges(resultImage, widths);
+        DrawCaliperEdges(resultImage, lengths);
+        return true;
+    }
+
+    // ۿ˰Բİ뾶ۿسͶӰѳֱ߶εֵˣԲ
+    // (ֻһе)̫١ʧܻԲһÿȵһ
+    static void FitSlotArcs(const std::vector<cv::Point>& contour, const cv::Point2f& longAxis,
+        const InspectOptions& options, SlotResult& slot)
+    {
+        const int kMinArcPoints = 5;
+        const float reach = 0.5f * std::max(0.0f, slot.length - slot.width); // ԲԲĵۿĵľ
+        thread_local std::vector<cv::Point> endPoints[2];
+        thread_local PointSet points;
+        endPoints[0].clear();
+        endPoints[1].clear();
+        for (const cv::Point& p : contour)
+        {
+            const float t = (p.x - slot.center.x) * longAxis.x + (p.y - slot.center.y) * longAxis.y;
+            if (t < -reach) endPoints[0].push_back(p);
+            else if (t > reach) endPoints[1].push_back(p);
+        }
+
+        // ԲСԲû壬ѡʱ Hyper
+        const CircleFitMethod method = options.circleFit == CircleFit_MinEnclosing ? CircleFit_Hyper : options.circleFit;
+        for (int end = 0; end < 2; ++end)
+        {
+            slot.arcRadius[end] = 0.5f * slot.width;
+            if (static_cast<int>(endPoints[end].size()) < kMinArcPoints) continue;
+            points.assign(endPoints[end]);
+            CircleFit fit;
+            if (FitCircle(points, method, fit, options.circleFitIterations) && fit.radius < slot.width) {
+                slot.arcRadius[end] = fit.radius;
+            }
+        }
+    }
+
+    // Feret ȵĻ׼ (FeretOptions::angles )״ģ͵λʱλ˵ת (ءû)
+    // Ӿγߵķ ( NominalModelGoldenModel ͬ)
+    // : minAreaRect תʱύߡǶ 90㣬ֱ box.angle ʱ {0, 90} ĿȻ֡
+    static float FeretReferenceAngle(const MeasurementResults& results)
+    {
+        if (results.pose.found) return results.pose.angle;
+        const cv::RotatedRect& box = results.boundingBox;
+        return box.size.width < box.size.height ? box.angle + 90.0f : box.angle;
+    }
+
+    // Feret ߴ磺͹ (ÿһ)תߺ͸Ŀȶֻ͹Ķ㡣
+    // options.angles  referenceAngle ( FeretReferenceAngle) Ϊ׼Բڵ contours[index] 
+    static void MeasureContourFeret(const std::vector<std::vector<cv::Point>>& contours, const std::vector<cv::Vec4i>& hierarchy, int index,
+        const FeretOptions& options, float referenceAngle, FeretResult& feret)
+    {
+        thread_local std::vector<cv::Point> hull;
+        feret = FeretResult();
+        ConvexHullOf(contours[index], hull);
+        if (!MeasureFeret(hull, feret)) return;
+        for (float angle : options.angles) feret.widths.push_back(FeretWidth(hull, referenceAngle + angle));
+        if (options.inscribed) feret.maxInscribed = MaxInscribedDiameter(contours, hierarchy, index);
+    }
+
+    // --- 弸αȽ ( NominalModel.h) ---
+    // ͼһضӦĺʹ NominalOptions::pixelSize궨 center ľֲ
+    // ûʱ0 (Ƚ)
+    static float NominalPixelSize(const InspectOptions& options, bool halfResolution, const cv::Point2f& center)
+    {
+        const float scale = static_cast<float>(std::max(1, options.sensorScale)) * (halfResolution ? 2.0f : 1.0f);
+        if (options.nominal.pixelSize > 0.0f) return options.nominal.pixelSize * scale;
+        if (!options.calibration || !options.calibration->isValid()) return 0.0f;
+        const cv::Point2f sensor = center * scale + cv::Point2f(options.sensorOffset);
+        const cv::Point2f origin = options.calibration->toMillimetres(sensor);
+        const double dx = cv::norm(options.calibration->toMillimetres(sensor + cv::Point2f(scale, 0.0f)) - origin);
+        const double dy = cv::norm(options.calibration->toMillimetres(sensor + cv::Point2f(0.0f, scale)) - origin);
+        return static_cast<float>(0.5 * (dx + dy));
+    }
+
+    // ڿ (е) 弸αȽϣʼλΪӾ box
+    static void CompareWithNominal(const std::vector<std::vector<cv::Point>>& contours, const std::vector<cv::Vec4i>& hierarchy,
+        int partContourIdx, const cv::RotatedRect& box, const InspectOptions& options, PixelFormat format, DeviationResult& deviation)
+    {
+        thread_local std::vector<int> indices;
+        indices.assign(1, partContourIdx);
+        for (int i = hierarchy[partContourIdx][2]; i >= 0; i = hierarchy[i][0]) indices.push_back(i);
+        const bool halfResolution = options.bayerHalfResolution && IsBayerFormat(format);
+        options.nominal.model->compare(contours, indices, box, NominalPixelSize(options, halfResolution, box.center),
+                                       options.nominal.tolerance, options.nominal.bestFit, deviation);
+    }
+
+    // ͼĸΣΪƷɫȱΪɫԲȦȦƫĵ
+    static void DrawDeviation(cv::Mat& resultImage, const DeviationResult& deviation)
+    {
+        if (resultImage.empty()) return;
+        for (const DeviationDefect& defect : deviation.defects) {
+            cv::circle(resultImage, defect.position, 12, defect.excess ? COLOR_MAGENTA : COLOR_ORANGE, 2);
+        }
+    }
+
+    // ͼľֲƫĸӰӻ (ճ)  (kMaxDistance) ͸Ϳϣ
+    // ھıԵϻһ档ֻͿ򣬲
+    static void DrawGoldenHeatmap(cv::Mat& resultImage, const GoldenModel& model, const GoldenResult& golden, float tolerance)
+    {
+        if (resultImage.empty() || !golden.valid || golden.maxDistance <= tolerance) return;
+        thread_local std::vector<std::vector<cv::Point>> cells;
+        thread_local std::vector<cv::Scalar> colors;
+        cells.clear();
+        colors.clear();
+        const float size = static_cast<float>(GoldenModel::kHeatCell);
+        const float range = std::max(1.0f, GoldenModel::kMaxDistance - tolerance);
+        cv::Rect dirty;
+        for (int i = 0; i < golden.heatmap.rows; ++i)
+        {
+            const float* row = golden.heatmap.ptr<float>(i);
+            for (int j = 0; j < golden.heatmap.cols; ++j)
+            {
+                if (row[j] <= tolerance) continue;
+                const cv::Point2f corner(j * size, i * size);
+                std::vector<cv::Point> cell = {
+                    model.toImage(golden, corner), model.toImage(golden, corner + cv::Point2f(size, 0.0f)),
+                    model.toImage(golden, corner + cv::Point2f(size, size)), model.toImage(golden, corner + cv::Point2f(0.0f, size)) };
+                dirty = dirty.empty() ? cv::boundingRect(cell) : (dirty | cv::boundingRect(cell));
+                const float t = std::min(1.0f, (row[j] - tolerance) / range);
+                cells.push_back(cell);
+                colors.push_back(cv::Scalar(0, 255 * (1.0f - t), 255));
+            }
+        }
+        dirty &= cv::Rect(0, 0, resultImage.cols, resultImage.rows);
+        if (!dirty.empty())
+        {
+            cv::Mat area = resultImage(dirty);
+            cv::Mat overlay = area.clone();
+            for (size_t k = 0; k < cells.size(); ++k) {
+                cv::fillPoly(overlay, std::vector<std::vector<cv::Point>>(1, cells[k]), colors[k], cv::LINE_8, 0, -dirty.tl());
+            }
+            cv::addWeighted(overlay, 0.5, area, 0.5, 0.0, area);
+        }
+        cv::drawMarker(resultImage, golden.worstPoint, COLOR_RED, cv::MARKER_TILTED_CROSS, 16, 2);
+    }
+
+    // вۿԲ뾶ƽ (MeasurementResults::arcRadius)
+    static float MeanArcRadius(const std::vector<SlotResult>& slots)
+    {
+        if (slots.empty()) return 0.0f;
+        float sum = 0.0f;
+        for (const SlotResult& slot : slots) sum += slot.arcRadius[0] + slot.arcRadius[1];
+        return sum / (2.0f * slots.size());
+    }
+
+    enum HoleKind { Hole_None = 0, Hole_Circle, Hole_Slot };
+
+    // һڿ contours[index]ǡԲǡۿڡ׷ӵбвslotBox Ϊ nullptr ʱۿڵӾ
+    // preview Ϊ8λҶȵͼ (߲ʱʹ)
+    static HoleKind MeasureHole(const std::vector<std::vector<cv::Point>>& contours, const std::vector<cv::Vec4i>& hierarchy, int index,
+        const InspectOptions& options, const cv::Mat& preview,
+        MeasurementResults& results, cv::Mat& resultImage, cv::RotatedRect* slotBox = nullptr)
+    {
+        const std::vector<cv::Point>& contour = contours[index];
+        double area = cv::contourArea(contour);
+        double perimeter = cv::arcLength(contour, true); // true=պ
+
+        if (perimeter == 0) return Hole_None; // 
+
+        double circularity = (4 * CV_PI * area) / (perimeter * perimeter);
+
+        // ԲȺһֵųܵ㣩
+        if (circularity > 0.85 && area > 50) // Բȴ0.85ľԲ
+        {
+            // --- һСԲ ---
+            CircleResult circleRes;
+            // Сϵе (㼯̸߳ãʱڴ)
+            // ѡСԲʧʱ cv::minEnclosingCircle ҵСԲ
+            bool fitted = false;
+            if (options.circleFit != CircleFit_MinEnclosing) {
+                thread_local PointSet points;
+                points.assign(contour);
+                CircleFit fit;
+                fitted = FitCircle(points, options.circleFit, fit, options.circleFitIterations);
+                circleRes.center = fit.center;
+                circleRes.radius = fit.radius;
+            }
+            if (!fitted) cv::minEnclosingCircle(contour, circleRes.center, circleRes.radius);
+            if (options.feret.enabled) MeasureContourFeret(contours, hierarchy, index, options.feret, FeretReferenceAngle(results), circleRes.feret);
+            results.circles.push_back(circleRes); // ӵб
+            DrawCircle(resultImage, circleRes);
+            return Hole_Circle;
+        }
+        else if (area > 1000) // ԲȽϵϴǲۿ
+        {
+            // --- Ǹۿ ---
+            cv::RotatedRect box = cv::minAreaRect(contour);
+            SlotResult slot;
+            slot.center = box.center;
+            slot.angle = box.angle;
+            // ֤ length ʼǳߣwidth ʼǶ̱
+            if (box.size.width > box.size.height) {
+                slot.length = box.size.width;
+                slot.width = box.size.height;
+            }
+            else {
+                slot.length = box.size.height;
+                slot.width = box.size.width;
+            }
+            // ߣڻҶͼؾ² (ʧʱӾεĽ)
+            if (options.caliper.enabled) RefineSlotWithCalipers(preview, options.caliper, box, slot, resultImage);
+
+            // ˵Բ뾶 (ͬһ᷽뿨ͬ)
+            const double rad = box.angle * CV_PI / 180.0;
+            const cv::Point2f u(static_cast<float>(std::cos(rad)), static_cast<float>(std::sin(rad)));
+            FitSlotArcs(contour, box.size.width >= box.size.height ? u : cv::Point2f(-u.y, u.x), options, slot);
+            if (options.feret.enabled) MeasureContourFeret(contours, hierarchy, index, options.feret, FeretReferenceAngle(results), slot.feret);
+            results.slotResults.push_back(slot);
+            DrawSlot(resultImage, box);
+            if (slotBox) *slotBox = box;
+            return Hole_Slot;
+        }
+        return Hole_None;
+    }
+
+    // ǰ벿 (Ͷ⹲)Ԥ졢ֵ״ƥ (useShapeModel ʱ) ֡
+    // ط0ʱΪ룻preview Ϊ8λͼcontours/hierarchy Ϊͼϵ
+    static uint32_t FindFrameContours(const cv::Mat& srcImage, PixelFormat format, const InspectOptions& options, bool useShapeModel,
+        MeasurementResults& results, cv::Mat& resultImage, cv::Mat& preview,
+        std::vector<std::vector<cv::Point>>& contours, std::vector<cv::Vec4i>& hierarchy)
     {
+        // һεĺʱ¼δִеĽ׶αΪ0
+        StageTiming& timing = results.timing;
+        timing = StageTiming();
+        results.threshold = 0;
+        results.quality = FrameQuality();
+        results.deviation = DeviationResult();
+        results.golden = GoldenResult();
+
         // --- a. b. Լ () ---
         if (srcImage.empty()) return 1;
         if (srcImage.channels() != 1) return 2;
+        if (RawFrameWidth(srcImage, format) <= 0) return 2; // ͼظʽƥ
+
+        // --- b'. Ԥ죺ֻȡأ֡ģع쳣֡ﷵأֵ ---
+        if (options.qualityGate.enabled)
+        {
+            timing.beginNs[Stage_QualityGate] = MonotonicNowNs();
+            const bool measured = MeasureFrameQuality(srcImage, format, options.qualityGate, results.quality);
+            const uint32_t reject = measured ? CheckFrameQuality(results.quality, options.qualityGate) : 0;
+            timing.endNs[Stage_QualityGate] = MonotonicNowNs();
+            if (reject != 0) return reject;
+        }
+
+        // ѡȡֵ (ֵ׶εĺʱ)
+        timing.beginNs[Stage_Threshold] = MonotonicNowNs();
+        const int bitDepth = PixelFormatBitDepth(format);
+        results.threshold = SelectThreshold(srcImage, format, options);
+        const uint16_t threshold = NativeThreshold(results.threshold, bitDepth);
 
-        // --- c. ӻ () ---
-        cv::cvtColor(srcImage, resultImage, cv::COLOR_GRAY2BGR);
+        // ƽУȡһ֡Ӧֵ (ͼ񳬳궨Χʱ˻ͳһֵ)
+        const bool halfResolution = options.bayerHalfResolution && IsBayerFormat(format);
+        const cv::Mat thresholdMap = FlatFieldThresholds(srcImage, format, options, threshold);
 
-        // --- d. ͼֵ () ---
         cv::Mat binaryImage;
-        cv::threshold(srcImage, binaryImage, 50, 255, cv::THRESH_BINARY);
+        if (format == PixelFormat_Mono8 && thresholdMap.empty())
+        {
+            preview = srcImage;
+
+            // --- d. ͼֵ (ֵ) ---
+            cv::threshold(srcImage, binaryImage, results.threshold, 255, cv::THRESH_BINARY);
+            timing.endNs[Stage_Threshold] = MonotonicNowNs();
+
+            // --- c. ӻ () ---
+            timing.beginNs[Stage_Canvas] = MonotonicNowNs();
+            cv::cvtColor(srcImage, resultImage, cv::COLOR_GRAY2BGR);
+            timing.endNs[Stage_Canvas] = MonotonicNowNs();
+        }
+        else
+        {
+            // --- c'. d'. λ/ʽ/Bayer/ƽУ (תΪ) ͶֵںΪһɨ ---
+            // : ͬһɨ˳8λԤͼΪĵͼҪȰͼתΪ8λ16λBGR
+            //       ƽУֻǰѹ̶ֵصֵҲɨ
+            UnpackAndThreshold(srcImage, format, threshold, binaryImage, &preview,
+                               halfResolution, thresholdMap.empty() ? nullptr : &thresholdMap);
+            timing.endNs[Stage_Threshold] = MonotonicNowNs();
+
+            timing.beginNs[Stage_Canvas] = MonotonicNowNs();
+            cv::cvtColor(preview, resultImage, cv::COLOR_GRAY2BGR);
+            timing.endNs[Stage_Canvas] = MonotonicNowNs();
+        }
+
+        // --- d''. ״ģƥ (ṩ״ģʱ)ڻҶͼ϶λֻ֮ģڽ ---
+        // :  (±) ᱻ߷ֱʱֵķΧҲСö
+        cv::Rect searchRegion(cv::Point(), binaryImage.size());
+        results.pose = PartPose();
+        if (useShapeModel && options.shapeModel)
+        {
+            timing.beginNs[Stage_ShapeMatch] = MonotonicNowNs();
+            const bool found = options.shapeModel->find(preview, options.minMatchScore, results.pose);
+            timing.endNs[Stage_ShapeMatch] = MonotonicNowNs();
+            if (!found) return 3; // ûģƵͬδҵ
+
+            const int kPoseMargin = 8; // ģչ (ͼԵʱҲ)
+            const cv::Rect box = options.shapeModel->region(results.pose).boundingRect();
+            searchRegion &= cv::Rect(box.x - kPoseMargin, box.y - kPoseMargin, box.width + 2 * kPoseMargin, box.height + 2 * kPoseMargin);
+            if (searchRegion.empty()) return 3;
+            DrawPose(resultImage, *options.shapeModel, results.pose);
+        }
+
+        // --- e.  (λʱֻģڣͼ) ---
+        timing.beginNs[Stage_FindContours] = MonotonicNowNs();
+        cv::findContours(binaryImage(searchRegion), contours, hierarchy, cv::RETR_TREE, cv::CHAIN_APPROX_SIMPLE, searchRegion.tl());
+        timing.endNs[Stage_FindContours] = MonotonicNowNs();
+        return 0;
+    }
 
-        // --- e.  () ---
+    // ǵĺ㷨ʵ ( InspectPart / InspectRawFrame )
+    // snapshot Ϊ nullptr ʱ˳¼仯ֲزҪϢ ( ChangeDetector::Snapshot)
+    static uint32_t InspectPartImpl(const cv::Mat& srcImage, PixelFormat format, const InspectOptions& options,
+        MeasurementResults& results,
+        cv::Mat& resultImage,
+        ChangeDetector::Snapshot* snapshot = nullptr)
+    {
+        // --- a. ~ e. Ԥ졢ֵ ---
+        StageTiming& timing = results.timing;
+        cv::Mat preview; // 8λͼ
         std::vector<std::vector<cv::Point>> contours;
         std::vector<cv::Vec4i> hierarchy;
-        cv::findContours(binaryImage, contours, hierarchy, cv::RETR_TREE, cv::CHAIN_APPROX_SIMPLE);
+        const uint32_t status = FindFrameContours(srcImage, format, options, true, results, resultImage, preview, contours, hierarchy);
+        if (status != 0) return status;
 
         // --- f. ؼʵ֡һѭҲ ---
         // (֮ǰ۹ģĸ׳㷨)
 
+        timing.beginNs[Stage_LocatePart] = MonotonicNowNs();
         int partContourIdx = -1; // 洢
         double maxArea = 0.0;    // 洢
 
@@ -54,28 +648,29 @@ namespace InspectorLib
         // Լ飺ûҵκζ
         if (partContourIdx == -1)
         {
+            timing.endNs[Stage_LocatePart] = MonotonicNowNs();
             return 3; // ش3δҵ
         }
 
         // --- g. ؼʵ֡ ---
         // Ѿ contours[partContourIdx]
         results.boundingBox = cv::minAreaRect(contours[partContourIdx]); // Сת
+        // ߣӾΪʼλãڻҶͼ²γߴ (ʧʱӾ)
+        if (options.caliper.enabled) RefineBoxWithCalipers(preview, options.caliper, results.boundingBox, resultImage);
+        results.feret = FeretResult();
+        if (options.feret.enabled) MeasureContourFeret(contours, hierarchy, partContourIdx, options.feret, FeretReferenceAngle(results), results.feret);
 
-        // ͼڻϻɫ
-        cv::drawContours(resultImage, contours, partContourIdx, COLOR_GREEN, 2);
+        // ͼڻϻɫߺͺɫľο
+        DrawPartOutline(resultImage, contours[partContourIdx], results.boundingBox);
 
-        // ͼڻϻɫľο
-        cv::Point2f vertices[4];
-        results.boundingBox.points(vertices);
-        for (int i = 0; i < 4; i++)
-        {
-            cv::line(resultImage, vertices[i], vertices[(i + 1) % 4], COLOR_RED, 2);
-        }
+        timing.endNs[Stage_LocatePart] = MonotonicNowNs();
 
         // --- h. ؼʵ֡ڶѭҲڲ׶ ---
 
         // ҪϴεĽбֹظʱۼ
+        timing.beginNs[Stage_Features] = MonotonicNowNs();
         results.circles.clear();
+        results.slotResults.clear();
 
         for (int i = 0; i < contours.size(); i++)
         {
@@ -83,53 +678,534 @@ namespace InspectorLib
             if (hierarchy[i][3] == partContourIdx)
             {
                 // ȷһڿףǡԲǡۿڡ
-                double area = cv::contourArea(contours[i]);
-                double perimeter = cv::arcLength(contours[i], true); // true=պ
+                cv::RotatedRect slotBox;
+                const HoleKind kind = MeasureHole(contours, hierarchy, i, options, preview, results, resultImage, &slotBox);
+                if (snapshot && kind == Hole_Circle) snapshot->circleRects.push_back(cv::boundingRect(contours[i]));
+                if (snapshot && kind == Hole_Slot) snapshot->slotBoxes.push_back(slotBox);
+            }
+        } // ڿѭ
+        results.arcRadius = MeanArcRadius(results.slotResults);
 
-                if (perimeter == 0) continue; // 
+        timing.endNs[Stage_Features] = MonotonicNowNs();
 
-                double circularity = (4 * CV_PI * area) / (perimeter * perimeter);
+        // --- h'. 弸αȽ (ṩģʱ)ڿϵÿһξͼģ͵Ķ޹ ---
+        if (options.nominal.model)
+        {
+            timing.beginNs[Stage_Deviation] = MonotonicNowNs();
+            CompareWithNominal(contours, hierarchy, partContourIdx, results.boundingBox, options, format, results.deviation);
+            DrawDeviation(resultImage, results.deviation);
+            timing.endNs[Stage_Deviation] = MonotonicNowNs();
+        }
 
-                // ԲȺһֵųܵ㣩
-                if (circularity > 0.85 && area > 50) // Բȴ0.85ľԲ
-                {
-                    // --- һСԲ ---
-                    CircleResult circleRes;
-                    // : cv::minEnclosingCircle ҵСԲ
-                    cv::minEnclosingCircle(contours[i], circleRes.center, circleRes.radius);
-                    results.circles.push_back(circleRes); // ӵб
-
-                    // ͼɫԲ
-                    cv::circle(resultImage, circleRes.center, (int)circleRes.radius, COLOR_BLUE, 2);
+        // --- h''. Ƚ (ṩ˽ģʱ)ϵıԵڽľͼϲһɨ ---
+        if (options.golden.model)
+        {
+            timing.beginNs[Stage_Golden] = MonotonicNowNs();
+            options.golden.model->compare(preview, contours[partContourIdx], results.boundingBox, results.pose, options.golden.tolerance, results.golden);
+            DrawGoldenHeatmap(resultImage, *options.golden.model, results.golden, options.golden.tolerance);
+            timing.endNs[Stage_Golden] = MonotonicNowNs();
+        }
+
+        // ֲزҪϢͼ (Mono8 ʱǵ÷ͼ񣬱뿽) 
+        if (snapshot)
+        {
+            snapshot->preview = preview.data == srcImage.data ? preview.clone() : preview;
+            snapshot->partContour = contours[partContourIdx];
+        }
+
+        // --- i. سɹ ---
+        return 0;
+    }
+
+    // μǷͬ (ͬʱĽܸ)
+    static bool SameSettings(const InspectOptions& a, const InspectOptions& b)
+    {
+        const QualityGateOptions& qa = a.qualityGate;
+        const QualityGateOptions& qb = b.qualityGate;
+        return a.bayerHalfResolution == b.bayerHalfResolution && a.flatField == b.flatField
+            && a.sensorOffset == b.sensorOffset && a.sensorScale == b.sensorScale
+            && a.thresholdMethod == b.thresholdMethod
+            && a.circleFit == b.circleFit && a.circleFitIterations == b.circleFitIterations
+            && a.caliper.enabled == b.caliper.enabled && a.caliper.count == b.caliper.count
+            && a.caliper.width == b.caliper.width && a.caliper.minStrength == b.caliper.minStrength
+            && a.shapeModel == b.shapeModel && a.minMatchScore == b.minMatchScore
+            && a.feret.enabled == b.feret.enabled && a.feret.inscribed == b.feret.inscribed && a.feret.angles == b.feret.angles
+            && a.nominal.model == b.nominal.model && a.nominal.pixelSize == b.nominal.pixelSize
+            && a.nominal.tolerance == b.nominal.tolerance && a.nominal.bestFit == b.nominal.bestFit
+            && a.golden.model == b.golden.model && a.golden.tolerance == b.golden.tolerance
+            && qa.enabled == qb.enabled && qa.foregroundLevel == qb.foregroundLevel
+            && qa.minForegroundFraction == qb.minForegroundFraction && qa.maxBorderFraction == qb.maxBorderFraction
+            && qa.minFocus == qb.minFocus && qa.maxSaturatedFraction == qb.maxSaturatedFraction
+            && qa.minBrightLevel == qb.minBrightLevel;
+    }
+
+    // ǩ index  () ͼϵľ (֣ SampleTileMeans һ)
+    static cv::Rect TileRect(int index, const cv::Size& size)
+    {
+        const int grid = ChangeDetector::kGridSize;
+        const int tx = index % grid;
+        const int ty = index / grid;
+        const int x0 = tx * size.width / grid, x1 = (tx + 1) * size.width / grid;
+        const int y0 = ty * size.height / grid, y1 = (ty + 1) * size.height / grid;
+        return cv::Rect(x0, y0, x1 - x0, y1 - y0);
+    }
+
+    // ֲز⣺仯ڲ () ʱֻ¶ֵͲеĿס
+    // ӾκĿû档 false ʾʺϾֲز (÷Ϊ)
+    static bool InspectChangedRegion(const cv::Mat& srcImage, PixelFormat format, const InspectOptions& options,
+        const ChangeDetector::Snapshot& cache, const std::vector<uint8_t>& changedTiles,
+        MeasurementResults& results, cv::Mat& resultImage, ChangeDetector::Snapshot& updated)
+    {
+        const int kMargin = 4; // չأֵ߽ܿϵӰ
+        const cv::Size frameSize = cache.preview.size(); //  (Bayer ֱʱΪԭͼһ)
+        const cv::Rect frame(cv::Point(), frameSize);
+        if (options.nominal.model || options.golden.model) return false; // 弸/Ƚϸֻһ
+
+        // 1. ϲ仯Ŀ飬ཻĿ (Ҫôز⣬Ҫô)
+        cv::Rect region;
+        for (size_t i = 0; i < changedTiles.size(); ++i) {
+            if (changedTiles[i]) region |= TileRect(static_cast<int>(i), frameSize);
+        }
+        std::vector<cv::Rect> featureRects = cache.circleRects;
+        for (const cv::RotatedRect& slotBox : cache.slotBoxes) featureRects.push_back(slotBox.boundingRect());
+        for (bool grown = true; grown; )
+        {
+            grown = false;
+            for (const cv::Rect& r : featureRects) {
+                if ((r & region).area() > 0 && (r | region) != region) {
+                    region |= r;
+                    grown = true;
                 }
-                else if (area > 1000) // ԲȽϵϴǲۿ
+            }
+        }
+        region = cv::Rect(region.x - kMargin, region.y - kMargin, region.width + 2 * kMargin, region.height + 2 * kMargin) & frame;
+        // 뵽żʽ2һ飬Bayer Ҫ
+        region.x &= ~1;
+        region.y &= ~1;
+        region.width = std::min((region.width + 1) & ~1, frame.width - region.x) & ~1;
+        region.height = std::min((region.height + 1) & ~1, frame.height - region.y) & ~1;
+        if (region.empty() || region.area() * 2 > frame.area()) return false; // 仯̫󣬲
+
+        // ƶ
+        // :  CHAIN_APPROX_SIMPLE ѹģһֱֻʣ˵㣬Ҫ߶ж϶ֻ
+        const size_t vertices = cache.partContour.size();
+        for (size_t i = 0; i < vertices; ++i) {
+            cv::Point a = cache.partContour[i], b = cache.partContour[(i + 1) % vertices];
+            if (cv::clipLine(region, a, b)) return false;
+        }
+
+        // 2. ֻͶֵ (ûֵδ仯Ĳֱһ)
+        StageTiming timing; //  results ᱻĽǣʱȼ
+        timing.beginNs[Stage_Threshold] = MonotonicNowNs();
+        const bool halfResolution = options.bayerHalfResolution && IsBayerFormat(format);
+        const uint16_t threshold = NativeThreshold(cache.results.threshold, PixelFormatBitDepth(format));
+        const cv::Rect rawRegion = halfResolution
+            ? cv::Rect(region.x * 2, region.y * 2, region.width * 2, region.height * 2) : region;
+        const cv::Mat rawCrop = CropRawFrame(srcImage, format, rawRegion);
+        if (rawCrop.empty()) return false;
+        cv::Mat thresholdMap = FlatFieldThresholds(srcImage, format, options, threshold);
+        if (!thresholdMap.empty()) thresholdMap = thresholdMap(region);
+
+        cv::Mat binaryRegion, previewRegion;
+        if (!UnpackAndThreshold(rawCrop, format, threshold, binaryRegion, &previewRegion, halfResolution,
+                                thresholdMap.empty() ? nullptr : &thresholdMap)) return false;
+        timing.endNs[Stage_Threshold] = MonotonicNowNs();
+
+        // 3. ڲ (ֱƫƵͼ)Ƕİɫ򣬿
+        std::vector<std::vector<cv::Point>> contours;
+        std::vector<cv::Vec4i> hierarchy;
+        timing.beginNs[Stage_FindContours] = MonotonicNowNs();
+        cv::findContours(binaryRegion, contours, hierarchy, cv::RETR_TREE, cv::CHAIN_APPROX_SIMPLE, region.tl());
+        timing.endNs[Stage_FindContours] = MonotonicNowNs();
+
+        // 4. ػڵĵͼõĽԭ
+        timing.beginNs[Stage_Canvas] = MonotonicNowNs();
+        updated.preview = cache.preview.clone();
+        previewRegion.copyTo(updated.preview(region));
+        cv::cvtColor(updated.preview, resultImage, cv::COLOR_GRAY2BGR);
+        timing.endNs[Stage_Canvas] = MonotonicNowNs();
+
+        timing.beginNs[Stage_Features] = MonotonicNowNs();
+        results = cache.results;
+        DrawPartOutline(resultImage, cache.partContour, results.boundingBox);
+
+        // Ŀû棬ڵĿ² (µĿбĩβ)
+        results.circles.clear();
+        updated.circleRects.clear();
+        for (size_t i = 0; i < cache.circleRects.size() && i < cache.results.circles.size(); ++i)
+        {
+            if ((cache.circleRects[i] & region).area() > 0) continue;
+            results.circles.push_back(cache.results.circles[i]);
+            updated.circleRects.push_back(cache.circleRects[i]);
+            DrawCircle(resultImage, cache.results.circles[i]);
+        }
+        results.slotResults.clear();
+        updated.slotBoxes.clear();
+        for (size_t i = 0; i < cache.slotBoxes.size() && i < cache.results.slotResults.size(); ++i)
+        {
+            if ((cache.slotBoxes[i].boundingRect() & region).area() > 0) continue;
+            results.slotResults.push_back(cache.results.slotResults[i]);
+            updated.slotBoxes.push_back(cache.slotBoxes[i]);
+            DrawSlot(resultImage, cache.slotBoxes[i]);
+        }
+
+        const cv::Rect inner(region.x + 1, region.y + 1, region.width - 2, region.height - 2);
+        for (size_t i = 0; i < contours.size(); ++i)
+        {
+            const int parent = hierarchy[i][3];
+            if (parent < 0 || hierarchy[parent][3] != -1) continue; // ֻҪ (ɫ) ֱ
+            const cv::Rect bounds = cv::boundingRect(contours[i]);
+            if ((bounds & inner) != bounds) return false;           // ױ߽ض (³ڱ߽ϵĿ)Ϊ
+            cv::RotatedRect slotBox;
+            const HoleKind kind = MeasureHole(contours, hierarchy, static_cast<int>(i), options, updated.preview, results, resultImage, &slotBox);
+            if (kind == Hole_Circle) updated.circleRects.push_back(bounds);
+            if (kind == Hole_Slot) updated.slotBoxes.push_back(slotBox);
+        }
+        results.arcRadius = MeanArcRadius(results.slotResults);
+        timing.endNs[Stage_Features] = MonotonicNowNs();
+        results.timing = timing;
+
+        updated.results = results;
+        updated.resultImage = resultImage;
+        return true;
+    }
+
+    // 仯ļ⣺ûб仯ʱû棬ֻڲ仯ʱֲز⣬Ⲣ»
+    static uint32_t InspectWithChangeDetection(const cv::Mat& srcImage, PixelFormat format, const InspectOptions& options,
+        MeasurementResults& results, cv::Mat& resultImage)
+    {
+        MetricsRegistry& registry = MetricsRegistry::Global();
+        static Counter& reusedFrames = registry.counter("inspector_change_detection_total", "Frames by change-detection decision", "decision=\"reused\"");
+        static Counter& partialFrames = registry.counter("inspector_change_detection_total", "Frames by change-detection decision", "decision=\"partial\"");
+        static Counter& fullFrames = registry.counter("inspector_change_detection_total", "Frames by change-detection decision", "decision=\"full\"");
+
+        ChangeDetector& detector = *options.changeDetector;
+        std::vector<float> signature;
+        if (!ChangeDetector::ComputeSignature(srcImage, format, signature)) {
+            return InspectPartImpl(srcImage, format, options, results, resultImage); // ͼ̫Сʽԣճ (ش)
+        }
+
+        // 1. 뻺Ƚ (ͼöͬ)
+        const std::shared_ptr<const ChangeDetector::Snapshot> cache = detector.snapshot();
+        if (cache && cache->frameSize == srcImage.size() && cache->frameType == srcImage.type() && cache->format == format
+            && SameSettings(cache->settings, options))
+        {
+            std::vector<uint8_t> changedTiles;
+            const int changed = detector.compare(*cache, signature, changedTiles);
+            if (changed == 0 && detector.allowReuse())
+            {
+                // ûб仯ֱӷػĽ (ûִκν׶Σʱ¼Ϊ0)
+                results = cache->results;
+                results.timing = StageTiming();
+                resultImage = cache->resultImage;
+                reusedFrames.inc();
+                return cache->status;
+            }
+            if (changed > 0 && cache->status == 0 && !cache->preview.empty() && detector.allowReuse())
+            {
+                auto updated = std::make_shared<ChangeDetector::Snapshot>(*cache);
+                if (InspectChangedRegion(srcImage, format, options, *cache, changedTiles, results, resultImage, *updated))
                 {
-                    // --- Ǹۿ ---
-                    cv::RotatedRect slotBox = cv::minAreaRect(contours[i]);
-                    results.slot.center = slotBox.center;
-                    results.slot.angle = slotBox.angle;
-                    // ֤ length ʼǳߣwidth ʼǶ̱
-                    if (slotBox.size.width > slotBox.size.height) {
-                        results.slot.length = slotBox.size.width;
-                        results.slot.width = slotBox.size.height;
-                    }
-                    else {
-                        results.slot.length = slotBox.size.height;
-                        results.slot.width = slotBox.size.width;
+                    for (size_t i = 0; i < changedTiles.size(); ++i) {
+                        if (changedTiles[i]) updated->signature[i] = signature[i]; // δ仯ĿϴȽ
                     }
+                    detector.store(updated, false);
+                    partialFrames.inc();
+                    return 0;
+                }
+            }
+        }
 
-                    // ͼɫĲۿھ
-                    cv::Point2f slotVertices[4];
-                    slotBox.points(slotVertices);
-                    for (int j = 0; j < 4; j++) {
-                        cv::line(resultImage, slotVertices[j], slotVertices[(j + 1) % 4], COLOR_YELLOW, 2);
-                    }
+        // 2. ⣬»
+        auto snapshot = std::make_shared<ChangeDetector::Snapshot>();
+        const uint32_t status = InspectPartImpl(srcImage, format, options, results, resultImage, snapshot.get());
+        snapshot->frameSize = srcImage.size();
+        snapshot->frameType = srcImage.type();
+        snapshot->format = format;
+        snapshot->settings = options;
+        snapshot->settings.changeDetector.reset();
+        snapshot->signature = std::move(signature);
+        snapshot->status = status;
+        snapshot->results = results;
+        snapshot->resultImage = resultImage;
+        detector.store(snapshot, true);
+        fullFrames.inc();
+        return status;
+    }
+
+    // ֮껻㣺Bayer ֱʱԭͼꣻ궨ʱΪ
+    static void FinishResults(uint32_t status, PixelFormat format, const InspectOptions& options, MeasurementResults& results)
+    {
+        if (status == 0 && options.bayerHalfResolution && IsBayerFormat(format)) {
+            // ֱʵĳ (x, y) λԭͼ (2x + 0.5, 2y + 0.5)ԭͼ
+            MapResultsToSensor(results, cv::Point2f(0.5f, 0.5f), 2.0f);
+        }
+        results.metric = MetricResults();
+        if (status == 0 && options.calibration) {
+            // ֻеĵ ()ͼȥ
+            options.calibration->apply(results, cv::Point2f(options.sensorOffset), static_cast<float>(std::max(1, options.sensorScale)));
+        }
+    }
+
+    // ǵĺĺִм⣬¼ʱָͺʱͳ
+    uint32_t INSPECTOR_API InspectRawFrame(const cv::Mat& rawImage, PixelFormat format,
+        MeasurementResults& results,
+        cv::Mat& resultImage,
+        const InspectOptions& options)
+    {
+        const int64_t beginNs = MonotonicNowNs();
+        const uint32_t status = options.changeDetector
+            ? InspectWithChangeDetection(rawImage, format, options, results, resultImage)
+            : InspectPartImpl(rawImage, format, options, results, resultImage);
+        FinishResults(status, format, options, results);
+        const int64_t elapsedNs = MonotonicNowNs() - beginNs;
+        RecordInspectMetrics(status, results, elapsedNs);
+        Stats::Global().record(status, results.timing, elapsedNs);
+        return status;
+    }
+
+    uint32_t INSPECTOR_API InspectPart(const cv::Mat& srcImage,
+        MeasurementResults& results,
+        cv::Mat& resultImage)
+    {
+        // 16λͼ ( TIFF ļȡ)  Mono16 
+        const PixelFormat format = srcImage.depth() == CV_16U ? PixelFormat_Mono16 : PixelFormat_Mono8;
+        return InspectRawFrame(srcImage, format, results, resultImage);
+    }
+
+    // ---  ()  ---
+    // һе± (յļо߸Ϊ -1)Χ ()ͲۿڵӾ (ͼ)
+    struct TrayPart
+    {
+        int contourIdx;
+        cv::Rect rect;
+        MeasurementResults results;
+        std::vector<cv::RotatedRect> slotBoxes;
+    };
+
+    // λ򣺰ĵ y ϵɨ裬뵱ǰеƽ y  tolerance ĹͬһУ
+    // ڰ x ҡֻλãͬڷŵÿεõͬ˳
+    static void SortByTrayPosition(std::vector<TrayPart>& parts, float rowTolerance)
+    {
+        if (parts.empty()) return;
+        auto centerX = [](const TrayPart& p) { return p.rect.x + 0.5f * p.rect.width; };
+        auto centerY = [](const TrayPart& p) { return p.rect.y + 0.5f * p.rect.height; };
+
+        std::vector<int> heights;
+        for (const TrayPart& part : parts) heights.push_back(part.rect.height);
+        std::nth_element(heights.begin(), heights.begin() + heights.size() / 2, heights.end());
+        const float tolerance = rowTolerance * heights[heights.size() / 2];
+
+        std::stable_sort(parts.begin(), parts.end(), [&](const TrayPart& a, const TrayPart& b) {
+            return centerY(a) != centerY(b) ? centerY(a) < centerY(b) : centerX(a) < centerX(b);
+        });
+        int row = 0, rowSize = 0;
+        float rowSum = 0.0f;
+        for (TrayPart& part : parts)
+        {
+            if (rowSize > 0 && centerY(part) - rowSum / rowSize > tolerance) { ++row; rowSize = 0; rowSum = 0.0f; }
+            part.results.trayRow = row;
+            rowSum += centerY(part);
+            ++rowSize;
+        }
+        std::stable_sort(parts.begin(), parts.end(), [&](const TrayPart& a, const TrayPart& b) {
+            return a.results.trayRow != b.results.trayRow ? a.results.trayRow < b.results.trayRow : centerX(a) < centerX(b);
+        });
+        for (size_t i = 0; i < parts.size(); ++i) {
+            parts[i].results.trayColumn = (i > 0 && parts[i].results.trayRow == parts[i - 1].results.trayRow) ? parts[i - 1].results.trayColumn + 1 : 0;
+        }
+    }
+
+    // оУÿŽڵĸӣǰ rows x columns ȶӦӣ
+    // ոӲһ trayEmpty ռλͬһĽԶ (Ϊ -1)
+    static void AssignFixtureCells(std::vector<TrayPart>& parts, const TrayOptions& tray)
+    {
+        const int cellCount = tray.rows * tray.columns;
+        std::vector<int> owner(cellCount, -1);     // ÿһе (parts ±)
+        std::vector<float> ownerDistance(cellCount);
+        std::vector<int> strays;                   // κθ
+        for (int k = 0; k < static_cast<int>(parts.size()); ++k)
+        {
+            const float x = parts[k].rect.x + 0.5f * parts[k].rect.width;
+            const float y = parts[k].rect.y + 0.5f * parts[k].rect.height;
+            const int column = tray.pitch.x != 0.0f ? cvRound((x - tray.origin.x) / tray.pitch.x) : 0;
+            const int row = tray.pitch.y != 0.0f ? cvRound((y - tray.origin.y) / tray.pitch.y) : 0;
+            if (column < 0 || column >= tray.columns || row < 0 || row >= tray.rows) { strays.push_back(k); continue; }
+
+            const int cell = row * tray.columns + column;
+            const float distance = std::hypot(x - (tray.origin.x + column * tray.pitch.x), y - (tray.origin.y + row * tray.pitch.y));
+            if (owner[cell] >= 0 && ownerDistance[cell] <= distance) { strays.push_back(k); continue; }
+            if (owner[cell] >= 0) strays.push_back(owner[cell]);
+            owner[cell] = k;
+            ownerDistance[cell] = distance;
+        }
+
+        std::vector<TrayPart> ordered;
+        ordered.reserve(cellCount + strays.size());
+        for (int cell = 0; cell < cellCount; ++cell)
+        {
+            if (owner[cell] >= 0) {
+                ordered.push_back(std::move(parts[owner[cell]]));
+            } else {
+                ordered.push_back({ -1, cv::Rect(), MeasurementResults(), {} });
+                ordered.back().results.trayEmpty = true;
+            }
+            ordered.back().results.trayRow = cell / tray.columns;
+            ordered.back().results.trayColumn = cell % tray.columns;
+        }
+        std::sort(strays.begin(), strays.end()); // ˳򣬽ظ
+        for (int k : strays)
+        {
+            ordered.push_back(std::move(parts[k]));
+            ordered.back().results.trayRow = -1;
+            ordered.back().results.trayColumn = -1;
+        }
+        parts.swap(ordered);
+    }
+
+    static uint32_t InspectPartsImpl(const cv::Mat& srcImage, PixelFormat format, const InspectOptions& options,
+        MeasurementResults& frame, std::vector<MeasurementResults>& results, cv::Mat& resultImage)
+    {
+        results.clear();
+
+        // --- a. ~ e. 뵥ͬ (ʹ״ģ) ---
+        StageTiming& timing = frame.timing;
+        cv::Mat preview;
+        std::vector<std::vector<cv::Point>> contours;
+        std::vector<cv::Vec4i> hierarchy;
+        const uint32_t status = FindFrameContours(srcImage, format, options, false, frame, resultImage, preview, contours, hierarchy);
+        if (status != 0) return status;
+
+        // --- f. 㹻ĶŽоߵĸ (ûʱλ) ---
+        // ÿֻͼֵԤͳƣʱֻ¼ frame 
+        timing.beginNs[Stage_LocatePart] = MonotonicNowNs();
+        std::vector<TrayPart> parts;
+        for (int i = 0; i < static_cast<int>(contours.size()); i++)
+        {
+            if (hierarchy[i][3] == -1 && cv::contourArea(contours[i]) >= options.tray.minPartArea) {
+                parts.push_back({ i, cv::boundingRect(contours[i]), MeasurementResults(), {} });
+                parts.back().results.threshold = frame.threshold;
+                parts.back().results.quality = frame.quality;
+            }
+        }
+        const bool fixtureGrid = options.tray.rows > 0 && options.tray.columns > 0;
+        if (!parts.empty()) {
+            if (fixtureGrid) AssignFixtureCells(parts, options.tray);
+            else SortByTrayPosition(parts, options.tray.rowTolerance);
+        }
+        timing.endNs[Stage_LocatePart] = MonotonicNowNs();
+        if (parts.empty()) return 3;
+
+        // --- g. h. ؼÿκͿ/ۿڲ໥ɵ ---
+        // : ʱ (յ Mat)ֻ߳дԼһݽԲϵĵ㼯̸߳
+        timing.beginNs[Stage_Features] = MonotonicNowNs();
+        cv::parallel_for_(cv::Range(0, static_cast<int>(parts.size())), [&](const cv::Range& range) {
+            cv::Mat noCanvas;
+            for (int k = range.start; k < range.end; ++k)
+            {
+                TrayPart& part = parts[k];
+                if (part.contourIdx < 0) continue; // յļо߸
+                MeasurementResults& r = part.results;
+                r.boundingBox = cv::minAreaRect(contours[part.contourIdx]);
+                if (options.caliper.enabled) RefineBoxWithCalipers(preview, options.caliper, r.boundingBox, noCanvas);
+                if (options.feret.enabled) MeasureContourFeret(contours, hierarchy, part.contourIdx, options.feret, FeretReferenceAngle(r), r.feret);
+                // ֻ (еһӣֵ)ɨб
+                for (int i = hierarchy[part.contourIdx][2]; i >= 0; i = hierarchy[i][0])
+                {
+                    cv::RotatedRect slotBox;
+                    if (MeasureHole(contours, hierarchy, i, options, preview, r, noCanvas, &slotBox) == Hole_Slot) part.slotBoxes.push_back(slotBox);
                 }
+                r.arcRadius = MeanArcRadius(r.slotResults);
+                if (options.nominal.model) CompareWithNominal(contours, hierarchy, part.contourIdx, r.boundingBox, options, format, r.deviation);
+                if (options.golden.model) options.golden.model->compare(preview, contours[part.contourIdx], r.boundingBox, PartPose(), options.golden.tolerance, r.golden);
             }
-        } // ڿѭ
+        });
+        timing.endNs[Stage_Features] = MonotonicNowNs();
 
-        // --- i. سɹ ---
+        // ˳ƣÿı results еţյļо߸ڸĻһ
+        for (size_t k = 0; k < parts.size(); ++k)
+        {
+            const TrayPart& part = parts[k];
+            if (part.contourIdx < 0) {
+                const cv::Point2f cell(options.tray.origin.x + part.results.trayColumn * options.tray.pitch.x,
+                                       options.tray.origin.y + part.results.trayRow * options.tray.pitch.y);
+                cv::drawMarker(resultImage, cell, COLOR_MAGENTA, cv::MARKER_TILTED_CROSS, 24, 2);
+                cv::putText(resultImage, std::to_string(k), cv::Point(cvRound(cell.x) + 14, cvRound(cell.y) + 8),
+                            cv::FONT_HERSHEY_SIMPLEX, 0.8, COLOR_MAGENTA, 2);
+                continue;
+            }
+            DrawPartOutline(resultImage, contours[part.contourIdx], part.results.boundingBox);
+            for (const CircleResult& circle : part.results.circles) DrawCircle(resultImage, circle);
+            for (const cv::RotatedRect& slotBox : part.slotBoxes) DrawSlot(resultImage, slotBox);
+            DrawDeviation(resultImage, part.results.deviation);
+            if (options.golden.model) DrawGoldenHeatmap(resultImage, *options.golden.model, part.results.golden, options.golden.tolerance);
+            cv::putText(resultImage, std::to_string(k), cv::Point(part.rect.x + 4, part.rect.y + 24),
+                        cv::FONT_HERSHEY_SIMPLEX, 0.8, COLOR_MAGENTA, 2);
+        }
+
+        results.reserve(parts.size());
+        for (TrayPart& part : parts) results.push_back(std::move(part.results));
         return 0;
     }
 
+    uint32_t INSPECTOR_API InspectParts(const cv::Mat& rawImage, PixelFormat format,
+        std::vector<MeasurementResults>& parts,
+        cv::Mat& resultImage,
+        const InspectOptions& options)
+    {
+        const int64_t beginNs = MonotonicNowNs();
+        MeasurementResults frame; // ͼֵԤͳƺ͸׶κʱ
+        const uint32_t status = InspectPartsImpl(rawImage, format, options, frame, parts, resultImage);
+        for (MeasurementResults& part : parts) {
+            if (!part.trayEmpty) FinishResults(status, format, options, part);
+        }
+        const int64_t elapsedNs = MonotonicNowNs() - beginNs;
+        RecordInspectMetrics(status, frame, elapsedNs);
+        Stats::Global().record(status, frame.timing, elapsedNs);
+        return status;
+    }
+
+    // ͼ -> 
+    void INSPECTOR_API MapResultsToSensor(MeasurementResults& results, const cv::Point2f& offset, float scale)
+    {
+        auto mapPoint = [&offset, scale](const cv::Point2f& p) { return cv::Point2f(p.x * scale + offset.x, p.y * scale + offset.y); };
+        auto mapFeret = [scale](FeretResult& feret) {
+            feret.maxDiameter *= scale;
+            feret.minDiameter *= scale;
+            feret.maxInscribed *= scale;
+            for (float& width : feret.widths) width *= scale;
+        };
+
+        results.boundingBox.center = mapPoint(results.boundingBox.center);
+        results.boundingBox.size = cv::Size2f(results.boundingBox.size.width * scale, results.boundingBox.size.height * scale);
+
+        for (CircleResult& circle : results.circles) {
+            circle.center = mapPoint(circle.center);
+            circle.radius *= scale;
+            mapFeret(circle.feret);
+        }
+
+        for (SlotResult& slot : results.slotResults) {
+            slot.center = mapPoint(slot.center);
+            slot.length *= scale;
+            slot.width *= scale;
+            slot.arcRadius[0] *= scale;
+            slot.arcRadius[1] *= scale;
+            mapFeret(slot.feret);
+        }
+
+        results.arcRadius *= scale;
+        mapFeret(results.feret);
+
+        results.pose.position = mapPoint(results.pose.position);
+
+        // ƫ mm ƣֻλ
+        results.deviation.worstPoint = mapPoint(results.deviation.worstPoint);
+        for (DeviationDefect& defect : results.deviation.defects) defect.position = mapPoint(defect.position);
+
+        // ȽϵľͼԴͼؼƣֻλ
+        results.golden.worstPoint = mapPoint(results.golden.worstPoint);
+        results.golden.center = mapPoint(results.golden.center);
+    }
+
 } // namespace InspectorLib
\ No newline at end of file
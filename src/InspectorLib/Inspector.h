@@ -19,12 +19,28 @@
 
 #include <opencv2/opencv.hpp>
 #include <vector>
+#include <cstdint>
+#include <memory>
 
 // --- �����ռ俪ʼ ---
 namespace InspectorLib
 {
     // --- ���ؼ������������������Ľṹ�嶨�壡---
 
+    /**
+     * @brief 一条轮廓的 Feret 尺寸 (见 Feret.h，FeretOptions::enabled 时计算)。
+     * @details 角度为测量方向 (卡尺两爪之间的连线) 与图像 x 轴的夹角 (度，[0, 180))。
+     */
+    struct FeretResult
+    {
+        float maxDiameter = 0.0f;  // 最大 Feret 直径 (凸包上最远的两点)
+        float maxAngle = 0.0f;
+        float minDiameter = 0.0f;  // 最小 Feret 直径 (最小宽度)
+        float minAngle = 0.0f;
+        float maxInscribed = 0.0f; // 最大内切圆直径 (FeretOptions::inscribed 时计算，像素精度)
+        std::vector<float> widths; // FeretOptions::angles 各方向上的宽度，一一对应
+    };
+
     /**
      * @brief �洢����Բ�ο׵Ĳ�������
      */
@@ -32,6 +48,7 @@ namespace InspectorLib
     {
         cv::Point2f center; // Բ������
         float radius;       // �뾶
+        FeretResult feret;  // FeretOptions::enabled 时有效
     };
 
     /**
@@ -43,6 +60,321 @@ namespace InspectorLib
         float length;       // �ۿڵ��ܳ��ȣ����ߣ�
         float width;        // �ۿڵĿ��ȣ��̱ߣ�
         float angle;        // �ۿھ�������ˮƽ��������ת�Ƕ�
+        float arcRadius[2];  // 两端半圆弧的拟合半径 (长轴负方向的一端在前)；拟合失败的一端为宽度的一半
+        FeretResult feret;   // FeretOptions::enabled 时有效
+    };
+
+    /**
+     * @brief 换算为毫米、去除镜头畸变之后的测量结果 (见 CameraCalibration)。
+     * @details 坐标为检测平面上的毫米坐标 (原点和方向由标定时平放的棋盘格决定)，角度为该坐标系下的角度。
+     */
+    struct MetricResults
+    {
+        bool valid = false;                // 没有标定或检测失败时为 false，以下字段无意义
+        cv::RotatedRect boundingBox;       // 零件外接矩形 (mm)
+        std::vector<CircleResult> circles; // 与 MeasurementResults::circles 一一对应
+        std::vector<SlotResult> slotResults; // 与 MeasurementResults::slotResults 一一对应
+        FeretResult feret;                 // 零件外形的 Feret 尺寸 (mm)
+    };
+
+    /**
+     * @brief 检测流程中的各个阶段，用于耗时统计和帧追踪。
+     */
+    enum InspectStage
+    {
+        Stage_QualityGate = 0, // 图像质量预检 (未启用时不执行)
+        Stage_Canvas,       // 创建可视化画布
+        Stage_Threshold,    // 图像二值化
+        Stage_ShapeMatch,   // 形状模板匹配定位零件 (未提供模型时不执行)
+        Stage_FindContours, // 轮廓发现
+        Stage_LocatePart,   // 定位零件外轮廓
+        Stage_Features,     // 内部孔/槽的测量
+        Stage_Deviation,    // 与名义几何比较 (未提供名义模型时不执行)
+        Stage_Golden,       // 与金板比较 (未提供金板模型时不执行)
+        Stage_Count         // 阶段总数 (不是一个真正的阶段)
+    };
+
+    /**
+     * @brief 相机输出的像素格式 (与相机SDK无关，由调用方从SDK的枚举值换算)。
+     * @details 原始图像在 cv::Mat 中的存放方式见 WrapRawFrame (PixelFormat.h)。
+     */
+    enum PixelFormat
+    {
+        PixelFormat_Mono8 = 0,    // 8位灰度，CV_8UC1
+        PixelFormat_Mono10,       // 10位灰度，每像素2字节 (小端，低10位有效)，CV_16UC1
+        PixelFormat_Mono12,       // 12位灰度，每像素2字节，CV_16UC1
+        PixelFormat_Mono16,       // 16位灰度，CV_16UC1
+        PixelFormat_Mono10Packed, // 10位灰度，每2个像素打包为3字节 (GigE Vision 格式)
+        PixelFormat_Mono12Packed, // 12位灰度，每2个像素打包为3字节 (GigE Vision 格式)
+        PixelFormat_BayerRG8,     // 8位 Bayer 彩色原始数据，CV_8UC1 (后缀表示左上角2x2的排列)
+        PixelFormat_BayerBG8,
+        PixelFormat_BayerGB8,
+        PixelFormat_BayerGR8,
+        PixelFormat_Count         // 格式总数 (不是一个真正的格式)
+    };
+
+    /**
+     * @brief 二值化阈值的选取方式。
+     */
+    enum ThresholdMethod
+    {
+        Threshold_Fixed = 0, // 固定阈值 (8位刻度的50)
+        Threshold_Otsu,      // 大津法：类间方差最大，适合零件与背景两个峰都明显的图像
+        Threshold_Triangle,  // 三角法：适合背景占绝大多数、零件的峰很弱的图像
+        Threshold_Count      // 方法总数 (不是一个真正的方法)
+    };
+
+    /**
+     * @brief 圆孔的拟合方法 (见 Fitting.h)。
+     */
+    enum CircleFitMethod
+    {
+        CircleFit_MinEnclosing = 0, // 最小外接圆：由最外侧的几个像素决定，毛刺会让半径偏大
+        CircleFit_Kasa,             // 代数最小二乘，最快；只有一段圆弧时半径偏小
+        CircleFit_Taubin,           // 梯度加权的代数拟合，偏差很小
+        CircleFit_Hyper,            // 半径无偏的代数拟合 (默认)
+        CircleFit_Count             // 方法总数 (不是一个真正的方法)
+    };
+
+    /**
+     * @brief 图像质量预检的参数 (见 FrameQuality.h)。
+     * @details 预检只读取整幅图像的一小部分像素，在二值化和轮廓发现之前拒绝不值得检测的帧，
+     * 并用单独的状态码 (4 ~ 8) 报告原因。与二值化的约定相同，零件比背景亮。
+     */
+    struct QualityGateOptions
+    {
+        bool enabled = false;
+        int foregroundLevel = 50;            // 高于它 (8位刻度) 的像素视为零件。不随自动阈值变化：空图上的自动阈值没有意义
+        float minForegroundFraction = 0.01f; // 零件像素的比例低于它：空帧 (状态码4)
+        float maxBorderFraction = 0.01f;     // 图像边界上零件像素的比例高于它：零件不完整 (状态码5)
+        float minFocus = 0.0f;               // 拉普拉斯响应的方差低于它：失焦或运动模糊 (状态码6)。与镜头和零件有关，0 表示不检查
+        float maxSaturatedFraction = 0.05f;  // 饱和像素的比例高于它：过曝 (状态码7)
+        int minBrightLevel = 20;             // 最亮的 1% 像素 (8位刻度) 仍低于它：欠曝或光源没有打开 (状态码8)
+    };
+
+    /**
+     * @brief 形状模板匹配得到的零件位姿 (见 ShapeModel)。
+     * @details position 为模型原点 (金板图像中心) 在图像中的位置，angle 为模型相对金板的旋转角度 (度，
+     * 与 cv::RotatedRect 的角度方向相同)，score 为相似度 (0 ~ 1)。
+     */
+    struct PartPose
+    {
+        bool found = false;
+        cv::Point2f position;
+        float angle = 0.0f;
+        float score = 0.0f;
+    };
+
+    /**
+     * @brief 与名义几何比较时，轮廓上连续超出公差的一段 (见 NominalModel)。
+     */
+    struct DeviationDefect
+    {
+        bool excess = false;  // true 为多料 (毛刺、凸起)，false 为缺料 (崩边、缺口)
+        float depth = 0.0f;   // 这一段上最大的偏差 (mm，绝对值)
+        float length = 0.0f;  // 沿轮廓的长度 (mm)
+        cv::Point2f position; // 偏差最大的点 (图像坐标)
+        int feature = -1;     // 所在的特征 (NominalModel::features() 的下标)
+    };
+
+    /**
+     * @brief 零件轮廓 (外形和内孔) 与名义几何的偏差 (见 NominalModel)。
+     * @details 偏差是轮廓点到名义轮廓的有符号距离 (mm)：点在名义实体之外为正 (多料)，之内为负 (缺料)。
+     */
+    struct DeviationResult
+    {
+        bool valid = false;
+        float maxDeviation = 0.0f; // 偏差绝对值的最大值
+        float maxExcess = 0.0f;    // 最大的多料 (没有时为0)
+        float maxMissing = 0.0f;   // 最大的缺料 (取绝对值，没有时为0)
+        float rms = 0.0f;          // 均方根偏差
+        cv::Point2f worstPoint;    // 偏差绝对值最大的点 (图像坐标)
+        int pointCount = 0;        // 参与比较的轮廓点数 (按1像素的间距补全之后)
+        std::vector<DeviationDefect> defects; // 超出公差的各段，按轮廓的顺序
+    };
+
+    /**
+     * @brief 与金板比较 (chamfer 匹配) 的结果 (见 GoldenModel)。
+     * @details 距离是这一帧零件上的边缘像素 (按零件位姿对齐到金板) 到最近的金板边缘的距离，单位为处理图像的像素，
+     * 截断在 GoldenModel::kMaxDistance。
+     */
+    struct GoldenResult
+    {
+        bool valid = false;
+        float meanDistance = 0.0f;  // 平均 chamfer 距离，零件与金板一致时接近0
+        float maxDistance = 0.0f;
+        float outlierRatio = 0.0f;  // 距离超出公差的边缘像素的比例
+        int edgeCount = 0;          // 参与比较的边缘像素数
+        cv::Point2f worstPoint;     // 距离最大的边缘像素 (图像坐标)
+        cv::Point2f center;         // 对齐所用的位姿：金板原点 (零件外接矩形中心) 在图像中的位置，
+        float angle = 0.0f;         // 和金板相对这一帧的转角 (度)
+        cv::Mat heatmap;            // 局部偏差 (CV_32FC1)：金板上每 GoldenModel::kHeatCell 像素一格，取格内边缘距离的最大值
+    };
+
+    /**
+     * @brief 卡尺测量的参数 (见 Caliper.h)。
+     * @details 开启后，零件外形尺寸和槽口的长宽在轮廓给出的位置和方向上，用几把卡尺在灰度图上重新测量：
+     * 边缘由灰度梯度定位到亚像素，不受二值化阈值和轮廓上毛刺的影响。卡尺找不到边缘时保留轮廓的结果。
+     */
+    struct CaliperOptions
+    {
+        bool enabled = false;
+        int count = 7;             // 每个方向上的卡尺数 (取各卡尺宽度的中位数)
+        int width = 5;             // 每把卡尺垂直方向上平均的采样线数
+        float minStrength = 8.0f;  // 边缘的最小梯度 (8位灰度/像素)
+    };
+
+    /**
+     * @brief Feret 尺寸的参数 (见 Feret.h)。
+     * @details 开启后，零件外轮廓和每个内孔都在凸包上用旋转卡尺计算最大/最小 Feret 直径，
+     * 并在 angles 的各个方向上测量宽度。angles 相对零件的方向 (度)：有形状模型时是匹配位姿的转角，否则是外接矩形长边的方向，
+     * 零件转动时测量方向随之转动。零件外形的最大内切圆挖掉了内孔。
+     */
+    struct FeretOptions
+    {
+        bool enabled = false;
+        bool inscribed = true;     // 同时计算最大内切圆直径 (需要对轮廓区域做一次距离变换)
+        std::vector<float> angles; // 额外测量宽度的方向
+    };
+
+    /**
+     * @brief 多零件 (料盘) 检测的参数 (见 InspectParts)。
+     * @details 设置了夹具网格 (rows、columns 都大于0) 时，零件按中心所在的格子确定行列：
+     * 列 = round((x - origin.x) / pitch.x)，行 = round((y - origin.y) / pitch.y)，空着的格子同样占一个位置。
+     * 夹具的行列需要与图像的 x/y 轴平行。没有网格时按零件之间的相对位置分行 (见 rowTolerance)，
+     * 这时行列只是排序的名次：一个空位会让后面零件的列号都前移一位。
+     */
+    struct TrayOptions
+    {
+        double minPartArea = 2000.0; // 顶层轮廓的最小面积 (像素)，更小的视为灰尘或反光，不算零件
+        float rowTolerance = 0.5f;   // 两个零件中心的 y 相差不到“零件高度中值 x rowTolerance”时视为同一行
+        // 夹具网格 (处理图像的像素；Bayer 半分辨率检测时为半分辨率的坐标)
+        int rows = 0;                // 行数和列数，为0时不使用网格
+        int columns = 0;
+        cv::Point2f origin;          // 第0行第0列格子的中心
+        cv::Point2f pitch;           // 列间距 (x) 和行间距 (y)；只有一列 (一行) 时对应的分量可以为0
+    };
+
+    /**
+     * @brief 质量预检的统计值 (都在稀疏的采样网格上得到，8位刻度)。
+     */
+    struct FrameQuality
+    {
+        float foregroundFraction = 0.0f; // 零件像素的比例
+        float borderFraction = 0.0f;     // 图像边界上零件像素的比例
+        float saturatedFraction = 0.0f;  // 饱和 (255) 像素的比例
+        int brightLevel = 0;             // 99% 分位的灰度
+        float focus = 0.0f;              // 拉普拉斯响应的方差，越大越清晰 (minFocus 为0时不计算)
+    };
+
+    class FlatFieldCorrection; // 见 FlatField.h
+    class AutoThreshold;       // 见 AutoThreshold.h
+    class ChangeDetector;      // 见 ChangeDetector.h
+    class CameraCalibration;   // 见 Calibration.h
+    class ShapeModel;          // 见 ShapeModel.h
+    class NominalModel;        // 见 NominalModel.h
+    class GoldenModel;         // 见 GoldenModel.h
+
+    /**
+     * @brief 与名义几何 (CAD) 比较的参数 (见 NominalModel)。
+     * @details 零件外轮廓和它的内孔逐点与名义轮廓比较，位姿以外接矩形为初值。
+     * 像素和毫米的换算优先使用 pixelSize；为0时用相机标定在零件中心处的局部比例 (不对轮廓去畸变)，两者都没有时不比较。
+     */
+    struct NominalOptions
+    {
+        std::shared_ptr<const NominalModel> model;
+        float pixelSize = 0.0f;  // 一个传感器像素 (不合并) 对应的毫米数
+        float tolerance = 0.1f;  // 公差 (mm)，超出的连续一段记为一处缺陷
+        bool bestFit = true;     // 最小二乘对齐 (只评价形状，零件的位置和转角不计入偏差)
+    };
+
+    /**
+     * @brief 与金板比较的参数 (见 GoldenModel)。
+     * @details 零件上的边缘按形状模型的位姿 (没有时按外接矩形) 对齐到金板，逐个边缘像素在金板的距离图上取值；超出公差的边缘在结果图上以热力图标出。
+     */
+    struct GoldenOptions
+    {
+        std::shared_ptr<const GoldenModel> model;
+        float tolerance = 2.0f;  // 边缘像素到金板边缘的距离上限 (处理图像的像素)
+    };
+
+    /**
+     * @brief InspectRawFrame 的可选参数。
+     */
+    struct InspectOptions
+    {
+        // Bayer 彩色图像按 2x2 超像素转换为半分辨率的灰度图再检测：像素数减为1/4，速度更快，
+        // 但定位精度也随之降低。测量结果仍然换算回原始图像的坐标，只有 resultImage 是半分辨率的。
+        bool bayerHalfResolution = false;
+
+        // 平场校正 (补偿背光暗角)。为空时使用固定阈值。校正折算为逐像素阈值，在二值化的同一遍扫描中完成。
+        std::shared_ptr<const FlatFieldCorrection> flatField;
+
+        // 图像在传感器上的位置 (相机端ROI的左上角，传感器像素) 和合并系数，用于从平场校正表中取出对应的区域
+        cv::Point sensorOffset;
+        int sensorScale = 1;
+        // 阈值的选取方式。自动阈值在稀疏采样的直方图上计算，只读取整幅图像的一小部分像素；
+        // 直方图统计失败 (例如图像只有一种灰度) 时退回固定阈值。
+        ThresholdMethod thresholdMethod = Threshold_Fixed;
+        // 连续检测时的直方图状态 (可选)。提供时每帧只采样网格的一个相位，与之前几帧的采样合并，
+        // 阈值随光照的缓慢变化而更新；为空时每帧独立采样整个网格。
+        std::shared_ptr<AutoThreshold> thresholdTracker;
+        // 图像质量预检 (默认关闭)
+        QualityGateOptions qualityGate;
+        // 变化检测 (可选，连续检测时使用)：画面没有变化时直接返回上一次的结果，只有零件内部变化时只重测变化区域里的孔。
+        // 复用的结果图与缓存共享，调用方不要修改。
+        std::shared_ptr<ChangeDetector> changeDetector;
+        // 相机标定 (可选)：提供时把测量结果换算为毫米 (MeasurementResults::metric)。
+        // 只换算结果中的点，不对整幅图像去畸变；坐标按 sensorOffset/sensorScale 换算到传感器坐标后查表。
+        std::shared_ptr<const CameraCalibration> calibration;
+        // 圆孔的拟合方法和稳健重加权的迭代次数 (0 为普通最小二乘)。重加权去掉毛刺、碎屑等离群的轮廓点。
+        CircleFitMethod circleFit = CircleFit_Hyper;
+        int circleFitIterations = 2;
+        // 卡尺测量 (默认关闭)：在灰度图上以亚像素精度重新测量外形尺寸和槽口
+        CaliperOptions caliper;
+        // 形状模型 (可选)：提供时先用模板匹配定位零件，轮廓发现只在模型区域 (按位姿放置) 内进行，
+        // 区域外的杂物不会被当成零件；相似度低于 minMatchScore 时返回状态码3 (未找到零件)。
+        std::shared_ptr<const ShapeModel> shapeModel;
+        float minMatchScore = 0.7f;
+        // 多零件检测 (InspectParts) 的参数
+        TrayOptions tray;
+        // Feret 尺寸 (默认关闭)
+        FeretOptions feret;
+        // 名义几何比较 (可选)：提供名义模型时报告最大偏差、多料和缺料
+        NominalOptions nominal;
+        // 与金板比较 (可选)：提供金板模型时报告边缘的 chamfer 距离和局部偏差热力图
+        GoldenOptions golden;
+    };
+
+    /**
+     * @brief 返回阶段的英文名称 (用于日志、追踪文件和统计输出)。
+     */
+    const char* INSPECTOR_API StageName(InspectStage stage);
+
+    /**
+     * @brief 返回 InspectPart 状态码的英文名称 (用于日志、指标标签和统计输出)。
+     * @details 0 为 "ok"，1 ~ 3 为输入错误或未找到零件，4 ~ 8 为质量预检拒绝的原因 (见 QualityGateOptions)，
+     * 未知的状态码返回 "unknown"。
+     */
+    const char* INSPECTOR_API StatusName(uint32_t status);
+
+    /**
+     * @brief 返回 StageTiming 使用的时钟读数 (std::chrono::steady_clock，纳秒)。
+     * @details 调用方(例如GUI的帧追踪)应使用同一个时钟，时间戳才能相互比较。
+     */
+    int64_t INSPECTOR_API MonotonicNowNs();
+
+    /**
+     * @brief 记录 InspectPart 各阶段的开始/结束时刻 (MonotonicNowNs 的读数)。
+     * @details 某个阶段没有执行时 (例如提前返回了错误码)，其开始和结束时刻都为0。
+     */
+    struct StageTiming
+    {
+        int64_t beginNs[Stage_Count] = {};
+        int64_t endNs[Stage_Count] = {};
+
+        // 某个阶段的耗时 (纳秒)，未执行时为0
+        int64_t durationNs(InspectStage stage) const { return endNs[stage] - beginNs[stage]; }
     };
 
     /**
@@ -57,13 +389,38 @@ namespace InspectorLib
         std::vector<CircleResult> circles; // һ����̬�б������ڴ洢�����ҵ���СԲ��
 
         // c. �ڲ��ۿ�
-        SlotResult slot; // һ�������Ķ��������ڴ洢�Ǹ����ۿڵ���Ϣ
+        std::vector<SlotResult> slotResults; // 所有槽口 (圆度低、面积较大的内孔)，按轮廓的顺序。不叫 slots：它是 Qt 的关键字宏
 
-        // d. ����Բ�� (Ϊδ������Ԥ��)
+        // d. 槽口两端圆弧的平均半径 (所有槽口的所有端；没有槽口时为0)
         float arcRadius;
 
+        // e. 各检测阶段的耗时记录 (用于帧追踪和性能统计)
+        StageTiming timing;
+
+        // f. 触发编号 (由调用方填写：相机软触发时分配，随图像一路传递到结果；非触发采集的图像为0)
+        uint64_t triggerId;
+        // g. 本次二值化使用的阈值 (8位刻度；自动阈值时为计算结果)
+        int threshold;
+        // h. 质量预检的统计值 (未启用预检时全为0)
+        FrameQuality quality;
+        // i. 换算为毫米的结果 (提供了相机标定时有效)
+        MetricResults metric;
+        // j. 形状模板匹配的零件位姿 (提供了形状模型时有效)
+        PartPose pose;
+        // k. 料盘上的位置 (InspectParts 时有效：行、列，从0开始；单零件检测时都为0)
+        //    使用夹具网格时，不在任何格子里的零件行列为 -1；trayEmpty 表示这一格没有零件 (其他测量值都无效)
+        int trayRow;
+        int trayColumn;
+        bool trayEmpty;
+        // l. 零件外轮廓的 Feret 尺寸 (FeretOptions::enabled 时有效；内孔的在 circles/slotResults 中)
+        FeretResult feret;
+        // m. 与名义几何的偏差 (提供了名义模型时有效，偏差以 mm 计)
+        DeviationResult deviation;
+        // n. 与金板的比较 (提供了金板模型时有效，距离以处理图像的像素计)
+        GoldenResult golden;
+
         // ���캯����ȷ���ڴ��� MeasurementResults ����ʱ������ֵ������ȷ��ʼ��
-        MeasurementResults() : arcRadius(0.0f) {}
+        MeasurementResults() : arcRadius(0.0f), triggerId(0), threshold(0), trayRow(0), trayColumn(0), trayEmpty(false) {}
     };
 
 
@@ -74,6 +431,47 @@ namespace InspectorLib
         MeasurementResults& results,
         cv::Mat& resultImage);
 
+    /**
+     * @brief 直接对相机的原始图像执行检测，支持 Mono8/10/12/16 以及打包格式。
+     * @details 高位深图像不会先整幅转换为8位：解包、二值化和生成8位画布在同一遍扫描中完成 (见 UnpackAndThreshold)，
+     * 二值化在原始位深上比较。PixelFormat_Mono8 与 InspectPart 完全相同；
+     * 反过来，InspectPart 收到 CV_16UC1 图像时按 PixelFormat_Mono16 处理。
+     * Bayer 彩色图像同样不经过 BGR，在同一遍扫描中直接得到亮度 (见 InspectOptions::bayerHalfResolution)。
+     * @param rawImage 原始图像，存放方式见 WrapRawFrame。
+     * @return 与 InspectPart 相同；rawImage 的类型与 format 不匹配时返回 2。
+     */
+    uint32_t INSPECTOR_API InspectRawFrame(const cv::Mat& rawImage, PixelFormat format,
+        MeasurementResults& results,
+        cv::Mat& resultImage,
+        const InspectOptions& options = InspectOptions());
+
+    /**
+     * @brief 多零件 (料盘) 检测：图像中每个足够大的顶层轮廓都是一个零件，每个零件一份测量结果。
+     * @details 预检、二值化和轮廓发现与 InspectRawFrame 相同，只做一次；各零件的外形和孔/槽口测量用
+     * cv::parallel_for_ 分派到多个核心，全部测量完成之后再按顺序画在 resultImage 上。
+     * 设置了夹具网格 (见 TrayOptions) 时，parts 的前 rows x columns 项按行优先对应夹具的各个格子，
+     * parts[row * columns + column] 就是这一格，没有零件的格子 trayEmpty 为 true；
+     * 不在网格里的零件 (以及同一格中离格子中心较远的零件) 排在最后，行列为 -1。
+     * 没有网格时结果按位置排序：先分行 (见 TrayOptions::rowTolerance)，行从上到下，行内从左到右，
+     * 这时序号只是排序的名次，缺一个零件时后面的零件都会前移，不能当作夹具的位置。
+     * 形状模型 (只定位一个零件) 和变化检测在这里不使用；每个零件的 threshold 和 quality 是整幅图像的，
+     * 耗时只对整幅图像记录 (Stats 和运行时指标)，零件的 timing 为空。
+     * @return 与 InspectRawFrame 相同；一个零件也没有时返回3 (parts 为空)。
+     */
+    uint32_t INSPECTOR_API InspectParts(const cv::Mat& rawImage, PixelFormat format,
+        std::vector<MeasurementResults>& parts,
+        cv::Mat& resultImage,
+        const InspectOptions& options = InspectOptions());
+
+    /**
+     * @brief 把在子图上得到的测量结果换算回整幅传感器的像素坐标。
+     * @details 相机只传输零件附近的区域 (ROI)，并且可能做了像素合并 (binning) 时，InspectPart
+     * 得到的是子图坐标。所有坐标按 sensor = sub * scale + offset 换算，所有长度 (半径、长宽) 乘以 scale，角度不变。
+     * @param offset 子图左上角在传感器上的位置 (传感器像素)。
+     * @param scale 子图一个像素对应的传感器像素数 (合并系数，不合并时为1)。
+     */
+    void INSPECTOR_API MapResultsToSensor(MeasurementResults& results, const cv::Point2f& offset, float scale);
+
 } // ���������ռ� InspectorLib
 
 #endif // INSPECTOR_H
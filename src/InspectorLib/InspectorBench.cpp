@@ -0,0 +1,181 @@
+﻿// InspectorBench.cpp (InspectorLib 的性能基准测试)
+
+// --- 1. 包含必要的头文件 ---
+#include <iostream>
+#include <iomanip>
+#include <cmath>
+#include <random>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Inspector.h"
+#include "Stats.h"
+#include "Fitting.h"
+#include <opencv2/opencv.hpp>
+
+using namespace std;
+using namespace InspectorLib;
+
+/**
+ * @brief 打印用法说明
+ */
+static void printUsage()
+{
+    cerr << "Usage: InspectorBench <image> [--iterations N] [--threads T] [--warmup W]" << endl;
+    cerr << "  Runs InspectPart N times on each of T threads and prints per-stage and per-outcome" << endl;
+    cerr << "  latency percentiles (HDR histogram, ~1% relative precision)." << endl;
+    cerr << "       InspectorBench --fitting [--iterations N]" << endl;
+    cerr << "  Times the circle/line/ellipse fitting kernels against the OpenCV calls per contour size." << endl;
+}
+
+/**
+ * @brief 拟合内核的微基准：对不同点数的合成轮廓，比较每次调用的平均耗时 (ns)。
+ * @details 轮廓为带噪声的整数像素圆 (直线) 加上 2% 的离群点，与 findContours 的输出类似。
+ *          拟合内核的耗时包含把轮廓转为 PointSet 的时间，与 OpenCV 函数内部的转换相当。
+ */
+static int runFittingBench(int iterations)
+{
+    const int sizes[] = { 16, 64, 256, 1024, 4096 };
+    std::mt19937 rng(12345);
+    std::normal_distribution<float> noise(0.0f, 0.5f);
+
+    // 每个点数一组轮廓
+    vector<vector<cv::Point>> circles, lines;
+    for (int n : sizes)
+    {
+        const float radius = std::max(4.0f, n / (2.0f * static_cast<float>(CV_PI)));
+        vector<cv::Point> circle, line;
+        for (int i = 0; i < n; i++)
+        {
+            const float t = 2.0f * static_cast<float>(CV_PI) * i / n;
+            const bool outlier = i % 50 == 49;
+            const float r = radius + (outlier ? 6.0f : 0.0f) + noise(rng);
+            circle.emplace_back(cvRound(1000 + r * std::cos(t)), cvRound(800 + r * std::sin(t)));
+            line.emplace_back(100 + i, cvRound(200 + 0.3f * i + noise(rng) + (outlier ? 8.0f : 0.0f)));
+        }
+        circles.push_back(circle);
+        lines.push_back(line);
+    }
+
+    // 单次调用的平均耗时 (ns)
+    auto timeIt = [iterations](auto&& call) {
+        for (int i = 0; i < std::min(iterations, 100); i++) call();
+        const int64_t beginNs = MonotonicNowNs();
+        for (int i = 0; i < iterations; i++) call();
+        return (MonotonicNowNs() - beginNs) / static_cast<double>(iterations);
+    };
+
+    PointSet points;
+    volatile float sink = 0.0f; // 防止编译器把结果没有被使用的调用优化掉
+    struct Row { const char* name; vector<double> ns; };
+    vector<Row> rows = {
+        { "cv::minEnclosingCircle", {} }, { "FitCircle kasa", {} }, { "FitCircle taubin", {} }, { "FitCircle hyper", {} },
+        { "FitCircle hyper robust2", {} }, { "cv::fitEllipse", {} }, { "FitEllipse", {} },
+        { "cv::fitLine (L2)", {} }, { "cv::fitLine (HUBER)", {} }, { "FitLine", {} }, { "FitLine robust2", {} }
+    };
+    for (size_t s = 0; s < circles.size(); s++)
+    {
+        const vector<cv::Point>& circle = circles[s];
+        const vector<cv::Point>& line = lines[s];
+        size_t r = 0;
+        rows[r++].ns.push_back(timeIt([&]() { cv::Point2f c; float radius; cv::minEnclosingCircle(circle, c, radius); sink = radius; }));
+        for (CircleFitMethod method : { CircleFit_Kasa, CircleFit_Taubin, CircleFit_Hyper }) {
+            rows[r++].ns.push_back(timeIt([&]() { CircleFit fit; points.assign(circle); FitCircle(points, method, fit); sink = fit.radius; }));
+        }
+        rows[r++].ns.push_back(timeIt([&]() { CircleFit fit; points.assign(circle); FitCircle(points, CircleFit_Hyper, fit, 2); sink = fit.radius; }));
+        rows[r++].ns.push_back(timeIt([&]() { sink = cv::fitEllipse(circle).size.width; }));
+        rows[r++].ns.push_back(timeIt([&]() { EllipseFit fit; points.assign(circle); FitEllipse(points, fit); sink = fit.box.size.width; }));
+        rows[r++].ns.push_back(timeIt([&]() { cv::Vec4f l; cv::fitLine(line, l, cv::DIST_L2, 0, 0.01, 0.01); sink = l[0]; }));
+        rows[r++].ns.push_back(timeIt([&]() { cv::Vec4f l; cv::fitLine(line, l, cv::DIST_HUBER, 0, 0.01, 0.01); sink = l[0]; }));
+        rows[r++].ns.push_back(timeIt([&]() { LineFit fit; points.assign(line); FitLine(points, fit); sink = fit.direction.x; }));
+        rows[r++].ns.push_back(timeIt([&]() { LineFit fit; points.assign(line); FitLine(points, fit, 2); sink = fit.direction.x; }));
+    }
+
+    // 输出表格：每行一个方法，每列一个点数
+    cout << "Fitting kernels, mean ns per call (" << iterations << " iterations)" << endl;
+    cout << left << setw(26) << "points";
+    for (int n : sizes) cout << right << setw(10) << n;
+    cout << endl;
+    for (const Row& row : rows)
+    {
+        cout << left << setw(26) << row.name;
+        for (double ns : row.ns) cout << right << setw(10) << fixed << setprecision(0) << ns;
+        cout << endl;
+    }
+    return 0;
+}
+
+// --- 2. 程序主入口 ---
+int main(int argc, char* argv[])
+{
+    // --- a. 解析命令行参数 ---
+    string imagePath;
+    int iterations = 1000;
+    int threads = 1;
+    int warmup = 20;
+    bool fitting = false;
+    for (int i = 1; i < argc; i++)
+    {
+        const bool hasValue = i + 1 < argc;
+        if (std::strcmp(argv[i], "--fitting") == 0) fitting = true;
+        else if (std::strcmp(argv[i], "--iterations") == 0 && hasValue) iterations = std::atoi(argv[++i]);
+        else if (std::strcmp(argv[i], "--threads") == 0 && hasValue) threads = std::atoi(argv[++i]);
+        else if (std::strcmp(argv[i], "--warmup") == 0 && hasValue) warmup = std::atoi(argv[++i]);
+        else if (argv[i][0] == '-') { printUsage(); return -1; }
+        else imagePath = argv[i];
+    }
+    if (fitting && iterations > 0) return runFittingBench(iterations);
+    if (imagePath.empty() || iterations <= 0 || threads <= 0 || warmup < 0)
+    {
+        printUsage();
+        return -1;
+    }
+
+    // --- b. 加载测试图像 ---
+    cv::Mat image = cv::imread(imagePath, cv::IMREAD_GRAYSCALE);
+    if (image.empty())
+    {
+        cerr << "!!! FATAL ERROR: Could not load image from: " << imagePath << endl;
+        return -1;
+    }
+
+    // --- c. 预热：让缓存、内存分配器和 OpenCV 的线程池进入稳定状态，这部分不计入统计 ---
+    {
+        MeasurementResults results;
+        cv::Mat canvas;
+        for (int i = 0; i < warmup; i++) InspectPart(image, results, canvas);
+    }
+
+    // --- d. 多线程压测 ---
+    // 解释: 使用独立的 Stats 对象，只统计本次压测的调用 (InspectPart 同时也会记入 Stats::Global())。
+    //       每个线程写自己的分片，线程之间没有锁竞争，不会影响测到的耗时。
+    Stats stats;
+    const int64_t beginNs = MonotonicNowNs();
+    vector<thread> workers;
+    for (int t = 0; t < threads; t++)
+    {
+        workers.emplace_back([&stats, &image, iterations]() {
+            MeasurementResults results;
+            cv::Mat canvas;
+            for (int i = 0; i < iterations; i++)
+            {
+                const int64_t callBeginNs = MonotonicNowNs();
+                const uint32_t status = InspectPart(image, results, canvas);
+                stats.record(status, results.timing, MonotonicNowNs() - callBeginNs);
+            }
+        });
+    }
+    for (thread& worker : workers) worker.join();
+    const double elapsedSeconds = (MonotonicNowNs() - beginNs) * 1e-9;
+
+    // --- e. 输出结果 ---
+    const uint64_t total = stats.totalHistogram().totalCount();
+    cout << "Image: " << imagePath << " (" << image.cols << "x" << image.rows << ")" << endl;
+    cout << "Threads: " << threads << ", iterations per thread: " << iterations << endl;
+    cout << "Throughput: " << total / elapsedSeconds << " parts/s" << endl << endl;
+    cout << stats.summary();
+
+    return 0;
+}
@@ -0,0 +1,246 @@
+﻿// Metrics.cpp
+
+#include "Metrics.h"
+
+#include <sstream>
+#include <stdexcept>
+
+namespace InspectorLib
+{
+    // --- 辅助函数 ---
+    namespace
+    {
+        // 对 std::atomic<double> 做原子加法 (C++17 没有 fetch_add，只能用比较交换循环)
+        void AtomicAdd(std::atomic<double>& target, double delta)
+        {
+            double expected = target.load(std::memory_order_relaxed);
+            while (!target.compare_exchange_weak(expected, expected + delta, std::memory_order_relaxed)) {
+            }
+        }
+
+        // 把标签串包进花括号，extra 是额外追加的标签 (直方图的 le)
+        std::string LabelBlock(const std::string& labels, const std::string& extra = std::string())
+        {
+            if (labels.empty() && extra.empty()) return std::string();
+            std::string block = "{" + labels;
+            if (!labels.empty() && !extra.empty()) block += ",";
+            return block + extra + "}";
+        }
+
+        void WriteHeader(std::ostringstream& out, const std::string& name, const std::string& help, const char* type)
+        {
+            out << "# HELP " << name << ' ' << help << '\n';
+            out << "# TYPE " << name << ' ' << type << '\n';
+        }
+    }
+
+    // =====================================================================
+    //  Gauge / RateMeter / Histogram
+    // =====================================================================
+
+    void Gauge::add(double delta)
+    {
+        AtomicAdd(m_value, delta);
+    }
+
+    void RateMeter::mark(uint64_t n)
+    {
+        m_total.fetch_add(n, std::memory_order_relaxed);
+
+        const int64_t second = MonotonicNowNs() / 1000000000;
+        Slot& slot = m_slots[second % kSlotCount];
+
+        // 这个桶上一次属于更早的某一秒：抢到重置权的线程负责清零
+        int64_t owner = slot.second.load(std::memory_order_acquire);
+        if (owner != second && slot.second.compare_exchange_strong(owner, second, std::memory_order_acq_rel)) {
+            slot.count.store(0, std::memory_order_relaxed);
+        }
+        slot.count.fetch_add(n, std::memory_order_relaxed);
+    }
+
+    double RateMeter::ratePerSecond() const
+    {
+        const int64_t now = MonotonicNowNs() / 1000000000;
+        uint64_t events = 0;
+        for (const Slot& slot : m_slots)
+        {
+            // 只统计窗口内已经结束的整秒，当前这一秒还在累加，不计入
+            const int64_t second = slot.second.load(std::memory_order_acquire);
+            if (second >= now - kWindowSeconds && second < now) {
+                events += slot.count.load(std::memory_order_relaxed);
+            }
+        }
+        return static_cast<double>(events) / kWindowSeconds;
+    }
+
+    Histogram::Histogram(const std::vector<double>& upperBounds)
+        : m_bounds(upperBounds)
+        , m_buckets(new std::atomic<uint64_t>[upperBounds.size() + 1])
+    {
+        for (size_t i = 0; i <= m_bounds.size(); ++i) {
+            m_buckets[i].store(0, std::memory_order_relaxed);
+        }
+    }
+
+    void Histogram::observe(double value)
+    {
+        // 桶数量很少 (十几个)，线性查找比二分查找更快
+        size_t i = 0;
+        while (i < m_bounds.size() && value > m_bounds[i]) ++i;
+        m_buckets[i].fetch_add(1, std::memory_order_relaxed);
+        m_count.fetch_add(1, std::memory_order_relaxed);
+        AtomicAdd(m_sum, value);
+    }
+
+    std::vector<double> Histogram::DefaultLatencyBounds()
+    {
+        return { 0.0005, 0.001, 0.0025, 0.005, 0.01, 0.025, 0.05, 0.1, 0.25, 0.5, 1.0 };
+    }
+
+    // =====================================================================
+    //  MetricsRegistry
+    // =====================================================================
+
+    MetricsRegistry& MetricsRegistry::Global()
+    {
+        // C++11 保证函数内静态变量的初始化是线程安全的
+        static MetricsRegistry registry;
+        return registry;
+    }
+
+    MetricsRegistry::Family& MetricsRegistry::family(const std::string& name, const std::string& help, Type type)
+    {
+        auto it = m_families.find(name);
+        if (it == m_families.end())
+        {
+            Family& created = m_families[name];
+            created.type = type;
+            created.help = help;
+            return created;
+        }
+        if (it->second.type != type) {
+            // 同一个名称注册成两种类型，输出会违反 Prometheus 格式，属于编程错误
+            throw std::logic_error("Metric '" + name + "' registered with conflicting types");
+        }
+        return it->second;
+    }
+
+    Counter& MetricsRegistry::counter(const std::string& name, const std::string& help, const std::string& labels)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        std::unique_ptr<Counter>& metric = family(name, help, Type::Counter).counters[labels];
+        if (!metric) metric.reset(new Counter());
+        return *metric;
+    }
+
+    Gauge& MetricsRegistry::gauge(const std::string& name, const std::string& help, const std::string& labels)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        std::unique_ptr<Gauge>& metric = family(name, help, Type::Gauge).gauges[labels];
+        if (!metric) metric.reset(new Gauge());
+        return *metric;
+    }
+
+    RateMeter& MetricsRegistry::meter(const std::string& name, const std::string& help, const std::string& labels)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        std::unique_ptr<RateMeter>& metric = family(name, help, Type::Meter).meters[labels];
+        if (!metric) metric.reset(new RateMeter());
+        return *metric;
+    }
+
+    Histogram& MetricsRegistry::histogram(const std::string& name, const std::string& help, const std::string& labels,
+                                          const std::vector<double>& upperBounds)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        std::unique_ptr<Histogram>& metric = family(name, help, Type::Histogram).histograms[labels];
+        if (!metric) metric.reset(new Histogram(upperBounds));
+        return *metric;
+    }
+
+    void MetricsRegistry::setCallbackGauge(const std::string& name, const std::string& help, const std::string& labels,
+                                           std::function<double()> callback)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        family(name, help, Type::Gauge).callbacks[labels] = std::move(callback);
+    }
+
+    void MetricsRegistry::removeCallbackGauge(const std::string& name, const std::string& labels)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_families.find(name);
+        if (it != m_families.end()) {
+            it->second.callbacks.erase(labels);
+        }
+    }
+
+    std::string MetricsRegistry::renderPrometheus() const
+    {
+        std::ostringstream out;
+        out.precision(10);
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (const auto& entry : m_families)
+        {
+            const std::string& name = entry.first;
+            const Family& f = entry.second;
+
+            switch (f.type)
+            {
+            case Type::Counter:
+                WriteHeader(out, name, f.help, "counter");
+                for (const auto& m : f.counters) {
+                    out << name << LabelBlock(m.first) << ' ' << m.second->value() << '\n';
+                }
+                break;
+
+            case Type::Gauge:
+                WriteHeader(out, name, f.help, "gauge");
+                for (const auto& m : f.gauges) {
+                    out << name << LabelBlock(m.first) << ' ' << m.second->value() << '\n';
+                }
+                for (const auto& m : f.callbacks) {
+                    out << name << LabelBlock(m.first) << ' ' << m.second() << '\n';
+                }
+                break;
+
+            case Type::Meter:
+                // 一个速率计输出为两个指标族：累计总数 + 最近窗口内的平均速率
+                WriteHeader(out, name + "_total", f.help + " (total)", "counter");
+                for (const auto& m : f.meters) {
+                    out << name << "_total" << LabelBlock(m.first) << ' ' << m.second->total() << '\n';
+                }
+                WriteHeader(out, name + "_per_second", f.help + " (per second, averaged over the last "
+                            + std::to_string(RateMeter::kWindowSeconds) + " s)", "gauge");
+                for (const auto& m : f.meters) {
+                    out << name << "_per_second" << LabelBlock(m.first) << ' ' << m.second->ratePerSecond() << '\n';
+                }
+                break;
+
+            case Type::Histogram:
+                WriteHeader(out, name, f.help, "histogram");
+                for (const auto& m : f.histograms)
+                {
+                    // Prometheus 的桶是累加的：le="x" 表示所有不大于 x 的样本数
+                    const Histogram& h = *m.second;
+                    uint64_t cumulative = 0;
+                    for (size_t i = 0; i < h.upperBounds().size(); ++i)
+                    {
+                        cumulative += h.bucketCount(i);
+                        std::ostringstream le;
+                        le.precision(10);
+                        le << "le=\"" << h.upperBounds()[i] << '"';
+                        out << name << "_bucket" << LabelBlock(m.first, le.str()) << ' ' << cumulative << '\n';
+                    }
+                    cumulative += h.bucketCount(h.upperBounds().size());
+                    out << name << "_bucket" << LabelBlock(m.first, "le=\"+Inf\"") << ' ' << cumulative << '\n';
+                    out << name << "_sum" << LabelBlock(m.first) << ' ' << h.sum() << '\n';
+                    out << name << "_count" << LabelBlock(m.first) << ' ' << cumulative << '\n';
+                }
+                break;
+            }
+        }
+        return out.str();
+    }
+
+} // namespace InspectorLib
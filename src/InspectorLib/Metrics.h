@@ -0,0 +1,174 @@
+﻿// Metrics.h (运行时指标：计数器、仪表、速率和直方图)
+
+#ifndef INSPECTOR_METRICS_H
+#define INSPECTOR_METRICS_H
+
+#include "Inspector.h" // INSPECTOR_API、MonotonicNowNs()
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace InspectorLib
+{
+    /**
+     * @brief 单调递增的计数器 (例如：检测过的零件总数)。
+     * @details 所有操作都是无锁的原子操作，可以从任意线程调用。
+     */
+    class INSPECTOR_API Counter
+    {
+    public:
+        void inc(uint64_t n = 1) { m_value.fetch_add(n, std::memory_order_relaxed); }
+        uint64_t value() const { return m_value.load(std::memory_order_relaxed); }
+
+    private:
+        std::atomic<uint64_t> m_value{ 0 };
+    };
+
+    /**
+     * @brief 可增可减的瞬时值 (例如：队列深度)。
+     */
+    class INSPECTOR_API Gauge
+    {
+    public:
+        void set(double value) { m_value.store(value, std::memory_order_relaxed); }
+        void add(double delta);
+        double value() const { return m_value.load(std::memory_order_relaxed); }
+
+    private:
+        std::atomic<double> m_value{ 0.0 };
+    };
+
+    /**
+     * @brief 事件速率计：既累计总数，也给出最近几秒的平均速率 (例如：采集帧率)。
+     *
+     * @details 内部按秒分桶，mark() 只对当前秒的桶做原子加法。
+     * ratePerSecond() 返回最近 kWindowSeconds 个完整秒的平均值，因此速率会有约1秒的滞后。
+     * 桶在跨秒时被重置，与重置同时发生的少量 mark() 可能丢失，速率只是近似值；总数是精确的。
+     */
+    class INSPECTOR_API RateMeter
+    {
+    public:
+        static const int kWindowSeconds = 5;
+
+        void mark(uint64_t n = 1);
+        uint64_t total() const { return m_total.load(std::memory_order_relaxed); }
+        double ratePerSecond() const;
+
+    private:
+        static const int kSlotCount = kWindowSeconds + 2; // 当前秒、窗口内的秒，再留一个正在被重置的桶
+
+        struct Slot
+        {
+            std::atomic<int64_t> second{ -1 };
+            std::atomic<uint64_t> count{ 0 };
+        };
+
+        std::atomic<uint64_t> m_total{ 0 };
+        Slot m_slots[kSlotCount];
+    };
+
+    /**
+     * @brief 固定分桶的直方图，用于耗时分布 (单位：秒，与 Prometheus 的约定一致)。
+     * @details 桶的上界在构造时确定，observe() 是无锁的；最后还有一个隐含的 +Inf 桶。
+     */
+    class INSPECTOR_API Histogram
+    {
+    public:
+        explicit Histogram(const std::vector<double>& upperBounds);
+
+        void observe(double value);
+
+        const std::vector<double>& upperBounds() const { return m_bounds; }
+        // 第 i 个桶 (不累加) 的计数，i == upperBounds().size() 时为 +Inf 桶
+        uint64_t bucketCount(size_t i) const { return m_buckets[i].load(std::memory_order_relaxed); }
+        uint64_t count() const { return m_count.load(std::memory_order_relaxed); }
+        double sum() const { return m_sum.load(std::memory_order_relaxed); }
+
+        // 默认的耗时分桶：0.5ms ~ 1s，覆盖单帧检测从正常到严重超时的范围
+        static std::vector<double> DefaultLatencyBounds();
+
+    private:
+        std::vector<double> m_bounds;
+        std::unique_ptr<std::atomic<uint64_t>[]> m_buckets;
+        std::atomic<uint64_t> m_count{ 0 };
+        std::atomic<double> m_sum{ 0.0 };
+    };
+
+    /**
+     * @class MetricsRegistry
+     * @brief 全局指标注册表，负责按 Prometheus 文本格式输出所有指标。
+     *
+     * @details 同名不同标签的指标属于同一个“指标族”，输出时共享 HELP/TYPE 行。
+     * labels 参数是已经拼好的标签串，例如 `stage="Threshold"`，空串表示没有标签。
+     *
+     * counter()/gauge()/meter()/histogram() 按 (名称, 标签) 查找，不存在时创建；
+     * 返回的引用在程序整个生命周期内有效，热路径代码应当把它缓存起来 (例如存为 static 引用)，
+     * 避免每次都加锁查表。
+     */
+    class INSPECTOR_API MetricsRegistry
+    {
+    public:
+        /**
+         * @brief 进程内唯一的注册表。InspectorLib 自身的指标和调用方 (GUI、命令行工具) 的指标都注册在这里。
+         */
+        static MetricsRegistry& Global();
+
+        Counter& counter(const std::string& name, const std::string& help, const std::string& labels = std::string());
+        Gauge& gauge(const std::string& name, const std::string& help, const std::string& labels = std::string());
+
+        /**
+         * @brief 速率计，输出为两个指标：<name>_total (计数器) 和 <name>_per_second (仪表)。
+         */
+        RateMeter& meter(const std::string& name, const std::string& help, const std::string& labels = std::string());
+
+        Histogram& histogram(const std::string& name, const std::string& help, const std::string& labels = std::string(),
+                             const std::vector<double>& upperBounds = Histogram::DefaultLatencyBounds());
+
+        /**
+         * @brief 注册一个在输出时才取值的仪表 (例如：缓冲池中正在使用的缓冲区个数)。
+         * @details 回调在 renderPrometheus() 的调用线程中执行，必须是线程安全的。
+         * 回调引用的对象被销毁之前，必须调用 removeCallbackGauge() 注销。
+         */
+        void setCallbackGauge(const std::string& name, const std::string& help, const std::string& labels,
+                              std::function<double()> callback);
+        void removeCallbackGauge(const std::string& name, const std::string& labels);
+
+        /**
+         * @brief 按 Prometheus 文本格式 (version 0.0.4) 输出全部指标。
+         */
+        std::string renderPrometheus() const;
+
+    private:
+        MetricsRegistry() = default;
+        MetricsRegistry(const MetricsRegistry&) = delete;
+        MetricsRegistry& operator=(const MetricsRegistry&) = delete;
+
+        enum class Type { Counter, Gauge, Meter, Histogram };
+
+        // 一个指标族：同名、同类型，不同标签的若干个指标
+        struct Family
+        {
+            Type type = Type::Counter;
+            std::string help;
+            std::map<std::string, std::unique_ptr<Counter>> counters;
+            std::map<std::string, std::unique_ptr<Gauge>> gauges;
+            std::map<std::string, std::function<double()>> callbacks;
+            std::map<std::string, std::unique_ptr<RateMeter>> meters;
+            std::map<std::string, std::unique_ptr<Histogram>> histograms;
+        };
+
+        Family& family(const std::string& name, const std::string& help, Type type);
+
+        mutable std::mutex m_mutex;
+        std::map<std::string, Family> m_families; // 按名称排序，输出顺序稳定
+    };
+
+} // namespace InspectorLib
+
+#endif // INSPECTOR_METRICS_H
@@ -0,0 +1,655 @@
+﻿// NominalModel.cpp
+
+#include "NominalModel.h"
+#include "DxfReader.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cfloat>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+
+namespace InspectorLib
+{
+    namespace
+    {
+        const int kSegmentColumns = 10;  // 保存时每段一行: type, start(2), end(2), center(2), radius, startAngle, sweepAngle
+        const int kFitIterations = 5;    // 最佳拟合的 Gauss-Newton 迭代次数
+        const int kFitStride = 4;        // 选方向和最佳拟合时每隔几个轮廓点取一个
+        const int kMinSamples = 16;      // 抽样点太少时不做最佳拟合
+        const char kCacheMagic[4] = { 'P', 'I', 'N', 'M' };
+        const uint32_t kCacheVersion = 1; // 缓存的布局或编译算法改变时加1，旧缓存自动失效
+
+        // 把一条闭合轮廓折线化 (CAD 坐标，flipY 时翻转 y)。圆弧按弦高误差不超过 maxError 分段；
+        // 每段的起点与上一段的终点重合时只保留一个
+        void Polygonize(const NominalLoop& loop, float maxError, bool flipY, std::vector<cv::Point2f>& polygon)
+        {
+            polygon.clear();
+            auto append = [&](const cv::Point2f& p) {
+                const cv::Point2f q(p.x, flipY ? -p.y : p.y);
+                if (polygon.empty() || cv::norm(polygon.back() - q) > 1e-6) polygon.push_back(q);
+            };
+            for (const NominalSegment& segment : loop)
+            {
+                if (segment.type == NominalSegment::Line) {
+                    append(segment.start);
+                    append(segment.end);
+                    continue;
+                }
+                // 弦高 r (1 - cos(step / 2)) <= maxError
+                const double r = std::max(segment.radius, 1e-6f);
+                const double maxStep = 2.0 * std::acos(std::max(-1.0, 1.0 - maxError / r));
+                const double sweep = segment.sweepAngle * CV_PI / 180.0;
+                const int n = std::max(1, static_cast<int>(std::ceil(std::fabs(sweep) / std::max(maxStep, 1e-3))));
+                const double a0 = segment.startAngle * CV_PI / 180.0;
+                for (int k = 0; k <= n; ++k)
+                {
+                    const double a = a0 + sweep * k / n;
+                    append(cv::Point2f(static_cast<float>(segment.center.x + r * std::cos(a)),
+                                       static_cast<float>(segment.center.y + r * std::sin(a))));
+                }
+            }
+            // 闭合：最后一点与第一点重合时去掉
+            if (polygon.size() > 1 && cv::norm(polygon.back() - polygon.front()) <= 1e-6) polygon.pop_back();
+        }
+
+        float SegmentDistance(const cv::Point2f& p, const cv::Point2f& a, const cv::Point2f& b)
+        {
+            const cv::Point2f ab = b - a, ap = p - a;
+            const float len2 = ab.dot(ab);
+            const float t = len2 > 0.0f ? std::min(1.0f, std::max(0.0f, ap.dot(ab) / len2)) : 0.0f;
+            const cv::Point2f d = ap - t * ab;
+            return std::sqrt(d.dot(d));
+        }
+
+        // 由组成轮廓的各段识别特征的类型：同一个圆上的圆弧合起来是整圆为圆孔，
+        // 两段同半径的半圆加直线为槽口 (腰形孔)
+        NominalFeature::Kind ClassifyLoop(const NominalLoop& loop)
+        {
+            int arcs = 0, halfArcs = 0;
+            bool sameCircle = true;
+            float sweep = 0.0f;
+            const NominalSegment* firstArc = nullptr;
+            for (const NominalSegment& s : loop)
+            {
+                if (s.type != NominalSegment::Arc) continue;
+                ++arcs;
+                sweep += std::fabs(s.sweepAngle);
+                if (std::fabs(std::fabs(s.sweepAngle) - 180.0f) < 5.0f) ++halfArcs;
+                if (!firstArc) { firstArc = &s; continue; }
+                const float tolerance = 1e-3f * std::max(firstArc->radius, 1.0f);
+                if (cv::norm(s.center - firstArc->center) > tolerance || std::fabs(s.radius - firstArc->radius) > tolerance) sameCircle = false;
+                if (halfArcs == 2 && std::fabs(s.radius - firstArc->radius) > 0.01f * firstArc->radius) halfArcs = 0;
+            }
+            if (arcs == static_cast<int>(loop.size()) && sameCircle && sweep >= 359.0f) return NominalFeature::Hole;
+            if (arcs == 2 && halfArcs == 2) return NominalFeature::Slot;
+            return NominalFeature::Other;
+        }
+
+        // 64位 FNV-1a，缓存的键：源文件的内容 (和图层名)
+        uint64_t Fnv1a(const std::string& bytes, uint64_t hash = 14695981039346656037ull)
+        {
+            for (unsigned char c : bytes) { hash ^= c; hash *= 1099511628211ull; }
+            return hash;
+        }
+
+        // 二进制缓存的读写 (本机字节序，缓存只在生成它的工位电脑上使用)
+        template <typename T> void Write(std::ostream& out, const T& value)
+        {
+            out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+        }
+        template <typename T> bool Read(std::istream& in, T& value)
+        {
+            return static_cast<bool>(in.read(reinterpret_cast<char*>(&value), sizeof(T)));
+        }
+        void WriteMat(std::ostream& out, const cv::Mat& m)
+        {
+            Write<int32_t>(out, m.rows);
+            Write<int32_t>(out, m.cols);
+            Write<int32_t>(out, m.type());
+            for (int i = 0; i < m.rows; ++i) out.write(m.ptr<char>(i), m.cols * m.elemSize());
+        }
+        bool ReadMat(std::istream& in, int type, cv::Mat& m)
+        {
+            int32_t rows = 0, cols = 0, storedType = -1;
+            if (!Read(in, rows) || !Read(in, cols) || !Read(in, storedType) || storedType != type) return false;
+            if (rows <= 0 || cols <= 0 || rows > NominalModel::kMaxGridSize || cols > NominalModel::kMaxGridSize) return false;
+            m.create(rows, cols, type);
+            for (int i = 0; i < rows; ++i) if (!in.read(m.ptr<char>(i), m.cols * m.elemSize())) return false;
+            return true;
+        }
+
+        bool IsDxf(const std::string& path)
+        {
+            if (path.size() < 4) return false;
+            std::string extension = path.substr(path.size() - 4);
+            for (char& c : extension) c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+            return extension == ".dxf";
+        }
+
+        // 图像坐标 -> 模型坐标的仿射变换 (2x3) 作用于一点
+        inline cv::Point2f Apply(const cv::Matx23f& m, const cv::Point2f& p)
+        {
+            return cv::Point2f(m(0, 0) * p.x + m(0, 1) * p.y + m(0, 2), m(1, 0) * p.x + m(1, 1) * p.y + m(1, 2));
+        }
+    }
+
+    bool NominalModel::compile(const std::vector<NominalLoop>& loops, const NominalCompileOptions& options)
+    {
+        // 1. 粗略折线化，找出外形 (面积最大的闭合轮廓) 和模型坐标系
+        std::vector<std::vector<cv::Point2f>> polygons(loops.size());
+        int outline = -1;
+        double maxArea = 0.0;
+        for (size_t i = 0; i < loops.size(); ++i)
+        {
+            float extent = 0.0f;
+            for (const NominalSegment& s : loops[i]) extent = std::max(extent, s.radius);
+            Polygonize(loops[i], std::max(extent, 1.0f) * 1e-3f, options.flipY, polygons[i]);
+            if (polygons[i].size() < 3) continue;
+            const double area = std::fabs(cv::contourArea(polygons[i]));
+            if (area > maxArea) { maxArea = area; outline = static_cast<int>(i); }
+        }
+        if (outline < 0) return false;
+
+        // 原点为外形最小外接矩形的中心，x 轴沿长边 (与 boundingBox 的长边方向对应)
+        cv::RotatedRect frame = cv::minAreaRect(polygons[outline]);
+        if (frame.size.width < frame.size.height) {
+            std::swap(frame.size.width, frame.size.height);
+            frame.angle += 90.0f;
+        }
+        const float length = frame.size.width, width = frame.size.height;
+        const float cellSize = options.cellSize > 0.0f ? options.cellSize : length / kAutoGridSize;
+        const float margin = std::max(8.0f * cellSize, 0.05f * length); // 外形之外保留的范围 (毛刺也在网格内)
+        const int cols = static_cast<int>(std::ceil((length + 2.0f * margin) / cellSize)) + 1;
+        const int rows = static_cast<int>(std::ceil((width + 2.0f * margin) / cellSize)) + 1;
+        if (cellSize <= 0.0f || std::max(cols, rows) > kMaxGridSize) return false;
+
+        // 2. 按网格间距重新折线化，换算到模型坐标系
+        const double rad = frame.angle * CV_PI / 180.0;
+        const float c = static_cast<float>(std::cos(rad)), s = static_cast<float>(std::sin(rad));
+        for (size_t i = 0; i < loops.size(); ++i)
+        {
+            Polygonize(loops[i], cellSize / 20.0f, options.flipY, polygons[i]);
+            for (cv::Point2f& p : polygons[i]) {
+                const cv::Point2f d = p - frame.center;
+                p = cv::Point2f(c * d.x + s * d.y, -s * d.x + c * d.y);
+            }
+        }
+        const cv::Point2f origin(-0.5f * length - margin, -0.5f * width - margin);
+        const float band = kExactBand * cellSize;
+
+        // 特征：外形是第0个，其余轮廓按顺序 (折线化后不足3个点的轮廓没有面积，归入外形)
+        std::vector<NominalFeature> features;
+        std::vector<int> featureOf(loops.size(), 0);
+        auto addFeature = [&](int i) {
+            if (polygons[i].size() < 3) return;
+            NominalFeature feature;
+            feature.kind = i == outline ? NominalFeature::Outline : ClassifyLoop(loops[i]);
+            feature.loop = i;
+            const cv::RotatedRect rect = cv::minAreaRect(polygons[i]);
+            feature.center = rect.center;
+            feature.length = std::max(rect.size.width, rect.size.height);
+            feature.width = std::min(rect.size.width, rect.size.height);
+            cv::Point2f low(FLT_MAX, FLT_MAX), high(-FLT_MAX, -FLT_MAX);
+            for (const cv::Point2f& p : polygons[i]) {
+                low = cv::Point2f(std::min(low.x, p.x), std::min(low.y, p.y));
+                high = cv::Point2f(std::max(high.x, p.x), std::max(high.y, p.y));
+            }
+            feature.roi = cv::Rect2f(low.x - band, low.y - band, high.x - low.x + 2.0f * band, high.y - low.y + 2.0f * band);
+            featureOf[i] = static_cast<int>(features.size());
+            features.push_back(feature);
+        };
+        addFeature(outline);
+        for (int i = 0; i < static_cast<int>(loops.size()); ++i) if (i != outline) addFeature(i);
+
+        // 3. 轮廓两侧 kExactBand 格以内：逐段精确计算无符号距离，同时记录最近的轮廓所属的特征
+        cv::Mat distance(rows, cols, CV_32F, cv::Scalar(FLT_MAX));
+        cv::Mat featureMap(rows, cols, CV_16U, cv::Scalar(0));
+        for (size_t p = 0; p < polygons.size(); ++p)
+        {
+            const std::vector<cv::Point2f>& polygon = polygons[p];
+            const ushort label = static_cast<ushort>(featureOf[p]);
+            const size_t n = polygon.size();
+            for (size_t k = 0; k < n && n > 1; ++k)
+            {
+                const cv::Point2f& a = polygon[k];
+                const cv::Point2f& b = polygon[(k + 1) % n];
+                const int j0 = std::max(0, static_cast<int>(std::floor((std::min(a.x, b.x) - band - origin.x) / cellSize)));
+                const int j1 = std::min(cols - 1, static_cast<int>(std::ceil((std::max(a.x, b.x) + band - origin.x) / cellSize)));
+                const int i0 = std::max(0, static_cast<int>(std::floor((std::min(a.y, b.y) - band - origin.y) / cellSize)));
+                const int i1 = std::min(rows - 1, static_cast<int>(std::ceil((std::max(a.y, b.y) + band - origin.y) / cellSize)));
+                for (int i = i0; i <= i1; ++i)
+                {
+                    float* row = distance.ptr<float>(i);
+                    ushort* labels = featureMap.ptr<ushort>(i);
+                    for (int j = j0; j <= j1; ++j) {
+                        const cv::Point2f node(origin.x + j * cellSize, origin.y + i * cellSize);
+                        const float d = SegmentDistance(node, a, b);
+                        if (d < row[j]) { row[j] = d; labels[j] = label; }
+                    }
+                }
+            }
+        }
+
+        // 4. 更远处：到带内节点的距离变换 (近似，只用于报告大的偏差)
+        cv::Mat far(rows, cols, CV_8U);
+        for (int i = 0; i < rows; ++i)
+        {
+            const float* d = distance.ptr<float>(i);
+            uchar* f = far.ptr<uchar>(i);
+            for (int j = 0; j < cols; ++j) f[j] = d[j] <= band ? 0 : 255;
+        }
+        cv::Mat farDistance;
+        cv::distanceTransform(far, farDistance, cv::DIST_L2, cv::DIST_MASK_PRECISE);
+
+        // 带外的节点属于包含它的最小的特征 ROI：按面积从大到小画，小的覆盖大的 (都不包含时属于外形)
+        std::vector<int> order;
+        for (int f = 1; f < static_cast<int>(features.size()); ++f) order.push_back(f);
+        std::sort(order.begin(), order.end(), [&](int x, int y) { return features[x].roi.area() > features[y].roi.area(); });
+        for (int f : order)
+        {
+            const cv::Rect2f& roi = features[f].roi;
+            const int j0 = std::max(0, static_cast<int>(std::ceil((roi.x - origin.x) / cellSize)));
+            const int j1 = std::min(cols - 1, static_cast<int>(std::floor((roi.x + roi.width - origin.x) / cellSize)));
+            const int i0 = std::max(0, static_cast<int>(std::ceil((roi.y - origin.y) / cellSize)));
+            const int i1 = std::min(rows - 1, static_cast<int>(std::floor((roi.y + roi.height - origin.y) / cellSize)));
+            for (int i = i0; i <= i1; ++i)
+            {
+                const uchar* f8 = far.ptr<uchar>(i);
+                ushort* labels = featureMap.ptr<ushort>(i);
+                for (int j = j0; j <= j1; ++j) if (f8[j]) labels[j] = static_cast<ushort>(f);
+            }
+        }
+
+        // 5. 符号：逐行求所有多边形边与这一行的交点，偶奇规则 (外形之内、内孔之外为实体)
+        std::vector<float> crossings;
+        for (int i = 0; i < rows; ++i)
+        {
+            const float y = origin.y + i * cellSize;
+            crossings.clear();
+            for (const std::vector<cv::Point2f>& polygon : polygons)
+            {
+                const size_t n = polygon.size();
+                for (size_t k = 0; k < n && n > 2; ++k)
+                {
+                    const cv::Point2f& a = polygon[k];
+                    const cv::Point2f& b = polygon[(k + 1) % n];
+                    if ((a.y <= y) != (b.y <= y)) crossings.push_back(a.x + (y - a.y) * (b.x - a.x) / (b.y - a.y));
+                }
+            }
+            std::sort(crossings.begin(), crossings.end());
+
+            float* d = distance.ptr<float>(i);
+            const float* f = farDistance.ptr<float>(i);
+            size_t next = 0;
+            for (int j = 0; j < cols; ++j)
+            {
+                const float x = origin.x + j * cellSize;
+                while (next < crossings.size() && crossings[next] <= x) ++next;
+                if (d[j] == FLT_MAX) d[j] = (kExactBand - 1 + f[j]) * cellSize;
+                if (next % 2 == 1) d[j] = -d[j]; // 左侧交点数为奇数：在实体内
+            }
+        }
+
+        m_loops = loops;
+        m_options = options;
+        m_size = cv::Size2f(length, width);
+        m_distance = distance;
+        m_origin = origin;
+        m_cellSize = cellSize;
+        m_features = features;
+        m_featureMap = featureMap;
+        return true;
+    }
+
+    bool NominalModel::save(const std::string& path) const
+    {
+        if (!isValid()) return false;
+        cv::FileStorage fs(path, cv::FileStorage::WRITE);
+        if (!fs.isOpened()) return false;
+        fs << "cellSize" << m_options.cellSize;
+        fs << "flipY" << static_cast<int>(m_options.flipY);
+        fs << "loops" << static_cast<int>(m_loops.size());
+        for (size_t i = 0; i < m_loops.size(); ++i)
+        {
+            cv::Mat segments(static_cast<int>(m_loops[i].size()), kSegmentColumns, CV_32F);
+            for (int k = 0; k < segments.rows; ++k)
+            {
+                const NominalSegment& s = m_loops[i][k];
+                float* row = segments.ptr<float>(k);
+                row[0] = static_cast<float>(s.type);
+                row[1] = s.start.x;  row[2] = s.start.y;
+                row[3] = s.end.x;    row[4] = s.end.y;
+                row[5] = s.center.x; row[6] = s.center.y;
+                row[7] = s.radius;   row[8] = s.startAngle; row[9] = s.sweepAngle;
+            }
+            fs << "loop" + std::to_string(i) << segments;
+        }
+        cv::Mat tolerances(1, static_cast<int>(m_features.size()), CV_32F);
+        for (int f = 0; f < tolerances.cols; ++f) tolerances.at<float>(0, f) = m_features[f].tolerance;
+        fs << "tolerances" << tolerances;
+        return true;
+    }
+
+    bool NominalModel::load(const std::string& path)
+    {
+        if (IsDxf(path)) return importDxf(path);
+
+        cv::FileStorage fs(path, cv::FileStorage::READ);
+        if (!fs.isOpened()) return false;
+
+        NominalCompileOptions options;
+        int flipY = 1, count = 0;
+        fs["cellSize"] >> options.cellSize;
+        fs["flipY"] >> flipY;
+        fs["loops"] >> count;
+        options.flipY = flipY != 0;
+        if (count <= 0) return false;
+
+        std::vector<NominalLoop> loops(count);
+        for (int i = 0; i < count; ++i)
+        {
+            cv::Mat segments;
+            fs["loop" + std::to_string(i)] >> segments;
+            if (segments.empty() || segments.cols != kSegmentColumns || segments.type() != CV_32F) return false;
+            for (int k = 0; k < segments.rows; ++k)
+            {
+                const float* row = segments.ptr<float>(k);
+                NominalSegment s;
+                s.type = row[0] == 0.0f ? NominalSegment::Line : NominalSegment::Arc;
+                s.start = cv::Point2f(row[1], row[2]);
+                s.end = cv::Point2f(row[3], row[4]);
+                s.center = cv::Point2f(row[5], row[6]);
+                s.radius = row[7];
+                s.startAngle = row[8];
+                s.sweepAngle = row[9];
+                loops[i].push_back(s);
+            }
+        }
+        if (!compile(loops, options)) return false;
+
+        // 各特征的公差 (可选；特征数与编译结果不同时忽略)
+        cv::Mat tolerances;
+        fs["tolerances"] >> tolerances;
+        if (tolerances.type() == CV_32F && tolerances.total() == m_features.size())
+            for (size_t f = 0; f < m_features.size(); ++f) m_features[f].tolerance = tolerances.at<float>(static_cast<int>(f));
+        return true;
+    }
+
+    bool NominalModel::importDxf(const std::string& path, const std::string& layer, const NominalCompileOptions& options)
+    {
+        std::vector<NominalLoop> loops;
+        return ReadDxf(path, layer, loops) && compile(loops, options);
+    }
+
+    bool NominalModel::loadCached(const std::string& path, const std::string& cachePath, const std::string& layer)
+    {
+        std::ifstream source(path, std::ios::binary);
+        if (!source.is_open()) return false;
+        const std::string bytes((std::istreambuf_iterator<char>(source)), std::istreambuf_iterator<char>());
+        const uint64_t key = Fnv1a(layer, Fnv1a(bytes));
+
+        if (readCache(cachePath, key)) return true;
+        const bool loaded = IsDxf(path) ? importDxf(path, layer) : load(path);
+        if (loaded) writeCache(cachePath, key);
+        return loaded;
+    }
+
+    // 缓存的布局：magic、版本、键，编译参数和结果，原始轮廓 (保存 YAML 时要用)，最后是两张网格
+    bool NominalModel::writeCache(const std::string& path, uint64_t key) const
+    {
+        if (!isValid()) return false;
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        if (!out.is_open()) return false;
+        out.write(kCacheMagic, sizeof(kCacheMagic));
+        Write(out, kCacheVersion);
+        Write(out, key);
+        Write(out, m_options.cellSize);
+        Write<uint8_t>(out, m_options.flipY ? 1 : 0);
+        Write(out, m_size.width);
+        Write(out, m_size.height);
+        Write(out, m_origin.x);
+        Write(out, m_origin.y);
+        Write(out, m_cellSize);
+
+        Write<uint32_t>(out, static_cast<uint32_t>(m_loops.size()));
+        for (const NominalLoop& loop : m_loops)
+        {
+            Write<uint32_t>(out, static_cast<uint32_t>(loop.size()));
+            for (const NominalSegment& s : loop) Write(out, s);
+        }
+        Write<uint32_t>(out, static_cast<uint32_t>(m_features.size()));
+        for (const NominalFeature& f : m_features) Write(out, f);
+
+        WriteMat(out, m_distance);
+        WriteMat(out, m_featureMap);
+        out.close();
+        if (out.fail()) { std::remove(path.c_str()); return false; }
+        return true;
+    }
+
+    bool NominalModel::readCache(const std::string& path, uint64_t key)
+    {
+        std::ifstream in(path, std::ios::binary);
+        if (!in.is_open()) return false;
+        char magic[sizeof(kCacheMagic)] = {};
+        uint32_t version = 0;
+        uint64_t storedKey = 0;
+        if (!in.read(magic, sizeof(magic)) || !std::equal(magic, magic + sizeof(magic), kCacheMagic)) return false;
+        if (!Read(in, version) || version != kCacheVersion || !Read(in, storedKey) || storedKey != key) return false;
+
+        NominalCompileOptions options;
+        uint8_t flipY = 1;
+        cv::Size2f size;
+        cv::Point2f origin;
+        float cellSize = 0.0f;
+        if (!Read(in, options.cellSize) || !Read(in, flipY) || !Read(in, size.width) || !Read(in, size.height)
+            || !Read(in, origin.x) || !Read(in, origin.y) || !Read(in, cellSize) || !(cellSize > 0.0f)) return false;
+        options.flipY = flipY != 0;
+
+        uint32_t loopCount = 0;
+        if (!Read(in, loopCount) || loopCount == 0 || loopCount > 65535) return false;
+        std::vector<NominalLoop> loops(loopCount);
+        for (NominalLoop& loop : loops)
+        {
+            uint32_t segmentCount = 0;
+            if (!Read(in, segmentCount) || segmentCount > 1000000) return false;
+            loop.resize(segmentCount);
+            for (NominalSegment& s : loop) if (!Read(in, s)) return false;
+        }
+        uint32_t featureCount = 0;
+        if (!Read(in, featureCount) || featureCount == 0 || featureCount > loopCount) return false;
+        std::vector<NominalFeature> features(featureCount);
+        for (NominalFeature& f : features) if (!Read(in, f)) return false;
+
+        cv::Mat distance, featureMap;
+        if (!ReadMat(in, CV_32F, distance) || !ReadMat(in, CV_16U, featureMap) || featureMap.size() != distance.size()) return false;
+        for (int i = 0; i < featureMap.rows; ++i)
+        {
+            const ushort* labels = featureMap.ptr<ushort>(i);
+            for (int j = 0; j < featureMap.cols; ++j) if (labels[j] >= featureCount) return false;
+        }
+
+        m_loops = loops;
+        m_options = options;
+        m_size = size;
+        m_distance = distance;
+        m_origin = origin;
+        m_cellSize = cellSize;
+        m_features = features;
+        m_featureMap = featureMap;
+        return true;
+    }
+
+    void NominalModel::setTolerance(NominalFeature::Kind kind, float tolerance)
+    {
+        for (NominalFeature& f : m_features) if (f.kind == kind) f.tolerance = std::max(0.0f, tolerance);
+    }
+
+    int NominalModel::featureAt(const cv::Point2f& p) const
+    {
+        const int j = std::min(std::max(cvRound((p.x - m_origin.x) / m_cellSize), 0), m_featureMap.cols - 1);
+        const int i = std::min(std::max(cvRound((p.y - m_origin.y) / m_cellSize), 0), m_featureMap.rows - 1);
+        return m_featureMap.at<ushort>(i, j);
+    }
+
+    float NominalModel::distanceAt(const cv::Point2f& p) const
+    {
+        // 网格之外钳位到边界 (边界上的值已经超出公差很多，只是不再增长)
+        const float x = std::min(std::max((p.x - m_origin.x) / m_cellSize, 0.0f), static_cast<float>(m_distance.cols - 1));
+        const float y = std::min(std::max((p.y - m_origin.y) / m_cellSize, 0.0f), static_cast<float>(m_distance.rows - 1));
+        const int j = std::min(static_cast<int>(x), m_distance.cols - 2);
+        const int i = std::min(static_cast<int>(y), m_distance.rows - 2);
+        const float fx = x - j, fy = y - i;
+        const float* r0 = m_distance.ptr<float>(i) + j;
+        const float* r1 = m_distance.ptr<float>(i + 1) + j;
+        return (r0[0] * (1.0f - fx) + r0[1] * fx) * (1.0f - fy) + (r1[0] * (1.0f - fx) + r1[1] * fx) * fy;
+    }
+
+    bool NominalModel::compare(const std::vector<std::vector<cv::Point>>& contours, const std::vector<int>& indices,
+        const cv::RotatedRect& box, float pixelSize, float tolerance, bool bestFit, DeviationResult& deviation) const
+    {
+        deviation = DeviationResult();
+        if (!isValid() || pixelSize <= 0.0f || tolerance < 0.0f) return false;
+
+        // 1. 补全轮廓点：相邻两点之间按不超过1像素的间距插值，每个点记录它代表的轮廓长度 (像素)
+        thread_local std::vector<cv::Point2f> points;
+        thread_local std::vector<float> steps;
+        thread_local std::vector<size_t> starts;
+        points.clear();
+        steps.clear();
+        starts.clear();
+        for (int index : indices)
+        {
+            if (index < 0 || index >= static_cast<int>(contours.size())) continue;
+            const std::vector<cv::Point>& contour = contours[index];
+            const size_t n = contour.size();
+            if (n == 0) continue;
+            starts.push_back(points.size());
+            for (size_t k = 0; k < n; ++k)
+            {
+                const cv::Point2f a(contour[k]), b(contour[(k + 1) % n]);
+                const float len = static_cast<float>(cv::norm(b - a));
+                const int m = std::max(1, static_cast<int>(std::ceil(len)));
+                for (int t = 0; t < m; ++t) {
+                    points.push_back(a + (b - a) * (static_cast<float>(t) / m));
+                    steps.push_back(len / m);
+                }
+            }
+        }
+        if (points.empty()) return false;
+        starts.push_back(points.size());
+
+        // 轮廓点是零件一侧边界像素的中心，比二值化的边缘向实体内偏半个像素
+        const float bias = 0.5f * pixelSize;
+        const float huber = std::max(tolerance, 2.0f * m_cellSize); // 超过它的偏差 (毛刺) 在拟合中降权
+        auto residual = [&](const cv::Point2f& q) { return distanceAt(q) + bias; };
+
+        // 2. 初始位姿：外接矩形的中心和长边方向。图像 -> 模型: q = pixelSize * R(-angle) * (p - center)
+        float angle = box.angle;
+        if (box.size.width < box.size.height) angle += 90.0f;
+        const double rad = angle * CV_PI / 180.0;
+        const float a = static_cast<float>(std::cos(rad)) * pixelSize, b = static_cast<float>(std::sin(rad)) * pixelSize;
+        const cv::Point2f& c = box.center;
+        cv::Matx23f transform(a, b, -(a * c.x + b * c.y), -b, a, -(-b * c.x + a * c.y));
+
+        // 长边方向有正反两种：在抽样点上比较截断的平均偏差
+        const size_t stride = points.size() / kFitStride >= kMinSamples ? kFitStride : 1;
+        auto score = [&](const cv::Matx23f& m) {
+            double sum = 0.0;
+            for (size_t i = 0; i < points.size(); i += stride) sum += std::min(std::fabs(residual(Apply(m, points[i]))), huber);
+            return sum;
+        };
+        const cv::Matx23f flipped = transform * -1.0f;
+        if (score(flipped) < score(transform)) transform = flipped;
+
+        // 3. 最佳拟合：以平移 (tx, ty) 和转角 phi 为参数的 Gauss-Newton，Huber 权重
+        const size_t samples = (points.size() + stride - 1) / stride;
+        for (int iteration = 0; bestFit && samples >= kMinSamples && iteration < kFitIterations; ++iteration)
+        {
+            cv::Matx33d h = cv::Matx33d::zeros();
+            cv::Vec3d g(0.0, 0.0, 0.0);
+            for (size_t i = 0; i < points.size(); i += stride)
+            {
+                const cv::Point2f q = Apply(transform, points[i]);
+                const float r = residual(q);
+                const float gx = (distanceAt(cv::Point2f(q.x + m_cellSize, q.y)) - distanceAt(cv::Point2f(q.x - m_cellSize, q.y))) / (2.0f * m_cellSize);
+                const float gy = (distanceAt(cv::Point2f(q.x, q.y + m_cellSize)) - distanceAt(cv::Point2f(q.x, q.y - m_cellSize))) / (2.0f * m_cellSize);
+                const cv::Vec3d j(gx, gy, gy * q.x - gx * q.y);
+                const double w = std::fabs(r) <= huber ? 1.0 : huber / std::fabs(r);
+                h += w * (j * j.t());
+                g += w * r * j;
+            }
+            cv::Mat solution;
+            if (!cv::solve(cv::Mat(h), cv::Mat(-g), solution, cv::DECOMP_CHOLESKY)) break;
+            const cv::Vec3d delta(solution.ptr<double>());
+
+            // q' = R(phi) q + t
+            const float cp = static_cast<float>(std::cos(delta[2])), sp = static_cast<float>(std::sin(delta[2]));
+            const cv::Matx23f m = transform;
+            for (int col = 0; col < 3; ++col)
+            {
+                transform(0, col) = cp * m(0, col) - sp * m(1, col);
+                transform(1, col) = sp * m(0, col) + cp * m(1, col);
+            }
+            transform(0, 2) += static_cast<float>(delta[0]);
+            transform(1, 2) += static_cast<float>(delta[1]);
+            if (std::hypot(delta[0], delta[1]) < 0.01 * m_cellSize && std::fabs(delta[2]) < 1e-5) break;
+        }
+
+        // 4. 所有点：最大偏差、均方根，以及沿轮廓连续超出公差的各段
+        double sumSquares = 0.0;
+        float worst = 0.0f;
+        for (size_t k = 0; k + 1 < starts.size(); ++k)
+        {
+            const size_t begin = starts[k], end = starts[k + 1];
+            const size_t firstDefect = deviation.defects.size();
+            bool openAtBegin = false; // 第一段缺陷从轮廓的起点开始
+            int sign = 0;
+            for (size_t i = begin; i < end; ++i)
+            {
+                const cv::Point2f q = Apply(transform, points[i]);
+                const float r = residual(q);
+                const int feature = featureAt(q);
+                const float limit = m_features[feature].tolerance > 0.0f ? m_features[feature].tolerance : tolerance;
+                sumSquares += static_cast<double>(r) * r;
+                deviation.maxExcess = std::max(deviation.maxExcess, r);
+                deviation.maxMissing = std::max(deviation.maxMissing, -r);
+                if (std::fabs(r) > worst) { worst = std::fabs(r); deviation.worstPoint = points[i]; }
+
+                const int s = r > limit ? 1 : (r < -limit ? -1 : 0);
+                if (s != 0 && s != sign)
+                {
+                    if (i == begin) openAtBegin = true;
+                    DeviationDefect defect;
+                    defect.excess = s > 0;
+                    defect.feature = feature;
+                    deviation.defects.push_back(defect);
+                }
+                sign = s;
+                if (s == 0) continue;
+                DeviationDefect& defect = deviation.defects.back();
+                defect.length += steps[i] * pixelSize;
+                if (std::fabs(r) > defect.depth) { defect.depth = std::fabs(r); defect.position = points[i]; defect.feature = feature; }
+            }
+            // 轮廓是闭合的：最后一段延续到终点、第一段从起点开始且同号时是同一处缺陷
+            const size_t count = deviation.defects.size() - firstDefect;
+            if (count > 1 && openAtBegin && sign != 0 && deviation.defects[firstDefect].excess == (sign > 0))
+            {
+                DeviationDefect& first = deviation.defects[firstDefect];
+                const DeviationDefect& last = deviation.defects.back();
+                first.length += last.length;
+                if (last.depth > first.depth) { first.depth = last.depth; first.position = last.position; first.feature = last.feature; }
+                deviation.defects.pop_back();
+            }
+        }
+        deviation.maxDeviation = worst;
+        deviation.rms = static_cast<float>(std::sqrt(sumSquares / points.size()));
+        deviation.pointCount = static_cast<int>(points.size());
+        deviation.valid = true;
+        return true;
+    }
+
+} // namespace InspectorLib
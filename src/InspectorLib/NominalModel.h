@@ -0,0 +1,166 @@
+﻿// NominalModel.h (名义几何：CAD 的直线/圆弧轮廓编译为有符号距离图，逐帧比较零件轮廓的偏差)
+
+#ifndef INSPECTOR_NOMINALMODEL_H
+#define INSPECTOR_NOMINALMODEL_H
+
+#include "Inspector.h" // INSPECTOR_API、DeviationResult
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace InspectorLib
+{
+    /**
+     * @brief 名义轮廓的一段：直线或圆弧 (CAD 坐标，单位 mm)。
+     */
+    struct NominalSegment
+    {
+        enum Type { Line = 0, Arc };
+
+        Type type = Line;
+        cv::Point2f start, end;  // 直线的两个端点
+        cv::Point2f center;      // 圆弧的圆心和半径
+        float radius = 0.0f;
+        float startAngle = 0.0f; // 圆弧的起始角和扫过的角度 (度，逆时针为正；360 为整圆)
+        float sweepAngle = 0.0f;
+    };
+
+    /**
+     * @brief 一条闭合的名义轮廓 (外形或一个内孔)，各段首尾相接。
+     */
+    typedef std::vector<NominalSegment> NominalLoop;
+
+    /**
+     * @brief 编译参数。
+     */
+    struct NominalCompileOptions
+    {
+        float cellSize = 0.0f; // 距离图的网格间距 (mm)，0 为自动：外形的长边分为 NominalModel::kAutoGridSize 格
+        bool flipY = true;     // CAD 的 y 轴向上、图像的 y 轴向下 (相机从正上方拍摄)，编译时翻转；从下方拍摄时关闭
+    };
+
+    /**
+     * @brief 编译时识别出的一个特征：外形、圆孔、槽口或其他内孔 (每条闭合轮廓一个)。
+     * @details 坐标都在模型坐标系中 (mm)。tolerance 是这个特征自己的公差，为0时使用 NominalOptions::tolerance。
+     */
+    struct NominalFeature
+    {
+        enum Kind { Outline = 0, Hole, Slot, Other };
+
+        Kind kind = Outline;
+        int loop = -1;           // NominalModel::loops() 中的下标
+        cv::Rect2f roi;          // 轮廓的外接矩形，四周加 kExactBand 格
+        cv::Point2f center;      // 最小外接矩形的中心
+        float length = 0.0f;     // 最小外接矩形的长、宽 (圆孔为直径)
+        float width = 0.0f;
+        float tolerance = 0.0f;
+    };
+
+    /**
+     * @brief 名义几何模型：零件外形和内孔的 CAD 轮廓，预先编译为有符号距离图。
+     *
+     * @details 编译 (每个配方一次)：
+     *  1. 圆弧按弦高误差不超过网格间距的 1/20 折线化；面积最大的闭合轮廓是外形，其余是内孔；
+     *  2. 模型坐标系的原点为外形最小外接矩形的中心，x 轴沿它的长边，与 MeasurementResults::boundingBox 的约定相同；
+     *  3. 在覆盖外形 (加上边距) 的均匀网格上计算每个节点到名义轮廓的有符号距离：名义实体之外为正，之内为负。
+     *     轮廓两侧 kExactBand 格以内逐段精确计算 (符号由射线交点数决定)，更远处用距离变换近似；
+     *  4. 每条轮廓识别为一个特征 (外形、圆孔、槽口或其他)，同一网格上再记录每个节点属于哪个特征：
+     *     带内取最近的轮廓，更远处取包含它的最小的特征 ROI。逐帧比较时每个点由它查到自己的公差 (公差表)。
+     *
+     * 逐帧比较是 O(轮廓点数) 的：每个点按零件位姿换算到模型坐标系后，在距离图上双线性插值，
+     * 与模型有多少段无关。正偏差是多料 (毛刺、凸起)，负偏差是缺料 (崩边、缺口)，
+     * 外形和内孔的符号约定相同 (内孔偏小也是多料)。
+     *
+     * 编译之后对象只读，可以被多个测量线程共享。
+     */
+    class INSPECTOR_API NominalModel
+    {
+    public:
+        static const int kAutoGridSize = 512; // 自动网格间距时外形长边的格数
+        static const int kExactBand = 4;      // 名义轮廓两侧精确计算距离的格数
+        static const int kMaxGridSize = 4096; // 网格长边的上限 (网格间距太小时编译失败)
+
+        /**
+         * @brief 由闭合轮廓编译模型。
+         * @return 没有面积大于0的闭合轮廓、或网格超过 kMaxGridSize 时返回 false，原有的模型保持不变。
+         */
+        bool compile(const std::vector<NominalLoop>& loops, const NominalCompileOptions& options = NominalCompileOptions());
+
+        /**
+         * @brief 保存/加载模型 (OpenCV YAML 格式，只保存轮廓、编译参数和各特征的公差，距离图在加载时重新编译)。
+         * load 也接受 DXF 文件 (扩展名 .dxf，读取所有图层，编译参数取默认值)。
+         */
+        bool save(const std::string& path) const;
+        bool load(const std::string& path);
+
+        /**
+         * @brief 由客户图纸 (DXF) 建立模型：读取 layer 图层 (为空时所有图层) 上的轮廓并编译，见 ReadDxf。
+         */
+        bool importDxf(const std::string& path, const std::string& layer = std::string(),
+                       const NominalCompileOptions& options = NominalCompileOptions());
+
+        /**
+         * @brief 带缓存的加载：编译结果 (距离图、特征表和特征图) 以二进制形式保存在 cachePath，
+         * 工位启动时直接读取，不再折线化和计算距离。
+         * @details 缓存记录了源文件 (和 layer) 内容的哈希值，源文件修改过、缓存损坏或版本不同时按 load/importDxf
+         * 重新编译并改写缓存。缓存写不进去不影响加载的结果。
+         * @param layer 只对 DXF 源文件有效。
+         */
+        bool loadCached(const std::string& path, const std::string& cachePath, const std::string& layer = std::string());
+
+        bool isValid() const { return !m_distance.empty(); }
+        const std::vector<NominalLoop>& loops() const { return m_loops; }
+        cv::Size2f size() const { return m_size; } // 外形最小外接矩形的长、宽 (mm)
+        float cellSize() const { return m_cellSize; }
+        const std::vector<NominalFeature>& features() const { return m_features; } // 第0个是外形
+
+        /**
+         * @brief 设置一类特征 (例如所有圆孔) 的公差 (mm)，0 为使用 NominalOptions::tolerance。
+         * @details 修改的是编译好的公差表，不需要重新编译；模型被测量线程共享之前调用。
+         */
+        void setTolerance(NominalFeature::Kind kind, float tolerance);
+
+        /**
+         * @brief 模型坐标系中一点所属的特征 (features() 的下标，取最近的网格节点)。
+         */
+        int featureAt(const cv::Point2f& p) const;
+
+        /**
+         * @brief 模型坐标系中一点到名义轮廓的有符号距离 (mm，双线性插值)。网格之外取边界上的值。
+         */
+        float distanceAt(const cv::Point2f& p) const;
+
+        /**
+         * @brief 比较零件的轮廓与名义几何。
+         * @details 初始位姿由零件外接矩形给出 (中心和长边方向，长边方向有正反两种可能，取偏差小的一种)；
+         * bestFit 时再以 Gauss-Newton 迭代平移和转动，使偏差的平方和最小 (Huber 权重，毛刺不会把模型拉偏)，
+         * 相当于三坐标测量的“最佳拟合”。轮廓点按1像素的间距补全 (CHAIN_APPROX_SIMPLE 只保留了拐点)。
+         * @param contours 轮廓树，indices 为参与比较的轮廓 (零件外轮廓和它的内孔)，坐标为处理图像的像素。
+         * @param box 零件外接矩形 (同一坐标)。
+         * @param pixelSize 处理图像一个像素对应的毫米数。
+         * @param tolerance 公差 (mm)，超出的连续一段记为一处缺陷。特征有自己的公差时使用特征的公差。
+         * @return 参数无效或没有轮廓点时返回 false，deviation.valid 与返回值相同。
+         */
+        bool compare(const std::vector<std::vector<cv::Point>>& contours, const std::vector<int>& indices,
+            const cv::RotatedRect& box, float pixelSize, float tolerance, bool bestFit, DeviationResult& deviation) const;
+
+    private:
+        std::vector<NominalLoop> m_loops;  // 原始轮廓 (CAD 坐标)
+        NominalCompileOptions m_options;
+        cv::Size2f m_size;
+
+        // --- 编译结果 ---
+        cv::Mat m_distance;    // 有符号距离 (mm)，CV_32FC1，节点 (i, j) 位于模型坐标 m_origin + (j, i) * m_cellSize
+        cv::Point2f m_origin;
+        float m_cellSize = 0.0f;
+        std::vector<NominalFeature> m_features;
+        cv::Mat m_featureMap;  // 每个节点所属的特征 (m_features 的下标)，CV_16UC1，与 m_distance 同尺寸
+
+        bool writeCache(const std::string& path, uint64_t key) const;
+        bool readCache(const std::string& path, uint64_t key);
+    };
+
+} // namespace InspectorLib
+
+#endif // INSPECTOR_NOMINALMODEL_H
@@ -0,0 +1,543 @@
+﻿// PixelFormat.cpp
+
+#include "PixelFormat.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "Simd.h" // INSPECTOR_SSE2、INSPECTOR_SSSE3
+
+namespace InspectorLib
+{
+    // --- 辅助函数 ---
+    namespace
+    {
+        bool IsPacked(PixelFormat format)
+        {
+            return format == PixelFormat_Mono10Packed || format == PixelFormat_Mono12Packed;
+        }
+
+        // 一行解包之后要写入的目标，指针为 nullptr 表示不需要这个输出
+        struct RowTargets
+        {
+            uint16_t* mono16 = nullptr;
+            uint8_t* mono8 = nullptr;
+            uint8_t* binary = nullptr;
+            const uint16_t* threshold = nullptr; // 逐像素阈值 (平场校正)，为 nullptr 时使用 UnpackParams::threshold
+        };
+
+        // 解包参数：shift8 是从原始位深得到8位预览值需要右移的位数
+        struct UnpackParams
+        {
+            int bitDepth = 8;
+            int shift8 = 0;
+            uint16_t threshold = 0;
+        };
+
+        // 把一个已经解包的像素写入各个目标 (标量版本，也用于处理行尾)
+        inline void StorePixel(uint16_t value, int x, const RowTargets& targets, const UnpackParams& params)
+        {
+            if (targets.mono16) targets.mono16[x] = value;
+            if (targets.mono8) targets.mono8[x] = static_cast<uint8_t>(std::min(value >> params.shift8, 255));
+            if (targets.binary) targets.binary[x] = value > (targets.threshold ? targets.threshold[x] : params.threshold) ? 255 : 0;
+        }
+
+#ifdef INSPECTOR_SSE2
+        // 向量版本：一次写入8个像素
+        // 【关键】SSE2 没有无符号16位比较，两边同时异或 0x8000 之后用有符号比较，结果相同
+        inline void StorePixels8(__m128i value, int x, const RowTargets& targets, __m128i shift8, __m128i thresholdBiased)
+        {
+            if (targets.mono16) {
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(targets.mono16 + x), value);
+            }
+            if (targets.mono8) {
+                const __m128i shifted = _mm_srl_epi16(value, shift8);
+                _mm_storel_epi64(reinterpret_cast<__m128i*>(targets.mono8 + x), _mm_packus_epi16(shifted, shifted));
+            }
+            if (targets.binary) {
+                const __m128i bias = _mm_set1_epi16(static_cast<short>(0x8000));
+                const __m128i limit = targets.threshold
+                    ? _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(targets.threshold + x)), bias)
+                    : thresholdBiased;
+                const __m128i mask = _mm_cmpgt_epi16(_mm_xor_si128(value, bias), limit);
+                _mm_storel_epi64(reinterpret_cast<__m128i*>(targets.binary + x), _mm_packs_epi16(mask, mask));
+            }
+        }
+#endif
+
+        // --- Mono8 (只在使用逐像素阈值时经过这里，否则直接用 cv::threshold) ---
+        void UnpackRow8(const uint8_t* src, int width, const RowTargets& targets, const UnpackParams& params)
+        {
+            int x = 0;
+#ifdef INSPECTOR_SSE2
+            const __m128i zero = _mm_setzero_si128();
+            const __m128i shift8 = _mm_cvtsi32_si128(0);
+            const __m128i thresholdBiased = _mm_set1_epi16(static_cast<short>(params.threshold ^ 0x8000));
+            for (; x + 16 <= width; x += 16)
+            {
+                const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + x));
+                StorePixels8(_mm_unpacklo_epi8(bytes, zero), x, targets, shift8, thresholdBiased);
+                StorePixels8(_mm_unpackhi_epi8(bytes, zero), x + 8, targets, shift8, thresholdBiased);
+            }
+#endif
+            for (; x < width; ++x)
+            {
+                StorePixel(src[x], x, targets, params);
+            }
+        }
+
+        // --- 每像素2字节的格式 (Mono10/12/16) ---
+        void UnpackRow16(const uint16_t* src, int width, const RowTargets& targets, const UnpackParams& params)
+        {
+            int x = 0;
+#ifdef INSPECTOR_SSE2
+            const __m128i shift8 = _mm_cvtsi32_si128(params.shift8);
+            const __m128i thresholdBiased = _mm_set1_epi16(static_cast<short>(params.threshold ^ 0x8000));
+            for (; x + 8 <= width; x += 8)
+            {
+                StorePixels8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + x)), x, targets, shift8, thresholdBiased);
+            }
+#endif
+            for (; x < width; ++x)
+            {
+                StorePixel(src[x], x, targets, params);
+            }
+        }
+
+        // --- 打包格式 (Mono10Packed/Mono12Packed，GigE Vision 布局) ---
+        // 每3个字节 b0 b1 b2 存放2个像素:
+        //   Mono12Packed: p0 = b0 << 4 | (b1 & 0x0F)，p1 = b2 << 4 | (b1 >> 4)
+        //   Mono10Packed: p0 = b0 << 2 | (b1 & 0x03)，p1 = b2 << 2 | ((b1 >> 4) & 0x03)
+        void UnpackRowPacked(const uint8_t* src, int width, const RowTargets& targets, const UnpackParams& params)
+        {
+            const int highShift = params.bitDepth - 8;   // 高8位左移的位数
+            const int lowMask = (1 << highShift) - 1;    // 低位在 b1 中占用的位
+            int x = 0;
+#ifdef INSPECTOR_SSSE3
+            // 1. 用一次字节重排把8个像素 (12字节) 展开为8个16位通道:
+            //    偶数像素 = b0 << 8 | b1，奇数像素 = b2 << 8 | b1
+            const __m128i shuffle = _mm_setr_epi8(1, 0, 1, 2, 4, 3, 4, 5, 7, 6, 7, 8, 10, 9, 10, 11);
+            const __m128i evenLanes = _mm_setr_epi16(-1, 0, -1, 0, -1, 0, -1, 0);
+            const __m128i highMask = _mm_set1_epi16(static_cast<short>(0xFF << highShift));
+            const __m128i lowMaskV = _mm_set1_epi16(static_cast<short>(lowMask));
+            const __m128i highShiftV = _mm_cvtsi32_si128(8 - highShift);
+            const __m128i shift8 = _mm_cvtsi32_si128(params.shift8);
+            const __m128i thresholdBiased = _mm_set1_epi16(static_cast<short>(params.threshold ^ 0x8000));
+
+            // 每次读取16字节但只使用12字节，最后不足16字节的部分留给标量代码，避免读越界
+            for (; x + 12 <= width; x += 8)
+            {
+                const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + x / 2 * 3));
+                const __m128i v = _mm_shuffle_epi8(bytes, shuffle);
+
+                // 2. 高位: 两种通道都是 (v >> (8 - highShift)) & (0xFF << highShift)
+                const __m128i high = _mm_and_si128(_mm_srl_epi16(v, highShiftV), highMask);
+
+                // 3. 低位: 偶数通道取 b1 的最低几位，奇数通道取 b1 右移4位之后的最低几位
+                const __m128i lowSource = _mm_or_si128(_mm_and_si128(evenLanes, v), _mm_andnot_si128(evenLanes, _mm_srli_epi16(v, 4)));
+                const __m128i value = _mm_or_si128(high, _mm_and_si128(lowSource, lowMaskV));
+
+                StorePixels8(value, x, targets, shift8, thresholdBiased);
+            }
+#endif
+            for (; x + 1 < width; x += 2)
+            {
+                const uint8_t* b = src + x / 2 * 3;
+                StorePixel(static_cast<uint16_t>((b[0] << highShift) | (b[1] & lowMask)), x, targets, params);
+                StorePixel(static_cast<uint16_t>((b[2] << highShift) | ((b[1] >> 4) & lowMask)), x + 1, targets, params);
+            }
+        }
+
+        // --- Bayer -> 亮度，全分辨率 ---
+        // [1 2 1] x [1 2 1] / 16 的可分离滤波：先把上中下三行按 1:2:1 相加到行缓冲 (16位)，再在行缓冲上横向做同样的加权。
+        // 边界使用“镜像不含边缘”(row -1 = row 1)，这样边界像素的邻域仍然符合 Bayer 的排列。
+        // rowSum 的长度为 width + 2，rowSum[0] 和 rowSum[width + 1] 存放左右镜像的列。
+        void BayerRowFull(const uint8_t* up, const uint8_t* mid, const uint8_t* down, int width,
+            uint16_t* rowSum, const RowTargets& targets, const UnpackParams& params)
+        {
+            // 1. 纵向: rowSum[x + 1] = up[x] + 2 * mid[x] + down[x]
+            int x = 0;
+#ifdef INSPECTOR_SSE2
+            const __m128i zero = _mm_setzero_si128();
+            for (; x + 16 <= width; x += 16)
+            {
+                const __m128i u = _mm_loadu_si128(reinterpret_cast<const __m128i*>(up + x));
+                const __m128i m = _mm_loadu_si128(reinterpret_cast<const __m128i*>(mid + x));
+                const __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(down + x));
+                const __m128i lo = _mm_add_epi16(_mm_add_epi16(_mm_unpacklo_epi8(u, zero), _mm_unpacklo_epi8(d, zero)),
+                                                 _mm_slli_epi16(_mm_unpacklo_epi8(m, zero), 1));
+                const __m128i hi = _mm_add_epi16(_mm_add_epi16(_mm_unpackhi_epi8(u, zero), _mm_unpackhi_epi8(d, zero)),
+                                                 _mm_slli_epi16(_mm_unpackhi_epi8(m, zero), 1));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(rowSum + 1 + x), lo);
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(rowSum + 1 + x + 8), hi);
+            }
+#endif
+            for (; x < width; ++x)
+            {
+                rowSum[x + 1] = static_cast<uint16_t>(up[x] + 2 * mid[x] + down[x]);
+            }
+            rowSum[0] = rowSum[2];
+            rowSum[width + 1] = rowSum[width - 1];
+
+            // 2. 横向: Y = (rowSum[x] + 2 * rowSum[x + 1] + rowSum[x + 2] + 8) / 16，最大 4080，不会溢出16位
+            x = 0;
+#ifdef INSPECTOR_SSE2
+            const __m128i round = _mm_set1_epi16(8);
+            const __m128i shift8 = _mm_cvtsi32_si128(params.shift8);
+            const __m128i thresholdBiased = _mm_set1_epi16(static_cast<short>(params.threshold ^ 0x8000));
+            for (; x + 8 <= width; x += 8)
+            {
+                const __m128i left = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rowSum + x));
+                const __m128i center = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rowSum + x + 1));
+                const __m128i right = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rowSum + x + 2));
+                const __m128i sum = _mm_add_epi16(_mm_add_epi16(left, right), _mm_add_epi16(_mm_slli_epi16(center, 1), round));
+                StorePixels8(_mm_srli_epi16(sum, 4), x, targets, shift8, thresholdBiased);
+            }
+#endif
+            for (; x < width; ++x)
+            {
+                StorePixel(static_cast<uint16_t>((rowSum[x] + 2 * rowSum[x + 1] + rowSum[x + 2] + 8) >> 4), x, targets, params);
+            }
+        }
+
+        // --- Bayer -> 亮度，半分辨率 (2x2 超像素) ---
+        // 输出像素 x = (top[2x] + top[2x + 1] + bottom[2x] + bottom[2x + 1] + 2) / 4
+        void BayerRowHalf(const uint8_t* top, const uint8_t* bottom, int outWidth,
+            const RowTargets& targets, const UnpackParams& params)
+        {
+            int x = 0;
+#ifdef INSPECTOR_SSE2
+            const __m128i lowBytes = _mm_set1_epi16(0x00FF);
+            const __m128i round = _mm_set1_epi16(2);
+            const __m128i shift8 = _mm_cvtsi32_si128(params.shift8);
+            const __m128i thresholdBiased = _mm_set1_epi16(static_cast<short>(params.threshold ^ 0x8000));
+            for (; x + 8 <= outWidth; x += 8)
+            {
+                // 16个输入字节 -> 8个输出：偶数列和奇数列分别取出为16位再相加
+                const __m128i t = _mm_loadu_si128(reinterpret_cast<const __m128i*>(top + 2 * x));
+                const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bottom + 2 * x));
+                const __m128i sum = _mm_add_epi16(_mm_add_epi16(_mm_and_si128(t, lowBytes), _mm_srli_epi16(t, 8)),
+                                                  _mm_add_epi16(_mm_and_si128(b, lowBytes), _mm_srli_epi16(b, 8)));
+                StorePixels8(_mm_srli_epi16(_mm_add_epi16(sum, round), 2), x, targets, shift8, thresholdBiased);
+            }
+#endif
+            for (; x < outWidth; ++x)
+            {
+                StorePixel(static_cast<uint16_t>((top[2 * x] + top[2 * x + 1] + bottom[2 * x] + bottom[2 * x + 1] + 2) >> 2), x, targets, params);
+            }
+        }
+
+        // 直方图采样网格：每行每隔 kSampleStride 个像素取连续的 kSampleWidth 个像素 (都是偶数，打包格式不会从半组开始)
+        const int kSampleWidth = 16;
+        const int kSampleStride = 64;
+
+        // 读取一小段像素的8位值 (坐标已经检查过)。Mono8 直接返回原始数据的指针，其余格式写入 buffer
+        const uint8_t* ReadSegment8(const cv::Mat& rawImage, PixelFormat format, int y, int x, int n,
+            uint8_t* buffer, const UnpackParams& params)
+        {
+            RowTargets targets;
+            targets.mono8 = buffer;
+            if (format == PixelFormat_Mono8) {
+                return rawImage.ptr<uint8_t>(y) + x;
+            }
+            else if (IsBayerFormat(format)) {
+                BayerRowHalf(rawImage.ptr<uint8_t>(2 * y) + 2 * x, rawImage.ptr<uint8_t>(2 * y + 1) + 2 * x, n, targets, params);
+            }
+            else if (IsPacked(format)) {
+                UnpackRowPacked(rawImage.ptr<uint8_t>(y) + x / 2 * 3, n, targets, params);
+            }
+            else {
+                UnpackRow16(rawImage.ptr<uint16_t>(y) + x, n, targets, params);
+            }
+            return buffer;
+        }
+
+        // n 个字节之和
+        inline uint64_t SumBytes(const uint8_t* p, int n)
+        {
+            uint64_t sum = 0;
+            int i = 0;
+#ifdef INSPECTOR_SSE2
+            // _mm_sad_epu8 与0求差的绝对值之和，即每8个字节之和，放在两个64位通道中
+            const __m128i zero = _mm_setzero_si128();
+            __m128i acc = zero;
+            for (; i + 16 <= n; i += 16) {
+                acc = _mm_add_epi64(acc, _mm_sad_epu8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i)), zero));
+            }
+            alignas(16) uint64_t lanes[2];
+            _mm_store_si128(reinterpret_cast<__m128i*>(lanes), acc);
+            sum = lanes[0] + lanes[1];
+#endif
+            for (; i < n; ++i) sum += p[i];
+            return sum;
+        }
+
+        // 逐行解包，按需写入三个输出 (未使用的输出传 nullptr)
+        bool Unpack(const cv::Mat& rawImage, PixelFormat format, uint16_t threshold,
+            cv::Mat* mono16, cv::Mat* mono8, cv::Mat* binary, bool bayerHalfResolution = false,
+            const cv::Mat* thresholdMap = nullptr)
+        {
+            const int width = RawFrameWidth(rawImage, format);
+            if (width <= 0) return false;
+
+            const bool bayer = IsBayerFormat(format);
+            const bool half = bayer && bayerHalfResolution;
+            if (bayer && (half ? (width < 2 || rawImage.rows < 2) : (width < 3 || rawImage.rows < 3))) return false;
+            const int outWidth = half ? width / 2 : width;
+            const int outHeight = half ? rawImage.rows / 2 : rawImage.rows;
+            if (thresholdMap && (thresholdMap->type() != CV_16UC1 || thresholdMap->size() != cv::Size(outWidth, outHeight))) return false;
+
+            UnpackParams params;
+            params.bitDepth = PixelFormatBitDepth(format);
+            params.shift8 = params.bitDepth - 8;
+            params.threshold = threshold;
+
+            if (mono16) mono16->create(outHeight, outWidth, CV_16UC1);
+            if (mono8) mono8->create(outHeight, outWidth, CV_8UC1);
+            if (binary) binary->create(outHeight, outWidth, CV_8UC1);
+
+            std::vector<uint16_t> rowSum(bayer && !half ? width + 2 : 0); // 全分辨率 Bayer 的行缓冲
+            for (int y = 0; y < outHeight; ++y)
+            {
+                RowTargets targets;
+                if (mono16) targets.mono16 = mono16->ptr<uint16_t>(y);
+                if (mono8) targets.mono8 = mono8->ptr<uint8_t>(y);
+                if (binary) targets.binary = binary->ptr<uint8_t>(y);
+                if (thresholdMap) targets.threshold = thresholdMap->ptr<uint16_t>(y);
+
+                if (half) {
+                    BayerRowHalf(rawImage.ptr<uint8_t>(2 * y), rawImage.ptr<uint8_t>(2 * y + 1), outWidth, targets, params);
+                }
+                else if (bayer) {
+                    const int up = y > 0 ? y - 1 : 1;
+                    const int down = y < outHeight - 1 ? y + 1 : outHeight - 2;
+                    BayerRowFull(rawImage.ptr<uint8_t>(up), rawImage.ptr<uint8_t>(y), rawImage.ptr<uint8_t>(down), width,
+                                 rowSum.data(), targets, params);
+                }
+                else if (format == PixelFormat_Mono8) {
+                    UnpackRow8(rawImage.ptr<uint8_t>(y), width, targets, params);
+                }
+                else if (IsPacked(format)) {
+                    UnpackRowPacked(rawImage.ptr<uint8_t>(y), width, targets, params);
+                }
+                else {
+                    UnpackRow16(rawImage.ptr<uint16_t>(y), width, targets, params);
+                }
+            }
+            return true;
+        }
+    }
+
+    // 格式名称 (与 PixelFormat 的顺序一一对应)
+    const char* INSPECTOR_API PixelFormatName(PixelFormat format)
+    {
+        static const char* const names[PixelFormat_Count] = {
+            "Mono8", "Mono10", "Mono12", "Mono16", "Mono10Packed", "Mono12Packed",
+            "BayerRG8", "BayerBG8", "BayerGB8", "BayerGR8"
+        };
+        return (format >= 0 && format < PixelFormat_Count) ? names[format] : "Unknown";
+    }
+
+    bool INSPECTOR_API IsBayerFormat(PixelFormat format)
+    {
+        return format >= PixelFormat_BayerRG8 && format <= PixelFormat_BayerGR8;
+    }
+
+    int INSPECTOR_API PixelFormatBitDepth(PixelFormat format)
+    {
+        switch (format)
+        {
+        case PixelFormat_Mono8:
+        case PixelFormat_BayerRG8:
+        case PixelFormat_BayerBG8:
+        case PixelFormat_BayerGB8:
+        case PixelFormat_BayerGR8: return 8;
+        case PixelFormat_Mono10:
+        case PixelFormat_Mono10Packed: return 10;
+        case PixelFormat_Mono12:
+        case PixelFormat_Mono12Packed: return 12;
+        case PixelFormat_Mono16: return 16;
+        default: return 0;
+        }
+    }
+
+    cv::Mat INSPECTOR_API WrapRawFrame(void* data, int width, int height, PixelFormat format)
+    {
+        if (data == nullptr || width <= 0 || height <= 0) return cv::Mat();
+        if (format == PixelFormat_Mono8 || IsBayerFormat(format)) return cv::Mat(height, width, CV_8UC1, data);
+        if (IsPacked(format)) {
+            if (width % 2 != 0) return cv::Mat();
+            return cv::Mat(height, width / 2 * 3, CV_8UC1, data);
+        }
+        if (PixelFormatBitDepth(format) > 8) return cv::Mat(height, width, CV_16UC1, data);
+        return cv::Mat();
+    }
+
+    int INSPECTOR_API RawFrameWidth(const cv::Mat& rawImage, PixelFormat format)
+    {
+        if (rawImage.empty()) return -1;
+        if (format == PixelFormat_Mono8 || IsBayerFormat(format)) return rawImage.type() == CV_8UC1 ? rawImage.cols : -1;
+        if (IsPacked(format)) {
+            return (rawImage.type() == CV_8UC1 && rawImage.cols % 3 == 0) ? rawImage.cols / 3 * 2 : -1;
+        }
+        if (PixelFormatBitDepth(format) > 8) return rawImage.type() == CV_16UC1 ? rawImage.cols : -1;
+        return -1;
+    }
+
+    bool INSPECTOR_API UnpackToMono16(const cv::Mat& rawImage, PixelFormat format, cv::Mat& dst)
+    {
+        if (format == PixelFormat_Mono8) {
+            if (RawFrameWidth(rawImage, format) <= 0) return false;
+            rawImage.convertTo(dst, CV_16U);
+            return true;
+        }
+        return Unpack(rawImage, format, 0, &dst, nullptr, nullptr);
+    }
+
+    bool INSPECTOR_API UnpackToMono8(const cv::Mat& rawImage, PixelFormat format, cv::Mat& dst)
+    {
+        if (format == PixelFormat_Mono8) {
+            if (RawFrameWidth(rawImage, format) <= 0) return false;
+            dst = rawImage;
+            return true;
+        }
+        return Unpack(rawImage, format, 0, nullptr, &dst, nullptr);
+    }
+
+    bool INSPECTOR_API UnpackAndThreshold(const cv::Mat& rawImage, PixelFormat format, uint16_t threshold,
+        cv::Mat& binary, cv::Mat* preview8, bool bayerHalfResolution, const cv::Mat* thresholdMap)
+    {
+        if (format == PixelFormat_Mono8 && thresholdMap == nullptr) {
+            // 8位图像不需要解包，直接使用 OpenCV 的二值化 (同样是向量化的)
+            if (RawFrameWidth(rawImage, format) <= 0) return false;
+            cv::threshold(rawImage, binary, threshold, 255, cv::THRESH_BINARY);
+            if (preview8) *preview8 = rawImage;
+            return true;
+        }
+        return Unpack(rawImage, format, threshold, nullptr, preview8, &binary, bayerHalfResolution, thresholdMap);
+    }
+
+    int INSPECTOR_API SampleHistogram(const cv::Mat& rawImage, PixelFormat format, int rowStep, int phase,
+        uint32_t* histogram)
+    {
+        const int width = RawFrameWidth(rawImage, format);
+        if (width <= 0 || rowStep < 1 || phase < 0 || histogram == nullptr) return -1;
+
+        const bool bayer = IsBayerFormat(format);
+        const int rows = bayer ? rawImage.rows / 2 : rawImage.rows; // Bayer 按超像素的行和列采样
+        const int cols = bayer ? width / 2 : width;
+
+        UnpackParams params;
+        params.bitDepth = PixelFormatBitDepth(format);
+        params.shift8 = params.bitDepth - 8;
+
+        uint8_t segment[kSampleWidth];
+
+        // 4个交错的子直方图，最后再合并
+        uint32_t counts[4][256] = {};
+        int samples = 0;
+        for (int y = phase % rowStep; y < rows; y += rowStep)
+        {
+            for (int x = 0; x < cols; x += kSampleStride)
+            {
+                // 1. 取出一小段的8位值 (Mono8 直接使用原始数据)
+                const int n = std::min(kSampleWidth, cols - x);
+                const uint8_t* values = ReadSegment8(rawImage, format, y, x, n, segment, params);
+
+                // 2. 计数
+                int i = 0;
+                for (; i + 4 <= n; i += 4)
+                {
+                    ++counts[0][values[i]];
+                    ++counts[1][values[i + 1]];
+                    ++counts[2][values[i + 2]];
+                    ++counts[3][values[i + 3]];
+                }
+                for (; i < n; ++i) ++counts[0][values[i]];
+                samples += n;
+            }
+        }
+
+        for (int b = 0; b < 256; ++b) {
+            histogram[b] += counts[0][b] + counts[1][b] + counts[2][b] + counts[3][b];
+        }
+        return samples;
+    }
+
+    bool INSPECTOR_API SampleTileMeans(const cv::Mat& rawImage, PixelFormat format, int gridSize, int rowStep, float* means)
+    {
+        const int width = RawFrameWidth(rawImage, format);
+        if (width <= 0 || gridSize < 1 || rowStep < 1 || means == nullptr) return false;
+
+        const bool bayer = IsBayerFormat(format);
+        const int rows = bayer ? rawImage.rows / 2 : rawImage.rows;
+        const int cols = bayer ? width / 2 : width;
+        if (rows < gridSize || cols < gridSize) return false;
+
+        UnpackParams params;
+        params.bitDepth = PixelFormatBitDepth(format);
+        params.shift8 = params.bitDepth - 8;
+
+        // 块的列边界，第 t 块为 [bounds[t], bounds[t + 1])
+        std::vector<int> bounds(gridSize + 1);
+        for (int t = 0; t <= gridSize; ++t) bounds[t] = t * cols / gridSize;
+
+        std::vector<uint64_t> sums(gridSize * gridSize, 0);
+        std::vector<int> sampledRows(gridSize, 0); // 每一行块采样的行数
+        std::vector<uint8_t> line(cols);
+        for (int y = rowStep / 2; y < rows; y += rowStep)
+        {
+            const int tileRow = y * gridSize / rows;
+            const uint8_t* values = ReadSegment8(rawImage, format, y, 0, cols, line.data(), params);
+            uint64_t* rowSums = &sums[tileRow * gridSize];
+            for (int t = 0; t < gridSize; ++t) {
+                rowSums[t] += SumBytes(values + bounds[t], bounds[t + 1] - bounds[t]);
+            }
+            ++sampledRows[tileRow];
+        }
+
+        for (int ty = 0; ty < gridSize; ++ty)
+        {
+            for (int tx = 0; tx < gridSize; ++tx)
+            {
+                const uint64_t count = static_cast<uint64_t>(sampledRows[ty]) * (bounds[tx + 1] - bounds[tx]);
+                means[ty * gridSize + tx] = count > 0 ? static_cast<float>(static_cast<double>(sums[ty * gridSize + tx]) / count) : 0.0f;
+            }
+        }
+        return true;
+    }
+
+    cv::Mat INSPECTOR_API CropRawFrame(const cv::Mat& rawImage, PixelFormat format, const cv::Rect& region)
+    {
+        const int width = RawFrameWidth(rawImage, format);
+        if (width <= 0 || region.empty()) return cv::Mat();
+        if ((region & cv::Rect(0, 0, width, rawImage.rows)) != region) return cv::Mat();
+
+        if (IsPacked(format)) {
+            if (region.x % 2 != 0 || region.width % 2 != 0) return cv::Mat();
+            return rawImage(cv::Rect(region.x / 2 * 3, region.y, region.width / 2 * 3, region.height));
+        }
+        if (IsBayerFormat(format) && (region.x % 2 != 0 || region.y % 2 != 0)) return cv::Mat();
+        return rawImage(region);
+    }
+
+    bool INSPECTOR_API ReadPixels8(const cv::Mat& rawImage, PixelFormat format, int y, int x, int count, uint8_t* dst)
+    {
+        const int width = RawFrameWidth(rawImage, format);
+        if (width <= 0 || dst == nullptr) return false;
+
+        const bool bayer = IsBayerFormat(format);
+        const int rows = bayer ? rawImage.rows / 2 : rawImage.rows;
+        const int cols = bayer ? width / 2 : width;
+        if (y < 0 || y >= rows || x < 0 || count <= 0 || x + count > cols) return false;
+        if (IsPacked(format) && (x % 2 != 0 || count % 2 != 0)) return false;
+
+        UnpackParams params;
+        params.bitDepth = PixelFormatBitDepth(format);
+        params.shift8 = params.bitDepth - 8;
+        const uint8_t* values = ReadSegment8(rawImage, format, y, x, count, dst, params);
+        if (values != dst) std::copy(values, values + count, dst);
+        return true;
+    }
+
+} // namespace InspectorLib
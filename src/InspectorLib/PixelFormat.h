@@ -0,0 +1,112 @@
+﻿// PixelFormat.h (相机原始图像的解包：Mono10/12/16、打包格式及 Bayer)
+
+#ifndef INSPECTOR_PIXELFORMAT_H
+#define INSPECTOR_PIXELFORMAT_H
+
+#include "Inspector.h" // INSPECTOR_API、PixelFormat
+
+#include <cstdint>
+
+namespace InspectorLib
+{
+    /**
+     * @brief 返回像素格式的英文名称 (用于日志)。
+     */
+    const char* INSPECTOR_API PixelFormatName(PixelFormat format);
+
+    /**
+     * @brief 是否为 Bayer 彩色原始数据。
+     */
+    bool INSPECTOR_API IsBayerFormat(PixelFormat format);
+
+    /**
+     * @brief 像素的有效位数 (Mono8 为8，Mono12/Mono12Packed 为12 ...)，未知格式返回0。
+     */
+    int INSPECTOR_API PixelFormatBitDepth(PixelFormat format);
+
+    /**
+     * @brief 把相机SDK给出的原始数据包装为 cv::Mat (不拷贝)。
+     *
+     * @details 存放方式：
+     *  - Mono8、Bayer*8：CV_8UC1，height x width；
+     *  - Mono10/12/16：CV_16UC1，height x width；
+     *  - Mono10Packed/Mono12Packed：CV_8UC1，height x (width * 3 / 2)，即每行是打包之后的字节流。
+     * 打包格式要求 width 为偶数 (每3个字节存放2个像素)，否则返回空 Mat。
+     */
+    cv::Mat INSPECTOR_API WrapRawFrame(void* data, int width, int height, PixelFormat format);
+
+    /**
+     * @brief 原始图像的像素宽度；rawImage 的类型与 format 不匹配时返回 -1。
+     */
+    int INSPECTOR_API RawFrameWidth(const cv::Mat& rawImage, PixelFormat format);
+
+    /**
+     * @brief 解包为 CV_16UC1，数值保持原始位深 (例如 Mono12 的取值范围是 0 ~ 4095)。
+     */
+    bool INSPECTOR_API UnpackToMono16(const cv::Mat& rawImage, PixelFormat format, cv::Mat& dst);
+
+    /**
+     * @brief 解包为 CV_8UC1 (取最高的8位；Bayer 格式为全分辨率的亮度)，用于显示。
+     */
+    bool INSPECTOR_API UnpackToMono8(const cv::Mat& rawImage, PixelFormat format, cv::Mat& dst);
+
+    /**
+     * @brief 【关键】解包与二值化融合：一遍扫描同时得到二值图和 (可选的) 8位预览图，中间不产生整幅的16位图像。
+     *
+     * @details 每个像素解包到寄存器之后立即与阈值比较 (在原始位深上，大于 threshold 为255)，
+     * 同时右移得到8位预览值。x86 上使用 SSE2 (打包格式的拆分需要 SSSE3，编译器未开启时退回标量代码)。
+     *
+     * Bayer 格式在同一遍中直接得到亮度 Y = (R + 2G + B) / 4，不经过 BGR：
+     *  - 全分辨率：对原始数据做 [1 2 1] x [1 2 1] / 16 的滤波。任何位置的 3x3 邻域中 R、G、B 的权重之和
+     *    恰好是 1:2:1，所以结果与 Bayer 的排列无关，也没有半像素的偏移；
+     *  - 半分辨率 (bayerHalfResolution)：每个 2x2 超像素 (正好是 1R + 2G + 1B) 取平均，输出宽高减半。
+     *    输出像素 (x, y) 的中心位于原图的 (2x + 0.5, 2y + 0.5)。
+     * @param threshold 原始位深上的阈值。
+     * @param binary 输出的二值图，CV_8UC1。
+     * @param preview8 为 nullptr 时不输出预览图。
+     * @param bayerHalfResolution 只对 Bayer 格式有效。
+     * @param thresholdMap 逐像素的阈值 (CV_16UC1，尺寸与输出相同，见 FlatFieldCorrection)。不为 nullptr 时
+     *                     代替 threshold，在同一条比较指令中完成校正，不增加额外的扫描。
+     */
+    bool INSPECTOR_API UnpackAndThreshold(const cv::Mat& rawImage, PixelFormat format, uint16_t threshold,
+        cv::Mat& binary, cv::Mat* preview8 = nullptr, bool bayerHalfResolution = false,
+        const cv::Mat* thresholdMap = nullptr);
+
+    /**
+     * @brief 在稀疏的采样网格上统计8位刻度的灰度直方图 (用于自动阈值，见 AutoThreshold)。
+     *
+     * @details 采样网格：行 phase, phase + rowStep, phase + 2 * rowStep ...；每一行上每隔64个像素取连续的16个像素。
+     * 取连续的一小段而不是单个像素，是为了直接复用上面解包用的向量化行内核；计数使用4个交错的子直方图，
+     * 相邻样本落入同一个 bin 时不会互相等待。Bayer 格式统计 2x2 超像素的亮度 (行号按超像素计算)。
+     * 每次调用读取的像素约为整幅的 1 / (4 * rowStep)。
+     * @param histogram 256个 bin，结果累加到其中 (不清零)。
+     * @return 采样的像素数；rawImage 的类型与 format 不匹配时返回 -1。
+     */
+    int INSPECTOR_API SampleHistogram(const cv::Mat& rawImage, PixelFormat format, int rowStep, int phase,
+        uint32_t* histogram);
+
+    /**
+     * @brief 读取一行中连续 count 个像素的8位值 (与 SampleHistogram 相同，Bayer 格式的坐标和数值按 2x2 超像素计算)。
+     * @details 用于只需要少量像素的统计 (例如质量预检)，不必解包整幅图像。打包格式要求 x 和 count 为偶数 (整组读取)。
+     * @return 坐标超出范围或 rawImage 的类型与 format 不匹配时返回 false。
+     */
+    bool INSPECTOR_API ReadPixels8(const cv::Mat& rawImage, PixelFormat format, int y, int x, int count, uint8_t* dst);
+
+    /**
+     * @brief 把图像分成 gridSize x gridSize 块，统计每一块的平均灰度 (8位刻度)，作为图像的签名 (见 ChangeDetector)。
+     * @details 每隔 rowStep 行采样整行 (坐标与 ReadPixels8 相同)，块内求和使用 SSE2 的 SAD 指令，一次累加16个像素。
+     * @param means gridSize * gridSize 个值，按行优先存放。
+     * @return 图像小于网格或 rawImage 的类型与 format 不匹配时返回 false。
+     */
+    bool INSPECTOR_API SampleTileMeans(const cv::Mat& rawImage, PixelFormat format, int gridSize, int rowStep, float* means);
+
+    /**
+     * @brief 取出原始图像的一个矩形区域 (不拷贝)，结果仍是同一格式的原始图像，可以交给 UnpackAndThreshold 等函数。
+     * @param region 像素坐标。打包格式要求 x 和 width 为偶数；Bayer 格式要求 x 和 y 为偶数 (保持排列不变)。
+     * @return 区域超出图像、不满足对齐要求或 rawImage 的类型与 format 不匹配时返回空 Mat。
+     */
+    cv::Mat INSPECTOR_API CropRawFrame(const cv::Mat& rawImage, PixelFormat format, const cv::Rect& region);
+
+} // namespace InspectorLib
+
+#endif // INSPECTOR_PIXELFORMAT_H
@@ -0,0 +1,472 @@
+﻿// ShapeModel.cpp
+
+#include "ShapeModel.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "Simd.h" // INSPECTOR_SSE2
+
+namespace InspectorLib
+{
+    namespace
+    {
+        const float kSobelGain = 4.0f;  // 3x3 Sobel 对单位灰度跳变的响应
+        const int kSearchRadius = 2;    // 向下一层细化时，位置的搜索范围 (±像素)
+        const float kNoScore = -1e30f;  // 模板超出图像，没有得分
+
+        // 一块区域上的梯度 (梯度太弱的像素为0)。offset 为区域左上角在本层图像中的位置
+        struct GradientPlanes
+        {
+            cv::Mat gx, gy;
+            cv::Point offset;
+        };
+
+        /**
+         * normalize 为 true 时归一化为单位向量 (打分只看方向)；为 false 时保留幅值，
+         * 得分在边缘中心处有明显的峰值，用于亚像素插值。
+         */
+        void ComputeGradients(const cv::Mat& image, const cv::Rect& roi, float minContrast, GradientPlanes& planes, bool normalize = true)
+        {
+            // 多取1个像素的边，Sobel 在区域边界上使用真实的邻点
+            const cv::Rect frame(0, 0, image.cols, image.rows);
+            const cv::Rect outer = cv::Rect(roi.x - 1, roi.y - 1, roi.width + 2, roi.height + 2) & frame;
+            const cv::Rect inner = roi & frame;
+            cv::Mat gx, gy;
+            cv::Sobel(image(outer), gx, CV_32F, 1, 0, 3);
+            cv::Sobel(image(outer), gy, CV_32F, 0, 1, 3);
+            const cv::Rect local(inner.x - outer.x, inner.y - outer.y, inner.width, inner.height);
+            planes.gx = gx(local).clone();
+            planes.gy = gy(local).clone();
+            planes.offset = inner.tl();
+
+            const float minMagnitude = kSobelGain * minContrast;
+            for (int y = 0; y < planes.gx.rows; ++y)
+            {
+                float* px = planes.gx.ptr<float>(y);
+                float* py = planes.gy.ptr<float>(y);
+                for (int x = 0; x < planes.gx.cols; ++x)
+                {
+                    const float m = std::sqrt(px[x] * px[x] + py[x] * py[x]);
+                    const float inv = m < minMagnitude ? 0.0f : (normalize ? 1.0f / m : 1.0f);
+                    px[x] *= inv;
+                    py[x] *= inv;
+                }
+            }
+        }
+
+        // 金板一层上的特征点：梯度幅值沿梯度方向的局部极大值 (细化为单像素宽的边缘)
+        void ExtractFeatures(const cv::Mat& image, float minContrast, int maxFeatures,
+            std::vector<cv::Point>& points, std::vector<cv::Point2f>& gradients)
+        {
+            cv::Mat gx, gy, magnitude;
+            cv::Sobel(image, gx, CV_32F, 1, 0, 3);
+            cv::Sobel(image, gy, CV_32F, 0, 1, 3);
+            cv::magnitude(gx, gy, magnitude);
+
+            const float minMagnitude = kSobelGain * minContrast;
+            const float tan22 = 0.41421356f; // tan(22.5°)
+            std::vector<cv::Point> all;
+            for (int y = 1; y < image.rows - 1; ++y)
+            {
+                const float* m = magnitude.ptr<float>(y);
+                const float* up = magnitude.ptr<float>(y - 1);
+                const float* down = magnitude.ptr<float>(y + 1);
+                const float* px = gx.ptr<float>(y);
+                const float* py = gy.ptr<float>(y);
+                for (int x = 1; x < image.cols - 1; ++x)
+                {
+                    if (m[x] < minMagnitude) continue;
+                    const float ax = std::fabs(px[x]), ay = std::fabs(py[x]);
+                    float before, after; // 梯度方向上的两个邻点
+                    if (ay <= ax * tan22) { before = m[x - 1]; after = m[x + 1]; }
+                    else if (ax <= ay * tan22) { before = up[x]; after = down[x]; }
+                    else if (px[x] * py[x] > 0.0f) { before = up[x - 1]; after = down[x + 1]; }
+                    else { before = up[x + 1]; after = down[x - 1]; }
+                    if (m[x] >= before && m[x] >= after) all.emplace_back(x, y); // 边缘正好在两个像素之间时两个都保留，不偏向一侧
+                }
+            }
+
+            // 超出数量时按扫描顺序均匀抽取
+            points.clear();
+            gradients.clear();
+            const size_t count = std::min(all.size(), static_cast<size_t>(std::max(1, maxFeatures)));
+            for (size_t k = 0; k < count; ++k)
+            {
+                const cv::Point& p = all[k * all.size() / count];
+                const float gxv = gx.at<float>(p), gyv = gy.at<float>(p);
+                const float inv = 1.0f / magnitude.at<float>(p);
+                points.push_back(p);
+                gradients.emplace_back(gxv * inv, gyv * inv);
+            }
+        }
+
+        /**
+         * 同一行上相邻4个位置 (x .. x+3，平面坐标) 的相似度：Σ (模型梯度 · 图像梯度) / n。
+         * 每8个特征点检查一次：4个位置的部分和都低于终止界限时返回 false。
+         * 界限 (以部分和计) = (1 - g) * (minScore * n - n + j) + g * minScore * j：
+         * 前一项假设剩余的点都完全吻合 (不会漏判)，后一项假设剩余的点平均只有 minScore。
+         */
+        bool Score4(const GradientPlanes& planes, const ShapeTemplate& t, int x, int y,
+            float minScore, float greediness, float scores[4])
+        {
+            const float* gx = planes.gx.ptr<float>(0);
+            const float* gy = planes.gy.ptr<float>(0);
+            const ptrdiff_t stride = static_cast<ptrdiff_t>(planes.gx.step / sizeof(float));
+            const ptrdiff_t base = y * stride + x;
+            const int n = static_cast<int>(t.dx.size());
+            const float safe = (1.0f - greediness), greedy = greediness * minScore;
+            const float start = safe * (minScore - 1.0f) * n;
+#ifdef INSPECTOR_SSE2
+            __m128 sum = _mm_setzero_ps();
+            for (int j = 0; j < n; ++j)
+            {
+                const ptrdiff_t offset = base + t.dy[j] * stride + t.dx[j];
+                const __m128 ix = _mm_loadu_ps(gx + offset);
+                const __m128 iy = _mm_loadu_ps(gy + offset);
+                sum = _mm_add_ps(sum, _mm_add_ps(_mm_mul_ps(ix, _mm_set1_ps(t.gx[j])), _mm_mul_ps(iy, _mm_set1_ps(t.gy[j]))));
+                if ((j & 7) == 7)
+                {
+                    const float bound = start + (safe + greedy) * (j + 1);
+                    if (_mm_movemask_ps(_mm_cmpge_ps(sum, _mm_set1_ps(bound))) == 0) return false;
+                }
+            }
+            _mm_storeu_ps(scores, _mm_mul_ps(sum, _mm_set1_ps(1.0f / n)));
+#else
+            float sum[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+            for (int j = 0; j < n; ++j)
+            {
+                const ptrdiff_t offset = base + t.dy[j] * stride + t.dx[j];
+                for (int l = 0; l < 4; ++l) sum[l] += gx[offset + l] * t.gx[j] + gy[offset + l] * t.gy[j];
+                if ((j & 7) == 7)
+                {
+                    const float bound = start + (safe + greedy) * (j + 1);
+                    if (std::max(std::max(sum[0], sum[1]), std::max(sum[2], sum[3])) < bound) return false;
+                }
+            }
+            for (int l = 0; l < 4; ++l) scores[l] = sum[l] / n;
+#endif
+            return true;
+        }
+
+        // 平面坐标 (x .. x+3, y) 处模板是否完整落在平面内
+        inline bool Fits4(const GradientPlanes& planes, const ShapeTemplate& t, int x, int y)
+        {
+            return x + t.minX >= 0 && x + 3 + t.maxX < planes.gx.cols && y + t.minY >= 0 && y + t.maxY < planes.gx.rows;
+        }
+
+        // 单个位置的得分 (不提前终止)，模板超出平面时返回 kNoScore
+        float ScoreAt(const GradientPlanes& planes, const ShapeTemplate& t, int x, int y)
+        {
+            // 取4个位置的第一个：右边多读的3列要在平面内，放不下时改为以 x 为最后一个
+            float scores[4];
+            if (Fits4(planes, t, x, y)) { Score4(planes, t, x, y, -1.0f, 0.0f, scores); return scores[0]; }
+            if (Fits4(planes, t, x - 3, y)) { Score4(planes, t, x - 3, y, -1.0f, 0.0f, scores); return scores[3]; }
+            return kNoScore;
+        }
+
+        // 抛物线插值的顶点偏移 (-0.5 ~ 0.5)
+        inline float ParabolaPeak(float left, float center, float right)
+        {
+            const float curvature = left - 2.0f * center + right;
+            if (left == kNoScore || right == kNoScore || curvature >= 0.0f) return 0.0f; // 缺少邻点或不是极大值
+            return std::max(-0.5f, std::min(0.5f, 0.5f * (left - right) / curvature));
+        }
+
+        struct Hypothesis
+        {
+            float score;
+            cv::Point2f position; // 本层图像坐标
+            float angle;
+        };
+    }
+
+    bool ShapeModel::train(const cv::Mat& golden, const ShapeModelOptions& options)
+    {
+        if (golden.empty() || golden.type() != CV_8UC1) return false;
+
+        // 1. 层数：自动时，直到下一层模型的短边小于 kMinTopSize
+        int levels = options.numLevels > 0 ? std::min(options.numLevels, static_cast<int>(kMaxLevels)) : 1;
+        if (options.numLevels <= 0) {
+            while (levels < kMaxLevels && (std::min(golden.cols, golden.rows) >> levels) >= kMinTopSize) ++levels;
+        }
+
+        // 2. 每层提取特征点 (相对模型原点：第0层为图像中心，上层按 pyrDown 的像素中心换算)
+        std::vector<Level> trained;
+        cv::Mat image = golden;
+        for (int l = 0; l < levels; ++l)
+        {
+            if (l > 0) cv::pyrDown(image, image);
+            std::vector<cv::Point> points;
+            Level level;
+            ExtractFeatures(image, options.minContrast, options.maxFeatures, points, level.gradients);
+            if (static_cast<int>(points.size()) < kMinFeatures) break; // 这一层边缘太少，不再往上
+            const float scale = 1.0f / (1 << l);
+            const cv::Point2f origin((golden.cols - 1) * 0.5f + 0.5f, (golden.rows - 1) * 0.5f + 0.5f);
+            const cv::Point2f levelOrigin(origin.x * scale - 0.5f, origin.y * scale - 0.5f);
+            for (const cv::Point& p : points) level.points.emplace_back(p.x - levelOrigin.x, p.y - levelOrigin.y);
+            trained.push_back(level);
+        }
+        if (trained.empty()) return false;
+
+        m_options = options;
+        m_size = golden.size();
+        m_levels = trained;
+        return finishLevels();
+    }
+
+    bool ShapeModel::finishLevels()
+    {
+        for (Level& level : m_levels)
+        {
+            level.radius = 1.0f;
+            for (const cv::Point2f& p : level.points) level.radius = std::max(level.radius, std::sqrt(p.x * p.x + p.y * p.y));
+            level.angleStep = static_cast<float>(std::atan(1.0 / level.radius) * 180.0 / CV_PI);
+        }
+
+        // 最顶层所有角度的模板 (整圈时不重复终点)
+        m_topTemplates.clear();
+        const int top = levels() - 1;
+        const float step = m_levels[top].angleStep;
+        const bool fullCircle = m_options.angleExtent >= 360.0f;
+        const int count = std::max(1, static_cast<int>(std::floor(m_options.angleExtent / step)) + (fullCircle ? 0 : 1));
+        for (int k = 0; k < count; ++k)
+        {
+            ShapeTemplate t;
+            makeTemplate(top, m_options.angleStart + k * step, t);
+            m_topTemplates.push_back(std::move(t));
+        }
+        return true;
+    }
+
+    void ShapeModel::makeTemplate(int level, float angle, ShapeTemplate& t) const
+    {
+        const Level& lv = m_levels[level];
+        const double rad = angle * CV_PI / 180.0;
+        const float c = static_cast<float>(std::cos(rad)), s = static_cast<float>(std::sin(rad));
+        const size_t n = lv.points.size();
+        t.angle = angle;
+        t.dx.resize(n);
+        t.dy.resize(n);
+        t.gx.resize(n);
+        t.gy.resize(n);
+        t.minX = t.minY = 0;
+        t.maxX = t.maxY = 0;
+        for (size_t i = 0; i < n; ++i)
+        {
+            const cv::Point2f& p = lv.points[i];
+            const cv::Point2f& g = lv.gradients[i];
+            t.dx[i] = cvRound(c * p.x - s * p.y);
+            t.dy[i] = cvRound(s * p.x + c * p.y);
+            t.gx[i] = c * g.x - s * g.y;
+            t.gy[i] = s * g.x + c * g.y;
+            t.minX = std::min(t.minX, t.dx[i]);
+            t.maxX = std::max(t.maxX, t.dx[i]);
+            t.minY = std::min(t.minY, t.dy[i]);
+            t.maxY = std::max(t.maxY, t.dy[i]);
+        }
+    }
+
+    bool ShapeModel::save(const std::string& path) const
+    {
+        if (!isValid()) return false;
+        cv::FileStorage fs(path, cv::FileStorage::WRITE);
+        if (!fs.isOpened()) return false;
+        fs << "width" << m_size.width;
+        fs << "height" << m_size.height;
+        fs << "angleStart" << m_options.angleStart;
+        fs << "angleExtent" << m_options.angleExtent;
+        fs << "minContrast" << m_options.minContrast;
+        fs << "levels" << levels();
+        for (int l = 0; l < levels(); ++l)
+        {
+            // 每行一个特征点：x, y, gx, gy
+            const Level& level = m_levels[l];
+            cv::Mat features(static_cast<int>(level.points.size()), 4, CV_32F);
+            for (int i = 0; i < features.rows; ++i)
+            {
+                float* row = features.ptr<float>(i);
+                row[0] = level.points[i].x;
+                row[1] = level.points[i].y;
+                row[2] = level.gradients[i].x;
+                row[3] = level.gradients[i].y;
+            }
+            fs << ("level" + std::to_string(l)) << features;
+        }
+        return true;
+    }
+
+    bool ShapeModel::load(const std::string& path)
+    {
+        cv::FileStorage fs(path, cv::FileStorage::READ);
+        if (!fs.isOpened()) return false;
+
+        int width = 0, height = 0, count = 0;
+        ShapeModelOptions options;
+        fs["width"] >> width;
+        fs["height"] >> height;
+        fs["angleStart"] >> options.angleStart;
+        fs["angleExtent"] >> options.angleExtent;
+        fs["minContrast"] >> options.minContrast;
+        fs["levels"] >> count;
+        if (width <= 0 || height <= 0 || count <= 0 || count > kMaxLevels || options.angleExtent <= 0.0f) return false;
+
+        std::vector<Level> levels(count);
+        for (int l = 0; l < count; ++l)
+        {
+            cv::Mat features;
+            fs["level" + std::to_string(l)] >> features;
+            if (features.empty() || features.cols != 4 || features.type() != CV_32F) return false;
+            for (int i = 0; i < features.rows; ++i)
+            {
+                const float* row = features.ptr<float>(i);
+                levels[l].points.emplace_back(row[0], row[1]);
+                levels[l].gradients.emplace_back(row[2], row[3]);
+            }
+        }
+
+        options.numLevels = count;
+        m_options = options;
+        m_size = cv::Size(width, height);
+        m_levels = levels;
+        return finishLevels();
+    }
+
+    cv::RotatedRect ShapeModel::region(const PartPose& pose) const
+    {
+        return cv::RotatedRect(pose.position, cv::Size2f(static_cast<float>(m_size.width), static_cast<float>(m_size.height)), pose.angle);
+    }
+
+    bool ShapeModel::find(const cv::Mat& image, float minScore, PartPose& pose, float greediness) const
+    {
+        pose = PartPose();
+        if (!isValid() || image.empty() || image.type() != CV_8UC1) return false;
+        const int top = levels() - 1;
+        greediness = std::max(0.0f, std::min(1.0f, greediness));
+
+        // 1. 图像金字塔
+        std::vector<cv::Mat> pyramid(levels());
+        pyramid[0] = image;
+        for (int l = 1; l <= top; ++l) cv::pyrDown(pyramid[l - 1], pyramid[l]);
+
+        // 2. 最顶层：所有角度、所有位置 (阈值略低于 minScore：金字塔的平滑让得分偏低)
+        const float topMinScore = 0.9f * minScore;
+        GradientPlanes planes;
+        ComputeGradients(pyramid[top], cv::Rect(0, 0, pyramid[top].cols, pyramid[top].rows), m_options.minContrast, planes);
+        std::vector<Hypothesis> candidates;
+        for (const ShapeTemplate& t : m_topTemplates)
+        {
+            const int xMin = -t.minX, xMax = planes.gx.cols - 1 - t.maxX;
+            const int yMin = -t.minY, yMax = planes.gx.rows - 1 - t.maxY;
+            if (xMax - xMin < 3 || yMax < yMin) continue; // 模型比图像还大
+            for (int y = yMin; y <= yMax; ++y)
+            {
+                for (int x = xMin; x <= xMax; x += 4)
+                {
+                    const int x0 = std::min(x, xMax - 3); // 最后一组与前一组重叠，保证不越界
+                    float scores[4];
+                    if (!Score4(planes, t, x0, y, topMinScore, greediness, scores)) continue;
+                    for (int l = 0; l < 4; ++l) {
+                        if (scores[l] >= topMinScore) candidates.push_back({ scores[l], cv::Point2f(static_cast<float>(x0 + l), static_cast<float>(y)), t.angle });
+                    }
+                }
+            }
+        }
+
+        // 非极大值抑制：得分从高到低，离已保留的候选太近的舍去
+        std::sort(candidates.begin(), candidates.end(), [](const Hypothesis& a, const Hypothesis& b) { return a.score > b.score; });
+        std::vector<Hypothesis> kept;
+        const float minDistance = std::max(2.0f, 0.5f * m_levels[top].radius);
+        for (const Hypothesis& c : candidates)
+        {
+            bool near = false;
+            for (const Hypothesis& k : kept) {
+                if (std::hypot(c.position.x - k.position.x, c.position.y - k.position.y) < minDistance) { near = true; break; }
+            }
+            if (!near) kept.push_back(c);
+            if (static_cast<int>(kept.size()) >= kMaxCandidates) break;
+        }
+
+        // 3. 逐层细化：位置 ±kSearchRadius，角度为上一层步长的范围 (最顶层本身也细化一次，用于只有一层的模型)
+        Hypothesis best = { kNoScore, cv::Point2f(), 0.0f };
+        ShapeTemplate t;
+        for (Hypothesis hyp : kept)
+        {
+            float grid[2 * kSearchRadius + 1][2 * kSearchRadius + 1] = {};
+            float bestAngleScores[2] = { kNoScore, kNoScore }; // 最好角度两侧的得分 (亚像素角度插值)
+            for (int l = top; l >= 0; --l)
+            {
+                const Level& level = m_levels[l];
+                const cv::Point center = l < top
+                    ? cv::Point(cvRound(hyp.position.x * 2.0f + 0.5f), cvRound(hyp.position.y * 2.0f + 0.5f))
+                    : cv::Point(cvRound(hyp.position.x), cvRound(hyp.position.y));
+                const float range = l < top ? m_levels[l + 1].angleStep : level.angleStep;
+                const int halfAngles = std::max(1, static_cast<int>(std::ceil(range / level.angleStep)));
+
+                // 只在候选附近计算梯度
+                const int half = static_cast<int>(std::ceil(level.radius)) + kSearchRadius + 4;
+                ComputeGradients(pyramid[l], cv::Rect(center.x - half, center.y - half, 2 * half + 1, 2 * half + 1),
+                    m_options.minContrast, planes);
+                const cv::Point local = center - planes.offset;
+
+                Hypothesis levelBest = { kNoScore, cv::Point2f(), hyp.angle };
+                bool placed = false;
+                for (int a = -halfAngles; a <= halfAngles; ++a)
+                {
+                    makeTemplate(l, hyp.angle + a * level.angleStep, t);
+                    for (int dy = -kSearchRadius; dy <= kSearchRadius; ++dy)
+                    {
+                        for (int dx = -kSearchRadius; dx <= kSearchRadius; ++dx)
+                        {
+                            const float score = ScoreAt(planes, t, local.x + dx, local.y + dy);
+                            if (score > levelBest.score)
+                            {
+                                levelBest = { score, cv::Point2f(static_cast<float>(center.x + dx), static_cast<float>(center.y + dy)), t.angle };
+                                placed = true;
+                            }
+                        }
+                    }
+                }
+                if (!placed) { hyp.score = kNoScore; break; } // 模板超出图像
+
+                if (l == 0)
+                {
+                    // 最好角度下的 5x5 得分 (亚像素位置)，以及最好位置上相邻角度的得分 (亚像素角度)。
+                    // 单位梯度的得分在边缘两侧1~2个像素内几乎不变，这里改用带幅值的梯度
+                    ComputeGradients(pyramid[0], cv::Rect(center.x - half, center.y - half, 2 * half + 1, 2 * half + 1),
+                        m_options.minContrast, planes, false);
+                    makeTemplate(0, levelBest.angle, t);
+                    const cv::Point bestLocal = cv::Point(cvRound(levelBest.position.x), cvRound(levelBest.position.y)) - planes.offset;
+                    for (int dy = -kSearchRadius; dy <= kSearchRadius; ++dy)
+                        for (int dx = -kSearchRadius; dx <= kSearchRadius; ++dx)
+                            grid[dy + kSearchRadius][dx + kSearchRadius] = ScoreAt(planes, t, bestLocal.x + dx, bestLocal.y + dy);
+                    for (int side = 0; side < 2; ++side)
+                    {
+                        makeTemplate(0, levelBest.angle + (side == 0 ? -level.angleStep : level.angleStep), t);
+                        bestAngleScores[side] = ScoreAt(planes, t, bestLocal.x, bestLocal.y);
+                    }
+                }
+                hyp = levelBest;
+            }
+            if (hyp.score <= best.score) continue;
+
+            // 4. 亚像素：x、y 和角度各自用抛物线插值
+            const int c = kSearchRadius;
+            const float s0 = grid[c][c];
+            const float offsetX = ParabolaPeak(grid[c][c - 1], s0, grid[c][c + 1]);
+            const float offsetY = ParabolaPeak(grid[c - 1][c], s0, grid[c + 1][c]);
+            const float offsetAngle = ParabolaPeak(bestAngleScores[0], s0, bestAngleScores[1]);
+            best = hyp;
+            best.position += cv::Point2f(offsetX, offsetY);
+            best.angle += offsetAngle * m_levels[0].angleStep;
+        }
+
+        if (best.score < minScore) return false;
+        pose.found = true;
+        pose.position = best.position;
+        pose.angle = best.angle > 180.0f ? best.angle - 360.0f : (best.angle <= -180.0f ? best.angle + 360.0f : best.angle);
+        pose.score = best.score;
+        return true;
+    }
+
+} // namespace InspectorLib
@@ -0,0 +1,112 @@
+﻿// ShapeModel.h (基于形状的模板匹配：金字塔上的梯度方向模板，由粗到精搜索零件的位置和角度)
+
+#ifndef INSPECTOR_SHAPEMODEL_H
+#define INSPECTOR_SHAPEMODEL_H
+
+#include "Inspector.h" // INSPECTOR_API、PartPose
+
+#include <string>
+#include <vector>
+
+namespace InspectorLib
+{
+    /**
+     * @brief 训练参数。
+     */
+    struct ShapeModelOptions
+    {
+        int numLevels = 0;           // 金字塔层数，0 为自动 (最顶层模型的短边不少于 ShapeModel::kMinTopSize 像素)
+        float angleStart = -180.0f;  // 搜索的角度范围 (度)
+        float angleExtent = 360.0f;
+        float minContrast = 10.0f;   // 特征点的最小灰度跳变 (8位灰度)；搜索时更弱的梯度视为没有边缘
+        int maxFeatures = 200;       // 每层最多的特征点数 (超出时均匀抽取)
+    };
+
+    /**
+     * @brief 一个角度下的模板：特征点相对模型原点的整数偏移和单位梯度方向 (SoA)。
+     */
+    struct ShapeTemplate
+    {
+        float angle = 0.0f;
+        std::vector<int> dx, dy;
+        std::vector<float> gx, gy;
+        int minX = 0, maxX = 0, minY = 0, maxY = 0; // 偏移的范围，用于确定搜索时模板完整落在图像内的位置
+    };
+
+    /**
+     * @brief 基于形状的零件定位模型。
+     *
+     * @details 训练时在金板图像 (golden image) 的每一层金字塔上提取边缘点 (梯度幅值的非极大值抑制)，
+     * 记录它们相对模型中心的位置和梯度方向。相似度是模型梯度与图像梯度 (都归一化为单位向量) 的点积平均值，
+     * 只依赖边缘的方向，不受光照强弱、背景杂物和局部遮挡的影响，这是“最大的顶层轮廓就是零件”做不到的。
+     *
+     * 搜索由粗到精：
+     *  1. 在最顶层 (最小的图像) 上，对所有角度、所有位置打分 (SSE2 一次算一行上相邻的4个位置)，
+     *     部分和已经不可能 (或按 greediness 不太可能) 达到阈值时提前终止；
+     *  2. 得分最高的几个候选逐层向下，在上一层位置的 ±2 像素、上一层角度步长的范围内细化，
+     *     下面几层只在候选附近计算梯度；
+     *  3. 最底层用抛物线插值得到亚像素的位置和角度。
+     *
+     * 训练之后对象只读，可以被多个测量线程共享。模型与搜索图像的分辨率必须相同
+     * (例如 Bayer 半分辨率检测时，金板也应该是半分辨率的预览图)。
+     */
+    class INSPECTOR_API ShapeModel
+    {
+    public:
+        static const int kMaxLevels = 6;
+        static const int kMinTopSize = 24;   // 自动层数时，最顶层模型短边的最小像素数
+        static const int kMinFeatures = 12;  // 每层至少的特征点数，不足时不再增加层数
+        static const int kMaxCandidates = 8; // 从最顶层向下细化的候选数
+
+        /**
+         * @brief 由金板图像训练 (CV_8UC1，零件位于图像中央，模型原点为图像中心)。
+         * @return 图像为空或找不到足够的边缘时返回 false。
+         */
+        bool train(const cv::Mat& golden, const ShapeModelOptions& options = ShapeModelOptions());
+
+        /**
+         * @brief 保存/加载模型 (OpenCV YAML 格式，保存每层角度为0的特征点，其余在加载时重新生成)。
+         */
+        bool save(const std::string& path) const;
+        bool load(const std::string& path);
+
+        bool isValid() const { return !m_levels.empty(); }
+        cv::Size size() const { return m_size; }
+        int levels() const { return static_cast<int>(m_levels.size()); }
+
+        /**
+         * @brief 在图像 (CV_8UC1) 中查找模型。
+         * @param minScore 相似度阈值 (0 ~ 1)，低于它视为没有找到。
+         * @param greediness 提前终止的激进程度 (0 ~ 1)：0 只在数学上不可能达到阈值时终止，
+         *        1 假设剩余特征点的得分不超过阈值，最快但可能漏掉部分被遮挡的零件。
+         * @return 是否找到；pose.found 与返回值相同。
+         */
+        bool find(const cv::Mat& image, float minScore, PartPose& pose, float greediness = 0.8f) const;
+
+        /**
+         * @brief 模型区域 (金板图像的矩形) 在搜索图像中的位置。
+         */
+        cv::RotatedRect region(const PartPose& pose) const;
+
+    private:
+        // 一层金字塔上的模型 (角度为0)
+        struct Level
+        {
+            std::vector<cv::Point2f> points;    // 相对模型原点的位置 (本层像素)
+            std::vector<cv::Point2f> gradients; // 单位梯度方向
+            float radius = 0.0f;                // 特征点到原点的最大距离
+            float angleStep = 0.0f;             // 角度步长 (度)：最远的特征点移动约1个像素
+        };
+
+        void makeTemplate(int level, float angle, ShapeTemplate& t) const;
+        bool finishLevels(); // 计算半径和角度步长，生成最顶层所有角度的模板
+
+        ShapeModelOptions m_options;
+        cv::Size m_size;                        // 金板图像尺寸
+        std::vector<Level> m_levels;            // 第0层为原始分辨率
+        std::vector<ShapeTemplate> m_topTemplates; // 最顶层所有角度的模板 (训练时生成，搜索时直接使用)
+    };
+
+} // namespace InspectorLib
+
+#endif // INSPECTOR_SHAPEMODEL_H
@@ -0,0 +1,22 @@
+﻿// Simd.h (内部头文件，不导出：SIMD 指令集检测，供各个内核的 .cpp 包含)
+
+#ifndef INSPECTOR_SIMD_H
+#define INSPECTOR_SIMD_H
+
+// 解释: MSVC 在 x64 下总是支持 SSE2，但不会定义 __SSE2__；SSSE3 只有在 /arch:AVX 及以上时才会开启 (__AVX__)。
+//       AVX2 需要 CMakeLists 中的 INSPECTOR_ENABLE_AVX2 (-mavx2 或 /arch:AVX2)。
+//       每个内核都要保留标量的退路：宏没有定义时结果必须相同。
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define INSPECTOR_SSE2 1
+#include <emmintrin.h>
+#endif
+#if defined(INSPECTOR_SSE2) && (defined(__SSSE3__) || defined(__AVX__))
+#define INSPECTOR_SSSE3 1
+#include <tmmintrin.h>
+#endif
+#if defined(__AVX2__)
+#define INSPECTOR_AVX2 1
+#include <immintrin.h>
+#endif
+
+#endif // INSPECTOR_SIMD_H
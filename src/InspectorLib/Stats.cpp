@@ -0,0 +1,369 @@
+﻿// Stats.cpp
+
+#include "Stats.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <utility>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace InspectorLib
+{
+    // --- 辅助函数 ---
+    namespace
+    {
+        // 64位整数的前导零个数 (value 不为0)
+        int CountLeadingZeros(uint64_t value)
+        {
+#ifdef _MSC_VER
+            unsigned long index;
+            _BitScanReverse64(&index, value);
+            return 63 - static_cast<int>(index);
+#else
+            return __builtin_clzll(value);
+#endif
+        }
+
+        // 覆盖 [0, kHighestTrackableNs] 需要多少个2的幂次区间
+        int ComputeBucketCount()
+        {
+            int64_t smallestUntrackable = LatencyHistogram::kSubBucketCount;
+            int buckets = 1;
+            while (smallestUntrackable <= LatencyHistogram::kHighestTrackableNs)
+            {
+                smallestUntrackable <<= 1;
+                ++buckets;
+            }
+            return buckets;
+        }
+
+        // 单线程写、多线程读的计数：写线程用 load + store 代替原子加法，避免总线锁；读线程不会读到撕裂的值
+        inline void SingleWriterAdd(std::atomic<uint64_t>& target, uint64_t delta)
+        {
+            target.store(target.load(std::memory_order_relaxed) + delta, std::memory_order_relaxed);
+        }
+    }
+
+    const int LatencyHistogram::kBucketCount = ComputeBucketCount();
+    const int LatencyHistogram::kCountsLength = (LatencyHistogram::kBucketCount + 1) * static_cast<int>(LatencyHistogram::kSubBucketHalfCount);
+
+    // =====================================================================
+    //  LatencyHistogram
+    // =====================================================================
+
+    LatencyHistogram::LatencyHistogram()
+        : m_counts(static_cast<size_t>(kCountsLength), 0)
+    {
+    }
+
+    int LatencyHistogram::countsIndex(int64_t valueNs)
+    {
+        const uint64_t value = static_cast<uint64_t>(std::min(std::max<int64_t>(valueNs, 0), kHighestTrackableNs));
+
+        // a. 所在的2的幂次区间 (前 kSubBucketCount 个值都落在第0段)
+        const int leadingZeroCountBase = 64 - kSubBucketHalfCountMagnitude - 1;
+        const int bucketIndex = leadingZeroCountBase - CountLeadingZeros(value | static_cast<uint64_t>(kSubBucketCount - 1));
+        // b. 段内的线性位置：第0段用满 [0, kSubBucketCount)，其余各段只用上半部分 [kSubBucketHalfCount, kSubBucketCount)
+        const int subBucketIndex = static_cast<int>(value >> bucketIndex);
+        return ((bucketIndex + 1) << kSubBucketHalfCountMagnitude) + (subBucketIndex - static_cast<int>(kSubBucketHalfCount));
+    }
+
+    int64_t LatencyHistogram::lowestValueAt(int index)
+    {
+        int bucketIndex = (index >> kSubBucketHalfCountMagnitude) - 1;
+        int subBucketIndex = (index & static_cast<int>(kSubBucketHalfCount - 1)) + static_cast<int>(kSubBucketHalfCount);
+        if (bucketIndex < 0) {
+            subBucketIndex -= static_cast<int>(kSubBucketHalfCount);
+            bucketIndex = 0;
+        }
+        return static_cast<int64_t>(subBucketIndex) << bucketIndex;
+    }
+
+    int64_t LatencyHistogram::highestValueAt(int index)
+    {
+        const int bucketIndex = std::max((index >> kSubBucketHalfCountMagnitude) - 1, 0);
+        return lowestValueAt(index) + (static_cast<int64_t>(1) << bucketIndex) - 1;
+    }
+
+    void LatencyHistogram::record(int64_t valueNs, uint64_t count)
+    {
+        if (count == 0) return;
+        m_counts[static_cast<size_t>(countsIndex(valueNs))] += count;
+        m_totalCount += count;
+        m_minNs = std::min(m_minNs, valueNs);
+        m_maxNs = std::max(m_maxNs, valueNs);
+    }
+
+    void LatencyHistogram::merge(const LatencyHistogram& other)
+    {
+        for (size_t i = 0; i < m_counts.size(); ++i) {
+            m_counts[i] += other.m_counts[i];
+        }
+        m_totalCount += other.m_totalCount;
+        m_minNs = std::min(m_minNs, other.m_minNs);
+        m_maxNs = std::max(m_maxNs, other.m_maxNs);
+    }
+
+    void LatencyHistogram::reset()
+    {
+        std::fill(m_counts.begin(), m_counts.end(), 0);
+        m_totalCount = 0;
+        m_minNs = INT64_MAX;
+        m_maxNs = 0;
+    }
+
+    double LatencyHistogram::meanNs() const
+    {
+        if (m_totalCount == 0) return 0.0;
+
+        // 用每个桶的中点近似该桶内所有样本的值
+        double sum = 0.0;
+        for (int i = 0; i < kCountsLength; ++i)
+        {
+            if (m_counts[i] != 0) {
+                sum += m_counts[i] * 0.5 * (lowestValueAt(i) + highestValueAt(i));
+            }
+        }
+        return sum / m_totalCount;
+    }
+
+    int64_t LatencyHistogram::valueAtPercentile(double percentile) const
+    {
+        if (m_totalCount == 0) return 0;
+
+        const double clamped = std::min(std::max(percentile, 0.0), 100.0);
+        const uint64_t target = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(clamped / 100.0 * m_totalCount)));
+
+        uint64_t cumulative = 0;
+        for (int i = 0; i < kCountsLength; ++i)
+        {
+            cumulative += m_counts[i];
+            if (cumulative >= target) {
+                // 桶的上界可能超过实际出现过的最大值，以实际最大值为准
+                return std::min(highestValueAt(i), m_maxNs);
+            }
+        }
+        return m_maxNs;
+    }
+
+    // =====================================================================
+    //  Stats
+    // =====================================================================
+
+    // 一个线程的分片：每个统计项 (阶段/结果/总耗时) 一组计数，第一次记录时才分配
+    struct Stats::Shard
+    {
+        struct Slot
+        {
+            std::unique_ptr<std::atomic<uint64_t>[]> counts;
+            std::atomic<uint64_t> total{ 0 };
+            std::atomic<int64_t> minNs{ INT64_MAX };
+            std::atomic<int64_t> maxNs{ 0 };
+
+            Slot() : counts(new std::atomic<uint64_t>[LatencyHistogram::kCountsLength])
+            {
+                for (int i = 0; i < LatencyHistogram::kCountsLength; ++i) {
+                    counts[i].store(0, std::memory_order_relaxed);
+                }
+            }
+        };
+
+        std::atomic<Slot*> slots[kSlotCount];
+
+        Shard()
+        {
+            for (std::atomic<Slot*>& slot : slots) slot.store(nullptr, std::memory_order_relaxed);
+        }
+        ~Shard()
+        {
+            for (std::atomic<Slot*>& slot : slots) delete slot.load(std::memory_order_relaxed);
+        }
+
+        // 只会被拥有这个分片的线程调用
+        void record(int index, int64_t valueNs)
+        {
+            Slot* slot = slots[index].load(std::memory_order_acquire);
+            if (slot == nullptr)
+            {
+                slot = new Slot();
+                slots[index].store(slot, std::memory_order_release);
+            }
+            SingleWriterAdd(slot->counts[LatencyHistogram::countsIndex(valueNs)], 1);
+            SingleWriterAdd(slot->total, 1);
+            if (valueNs < slot->minNs.load(std::memory_order_relaxed)) slot->minNs.store(valueNs, std::memory_order_relaxed);
+            if (valueNs > slot->maxNs.load(std::memory_order_relaxed)) slot->maxNs.store(valueNs, std::memory_order_relaxed);
+        }
+    };
+
+    namespace
+    {
+        std::atomic<uint64_t> g_nextStatsId{ 1 };
+    }
+
+    Stats::Stats()
+        : m_id(g_nextStatsId.fetch_add(1))
+    {
+    }
+
+    Stats::~Stats()
+    {
+    }
+
+    Stats& Stats::Global()
+    {
+        static Stats stats;
+        return stats;
+    }
+
+    int Stats::slotForOutcome(uint32_t status)
+    {
+        return Stage_Count + static_cast<int>(std::min<uint32_t>(status, kMaxOutcomes - 1));
+    }
+
+    Stats::Shard& Stats::localShard()
+    {
+        // 线程局部缓存：(Stats 编号, 分片)。编号永不复用，已销毁的 Stats 留下的条目不会被误用。
+        thread_local std::vector<std::pair<uint64_t, Shard*>> cache;
+        for (const auto& entry : cache)
+        {
+            if (entry.first == m_id) return *entry.second;
+        }
+
+        // 这个线程第一次记录到本对象：创建分片 (只在此时加锁)
+        Shard* shard = new Shard();
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_shards.emplace_back(shard);
+        }
+        cache.emplace_back(m_id, shard);
+        return *shard;
+    }
+
+    void Stats::record(uint32_t status, const StageTiming& timing, int64_t totalNs)
+    {
+        Shard& shard = localShard();
+        for (int i = 0; i < Stage_Count; ++i)
+        {
+            if (timing.endNs[i] != 0) {
+                shard.record(slotForStage(static_cast<InspectStage>(i)), timing.durationNs(static_cast<InspectStage>(i)));
+            }
+        }
+        shard.record(slotForOutcome(status), totalNs);
+        shard.record(slotForTotal(), totalNs);
+    }
+
+    LatencyHistogram Stats::mergeSlot(int index) const
+    {
+        LatencyHistogram merged;
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (const std::unique_ptr<Shard>& shard : m_shards)
+        {
+            const Shard::Slot* slot = shard->slots[index].load(std::memory_order_acquire);
+            if (slot == nullptr) continue;
+
+            uint64_t total = 0;
+            for (int i = 0; i < LatencyHistogram::kCountsLength; ++i)
+            {
+                const uint64_t count = slot->counts[i].load(std::memory_order_relaxed);
+                merged.m_counts[static_cast<size_t>(i)] += count;
+                total += count;
+            }
+            // 总数按实际合并的计数累加，写线程同时在记录时也能保持自洽
+            merged.m_totalCount += total;
+            if (total != 0)
+            {
+                merged.m_minNs = std::min(merged.m_minNs, slot->minNs.load(std::memory_order_relaxed));
+                merged.m_maxNs = std::max(merged.m_maxNs, slot->maxNs.load(std::memory_order_relaxed));
+            }
+        }
+        return merged;
+    }
+
+    LatencyHistogram Stats::stageHistogram(InspectStage stage) const
+    {
+        if (stage < 0 || stage >= Stage_Count) return LatencyHistogram();
+        return mergeSlot(slotForStage(stage));
+    }
+
+    LatencyHistogram Stats::outcomeHistogram(uint32_t status) const
+    {
+        return mergeSlot(slotForOutcome(status));
+    }
+
+    LatencyHistogram Stats::totalHistogram() const
+    {
+        return mergeSlot(slotForTotal());
+    }
+
+    std::vector<uint32_t> Stats::observedOutcomes() const
+    {
+        std::vector<uint32_t> outcomes;
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (uint32_t status = 0; status < kMaxOutcomes; ++status)
+        {
+            const int index = slotForOutcome(status);
+            for (const std::unique_ptr<Shard>& shard : m_shards)
+            {
+                const Shard::Slot* slot = shard->slots[index].load(std::memory_order_acquire);
+                if (slot != nullptr && slot->total.load(std::memory_order_relaxed) != 0) {
+                    outcomes.push_back(status);
+                    break;
+                }
+            }
+        }
+        return outcomes;
+    }
+
+    void Stats::reset()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (const std::unique_ptr<Shard>& shard : m_shards)
+        {
+            for (std::atomic<Shard::Slot*>& cell : shard->slots)
+            {
+                Shard::Slot* slot = cell.load(std::memory_order_acquire);
+                if (slot == nullptr) continue;
+                for (int i = 0; i < LatencyHistogram::kCountsLength; ++i) {
+                    slot->counts[i].store(0, std::memory_order_relaxed);
+                }
+                slot->total.store(0, std::memory_order_relaxed);
+                slot->minNs.store(INT64_MAX, std::memory_order_relaxed);
+                slot->maxNs.store(0, std::memory_order_relaxed);
+            }
+        }
+    }
+
+    std::string Stats::summary() const
+    {
+        std::string text;
+        char line[256];
+        auto appendRow = [&text, &line](const std::string& name, const LatencyHistogram& h) {
+            std::snprintf(line, sizeof(line), "%-22s %10llu %9.3f %9.3f %9.3f %9.3f %9.3f %9.3f\n",
+                          name.c_str(), static_cast<unsigned long long>(h.totalCount()),
+                          h.meanNs() * 1e-6, h.valueAtPercentile(50.0) * 1e-6, h.valueAtPercentile(90.0) * 1e-6,
+                          h.valueAtPercentile(99.0) * 1e-6, h.valueAtPercentile(99.9) * 1e-6, h.maxNs() * 1e-6);
+            text += line;
+        };
+
+        std::snprintf(line, sizeof(line), "%-22s %10s %9s %9s %9s %9s %9s %9s\n",
+                      "latency (ms)", "count", "mean", "p50", "p90", "p99", "p99.9", "max");
+        text += line;
+
+        for (int i = 0; i < Stage_Count; ++i)
+        {
+            const InspectStage stage = static_cast<InspectStage>(i);
+            appendRow(std::string("stage/") + StageName(stage), stageHistogram(stage));
+        }
+        for (uint32_t status : observedOutcomes())
+        {
+            appendRow(std::string("outcome/") + StatusName(status), outcomeHistogram(status));
+        }
+        appendRow("total", totalHistogram());
+        return text;
+    }
+
+} // namespace InspectorLib
@@ -0,0 +1,141 @@
+﻿// Stats.h (检测耗时统计：HDR 直方图)
+
+#ifndef INSPECTOR_STATS_H
+#define INSPECTOR_STATS_H
+
+#include "Inspector.h" // INSPECTOR_API、InspectStage、StageTiming
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace InspectorLib
+{
+    /**
+     * @brief HDR (高动态范围) 耗时直方图，单位为纳秒。
+     *
+     * @details 采用“对数分段 + 段内线性”的分桶方式：每个2的幂次区间被均分为 kSubBucketHalfCount 个桶，
+     * 因此任何数值的相对误差都不超过 1/kSubBucketHalfCount (约0.8%)，
+     * 而内存是固定的 (与样本数量无关)，可以记录数百万个零件的耗时并查询 p99.9 这样的尾部延迟。
+     *
+     * 可记录的范围是 1ns ~ kHighestTrackableNs，更大的值按最大值记录。
+     * 这个类本身不是线程安全的，它是 Stats 查询时返回的合并快照。
+     */
+    class INSPECTOR_API LatencyHistogram
+    {
+    public:
+        static const int kSubBucketHalfCountMagnitude = 7;                        // 段内精度: 2^7 = 128
+        static const int64_t kSubBucketHalfCount = 1 << kSubBucketHalfCountMagnitude;
+        static const int64_t kSubBucketCount = kSubBucketHalfCount * 2;
+        static const int64_t kHighestTrackableNs = 60LL * 1000 * 1000 * 1000;     // 60秒
+        static const int kBucketCount;                                           // 2的幂次区间数 (由最大值推算)
+        static const int kCountsLength;                                          // 计数数组的长度
+
+        LatencyHistogram();
+
+        void record(int64_t valueNs, uint64_t count = 1);
+        void merge(const LatencyHistogram& other);
+        void reset();
+
+        uint64_t totalCount() const { return m_totalCount; }
+        int64_t minNs() const { return m_totalCount ? m_minNs : 0; }
+        int64_t maxNs() const { return m_maxNs; }
+        double meanNs() const;
+
+        /**
+         * @brief 查询百分位数 (例如 99.9 表示 p99.9)，没有样本时返回0。
+         * @details 返回值是样本所在桶的上界，即“不超过这个值的样本至少占 percentile%”。
+         */
+        int64_t valueAtPercentile(double percentile) const;
+
+        // --- 分桶换算 (Stats 内部的分片也使用同样的布局) ---
+        static int countsIndex(int64_t valueNs);
+        static int64_t lowestValueAt(int index);
+        static int64_t highestValueAt(int index);
+
+    private:
+        friend class Stats;
+
+        std::vector<uint64_t> m_counts;
+        uint64_t m_totalCount = 0;
+        int64_t m_minNs = INT64_MAX;
+        int64_t m_maxNs = 0;
+    };
+
+    /**
+     * @class Stats
+     * @brief 按阶段和按结果(状态码)统计 InspectPart 的耗时分布。
+     *
+     * @details 【关键】每个记录线程都有自己的分片 (shard)，记录时只写本线程的分片，不加锁、没有竞争；
+     * 查询时把所有分片合并成一个 LatencyHistogram 快照。线程退出后它的分片仍然保留，数据不会丢失。
+     *
+     * InspectPart 每次调用都会记入 Stats::Global()；基准测试等需要独立统计的场景可以自己创建 Stats 对象，
+     * 再用 record() 记入 MeasurementResults::timing。
+     *
+     * 结果按状态码分类：0 为成功，其余为 InspectPart 的各个错误码；
+     * 不小于 kMaxOutcomes 的状态码合并记在最后一个分类中。
+     */
+    class INSPECTOR_API Stats
+    {
+    public:
+        static const int kMaxOutcomes = 16;
+
+        Stats();
+        ~Stats();
+
+        Stats(const Stats&) = delete;
+        Stats& operator=(const Stats&) = delete;
+
+        /**
+         * @brief 进程内共享的统计对象，InspectPart 的每一次调用都会记入这里。
+         */
+        static Stats& Global();
+
+        /**
+         * @brief 记录一次检测：各阶段耗时 (只记录实际执行过的阶段)，以及按状态码分类的总耗时。
+         * @details 可以从任意线程调用。
+         */
+        void record(uint32_t status, const StageTiming& timing, int64_t totalNs);
+
+        // --- 查询 (可以从任意线程调用，返回调用时刻的合并快照) ---
+        LatencyHistogram stageHistogram(InspectStage stage) const;
+        LatencyHistogram outcomeHistogram(uint32_t status) const;
+        LatencyHistogram totalHistogram() const;   // 不区分结果的总耗时
+
+        /**
+         * @brief 出现过的状态码 (升序)，用于遍历 outcomeHistogram()。
+         */
+        std::vector<uint32_t> observedOutcomes() const;
+
+        /**
+         * @brief 清空统计。与 record() 并发调用时，正在记录的样本可能部分丢失。
+         */
+        void reset();
+
+        /**
+         * @brief 生成一张文本表格 (次数、平均值、p50/p90/p99/p99.9、最大值，单位毫秒)，用于命令行输出。
+         */
+        std::string summary() const;
+
+    private:
+        struct Shard;
+
+        Shard& localShard();
+        LatencyHistogram mergeSlot(int slot) const;
+
+        static int slotForStage(InspectStage stage) { return stage; }
+        static int slotForOutcome(uint32_t status);
+        static int slotForTotal() { return Stage_Count + kMaxOutcomes; }
+        static const int kSlotCount = Stage_Count + kMaxOutcomes + 1;
+
+        const uint64_t m_id;                           // 全局唯一编号，线程局部缓存据此找到本对象的分片
+        mutable std::mutex m_mutex;                    // 只保护分片列表本身，不保护分片内的计数
+        std::vector<std::unique_ptr<Shard>> m_shards;  // 所有线程的分片
+    };
+
+} // namespace InspectorLib
+
+#endif // INSPECTOR_STATS_H
@@ -0,0 +1,316 @@
+// LogDecoder.cpp (二进制日志 .plog 的离线解码工具)
+
+// 用法:
+//   LogDecoder [--sort] <file1.plog> [file2.plog ...]
+//
+//   把 BinaryLogSink 写出的二进制日志还原为与 LogWidget 相同格式的文本，输出到标准输出。
+//   --sort  按时间戳对所有记录排序后再输出（多个线程的记录在文件中是按批次交错存放的）。
+
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "../InspectorGUI/Core/BinaryLogFormat.h"
+
+using namespace std;
+
+// --- 1. 解码后的参数和记录 ---
+struct DecodedArg
+{
+    uint8_t tag = 0;
+    int64_t i = 0;
+    uint64_t u = 0;
+    double d = 0.0;
+    string s;
+};
+
+struct DecodedRecord
+{
+    int64_t timestampNs = 0;
+    uint8_t level = 0;
+    uint32_t threadId = 0;
+    string text;
+};
+
+// --- 2. 辅助函数 ---
+
+/**
+ * @brief 从字节流中安全地读取一个定长值，越界时返回 false。
+ */
+template<typename T>
+bool readValue(const vector<char>& data, size_t& pos, size_t end, T& value)
+{
+    if (pos + sizeof(T) > end) return false;
+    memcpy(&value, data.data() + pos, sizeof(T));
+    pos += sizeof(T);
+    return true;
+}
+
+/**
+ * @brief 把时间戳渲染为 "yyyy-MM-dd hh:mm:ss.zzz" (本地时间)，与 LogManager 的文本格式一致。
+ */
+string formatTimestamp(int64_t timestampNs)
+{
+    const time_t seconds = static_cast<time_t>(timestampNs / 1000000000);
+    const int millis = static_cast<int>((timestampNs / 1000000) % 1000);
+    tm local {};
+#ifdef _WIN32
+    localtime_s(&local, &seconds);
+#else
+    localtime_r(&seconds, &local);
+#endif
+    char buffer[64];
+    size_t n = strftime(buffer, sizeof(buffer), "%Y-%m-%d %H:%M:%S", &local);
+    snprintf(buffer + n, sizeof(buffer) - n, ".%03d", millis);
+    return buffer;
+}
+
+const char* levelLabel(uint8_t level)
+{
+    switch (level) {
+    case BinaryLog::Level_Debug:    return "[DEBUG]   ";
+    case BinaryLog::Level_Info:     return "[INFO]    ";
+    case BinaryLog::Level_Warning:  return "[WARNING] ";
+    case BinaryLog::Level_Critical: return "[CRITICAL]";
+    case BinaryLog::Level_Fatal:    return "[FATAL]   ";
+    default:                        return "[?]       ";
+    }
+}
+
+/**
+ * @brief 按 printf 语义渲染一个格式字符串。
+ * @details 参数的真实类型来自记录中的类型标签，因此会根据标签调整长度修饰符
+ * (例如格式中写的是 %d 而参数是 64 位整数)，保证不会因类型不匹配而读错内存。
+ */
+string renderFormat(const string& format, const vector<DecodedArg>& args)
+{
+    string out;
+    size_t argIndex = 0;
+    char buffer[512];
+
+    for (size_t i = 0; i < format.size(); ++i)
+    {
+        if (format[i] != '%') {
+            out += format[i];
+            continue;
+        }
+        if (i + 1 < format.size() && format[i + 1] == '%') {
+            out += '%';
+            ++i;
+            continue;
+        }
+
+        // a. 解析 "%[flags][width][.precision][length]conversion"
+        size_t j = i + 1;
+        string spec = "%";
+        while (j < format.size() && strchr("-+ #0", format[j])) spec += format[j++];
+        while (j < format.size() && isdigit(static_cast<unsigned char>(format[j]))) spec += format[j++];
+        if (j < format.size() && format[j] == '.') {
+            spec += format[j++];
+            while (j < format.size() && isdigit(static_cast<unsigned char>(format[j]))) spec += format[j++];
+        }
+        while (j < format.size() && strchr("hlLqjzt", format[j])) ++j; // 长度修饰符由参数类型决定，这里丢弃
+        if (j >= format.size()) {
+            out += format.substr(i);
+            break;
+        }
+        const char conversion = format[j];
+        i = j;
+
+        if (argIndex >= args.size()) {
+            out += "<missing>";
+            continue;
+        }
+        const DecodedArg& arg = args[argIndex++];
+
+        // b. 按转换字符和参数的真实类型进行渲染
+        if (conversion == 's') {
+            if (arg.tag == BinaryLog::Arg_String) {
+                snprintf(buffer, sizeof(buffer), (spec + "s").c_str(), arg.s.c_str());
+            } else if (arg.tag == BinaryLog::Arg_Double) {
+                snprintf(buffer, sizeof(buffer), "%g", arg.d);
+            } else if (arg.tag == BinaryLog::Arg_Int64) {
+                snprintf(buffer, sizeof(buffer), "%lld", static_cast<long long>(arg.i));
+            } else {
+                snprintf(buffer, sizeof(buffer), "%llu", static_cast<unsigned long long>(arg.u));
+            }
+        } else if (strchr("fFeEgGaA", conversion)) {
+            double value = arg.tag == BinaryLog::Arg_Double ? arg.d
+                         : arg.tag == BinaryLog::Arg_Int64  ? static_cast<double>(arg.i)
+                         : static_cast<double>(arg.u);
+            snprintf(buffer, sizeof(buffer), (spec + conversion).c_str(), value);
+        } else if (strchr("diuoxXcp", conversion)) {
+            if (arg.tag == BinaryLog::Arg_String) {
+                snprintf(buffer, sizeof(buffer), "%s", arg.s.c_str());
+            } else if (conversion == 'c') {
+                snprintf(buffer, sizeof(buffer), (spec + 'c').c_str(), static_cast<int>(arg.tag == BinaryLog::Arg_Int64 ? arg.i : arg.u));
+            } else if (conversion == 'p') {
+                snprintf(buffer, sizeof(buffer), "0x%llx", static_cast<unsigned long long>(arg.tag == BinaryLog::Arg_Int64 ? arg.i : arg.u));
+            } else if (conversion == 'd' || conversion == 'i') {
+                long long value = arg.tag == BinaryLog::Arg_Double ? static_cast<long long>(arg.d)
+                                : arg.tag == BinaryLog::Arg_Int64  ? static_cast<long long>(arg.i)
+                                : static_cast<long long>(arg.u);
+                snprintf(buffer, sizeof(buffer), (spec + "ll" + conversion).c_str(), value);
+            } else {
+                unsigned long long value = arg.tag == BinaryLog::Arg_Double ? static_cast<unsigned long long>(arg.d)
+                                         : arg.tag == BinaryLog::Arg_Int64  ? static_cast<unsigned long long>(arg.i)
+                                         : static_cast<unsigned long long>(arg.u);
+                snprintf(buffer, sizeof(buffer), (spec + "ll" + conversion).c_str(), value);
+            }
+        } else {
+            snprintf(buffer, sizeof(buffer), "<bad conversion '%c'>", conversion);
+        }
+        out += buffer;
+    }
+    return out;
+}
+
+/**
+ * @brief 解码一个 .plog 文件，把其中的记录追加到 records 中。
+ * @return 文件头无效时返回 false。
+ */
+bool decodeFile(const string& path, vector<DecodedRecord>& records)
+{
+    ifstream file(path, ios::binary);
+    if (!file) {
+        cerr << "!!! Cannot open file: " << path << endl;
+        return false;
+    }
+    vector<char> data((istreambuf_iterator<char>(file)), istreambuf_iterator<char>());
+
+    // a. 校验文件头
+    BinaryLog::FileHeader header;
+    size_t pos = 0;
+    if (!readValue(data, pos, data.size(), header) ||
+        memcmp(header.magic, BinaryLog::kFileMagic, sizeof(header.magic)) != 0) {
+        cerr << "!!! Not a PartInspector binary log: " << path << endl;
+        return false;
+    }
+    if (header.version != BinaryLog::kFileVersion) {
+        cerr << "!!! Unsupported log version " << header.version << " in " << path << endl;
+        return false;
+    }
+
+    // b. 逐条解码。每个文件都携带完整的格式字典，所以文件之间互不依赖。
+    map<uint32_t, string> formats;
+    while (pos < data.size())
+    {
+        BinaryLog::RecordHeader record;
+        if (!readValue(data, pos, data.size(), record)) break;
+        const size_t end = pos + record.payloadSize;
+        if (end > data.size()) {
+            cerr << "!!! Truncated record at end of " << path << endl; // 程序异常退出时最后一批数据可能不完整
+            break;
+        }
+
+        if (record.type == BinaryLog::Record_Format)
+        {
+            uint32_t id = 0;
+            readValue(data, pos, end, id);
+            formats[id] = string(data.data() + pos, end - pos);
+        }
+        else if (record.type == BinaryLog::Record_Event)
+        {
+            BinaryLog::EventHeader event;
+            if (!readValue(data, pos, end, event)) break;
+
+            vector<DecodedArg> args;
+            for (uint16_t k = 0; k < record.argCount && pos < end; ++k)
+            {
+                DecodedArg arg;
+                readValue(data, pos, end, arg.tag);
+                switch (arg.tag) {
+                case BinaryLog::Arg_Int64:  readValue(data, pos, end, arg.i); break;
+                case BinaryLog::Arg_UInt64: readValue(data, pos, end, arg.u); break;
+                case BinaryLog::Arg_Double: readValue(data, pos, end, arg.d); break;
+                case BinaryLog::Arg_String: {
+                    uint16_t length = 0;
+                    readValue(data, pos, end, length);
+                    const size_t available = min<size_t>(length, end - pos);
+                    arg.s.assign(data.data() + pos, available);
+                    pos += available;
+                    break;
+                }
+                default:
+                    pos = end; // 未知标签，放弃这条记录剩余的参数
+                    break;
+                }
+                args.push_back(arg);
+            }
+
+            DecodedRecord decoded;
+            decoded.timestampNs = event.timestampNs;
+            decoded.level = record.level;
+            decoded.threadId = event.threadId;
+            auto it = formats.find(event.formatId);
+            decoded.text = it != formats.end() ? renderFormat(it->second, args)
+                                               : "<unknown format id " + to_string(event.formatId) + ">";
+            records.push_back(decoded);
+        }
+        else if (record.type == BinaryLog::Record_Lost)
+        {
+            uint32_t threadId = 0;
+            uint64_t count = 0;
+            readValue(data, pos, end, threadId);
+            readValue(data, pos, end, count);
+
+            DecodedRecord decoded;
+            decoded.timestampNs = records.empty() ? header.createdNs : records.back().timestampNs;
+            decoded.level = BinaryLog::Level_Warning;
+            decoded.threadId = threadId;
+            decoded.text = "<" + to_string(count) + " records dropped: thread buffer overflow>";
+            records.push_back(decoded);
+        }
+
+        pos = end; // 无论记录类型是否认识，都跳到下一条记录
+    }
+    return true;
+}
+
+// --- 3. 程序入口 ---
+int main(int argc, char* argv[])
+{
+    bool sortByTime = false;
+    vector<string> paths;
+    for (int i = 1; i < argc; ++i)
+    {
+        string arg = argv[i];
+        if (arg == "--sort") sortByTime = true;
+        else paths.push_back(arg);
+    }
+
+    if (paths.empty()) {
+        cerr << "Usage: LogDecoder [--sort] <file1.plog> [file2.plog ...]" << endl;
+        return -1;
+    }
+
+    vector<DecodedRecord> records;
+    int failures = 0;
+    for (const string& path : paths)
+    {
+        if (!decodeFile(path, records)) ++failures;
+    }
+
+    if (sortByTime) {
+        // stable_sort 保证同一时间戳的记录保持文件中的原始顺序
+        stable_sort(records.begin(), records.end(), [](const DecodedRecord& a, const DecodedRecord& b) {
+            return a.timestampNs < b.timestampNs;
+        });
+    }
+
+    for (const DecodedRecord& record : records)
+    {
+        cout << formatTimestamp(record.timestampNs) << " " << levelLabel(record.level)
+             << "[tid " << record.threadId << "] " << record.text << "\n";
+    }
+
+    return failures == 0 ? 0 : -1;
+}